@@ -5,6 +5,10 @@
 #include <bench/bench.h>
 #include <consensus/validation.h>
 #include <crypto/sha256.h>
+#include <mw/models/crypto/BlindingFactor.h>
+#include <mw/models/tx/Kernel.h>
+#include <mw/models/tx/Transaction.h>
+#include <policy/feerate.h>
 #include <test/util/mining.h>
 #include <test/util/setup_common.h>
 #include <test/util/wallet.h>
@@ -14,7 +18,15 @@
 
 #include <vector>
 
-static void AssembleBlock(benchmark::Bench& bench)
+static CTransactionRef MakeMWEBOnlyTx(CAmount fee)
+{
+    Kernel kernel = Kernel::Create(BlindingFactor::Random(), boost::none, fee, boost::none, {}, boost::none);
+    CMutableTransaction tx;
+    tx.mweb_tx = MWEB::Tx(std::make_shared<mw::Transaction>(BlindingFactor(), BlindingFactor(), TxBody({}, {}, {kernel})));
+    return MakeTransactionRef(tx);
+}
+
+static void AssembleBlockWith(benchmark::Bench& bench, size_t num_mweb_txs)
 {
     TestingSetup test_setup{
         CBaseChainParams::REGTEST,
@@ -52,6 +64,15 @@ static void AssembleBlock(benchmark::Bench& bench)
             bool ret{::AcceptToMemoryPool(*test_setup.m_node.mempool, state, txr, nullptr /* plTxnReplaced */, false /* bypass_limits */)};
             assert(ret);
         }
+
+        // MWEB-only transactions paying more than the canonical ones, so that
+        // they are evaluated first and compete with them for the block.
+        LOCK(test_setup.m_node.mempool->cs);
+        LockPoints lp;
+        for (size_t i = 0; i < num_mweb_txs; ++i) {
+            const CAmount fee = 100 * BASE_MWEB_FEE;
+            test_setup.m_node.mempool->addUnchecked(CTxMemPoolEntry(MakeMWEBOnlyTx(fee), fee, 0, 1, false, 0, lp));
+        }
     }
 
     bench.run([&] {
@@ -59,4 +80,16 @@ static void AssembleBlock(benchmark::Bench& bench)
     });
 }
 
+static void AssembleBlock(benchmark::Bench& bench)
+{
+    AssembleBlockWith(bench, 0);
+}
+
+// Same as AssembleBlock, with a mempool dominated by MWEB-only transactions.
+static void AssembleBlockMWEB(benchmark::Bench& bench)
+{
+    AssembleBlockWith(bench, 2000);
+}
+
 BENCHMARK(AssembleBlock);
+BENCHMARK(AssembleBlockMWEB);
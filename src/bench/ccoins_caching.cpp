@@ -4,10 +4,14 @@
 
 #include <bench/bench.h>
 #include <coins.h>
+#include <memusage.h>
 #include <policy/policy.h>
+#include <random.h>
 #include <script/signingprovider.h>
 #include <test/util/transaction_utils.h>
 
+#include <ostream>
+#include <unordered_map>
 #include <vector>
 
 // Microbenchmark for simple accesses to a CCoinsViewCache database. Note from
@@ -52,3 +56,54 @@ static void CCoinsCaching(benchmark::Bench& bench)
 }
 
 BENCHMARK(CCoinsCaching);
+
+//! The layout of the coins cache map before its nodes were pooled
+using CCoinsMapUnpooled = std::unordered_map<COutPoint, CCoinsCacheEntry, SaltedOutpointHasher>;
+
+/**
+ * Fill a coins cache map, look up every coin and erase them again, as a flush does.
+ * The memory used by the filled map is reported per coin.
+ */
+template <typename Map>
+static void CoinsMapFill(benchmark::Bench& bench)
+{
+    constexpr size_t NUM_COINS = 100000;
+    FastRandomContext rng(/* fDeterministic */ true);
+    std::vector<COutPoint> outpoints;
+    outpoints.reserve(NUM_COINS);
+    for (size_t i = 0; i < NUM_COINS; ++i) {
+        outpoints.emplace_back(rng.rand256(), rng.randrange(4));
+    }
+    const Coin coin(CTxOut(COIN, CScript() << OP_DUP << OP_HASH160 << std::vector<unsigned char>(20, 1) << OP_EQUALVERIFY << OP_CHECKSIG), 1, false, false);
+
+    size_t usage = 0;
+    bench.batch(NUM_COINS).unit("coin").run([&] {
+        Map map;
+        for (const COutPoint& outpoint : outpoints) {
+            map.emplace(std::piecewise_construct, std::forward_as_tuple(outpoint), std::forward_as_tuple(Coin(coin)));
+        }
+        for (const COutPoint& outpoint : outpoints) {
+            assert(map.count(outpoint));
+        }
+        usage = memusage::DynamicUsage(map);
+        for (auto it = map.begin(); it != map.end();) {
+            it = map.erase(it);
+        }
+    });
+    if (bench.output()) {
+        *bench.output() << "Map memory usage: " << usage / NUM_COINS << " bytes per coin" << std::endl;
+    }
+}
+
+static void CCoinsMapPooledFill(benchmark::Bench& bench)
+{
+    CoinsMapFill<CCoinsMap>(bench);
+}
+
+static void CCoinsMapUnpooledFill(benchmark::Bench& bench)
+{
+    CoinsMapFill<CCoinsMapUnpooled>(bench);
+}
+
+BENCHMARK(CCoinsMapPooledFill);
+BENCHMARK(CCoinsMapUnpooledFill);
@@ -0,0 +1,114 @@
+// Copyright (c) 2021 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <dbwrapper.h>
+#include <random.h>
+#include <test/util/dbengine.h>
+#include <uint256.h>
+#include <util/memory.h>
+
+#include <functional>
+#include <memory>
+#include <ostream>
+#include <utility>
+#include <vector>
+
+// Compare the LevelDB engine of CDBWrapper with a std::map. LevelDB runs in memory,
+// so that the difference is in how the engines store and find the keys, not in the
+// disk.
+
+constexpr size_t NUM_KEYS = 100000;
+constexpr size_t VALUE_SIZE = 40;
+
+using MakeDB = std::function<std::unique_ptr<CDBWrapper>()>;
+
+static std::unique_ptr<CDBWrapper> MakeLevelDB()
+{
+    return MakeUnique<CDBWrapper>("dbwrapper_bench", 8 << 20, /* fMemory */ true);
+}
+
+static std::unique_ptr<CDBWrapper> MakeMapDB()
+{
+    return MakeUnique<CDBWrapper>(MakeUnique<MapDBEngine>(), "dbwrapper_bench");
+}
+
+static std::vector<std::pair<char, uint256>> MakeKeys()
+{
+    FastRandomContext rng(/* fDeterministic */ true);
+    std::vector<std::pair<char, uint256>> keys;
+    keys.reserve(NUM_KEYS);
+    for (size_t i = 0; i < NUM_KEYS; ++i) {
+        keys.emplace_back('C', rng.rand256());
+    }
+    return keys;
+}
+
+/** Write all keys in one batch, overwriting them after the first run. */
+static void DBWrapperWrite(benchmark::Bench& bench, const MakeDB& make_db)
+{
+    const auto keys = MakeKeys();
+    const std::vector<unsigned char> value(VALUE_SIZE, 1);
+    const auto dbw = make_db();
+    bench.batch(NUM_KEYS).unit("key").run([&] {
+        CDBBatch batch(*dbw);
+        for (const auto& key : keys) {
+            batch.Write(key, value);
+        }
+        dbw->WriteBatch(batch);
+    });
+}
+
+/** Read random keys, of which half are in the database. */
+static void DBWrapperRead(benchmark::Bench& bench, const MakeDB& make_db)
+{
+    const auto keys = MakeKeys();
+    const std::vector<unsigned char> value(VALUE_SIZE, 1);
+    const auto dbw = make_db();
+    CDBBatch batch(*dbw);
+    for (size_t i = 0; i < NUM_KEYS; i += 2) {
+        batch.Write(keys[i], value);
+    }
+    dbw->WriteBatch(batch);
+    dbw->CompactRange(std::make_pair('C', uint256{}), std::make_pair('D', uint256{}));
+
+    FastRandomContext rng(/* fDeterministic */ true);
+    std::vector<unsigned char> read_value;
+    bench.batch(1000).unit("read").run([&] {
+        for (int i = 0; i < 1000; ++i) {
+            dbw->Read(keys[rng.randrange(NUM_KEYS)], read_value);
+        }
+    });
+
+    const DBStats stats = dbw->GetStats();
+    const uint64_t block_lookups = stats.block_cache_hits + stats.block_cache_misses;
+    if (bench.output() && block_lookups > 0) {
+        *bench.output() << "Block lookups per read: " << double(block_lookups) / stats.reads << std::endl;
+    }
+}
+
+static void DBWrapperWriteLevelDB(benchmark::Bench& bench)
+{
+    DBWrapperWrite(bench, MakeLevelDB);
+}
+
+static void DBWrapperWriteMap(benchmark::Bench& bench)
+{
+    DBWrapperWrite(bench, MakeMapDB);
+}
+
+static void DBWrapperReadLevelDB(benchmark::Bench& bench)
+{
+    DBWrapperRead(bench, MakeLevelDB);
+}
+
+static void DBWrapperReadMap(benchmark::Bench& bench)
+{
+    DBWrapperRead(bench, MakeMapDB);
+}
+
+BENCHMARK(DBWrapperWriteLevelDB);
+BENCHMARK(DBWrapperWriteMap);
+BENCHMARK(DBWrapperReadLevelDB);
+BENCHMARK(DBWrapperReadMap);
@@ -0,0 +1,82 @@
+// Copyright (c) 2020 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <mw/models/crypto/BlindingFactor.h>
+#include <mw/models/tx/Kernel.h>
+#include <mw/models/tx/Transaction.h>
+#include <policy/fees.h>
+#include <policy/policy.h>
+#include <random.h>
+#include <txmempool.h>
+
+#include <vector>
+
+static CTransactionRef MakeMWEBOnlyTx(CAmount fee)
+{
+    Kernel kernel = Kernel::Create(BlindingFactor::Random(), boost::none, fee, boost::none, {}, boost::none);
+    CMutableTransaction tx;
+    tx.mweb_tx = MWEB::Tx(std::make_shared<mw::Transaction>(BlindingFactor(), BlindingFactor(), TxBody({}, {}, {kernel})));
+    return MakeTransactionRef(tx);
+}
+
+// Replays a mempool history of canonical and MWEB-only transactions through
+// the fee estimator, with higher fee transactions confirming sooner, and then
+// estimates fees for every target.
+static void PolicyEstimatorReplay(benchmark::Bench& bench)
+{
+    constexpr unsigned int NUM_BLOCKS = 300;
+    constexpr int CANONICAL_TXS_PER_BLOCK = 40;
+    constexpr int MWEB_TXS_PER_BLOCK = 10;
+
+    FastRandomContext det_rand{true};
+    LockPoints lp;
+    std::vector<std::vector<CTxMemPoolEntry>> entered(NUM_BLOCKS);
+    std::vector<unsigned int> confirm_heights;
+    uint32_t tx_counter = 0;
+    for (unsigned int height = 0; height < NUM_BLOCKS; height++) {
+        entered[height].reserve(CANONICAL_TXS_PER_BLOCK + MWEB_TXS_PER_BLOCK);
+        for (int i = 0; i < CANONICAL_TXS_PER_BLOCK; i++) {
+            CMutableTransaction tx;
+            tx.vin.resize(1);
+            tx.vin[0].prevout.n = tx_counter++;
+            tx.vin[0].scriptSig = CScript() << OP_1;
+            tx.vout.resize(1);
+            tx.vout[0].scriptPubKey = CScript() << OP_1 << OP_EQUAL;
+            const int level = det_rand.randrange(10);
+            entered[height].emplace_back(MakeTransactionRef(tx), 2000 * (level + 1), 0, height, false, 4, lp);
+            confirm_heights.push_back(height + 1 + (9 - level) / 2);
+        }
+        for (int i = 0; i < MWEB_TXS_PER_BLOCK; i++) {
+            const int level = det_rand.randrange(5);
+            entered[height].emplace_back(MakeMWEBOnlyTx(BASE_MWEB_FEE * 2 * (level + 1)), BASE_MWEB_FEE * 2 * (level + 1), 0, height, false, 0, lp);
+            confirm_heights.push_back(height + 5 - level);
+        }
+    }
+
+    std::vector<std::vector<const CTxMemPoolEntry*>> confirmed(NUM_BLOCKS + 1);
+    size_t n = 0;
+    for (const std::vector<CTxMemPoolEntry>& entries : entered) {
+        for (const CTxMemPoolEntry& entry : entries) {
+            const unsigned int confirm_height = confirm_heights[n++];
+            if (confirm_height <= NUM_BLOCKS) confirmed[confirm_height].push_back(&entry);
+        }
+    }
+
+    bench.run([&] {
+        CBlockPolicyEstimator estimator;
+        for (unsigned int height = 0; height < NUM_BLOCKS; height++) {
+            for (const CTxMemPoolEntry& entry : entered[height]) {
+                estimator.processTransaction(entry, true);
+            }
+            estimator.processBlock(height + 1, confirmed[height + 1]);
+        }
+        for (int target = 2; target <= 48; target++) {
+            estimator.estimateSmartFee(target, nullptr, false);
+            estimator.estimateSmartMWEBFee(target, nullptr, false);
+        }
+    });
+}
+
+BENCHMARK(PolicyEstimatorReplay);
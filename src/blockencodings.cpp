@@ -115,11 +115,19 @@ ReadStatus PartiallyDownloadedBlock::InitData(const CBlockHeaderAndShortTxIDs& c
     {
     LOCK(pool->cs);
     for (size_t i = 0; i < pool->vTxHashes.size(); i++) {
-        uint64_t shortid = cmpctblock.GetShortID(pool->vTxHashes[i].first);
+        // MWEB: The wtxid doesn't commit to a tx's MWEB data, which is carried by the cmpctblock's
+        // mweb_block instead. The tx must be put into vtx stripped of it though, or CheckBlock rejects
+        // the block as mutated. The stripped form is cached by the mempool entry.
+        const CTransactionRef& block_tx = pool->vTxHashes[i].second->GetBlockTx();
+        if (!block_tx) {
+            continue; // MWEB-only txs are never in vtx
+        }
+
+        uint64_t shortid = cmpctblock.GetShortID(block_tx->GetWitnessHash());
         std::unordered_map<uint64_t, uint16_t>::iterator idit = shorttxids.find(shortid);
         if (idit != shorttxids.end()) {
             if (!have_txn[idit->second]) {
-                txn_available[idit->second] = pool->vTxHashes[i].second->GetSharedTx();
+                txn_available[idit->second] = block_tx;
                 have_txn[idit->second]  = true;
                 mempool_count++;
             } else {
@@ -22,6 +22,7 @@ static constexpr int GCS_SER_VERSION = 0;
 
 static const std::map<BlockFilterType, std::string> g_filter_types = {
     {BlockFilterType::BASIC, "basic"},
+    {BlockFilterType::MWEB, "mweb"},
 };
 
 // Map a value x that is uniformly distributed in the range [0, 2^64) to a
@@ -249,6 +250,26 @@ static GCSFilter::ElementSet BasicFilterElements(const CBlock& block,
     return elements;
 }
 
+GCSFilter::Element MWEBFilterElement(const mw::Hash& output_id)
+{
+    return output_id.vec();
+}
+
+static GCSFilter::ElementSet MWEBFilterElements(const CBlock& block)
+{
+    GCSFilter::ElementSet elements;
+    if (block.mweb_block.IsNull()) return elements;
+
+    for (const mw::Hash& output_id : block.mweb_block.GetOutputIDs()) {
+        elements.insert(MWEBFilterElement(output_id));
+    }
+    for (const mw::Hash& spent_id : block.mweb_block.GetSpentIDs()) {
+        elements.insert(MWEBFilterElement(spent_id));
+    }
+
+    return elements;
+}
+
 BlockFilter::BlockFilter(BlockFilterType filter_type, const uint256& block_hash,
                          std::vector<unsigned char> filter)
     : m_filter_type(filter_type), m_block_hash(block_hash)
@@ -267,13 +288,18 @@ BlockFilter::BlockFilter(BlockFilterType filter_type, const CBlock& block, const
     if (!BuildParams(params)) {
         throw std::invalid_argument("unknown filter_type");
     }
-    m_filter = GCSFilter(params, BasicFilterElements(block, block_undo));
+    if (filter_type == BlockFilterType::MWEB) {
+        m_filter = GCSFilter(params, MWEBFilterElements(block));
+    } else {
+        m_filter = GCSFilter(params, BasicFilterElements(block, block_undo));
+    }
 }
 
 bool BlockFilter::BuildParams(GCSFilter::Params& params) const
 {
     switch (m_filter_type) {
     case BlockFilterType::BASIC:
+    case BlockFilterType::MWEB:
         params.m_siphash_k0 = m_block_hash.GetUint64(0);
         params.m_siphash_k1 = m_block_hash.GetUint64(1);
         params.m_P = BASIC_FILTER_P;
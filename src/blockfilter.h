@@ -88,9 +88,13 @@ constexpr uint32_t BASIC_FILTER_M = 784931;
 enum class BlockFilterType : uint8_t
 {
     BASIC = 0,
+    MWEB = 1,
     INVALID = 255,
 };
 
+/** Get the MWEB filter element for an MWEB output ID, which is added when the output is created or spent. */
+GCSFilter::Element MWEBFilterElement(const mw::Hash& output_id);
+
 /** Get the human-readable name for a filter type. Returns empty string for unknown types. */
 const std::string& BlockFilterTypeName(BlockFilterType filter_type);
 
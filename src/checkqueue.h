@@ -52,6 +52,9 @@ private:
     //! The temporary evaluation result.
     bool fAllOk;
 
+    //! The first check that failed since the master last returned, if any
+    T failedCheck;
+
     /**
      * Number of verifications that haven't completed yet.
      * This includes elements that are no longer queued, but still in the
@@ -63,18 +66,23 @@ private:
     unsigned int nBatchSize;
 
     /** Internal function that does bulk of the verification work. */
-    bool Loop(bool fMaster = false)
+    bool Loop(bool fMaster = false, T* pfailed = nullptr)
     {
         boost::condition_variable& cond = fMaster ? condMaster : condWorker;
         std::vector<T> vChecks;
         vChecks.reserve(nBatchSize);
         unsigned int nNow = 0;
         bool fOk = true;
+        T failed;
         do {
             {
                 boost::unique_lock<boost::mutex> lock(mutex);
                 // first do the clean-up of the previous loop run (allowing us to do it in the same critsect)
                 if (nNow) {
+                    if (!fOk && fAllOk) {
+                        // Keep the first check that failed, so the master can tell why
+                        failedCheck.swap(failed);
+                    }
                     fAllOk &= fOk;
                     nTodo -= nNow;
                     if (nTodo == 0 && !fMaster)
@@ -89,8 +97,10 @@ private:
                     if (fMaster && nTodo == 0) {
                         nTotal--;
                         bool fRet = fAllOk;
+                        if (pfailed != nullptr && !fRet) pfailed->swap(failedCheck);
                         // reset the status for new work later
                         fAllOk = true;
+                        T().swap(failedCheck);
                         // return the current status
                         return fRet;
                     }
@@ -115,9 +125,12 @@ private:
                 fOk = fAllOk;
             }
             // execute work
-            for (T& check : vChecks)
-                if (fOk)
+            for (T& check : vChecks) {
+                if (fOk) {
                     fOk = check();
+                    if (!fOk) failed.swap(check);
+                }
+            }
             vChecks.clear();
         } while (true);
     }
@@ -127,7 +140,7 @@ public:
     boost::mutex ControlMutex;
 
     //! Create a new check queue
-    explicit CCheckQueue(unsigned int nBatchSizeIn) : nIdle(0), nTotal(0), fAllOk(true), nTodo(0), nBatchSize(nBatchSizeIn) {}
+    explicit CCheckQueue(unsigned int nBatchSizeIn) : nIdle(0), nTotal(0), fAllOk(true), failedCheck(), nTodo(0), nBatchSize(nBatchSizeIn) {}
 
     //! Worker thread
     void Thread()
@@ -136,9 +149,10 @@ public:
     }
 
     //! Wait until execution finishes, and return whether all evaluations were successful.
-    bool Wait()
+    //! If one failed and pfailed isn't nullptr, the first check that failed is swapped into it.
+    bool Wait(T* pfailed = nullptr)
     {
-        return Loop(true);
+        return Loop(true, pfailed);
     }
 
     //! Add a batch of checks to the queue
@@ -185,11 +199,11 @@ public:
         }
     }
 
-    bool Wait()
+    bool Wait(T* pfailed = nullptr)
     {
         if (pqueue == nullptr)
             return true;
-        bool fRet = pqueue->Wait();
+        bool fRet = pqueue->Wait(pfailed);
         fDone = true;
         return fRet;
     }
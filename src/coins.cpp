@@ -267,7 +267,9 @@ bool CCoinsViewCache::BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlockIn
 
 bool CCoinsViewCache::Flush() {
     bool fOk = base->BatchWrite(cacheCoins, hashBlock, mweb_view);
+    // Release the pool of the map, which the base may also have taken over with its entries
     cacheCoins.clear();
+    ReallocateCache();
     cachedCoinsUsage = 0;
     return fOk;
 }
@@ -283,6 +285,17 @@ void CCoinsViewCache::Uncache(const OutputIndex& coin)
     }
 }
 
+void CCoinsViewCache::AddFetchedCoins(std::vector<std::pair<COutPoint, Coin>>&& coins)
+{
+    for (auto& fetched : coins) {
+        if (fetched.second.IsSpent()) continue;
+        auto inserted = cacheCoins.emplace(std::piecewise_construct, std::forward_as_tuple(fetched.first), std::forward_as_tuple(std::move(fetched.second)));
+        if (inserted.second) {
+            cachedCoinsUsage += inserted.first->second.coin.DynamicMemoryUsage();
+        }
+    }
+}
+
 unsigned int CCoinsViewCache::GetCacheSize() const {
     return cacheCoins.size();
 }
@@ -13,6 +13,7 @@
 #include <mw/node/CoinsView.h>
 #include <primitives/transaction.h>
 #include <serialize.h>
+#include <support/allocators/pool.h>
 #include <uint256.h>
 
 #include <assert.h>
@@ -164,7 +165,15 @@ struct CCoinsCacheEntry
     explicit CCoinsCacheEntry(Coin&& coin_) : coin(std::move(coin_)), flags(0) {}
 };
 
-typedef std::unordered_map<COutPoint, CCoinsCacheEntry, SaltedOutpointHasher> CCoinsMap;
+/**
+ * The coins cache map. Its nodes are allocated from a pool, which saves the malloc
+ * overhead of every entry and makes the memory usage of the map exact. A node also
+ * holds the pointer to the next node, and the hash if it's cached, so blocks of up to
+ * four more pointers are pooled.
+ */
+using CCoinsMap = std::unordered_map<COutPoint, CCoinsCacheEntry, SaltedOutpointHasher, std::equal_to<COutPoint>,
+                                     PoolAllocator<std::pair<const COutPoint, CCoinsCacheEntry>,
+                                                   sizeof(std::pair<const COutPoint, CCoinsCacheEntry>) + sizeof(void*) * 4>>;
 
 /** Cursor for iterating over CoinsView state */
 class CCoinsViewCursor
@@ -333,6 +342,13 @@ public:
      */
     void Uncache(const OutputIndex& outpoint);
 
+    /**
+     * Add unmodified coins that were read from the base view, e.g. ahead of time on
+     * other threads. Outpoints that are already in the cache keep their entry. The
+     * caller must make sure that the base view didn't change since the coins were read.
+     */
+    void AddFetchedCoins(std::vector<std::pair<COutPoint, Coin>>&& coins);
+
     //! Calculate the size of the cache (in number of transaction outputs)
     unsigned int GetCacheSize() const;
 
@@ -342,9 +358,9 @@ public:
     //! Check whether all prevouts of the transaction are present in the UTXO set represented by this view
     bool HaveInputs(const CTransaction& tx) const;
 
-    //! Force a reallocation of the cache map. This is required when downsizing
-    //! the cache because the map's allocator may be hanging onto a lot of
-    //! memory despite having called .clear().
+    //! Force a reallocation of the cache map. This is required after the cache
+    //! was emptied, because the map's pool keeps its memory despite having
+    //! called .clear(). Flush() does this.
     //!
     //! See: https://stackoverflow.com/questions/42114044/how-to-release-unordered-map-memory
     void ReallocateCache();
@@ -477,6 +477,22 @@ public:
             }
         return false;
     }
+
+    /** for_each calls f on every element that is stored and not garbage
+     * collected, in table order.
+     *
+     * for_each does not modify the table, so it may run concurrently with
+     * contains.
+     *
+     * @param f the function to call on each element
+     */
+    template <typename F>
+    void for_each(F f) const
+    {
+        for (uint32_t i = 0; i < size; ++i)
+            if (!collection_flags.bit_is_set(i))
+                f(table[i]);
+    }
 };
 } // namespace CuckooCache
 
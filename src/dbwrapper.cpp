@@ -6,6 +6,8 @@
 
 #include <memory>
 #include <random.h>
+#include <sync.h>
+#include <util/memory.h>
 
 #include <leveldb/cache.h>
 #include <leveldb/env.h>
@@ -13,12 +15,27 @@
 #include <memenv.h>
 #include <stdint.h>
 #include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <iterator>
+#include <set>
+#include <sstream>
 
 class CBitcoinLevelDBLogger : public leveldb::Logger {
 public:
+    //! Compactions and write buffer flushes, which LevelDB only reports in its log
+    std::atomic<uint64_t> m_compactions{0};
+    std::atomic<uint64_t> m_memtable_flushes{0};
+
     // This code is adapted from posix_logger.h, which is why it is using vsprintf.
     // Please do not do this in normal code
     void Logv(const char * format, va_list ap) override {
+            // The format strings of these messages are in db/db_impl.cc
+            if (strcmp(format, "Compacting %d@%d + %d@%d files") == 0) {
+                ++m_compactions;
+            } else if (strcmp(format, "Level-0 table #%llu: started") == 0) {
+                ++m_memtable_flushes;
+            }
             if (!LogAcceptCategory(BCLog::LEVELDB)) {
                 return;
             }
@@ -72,6 +89,38 @@ public:
     }
 };
 
+/** A block cache that counts how often blocks are found in it. */
+class CountingCache : public leveldb::Cache {
+private:
+    const std::unique_ptr<leveldb::Cache> m_cache;
+
+public:
+    std::atomic<uint64_t> m_hits{0};
+    std::atomic<uint64_t> m_misses{0};
+
+    explicit CountingCache(size_t capacity) : m_cache(leveldb::NewLRUCache(capacity)) {}
+
+    Handle* Insert(const leveldb::Slice& key, void* value, size_t charge,
+                   void (*deleter)(const leveldb::Slice& key, void* value)) override
+    {
+        return m_cache->Insert(key, value, charge, deleter);
+    }
+
+    Handle* Lookup(const leveldb::Slice& key) override
+    {
+        Handle* handle = m_cache->Lookup(key);
+        ++(handle ? m_hits : m_misses);
+        return handle;
+    }
+
+    void Release(Handle* handle) override { m_cache->Release(handle); }
+    void* Value(Handle* handle) override { return m_cache->Value(handle); }
+    void Erase(const leveldb::Slice& key) override { m_cache->Erase(key); }
+    uint64_t NewId() override { return m_cache->NewId(); }
+    void Prune() override { m_cache->Prune(); }
+    size_t TotalCharge() const override { return m_cache->TotalCharge(); }
+};
+
 static void SetMaxOpenFiles(leveldb::Options *options) {
     // On most platforms the default setting of max_open_files (which is 1000)
     // is optimal. On Windows using a large file count is OK because the handles
@@ -97,12 +146,21 @@ static void SetMaxOpenFiles(leveldb::Options *options) {
              options->max_open_files, default_open_files);
 }
 
-static leveldb::Options GetOptions(size_t nCacheSize)
+//! Share of the cache that caches blocks. Divided first, as the product can overflow a 32-bit size_t.
+static size_t GetBlockCacheSize(size_t nCacheSize, const DBOptions& db_options)
+{
+    return nCacheSize / 100 * db_options.block_cache_percent;
+}
+
+static leveldb::Options GetOptions(size_t nCacheSize, const DBOptions& db_options)
 {
     leveldb::Options options;
-    options.block_cache = leveldb::NewLRUCache(nCacheSize / 2);
-    options.write_buffer_size = nCacheSize / 4; // up to two write buffers may be held in memory simultaneously
-    options.filter_policy = leveldb::NewBloomFilterPolicy(10);
+    options.block_cache = new CountingCache(GetBlockCacheSize(nCacheSize, db_options));
+    // up to two write buffers may be held in memory simultaneously
+    options.write_buffer_size = (nCacheSize - GetBlockCacheSize(nCacheSize, db_options)) / 2;
+    options.filter_policy = db_options.bloom_bits > 0 ? leveldb::NewBloomFilterPolicy(db_options.bloom_bits) : nullptr;
+    options.block_size = db_options.block_size;
+    options.max_file_size = db_options.max_file_size;
     options.compression = leveldb::kNoCompression;
     options.info_log = new CBitcoinLevelDBLogger();
     if (leveldb::kMajorVersion > 1 || (leveldb::kMajorVersion == 1 && leveldb::kMinorVersion >= 16)) {
@@ -114,38 +172,225 @@ static leveldb::Options GetOptions(size_t nCacheSize)
     return options;
 }
 
-CDBWrapper::CDBWrapper(const fs::path& path, size_t nCacheSize, bool fMemory, bool fWipe, bool obfuscate)
-    : m_name{path.stem().string()}
+namespace {
+
+struct DBOptionSetting {
+    const char* name;
+    int64_t min;
+    int64_t max;
+    void (*apply)(DBOptions& options, int64_t value);
+};
+
+const DBOptionSetting DB_OPTION_SETTINGS[] = {
+    {"bloombits", 0, 64, [](DBOptions& options, int64_t value) { options.bloom_bits = value; }},
+    {"blocksize", 1, 4 << 10, [](DBOptions& options, int64_t value) { options.block_size = value << 10; }},
+    {"maxfilesize", 1, 1 << 10, [](DBOptions& options, int64_t value) { options.max_file_size = value << 20; }},
+    {"blockcachepercent", 1, 99, [](DBOptions& options, int64_t value) { options.block_cache_percent = value; }},
+};
+
+/** The databases of the node use LevelDB. */
+class LevelDBEngine final : public DBEngine
 {
-    penv = nullptr;
-    readoptions.verify_checksums = true;
-    iteroptions.verify_checksums = true;
-    iteroptions.fill_cache = false;
-    syncoptions.sync = true;
-    options = GetOptions(nCacheSize);
-    options.create_if_missing = true;
-    if (fMemory) {
-        penv = leveldb::NewMemEnv(leveldb::Env::Default());
-        options.env = penv;
-    } else {
-        if (fWipe) {
-            LogPrintf("Wiping LevelDB in %s\n", path.string());
-            leveldb::Status result = leveldb::DestroyDB(path.string(), options);
-            dbwrapper_private::HandleError(result);
+private:
+    //! custom environment this database is using (may be nullptr in case of default environment)
+    leveldb::Env* penv{nullptr};
+
+    //! database options used
+    leveldb::Options options;
+
+    //! options used when reading from the database
+    leveldb::ReadOptions readoptions;
+
+    //! options used when iterating over values of the database
+    leveldb::ReadOptions iteroptions;
+
+    //! options used when writing to the database
+    leveldb::WriteOptions writeoptions;
+
+    //! options used when sync writing to the database
+    leveldb::WriteOptions syncoptions;
+
+    //! the database itself
+    leveldb::DB* pdb{nullptr};
+
+    mutable std::atomic<uint64_t> m_reads{0};
+
+public:
+    LevelDBEngine(const fs::path& path, size_t nCacheSize, bool fMemory, bool fWipe, const DBOptions& db_options)
+    {
+        readoptions.verify_checksums = true;
+        iteroptions.verify_checksums = true;
+        iteroptions.fill_cache = false;
+        syncoptions.sync = true;
+        options = GetOptions(nCacheSize, db_options);
+        options.create_if_missing = true;
+        LogPrint(BCLog::LEVELDB, "LevelDB options for %s: bloom_bits=%d block_size=%u max_file_size=%u block_cache=%u write_buffer_size=%u\n",
+                 path.string(), db_options.bloom_bits, options.block_size, options.max_file_size,
+                 GetBlockCacheSize(nCacheSize, db_options), options.write_buffer_size);
+        if (fMemory) {
+            penv = leveldb::NewMemEnv(leveldb::Env::Default());
+            options.env = penv;
+        } else {
+            if (fWipe) {
+                LogPrintf("Wiping LevelDB in %s\n", path.string());
+                leveldb::Status result = leveldb::DestroyDB(path.string(), options);
+                dbwrapper_private::HandleError(result);
+            }
+            TryCreateDirectories(path);
+            LogPrintf("Opening LevelDB in %s\n", path.string());
+        }
+        leveldb::Status status = leveldb::DB::Open(options, path.string(), &pdb);
+        dbwrapper_private::HandleError(status);
+        LogPrintf("Opened LevelDB successfully\n");
+
+        if (gArgs.GetBoolArg("-forcecompactdb", false)) {
+            LogPrintf("Starting database compaction of %s\n", path.string());
+            pdb->CompactRange(nullptr, nullptr);
+            LogPrintf("Finished database compaction of %s\n", path.string());
         }
-        TryCreateDirectories(path);
-        LogPrintf("Opening LevelDB in %s\n", path.string());
     }
-    leveldb::Status status = leveldb::DB::Open(options, path.string(), &pdb);
-    dbwrapper_private::HandleError(status);
-    LogPrintf("Opened LevelDB successfully\n");
 
-    if (gArgs.GetBoolArg("-forcecompactdb", false)) {
-        LogPrintf("Starting database compaction of %s\n", path.string());
-        pdb->CompactRange(nullptr, nullptr);
-        LogPrintf("Finished database compaction of %s\n", path.string());
+    ~LevelDBEngine() override
+    {
+        delete pdb;
+        pdb = nullptr;
+        delete options.filter_policy;
+        options.filter_policy = nullptr;
+        delete options.info_log;
+        options.info_log = nullptr;
+        delete options.block_cache;
+        options.block_cache = nullptr;
+        delete penv;
+        options.env = nullptr;
+    }
+
+    leveldb::Status Get(const leveldb::Slice& key, std::string* value) const override
+    {
+        ++m_reads;
+        return pdb->Get(readoptions, key, value);
     }
 
+    leveldb::Status Write(const leveldb::WriteBatch& batch, bool sync) override
+    {
+        // LevelDB doesn't modify the batch, it only takes it by pointer
+        return pdb->Write(sync ? syncoptions : writeoptions, const_cast<leveldb::WriteBatch*>(&batch));
+    }
+
+    leveldb::Iterator* NewIterator() const override
+    {
+        return pdb->NewIterator(iteroptions);
+    }
+
+    uint64_t EstimateSize(const leveldb::Slice& begin, const leveldb::Slice& end) const override
+    {
+        uint64_t size = 0;
+        leveldb::Range range(begin, end);
+        pdb->GetApproximateSizes(&range, 1, &size);
+        return size;
+    }
+
+    void CompactRange(const leveldb::Slice* begin, const leveldb::Slice* end) override
+    {
+        pdb->CompactRange(begin, end);
+    }
+
+    size_t DynamicMemoryUsage() const override
+    {
+        std::string memory;
+        if (!pdb->GetProperty("leveldb.approximate-memory-usage", &memory)) {
+            LogPrint(BCLog::LEVELDB, "Failed to get approximate-memory-usage property\n");
+            return 0;
+        }
+        return stoul(memory);
+    }
+
+    DBStats GetStats() const override
+    {
+        DBStats stats;
+        stats.engine = "leveldb";
+        stats.reads = m_reads;
+        const auto& cache = static_cast<const CountingCache&>(*options.block_cache);
+        stats.block_cache_hits = cache.m_hits;
+        stats.block_cache_misses = cache.m_misses;
+        const auto& logger = static_cast<const CBitcoinLevelDBLogger&>(*options.info_log);
+        stats.compactions = logger.m_compactions;
+        stats.memtable_flushes = logger.m_memtable_flushes;
+        stats.memory_usage = DynamicMemoryUsage();
+
+        // Parse the per level table below the three header lines
+        std::string table;
+        if (pdb->GetProperty("leveldb.stats", &table)) {
+            std::istringstream lines(table);
+            std::string line;
+            for (int header = 0; header < 3 && std::getline(lines, line); ++header) {}
+            while (std::getline(lines, line)) {
+                DBStats::Level level;
+                if (sscanf(line.c_str(), "%d %d %lf %lf %lf %lf", &level.level, &level.files, &level.size_mib,
+                           &level.compaction_secs, &level.compaction_read_mib, &level.compaction_write_mib) == 6) {
+                    stats.levels.push_back(level);
+                }
+            }
+        }
+        return stats;
+    }
+};
+
+Mutex g_dbwrappers_mutex;
+std::set<const CDBWrapper*> g_dbwrappers GUARDED_BY(g_dbwrappers_mutex);
+
+} // namespace
+
+bool ReadDBOptions(const ArgsManager& args, const std::string& db_name, DBOptions& options, std::string& error)
+{
+    for (const std::string& setting : args.GetArgs("-dboption")) {
+        const size_t colon = setting.find(':');
+        const size_t equals = setting.find('=', colon);
+        int64_t value;
+        if (colon == std::string::npos || equals == std::string::npos || !ParseInt64(setting.substr(equals + 1), &value)) {
+            error = strprintf("Invalid -dboption '%s', expected <db>:<option>=<value>", setting);
+            return false;
+        }
+        const std::string name = setting.substr(colon + 1, equals - colon - 1);
+        const auto it = std::find_if(std::begin(DB_OPTION_SETTINGS), std::end(DB_OPTION_SETTINGS),
+                                     [&](const DBOptionSetting& option) { return name == option.name; });
+        if (it == std::end(DB_OPTION_SETTINGS)) {
+            error = strprintf("Unknown database option '%s' in -dboption '%s'", name, setting);
+            return false;
+        }
+        if (value < it->min || value > it->max) {
+            error = strprintf("Database option %s must be between %d and %d in -dboption '%s'", name, it->min, it->max, setting);
+            return false;
+        }
+        if (setting.compare(0, colon, db_name) == 0) {
+            it->apply(options, value);
+        }
+    }
+    return true;
+}
+
+static std::string GetDBName(const fs::path& path, const std::string& name)
+{
+    return name.empty() ? path.stem().string() : name;
+}
+
+static DBOptions GetDBOptions(const std::string& name)
+{
+    DBOptions db_options;
+    std::string error;
+    // Malformed settings are rejected at startup
+    ReadDBOptions(gArgs, name, db_options, error);
+    return db_options;
+}
+
+CDBWrapper::CDBWrapper(const fs::path& path, size_t nCacheSize, bool fMemory, bool fWipe, bool obfuscate, const std::string& name)
+    : CDBWrapper(MakeUnique<LevelDBEngine>(path, nCacheSize, fMemory, fWipe, GetDBOptions(GetDBName(path, name))),
+                 GetDBName(path, name), obfuscate)
+{
+}
+
+CDBWrapper::CDBWrapper(std::unique_ptr<DBEngine> engine, const std::string& name, bool obfuscate)
+    : m_engine{std::move(engine)}, m_name{name}
+{
     // The base-case obfuscation key, which is a noop.
     obfuscate_key = std::vector<unsigned char>(OBFUSCATE_KEY_NUM_BYTES, '\000');
 
@@ -160,24 +405,17 @@ CDBWrapper::CDBWrapper(const fs::path& path, size_t nCacheSize, bool fMemory, bo
         Write(OBFUSCATE_KEY_KEY, new_key);
         obfuscate_key = new_key;
 
-        LogPrintf("Wrote new obfuscate key for %s: %s\n", path.string(), HexStr(obfuscate_key));
+        LogPrintf("Wrote new obfuscate key for %s: %s\n", m_name, HexStr(obfuscate_key));
     }
 
-    LogPrintf("Using obfuscation key for %s: %s\n", path.string(), HexStr(obfuscate_key));
+    LogPrintf("Using obfuscation key for %s: %s\n", m_name, HexStr(obfuscate_key));
+
+    WITH_LOCK(g_dbwrappers_mutex, g_dbwrappers.insert(this));
 }
 
 CDBWrapper::~CDBWrapper()
 {
-    delete pdb;
-    pdb = nullptr;
-    delete options.filter_policy;
-    options.filter_policy = nullptr;
-    delete options.info_log;
-    options.info_log = nullptr;
-    delete options.block_cache;
-    options.block_cache = nullptr;
-    delete penv;
-    options.env = nullptr;
+    WITH_LOCK(g_dbwrappers_mutex, g_dbwrappers.erase(this));
 }
 
 bool CDBWrapper::WriteBatch(CDBBatch& batch, bool fSync)
@@ -187,7 +425,7 @@ bool CDBWrapper::WriteBatch(CDBBatch& batch, bool fSync)
     if (log_memory) {
         mem_before = DynamicMemoryUsage() / 1024.0 / 1024;
     }
-    leveldb::Status status = pdb->Write(fSync ? syncoptions : writeoptions, &batch.batch);
+    leveldb::Status status = m_engine->Write(batch.batch, fSync);
     dbwrapper_private::HandleError(status);
     if (log_memory) {
         double mem_after = DynamicMemoryUsage() / 1024.0 / 1024;
@@ -198,12 +436,7 @@ bool CDBWrapper::WriteBatch(CDBBatch& batch, bool fSync)
 }
 
 size_t CDBWrapper::DynamicMemoryUsage() const {
-    std::string memory;
-    if (!pdb->GetProperty("leveldb.approximate-memory-usage", &memory)) {
-        LogPrint(BCLog::LEVELDB, "Failed to get approximate-memory-usage property\n");
-        return 0;
-    }
-    return stoul(memory);
+    return m_engine->DynamicMemoryUsage();
 }
 
 // Prefixed with null character to avoid collisions with other keys
@@ -233,6 +466,14 @@ bool CDBWrapper::IsEmpty()
     return !(it->Valid());
 }
 
+void ForEachDBWrapper(std::function<void(const CDBWrapper&)> fn)
+{
+    LOCK(g_dbwrappers_mutex);
+    for (const CDBWrapper* dbw : g_dbwrappers) {
+        fn(*dbw);
+    }
+}
+
 CDBIterator::~CDBIterator() { delete piter; }
 bool CDBIterator::Valid() const { return piter->Valid(); }
 void CDBIterator::SeekToFirst() { piter->SeekToFirst(); }
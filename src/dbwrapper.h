@@ -15,6 +15,9 @@
 #include <leveldb/db.h>
 #include <leveldb/write_batch.h>
 
+#include <functional>
+#include <memory>
+
 static const size_t DBWRAPPER_PREALLOC_KEY_SIZE = 64;
 static const size_t DBWRAPPER_PREALLOC_VALUE_SIZE = 1024;
 
@@ -24,6 +27,87 @@ public:
     explicit dbwrapper_error(const std::string& msg) : std::runtime_error(msg) {}
 };
 
+/**
+ * LevelDB settings of a database, which can be changed per database with
+ * -dboption=<db>:<option>=<value>.
+ */
+struct DBOptions {
+    //! Bits per key of the bloom filters, which save reading blocks that don't have a key (0 disables them)
+    int bloom_bits{10};
+    //! Size of the blocks that keys are read in, in bytes
+    size_t block_size{4 << 10};
+    //! Size up to which a table file is written, in bytes
+    size_t max_file_size{2 << 20};
+    //! Share of the cache that caches blocks, in percent. The rest is split between the two write buffers.
+    int block_cache_percent{50};
+};
+
+/**
+ * Apply the -dboption settings of the database db_name to options. All settings
+ * are checked, also those of other databases.
+ *
+ * @returns false if a setting is malformed or out of range, with the reason in error
+ */
+bool ReadDBOptions(const ArgsManager& args, const std::string& db_name, DBOptions& options, std::string& error);
+
+/** Statistics of a database, as far as its engine keeps them. */
+struct DBStats {
+    struct Level {
+        int level;
+        int files;
+        double size_mib;
+        double compaction_secs;
+        double compaction_read_mib;
+        double compaction_write_mib;
+    };
+
+    std::string engine;
+    //! Point reads, i.e. Read and Exists calls
+    uint64_t reads{0};
+    //! Lookups of data blocks in the block cache, by point reads and iterators
+    uint64_t block_cache_hits{0};
+    uint64_t block_cache_misses{0};
+    //! Compactions that merged files into the next level
+    uint64_t compactions{0};
+    //! Write buffers that were written to level 0
+    uint64_t memtable_flushes{0};
+    size_t memory_usage{0};
+    std::vector<Level> levels;
+};
+
+/**
+ * The storage engine of a CDBWrapper, which stores the serialized keys and values.
+ *
+ * LevelDB is the engine of all databases of the node. The interface allows another
+ * engine to be measured against it under the same CDBWrapper code. It speaks in the
+ * LevelDB types Slice, Status, WriteBatch and Iterator, which don't depend on how the
+ * data is stored. Engines must be safe to use from multiple threads.
+ */
+class DBEngine
+{
+public:
+    virtual ~DBEngine() = default;
+
+    //! Read the value of key, returning a NotFound status if there is none
+    virtual leveldb::Status Get(const leveldb::Slice& key, std::string* value) const = 0;
+
+    //! Apply all changes of the batch atomically, and to disk before returning if sync is set
+    virtual leveldb::Status Write(const leveldb::WriteBatch& batch, bool sync) = 0;
+
+    //! Iterate over a consistent view of the database, without filling caches
+    virtual leveldb::Iterator* NewIterator() const = 0;
+
+    //! Estimate the size on disk of the keys in [begin, end)
+    virtual uint64_t EstimateSize(const leveldb::Slice& begin, const leveldb::Slice& end) const = 0;
+
+    //! Compact the keys in [begin, end], where nullptr is before or after all keys
+    virtual void CompactRange(const leveldb::Slice* begin, const leveldb::Slice* end) = 0;
+
+    virtual size_t DynamicMemoryUsage() const = 0;
+
+    virtual DBStats GetStats() const = 0;
+};
+
 class CDBWrapper;
 
 /** These should be considered an implementation detail of the specific database.
@@ -176,26 +260,8 @@ class CDBWrapper
 {
     friend const std::vector<unsigned char>& dbwrapper_private::GetObfuscateKey(const CDBWrapper &w);
 private:
-    //! custom environment this database is using (may be nullptr in case of default environment)
-    leveldb::Env* penv;
-
-    //! database options used
-    leveldb::Options options;
-
-    //! options used when reading from the database
-    leveldb::ReadOptions readoptions;
-
-    //! options used when iterating over values of the database
-    leveldb::ReadOptions iteroptions;
-
-    //! options used when writing to the database
-    leveldb::WriteOptions writeoptions;
-
-    //! options used when sync writing to the database
-    leveldb::WriteOptions syncoptions;
-
-    //! the database itself
-    leveldb::DB* pdb;
+    //! the engine storing the database
+    std::unique_ptr<DBEngine> m_engine;
 
     //! the name of this database
     std::string m_name;
@@ -219,8 +285,15 @@ public:
      * @param[in] fWipe       If true, remove all existing data.
      * @param[in] obfuscate   If true, store data obfuscated via simple XOR. If false, XOR
      *                        with a zero'd byte array.
+     * @param[in] name        Name of the database for -dboption and getdbstats. Defaults to
+     *                        the last component of path.
+     */
+    CDBWrapper(const fs::path& path, size_t nCacheSize, bool fMemory = false, bool fWipe = false, bool obfuscate = false, const std::string& name = "");
+
+    /**
+     * Store the database in another engine than LevelDB, to compare the two.
      */
-    CDBWrapper(const fs::path& path, size_t nCacheSize, bool fMemory = false, bool fWipe = false, bool obfuscate = false);
+    CDBWrapper(std::unique_ptr<DBEngine> engine, const std::string& name, bool obfuscate = false);
     ~CDBWrapper();
 
     CDBWrapper(const CDBWrapper&) = delete;
@@ -235,7 +308,7 @@ public:
         leveldb::Slice slKey(ssKey.data(), ssKey.size());
 
         std::string strValue;
-        leveldb::Status status = pdb->Get(readoptions, slKey, &strValue);
+        leveldb::Status status = m_engine->Get(slKey, &strValue);
         if (!status.ok()) {
             if (status.IsNotFound())
                 return false;
@@ -269,7 +342,7 @@ public:
         leveldb::Slice slKey(ssKey.data(), ssKey.size());
 
         std::string strValue;
-        leveldb::Status status = pdb->Get(readoptions, slKey, &strValue);
+        leveldb::Status status = m_engine->Get(slKey, &strValue);
         if (!status.ok()) {
             if (status.IsNotFound())
                 return false;
@@ -292,9 +365,13 @@ public:
     // Get an estimate of LevelDB memory usage (in bytes).
     size_t DynamicMemoryUsage() const;
 
+    const std::string& GetName() const { return m_name; }
+
+    DBStats GetStats() const { return m_engine->GetStats(); }
+
     CDBIterator *NewIterator()
     {
-        return new CDBIterator(*this, pdb->NewIterator(iteroptions));
+        return new CDBIterator(*this, m_engine->NewIterator());
     }
 
     /**
@@ -312,10 +389,7 @@ public:
         ssKey2 << key_end;
         leveldb::Slice slKey1(ssKey1.data(), ssKey1.size());
         leveldb::Slice slKey2(ssKey2.data(), ssKey2.size());
-        uint64_t size = 0;
-        leveldb::Range range(slKey1, slKey2);
-        pdb->GetApproximateSizes(&range, 1, &size);
-        return size;
+        return m_engine->EstimateSize(slKey1, slKey2);
     }
 
     /**
@@ -331,9 +405,12 @@ public:
         ssKey2 << key_end;
         leveldb::Slice slKey1(ssKey1.data(), ssKey1.size());
         leveldb::Slice slKey2(ssKey2.data(), ssKey2.size());
-        pdb->CompactRange(&slKey1, &slKey2);
+        m_engine->CompactRange(&slKey1, &slKey2);
     }
 
 };
 
+/** Iterate over all open databases. */
+void ForEachDBWrapper(std::function<void(const CDBWrapper&)> fn);
+
 #endif // BITCOIN_DBWRAPPER_H
@@ -27,6 +27,9 @@
 /** WWW-Authenticate to present with 401 Unauthorized response */
 static const char* WWW_AUTH_HEADER_DATA = "Basic realm=\"jsonrpc\"";
 
+/** Number of bytes at the start of a request body that are scanned for its methods */
+static const size_t MAX_CLASSIFY_SCAN_SIZE = 64 * 1024;
+
 /** Simple one-shot callback timer to be used by the RPC mechanism to e.g.
  * re-lock the wallet.
  */
@@ -150,6 +153,34 @@ static bool RPCAuthorized(const std::string& strAuth, std::string& strAuthUserna
     return multiUserAuthorized(strUserPass);
 }
 
+/** Return the methods a JSON-RPC request or batch calls, to pick its work class.
+ * This runs on the event loop thread, before the request is authorized, so it
+ * doesn't parse the body: it only scans the start of it for "method" members, and
+ * HTTPReq_JSONRPC parses it once on a worker thread. A "method" inside a parameter,
+ * or one past the scanned part, can only move the request to a different class. */
+static std::vector<std::string> JSONRPCRequestMethods(HTTPRequest* req)
+{
+    std::vector<std::string> methods;
+    if (req->GetRequestMethod() != HTTPRequest::POST)
+        return methods;
+    static const std::string key = "\"method\"";
+    static const char* whitespace = " \t\r\n";
+    const std::string body = req->PeekBody(MAX_CLASSIFY_SCAN_SIZE);
+    for (size_t pos = body.find(key); pos != std::string::npos; pos = body.find(key, pos)) {
+        pos = body.find_first_not_of(whitespace, pos + key.size());
+        if (pos == std::string::npos || body[pos] != ':') continue;
+        pos = body.find_first_not_of(whitespace, pos + 1);
+        if (pos == std::string::npos || body[pos] != '"') continue;
+        const size_t end = body.find('"', pos + 1);
+        if (end == std::string::npos) break;
+        methods.push_back(body.substr(pos + 1, end - pos - 1));
+        pos = end + 1;
+    }
+    // Calls past the scanned part go to the default class at least
+    if (body.size() == MAX_CLASSIFY_SCAN_SIZE) methods.emplace_back();
+    return methods;
+}
+
 static bool HTTPReq_JSONRPC(const util::Ref& context, HTTPRequest* req)
 {
     // JSONRPC handles only POST
@@ -204,10 +235,12 @@ static bool HTTPReq_JSONRPC(const util::Ref& context, HTTPRequest* req)
                 req->WriteReply(HTTP_FORBIDDEN);
                 return false;
             }
+            std::string raw_result;
+            jreq.raw_result = &raw_result;
             UniValue result = tableRPC.execute(jreq);
 
             // Send reply
-            strReply = JSONRPCReply(result, NullUniValue, jreq.id);
+            strReply = raw_result.empty() ? JSONRPCReply(result, NullUniValue, jreq.id) : JSONRPCRawReply(raw_result, jreq.id);
 
         // array of requests
         } else if (valRequest.isArray()) {
@@ -291,9 +324,9 @@ bool StartHTTPRPC(const util::Ref& context)
         return false;
 
     auto handle_rpc = [&context](HTTPRequest* req, const std::string&) { return HTTPReq_JSONRPC(context, req); };
-    RegisterHTTPHandler("/", true, handle_rpc);
+    RegisterHTTPHandler("/", true, handle_rpc, JSONRPCRequestMethods);
     if (g_wallet_init_interface.HasWalletSupport()) {
-        RegisterHTTPHandler("/wallet/", false, handle_rpc);
+        RegisterHTTPHandler("/wallet/", false, handle_rpc, JSONRPCRequestMethods);
     }
     struct event_base* eventBase = EventBase();
     assert(eventBase);
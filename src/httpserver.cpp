@@ -14,10 +14,13 @@
 #include <util/strencodings.h>
 #include <util/system.h>
 #include <util/threadnames.h>
+#include <util/time.h>
 #include <util/translation.h>
 
+#include <algorithm>
 #include <deque>
 #include <memory>
+#include <set>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string>
@@ -33,6 +36,9 @@
 
 #include <support/events.h>
 
+#include <boost/algorithm/string/classification.hpp>
+#include <boost/algorithm/string/split.hpp>
+
 #ifdef EVENT__HAVE_NETINET_IN_H
 #include <netinet/in.h>
 #ifdef _XOPEN_SOURCE_EXTENDED
@@ -63,38 +69,119 @@ private:
     HTTPRequestHandler func;
 };
 
-/** Simple work queue for distributing work over multiple threads.
- * Work items are simply callable objects.
+/** A class of requests, queued and run under their own limits */
+struct HTTPWorkClass
+{
+    std::string name;
+    //! Maximum number of requests of this class running at once
+    int max_active;
+    //! Maximum number of requests of this class waiting to run
+    size_t max_depth;
+    //! Idle workers pick up requests from higher priority classes first
+    int priority;
+    //! RPC methods queued in this class
+    std::set<std::string> methods;
+};
+
+/** Work queue for distributing work over multiple threads.
+ * Work items are simply callable objects, queued in one of several classes
+ * which each have their own queue depth and limit on running items. Idle
+ * threads pick up the oldest item of the highest priority class that is
+ * below its limit, so that a burst of slow calls can't hold up the rest.
  */
 template <typename WorkItem>
 class WorkQueue
 {
 private:
-    /** Mutex protects entire object */
+    struct ClassState
+    {
+        //! Queued items and the time they were queued at
+        std::deque<std::pair<std::unique_ptr<WorkItem>, int64_t>> queue;
+        int active{0};
+        uint64_t rejected{0};
+        std::vector<uint64_t> queue_wait = std::vector<uint64_t>(HTTP_LATENCY_BUCKETS.size() + 1);
+        std::vector<uint64_t> exec = std::vector<uint64_t>(HTTP_LATENCY_BUCKETS.size() + 1);
+    };
+
+    //! Work classes in descending order of priority. Not changed after construction.
+    const std::vector<HTTPWorkClass> classes;
+    const size_t defaultClass;
+    /** Mutex protects the rest of the object */
     Mutex cs;
     std::condition_variable cond;
-    std::deque<std::unique_ptr<WorkItem>> queue;
-    bool running;
-    size_t maxDepth;
+    std::vector<ClassState> states GUARDED_BY(cs);
+    bool running GUARDED_BY(cs);
+
+    static std::vector<HTTPWorkClass> SortClasses(std::vector<HTTPWorkClass> _classes)
+    {
+        std::stable_sort(_classes.begin(), _classes.end(), [](const HTTPWorkClass& a, const HTTPWorkClass& b) { return a.priority > b.priority; });
+        return _classes;
+    }
+
+    static void AddToHistogram(std::vector<uint64_t>& histogram, int64_t micros)
+    {
+        size_t bucket = 0;
+        while (bucket < HTTP_LATENCY_BUCKETS.size() && micros >= HTTP_LATENCY_BUCKETS[bucket]) ++bucket;
+        ++histogram[bucket];
+    }
+
+    /** Return the class to run an item of next, or classes.size() if there is none */
+    size_t NextClass() EXCLUSIVE_LOCKS_REQUIRED(cs)
+    {
+        for (size_t n = 0; n < classes.size(); ++n) {
+            if (!states[n].queue.empty() && states[n].active < classes[n].max_active) return n;
+        }
+        return classes.size();
+    }
 
 public:
-    explicit WorkQueue(size_t _maxDepth) : running(true),
-                                 maxDepth(_maxDepth)
+    /** Precondition: _classes contains a class named "default" */
+    explicit WorkQueue(std::vector<HTTPWorkClass> _classes) : classes(SortClasses(std::move(_classes))),
+                                 defaultClass(std::find_if(classes.begin(), classes.end(), [](const HTTPWorkClass& c) { return c.name == "default"; }) - classes.begin()),
+                                 states(classes.size()),
+                                 running(true)
     {
+        assert(defaultClass < classes.size());
     }
     /** Precondition: worker threads have all stopped (they have been joined).
      */
     ~WorkQueue()
     {
     }
+    /** Return the class to queue a request calling the given methods in. Each
+     * method goes to the class it is assigned to, or the default class, and a
+     * batch calling methods of several classes goes to the lowest priority one.
+     */
+    size_t GetClass(const std::vector<std::string>& methods) const
+    {
+        if (methods.empty()) return defaultClass;
+        size_t n = 0;
+        for (const std::string& method : methods) {
+            size_t method_class = defaultClass;
+            for (size_t c = 0; c < classes.size(); ++c) {
+                if (classes[c].methods.count(method)) {
+                    method_class = c;
+                    break;
+                }
+            }
+            n = std::max(n, method_class);
+        }
+        return n;
+    }
+    const std::string& GetClassName(size_t n) const
+    {
+        return classes[n].name;
+    }
     /** Enqueue a work item */
-    bool Enqueue(WorkItem* item)
+    bool Enqueue(WorkItem* item, size_t n)
     {
         LOCK(cs);
-        if (queue.size() >= maxDepth) {
+        ClassState& state = states[n];
+        if (state.queue.size() >= classes[n].max_depth) {
+            ++state.rejected;
             return false;
         }
-        queue.emplace_back(std::unique_ptr<WorkItem>(item));
+        state.queue.emplace_back(std::unique_ptr<WorkItem>(item), GetTimeMicros());
         cond.notify_one();
         return true;
     }
@@ -103,16 +190,30 @@ public:
     {
         while (true) {
             std::unique_ptr<WorkItem> i;
+            size_t n;
+            int64_t start;
             {
                 WAIT_LOCK(cs, lock);
-                while (running && queue.empty())
+                while (running && (n = NextClass()) == classes.size())
                     cond.wait(lock);
                 if (!running)
                     break;
-                i = std::move(queue.front());
-                queue.pop_front();
+                ClassState& state = states[n];
+                start = GetTimeMicros();
+                AddToHistogram(state.queue_wait, start - state.queue.front().second);
+                i = std::move(state.queue.front().first);
+                state.queue.pop_front();
+                ++state.active;
             }
             (*i)();
+            {
+                LOCK(cs);
+                ClassState& state = states[n];
+                --state.active;
+                AddToHistogram(state.exec, GetTimeMicros() - start);
+                // The class may have dropped below its limit with items still queued
+                if (!state.queue.empty()) cond.notify_one();
+            }
         }
     }
     /** Interrupt and exit loops */
@@ -122,17 +223,29 @@ public:
         running = false;
         cond.notify_all();
     }
+    std::vector<HTTPWorkClassInfo> GetInfo()
+    {
+        LOCK(cs);
+        std::vector<HTTPWorkClassInfo> info;
+        for (size_t n = 0; n < classes.size(); ++n) {
+            const ClassState& state = states[n];
+            info.push_back({classes[n].name, classes[n].priority, classes[n].max_active, classes[n].max_depth,
+                            state.queue.size(), state.active, state.rejected, state.queue_wait, state.exec});
+        }
+        return info;
+    }
 };
 
 struct HTTPPathHandler
 {
-    HTTPPathHandler(std::string _prefix, bool _exactMatch, HTTPRequestHandler _handler):
-        prefix(_prefix), exactMatch(_exactMatch), handler(_handler)
+    HTTPPathHandler(std::string _prefix, bool _exactMatch, HTTPRequestHandler _handler, HTTPRequestClassifier _classifier):
+        prefix(_prefix), exactMatch(_exactMatch), handler(_handler), classifier(_classifier)
     {
     }
     std::string prefix;
     bool exactMatch;
     HTTPRequestHandler handler;
+    HTTPRequestClassifier classifier;
 };
 
 /** HTTP module state */
@@ -189,6 +302,46 @@ static bool InitHTTPAllowList()
     return true;
 }
 
+/** Parse -rpcworkclass into the work classes, next to the default class */
+static bool InitHTTPWorkClasses(std::vector<HTTPWorkClass>& classes, int rpcThreads, int workQueueDepth)
+{
+    classes.clear();
+    classes.push_back({"default", rpcThreads, (size_t)workQueueDepth, 0, {}});
+    std::vector<std::string> class_args;
+    if (!gArgs.IsArgNegated("-rpcworkclass")) {
+        class_args = gArgs.IsArgSet("-rpcworkclass") ? gArgs.GetArgs("-rpcworkclass") : std::vector<std::string>{DEFAULT_HTTP_HEAVY_WORK_CLASS};
+    }
+    std::set<std::string> classified;
+    for (const std::string& class_arg : class_args) {
+        std::vector<std::string> fields;
+        boost::split(fields, class_arg, boost::is_any_of(","));
+        int32_t max_active, max_depth, priority;
+        if (fields.size() < 5 || fields[0].empty() ||
+            std::any_of(classes.begin(), classes.end(), [&](const HTTPWorkClass& c) { return c.name == fields[0]; }) ||
+            !ParseInt32(fields[1], &max_active) || max_active < 1 ||
+            !ParseInt32(fields[2], &max_depth) || max_depth < 1 ||
+            !ParseInt32(fields[3], &priority)) {
+            uiInterface.ThreadSafeMessageBox(
+                strprintf(Untranslated("Invalid -rpcworkclass specification: %s. Expected a new class name, at least one thread, a queue depth of at least one, a priority and RPC methods, separated by commas."), class_arg),
+                "", CClientUIInterface::MSG_ERROR);
+            return false;
+        }
+        HTTPWorkClass work_class{fields[0], std::min(max_active, rpcThreads), (size_t)max_depth, priority, {}};
+        for (auto method = fields.begin() + 4; method != fields.end(); ++method) {
+            if (!classified.insert(*method).second) {
+                uiInterface.ThreadSafeMessageBox(
+                    strprintf(Untranslated("Invalid -rpcworkclass specification: %s. RPC method %s is already in another class."), class_arg, *method),
+                    "", CClientUIInterface::MSG_ERROR);
+                return false;
+            }
+            work_class.methods.insert(*method);
+        }
+        LogPrintf("HTTP: creating work class %s of depth %d, running %d at once with priority %d\n", work_class.name, work_class.max_depth, work_class.max_active, work_class.priority);
+        classes.push_back(std::move(work_class));
+    }
+    return true;
+}
+
 /** HTTP request method as string - use for logging only */
 std::string RequestMethodString(HTTPRequest::RequestMethod m)
 {
@@ -263,13 +416,14 @@ static void http_request_cb(struct evhttp_request* req, void* arg)
 
     // Dispatch to worker thread
     if (i != iend) {
-        std::unique_ptr<HTTPWorkItem> item(new HTTPWorkItem(std::move(hreq), path, i->handler));
         assert(workQueue);
-        if (workQueue->Enqueue(item.get()))
+        size_t work_class = workQueue->GetClass(i->classifier ? i->classifier(hreq.get()) : std::vector<std::string>{});
+        std::unique_ptr<HTTPWorkItem> item(new HTTPWorkItem(std::move(hreq), path, i->handler));
+        if (workQueue->Enqueue(item.get(), work_class))
             item.release(); /* if true, queue took ownership */
         else {
-            LogPrintf("WARNING: request rejected because http work queue depth exceeded, it can be increased with the -rpcworkqueue= setting\n");
-            item->req->WriteReply(HTTP_INTERNAL_SERVER_ERROR, "Work queue depth exceeded");
+            LogPrintf("WARNING: request rejected because http work queue depth of class %s exceeded, it can be increased with the -rpcworkqueue= or -rpcworkclass= setting\n", workQueue->GetClassName(work_class));
+            item->req->WriteReply(HTTP_SERVICE_UNAVAILABLE, "Work queue depth exceeded");
         }
     } else {
         hreq->WriteReply(HTTP_NOT_FOUND);
@@ -398,9 +552,13 @@ bool InitHTTPServer()
 
     LogPrint(BCLog::HTTP, "Initialized HTTP server\n");
     int workQueueDepth = std::max((long)gArgs.GetArg("-rpcworkqueue", DEFAULT_HTTP_WORKQUEUE), 1L);
+    int rpcThreads = std::max((long)gArgs.GetArg("-rpcthreads", DEFAULT_HTTP_THREADS), 1L);
     LogPrintf("HTTP: creating work queue of depth %d\n", workQueueDepth);
+    std::vector<HTTPWorkClass> classes;
+    if (!InitHTTPWorkClasses(classes, rpcThreads, workQueueDepth))
+        return false;
 
-    workQueue = new WorkQueue<HTTPClosure>(workQueueDepth);
+    workQueue = new WorkQueue<HTTPClosure>(std::move(classes));
     // transfer ownership to eventBase/HTTP via .release()
     eventBase = base_ctr.release();
     eventHTTP = http_ctr.release();
@@ -480,6 +638,12 @@ void StopHTTPServer()
     LogPrint(BCLog::HTTP, "Stopped HTTP server\n");
 }
 
+std::vector<HTTPWorkClassInfo> GetHTTPWorkClassInfo()
+{
+    if (!workQueue) return {};
+    return workQueue->GetInfo();
+}
+
 struct event_base* EventBase()
 {
     return eventBase;
@@ -556,6 +720,18 @@ std::string HTTPRequest::ReadBody()
     return rv;
 }
 
+std::string HTTPRequest::PeekBody(size_t max_size)
+{
+    struct evbuffer* buf = evhttp_request_get_input_buffer(req);
+    if (!buf)
+        return "";
+    size_t size = std::min(evbuffer_get_length(buf), max_size);
+    std::string rv(size, '\0');
+    if (size > 0 && evbuffer_copyout(buf, &rv[0], size) != (ev_ssize_t)size)
+        return "";
+    return rv;
+}
+
 void HTTPRequest::WriteHeader(const std::string& hdr, const std::string& value)
 {
     struct evkeyvalq* headers = evhttp_request_get_output_headers(req);
@@ -638,10 +814,10 @@ HTTPRequest::RequestMethod HTTPRequest::GetRequestMethod() const
     }
 }
 
-void RegisterHTTPHandler(const std::string &prefix, bool exactMatch, const HTTPRequestHandler &handler)
+void RegisterHTTPHandler(const std::string &prefix, bool exactMatch, const HTTPRequestHandler &handler, const HTTPRequestClassifier &classifier)
 {
     LogPrint(BCLog::HTTP, "Registering HTTP handler for %s (exactmatch %d)\n", prefix, exactMatch);
-    pathHandlers.push_back(HTTPPathHandler(prefix, exactMatch, handler));
+    pathHandlers.push_back(HTTPPathHandler(prefix, exactMatch, handler, classifier));
 }
 
 void UnregisterHTTPHandler(const std::string &prefix, bool exactMatch)
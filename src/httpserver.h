@@ -5,12 +5,19 @@
 #ifndef BITCOIN_HTTPSERVER_H
 #define BITCOIN_HTTPSERVER_H
 
+#include <array>
+#include <stdint.h>
 #include <string>
 #include <functional>
+#include <vector>
 
 static const int DEFAULT_HTTP_THREADS=4;
 static const int DEFAULT_HTTP_WORKQUEUE=16;
 static const int DEFAULT_HTTP_SERVER_TIMEOUT=30;
+/** Work class for RPC methods that can keep a worker busy for minutes. Format as for -rpcworkclass. */
+static const char* const DEFAULT_HTTP_HEAVY_WORK_CLASS = "heavy,1,4,-1,gettxoutsetinfo,scantxoutset,dumptxoutset,rescanblockchain,verifychain,savemempool,importwallet,dumpwallet,importmulti,importdescriptors";
+/** Upper bounds in microseconds of the work queue latency histogram buckets. The last bucket counts the rest. */
+static constexpr std::array<int64_t, 5> HTTP_LATENCY_BUCKETS{1000, 10000, 100000, 1000000, 10000000};
 
 struct evhttp_request;
 struct event_base;
@@ -37,14 +44,37 @@ bool UpdateHTTPServerLogging(bool enable);
 
 /** Handler for requests to a certain HTTP path */
 typedef std::function<bool(HTTPRequest* req, const std::string &)> HTTPRequestHandler;
+/** Returns the RPC methods a request to a certain HTTP path calls, which pick its work class.
+ * Runs on the event loop thread, so it must not block.
+ */
+typedef std::function<std::vector<std::string>(HTTPRequest* req)> HTTPRequestClassifier;
 /** Register handler for prefix.
  * If multiple handlers match a prefix, the first-registered one will
- * be invoked.
+ * be invoked. Requests are queued in the default work class unless a
+ * classifier is given.
  */
-void RegisterHTTPHandler(const std::string &prefix, bool exactMatch, const HTTPRequestHandler &handler);
+void RegisterHTTPHandler(const std::string &prefix, bool exactMatch, const HTTPRequestHandler &handler, const HTTPRequestClassifier &classifier = nullptr);
 /** Unregister handler for prefix */
 void UnregisterHTTPHandler(const std::string &prefix, bool exactMatch);
 
+/** Queue depth, limits and latency histograms of a work class */
+struct HTTPWorkClassInfo
+{
+    std::string name;
+    int priority;
+    int max_active;
+    size_t max_depth;
+    size_t queued;
+    int active;
+    uint64_t rejected;
+    /** Counts of requests per HTTP_LATENCY_BUCKETS bucket, from being queued to starting */
+    std::vector<uint64_t> queue_wait;
+    /** Counts of requests per HTTP_LATENCY_BUCKETS bucket, from starting to finishing */
+    std::vector<uint64_t> exec;
+};
+/** Return the state of the work classes, or nothing if the HTTP server isn't running */
+std::vector<HTTPWorkClassInfo> GetHTTPWorkClassInfo();
+
 /** Return evhttp event base. This can be used by submodules to
  * queue timers or custom events.
  */
@@ -97,6 +127,12 @@ public:
      */
     std::string ReadBody();
 
+    /**
+     * Return a copy of the first max_size bytes of the request body, leaving it
+     * in place for ReadBody.
+     */
+    std::string PeekBody(size_t max_size);
+
     /**
      * Write output header.
      *
@@ -8,14 +8,22 @@
 #include <shutdown.h>
 #include <tinyformat.h>
 #include <util/system.h>
+#include <util/threadpool.h>
 #include <util/translation.h>
 #include <validation.h>
 #include <warnings.h>
 
+#include <deque>
+#include <future>
+
 constexpr char DB_BEST_BLOCK = 'B';
 
 constexpr int64_t SYNC_LOG_INTERVAL = 30; // seconds
 constexpr int64_t SYNC_LOCATOR_WRITE_INTERVAL = 30; // seconds
+/** Maximum number of blocks read and prepared ahead of the index sync */
+constexpr int MAX_SYNC_READ_AHEAD = 16;
+/** Size of the batch of index entries at which the sync writes it out */
+constexpr size_t SYNC_BATCH_SIZE = 16 << 20; // 16 MiB
 
 template <typename... Args>
 static void FatalError(const char* fmt, const Args&... args)
@@ -27,8 +35,9 @@ static void FatalError(const char* fmt, const Args&... args)
     StartShutdown();
 }
 
-BaseIndex::DB::DB(const fs::path& path, size_t n_cache_size, bool f_memory, bool f_wipe, bool f_obfuscate) :
-    CDBWrapper(path, n_cache_size, f_memory, f_wipe, f_obfuscate)
+BaseIndex::DB::DB(const fs::path& path, size_t n_cache_size, bool f_memory, bool f_wipe, bool f_obfuscate,
+                  const std::string& name) :
+    CDBWrapper(path, n_cache_size, f_memory, f_wipe, f_obfuscate, name)
 {}
 
 bool BaseIndex::DB::ReadBestBlock(CBlockLocator& locator) const
@@ -84,16 +93,53 @@ static const CBlockIndex* NextSyncBlock(const CBlockIndex* pindex_prev) EXCLUSIV
     return ::ChainActive().Next(::ChainActive().FindFork(pindex_prev));
 }
 
+namespace {
+/** A block read, and prepared for writing, ahead of the index sync. */
+struct SyncBlock
+{
+    CBlock block;
+    bool read{false};
+    std::unique_ptr<BaseIndex::PreparedBlock> prepared;
+};
+} // namespace
+
 void BaseIndex::ThreadSync()
 {
     const CBlockIndex* pindex = m_best_block_index.load();
     if (!m_synced) {
         auto& consensus_params = Params().GetConsensus();
 
+        // Blocks following pindex on the active chain are read and prepared ahead of
+        // it on worker threads. Their entries are collected in one batch, which is
+        // written out once it grows large or the locator is written.
+        const size_t read_ahead = ReadAheadThreadCount(MAX_SYNC_READ_AHEAD);
+        ThreadPool read_pool("idxread", read_ahead);
+        std::deque<std::pair<const CBlockIndex*, std::future<SyncBlock>>> queued;
+        const auto queue_block = [&](const CBlockIndex* block_index) {
+            queued.emplace_back(block_index, read_pool.Submit([this, block_index, &consensus_params] {
+                SyncBlock result;
+                result.read = ReadBlockFromDisk(result.block, block_index, consensus_params);
+                if (result.read) result.prepared = PrepareBlock(result.block, block_index);
+                return result;
+            }));
+        };
+
+        CDBBatch batch(GetDB());
+        const auto flush_batch = [&]() {
+            if (batch.SizeEstimate() == 0) return true;
+            if (!GetDB().WriteBatch(batch)) {
+                FatalError("%s: Failed to write to %s database", __func__, GetName());
+                return false;
+            }
+            batch.Clear();
+            return true;
+        };
+
         int64_t last_log_time = 0;
         int64_t last_locator_write_time = 0;
         while (true) {
             if (m_interrupt) {
+                if (!flush_batch()) return;
                 m_best_block_index = pindex;
                 // No need to handle errors in Commit. If it fails, the error will be already be
                 // logged. The best way to recover is to continue, as index cannot be corrupted by
@@ -102,22 +148,44 @@ void BaseIndex::ThreadSync()
                 return;
             }
 
+            bool stale_queue = false;
             {
                 LOCK(cs_main);
                 const CBlockIndex* pindex_next = NextSyncBlock(pindex);
                 if (!pindex_next) {
+                    if (!flush_batch()) return;
                     m_best_block_index = pindex;
                     m_synced = true;
                     // No need to handle errors in Commit. See rationale above.
                     Commit();
                     break;
                 }
-                if (pindex_next->pprev != pindex && !Rewind(pindex, pindex_next->pprev)) {
-                    FatalError("%s: Failed to rewind index %s to a previous chain tip",
-                               __func__, GetName());
-                    return;
+                if (!queued.empty() && queued.front().first != pindex_next) {
+                    // The active chain changed since these blocks were queued.
+                    stale_queue = true;
+                } else {
+                    if (pindex_next->pprev != pindex) {
+                        if (!flush_batch()) return;
+                        if (!Rewind(pindex, pindex_next->pprev)) {
+                            FatalError("%s: Failed to rewind index %s to a previous chain tip",
+                                       __func__, GetName());
+                            return;
+                        }
+                    }
+                    pindex = pindex_next;
+
+                    if (queued.empty()) queue_block(pindex);
+                    while (queued.size() < read_ahead) {
+                        const CBlockIndex* pindex_ahead = ::ChainActive().Next(queued.back().first);
+                        if (!pindex_ahead) break;
+                        queue_block(pindex_ahead);
+                    }
                 }
-                pindex = pindex_next;
+            }
+            if (stale_queue) {
+                // Reads already running finish in the background, and their blocks are dropped.
+                queued.clear();
+                continue;
             }
 
             int64_t current_time = GetTime();
@@ -127,24 +195,28 @@ void BaseIndex::ThreadSync()
                 last_log_time = current_time;
             }
 
-            if (last_locator_write_time + SYNC_LOCATOR_WRITE_INTERVAL < current_time) {
-                m_best_block_index = pindex;
-                last_locator_write_time = current_time;
-                // No need to handle errors in Commit. See rationale above.
-                Commit();
-            }
-
-            CBlock block;
-            if (!ReadBlockFromDisk(block, pindex, consensus_params)) {
+            SyncBlock synced = queued.front().second.get();
+            queued.pop_front();
+            if (!synced.read) {
                 FatalError("%s: Failed to read block %s from disk",
                            __func__, pindex->GetBlockHash().ToString());
                 return;
             }
-            if (!WriteBlock(block, pindex)) {
+            if (!WritePreparedBlock(synced.block, pindex, synced.prepared.get(), batch)) {
                 FatalError("%s: Failed to write block %s to index database",
                            __func__, pindex->GetBlockHash().ToString());
                 return;
             }
+
+            if (last_locator_write_time + SYNC_LOCATOR_WRITE_INTERVAL < current_time) {
+                if (!flush_batch()) return;
+                m_best_block_index = pindex;
+                last_locator_write_time = current_time;
+                // No need to handle errors in Commit. See rationale above.
+                Commit();
+            } else if (batch.SizeEstimate() > SYNC_BATCH_SIZE) {
+                if (!flush_batch()) return;
+            }
         }
     }
 
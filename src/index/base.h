@@ -11,6 +11,8 @@
 #include <threadinterrupt.h>
 #include <validationinterface.h>
 
+#include <memory>
+
 class CBlockIndex;
 
 struct IndexSummary {
@@ -26,6 +28,12 @@ struct IndexSummary {
  */
 class BaseIndex : public CValidationInterface
 {
+public:
+    /// Index data derived from a block ahead of writing it during the initial sync.
+    struct PreparedBlock {
+        virtual ~PreparedBlock() = default;
+    };
+
 protected:
     /**
      * The database stores a block locator of the chain the database is synced to
@@ -38,7 +46,8 @@ protected:
     {
     public:
         DB(const fs::path& path, size_t n_cache_size,
-           bool f_memory = false, bool f_wipe = false, bool f_obfuscate = false);
+           bool f_memory = false, bool f_wipe = false, bool f_obfuscate = false,
+           const std::string& name = "");
 
         /// Read block locator of the chain that the txindex is in sync with.
         bool ReadBestBlock(CBlockLocator& locator) const;
@@ -63,7 +72,8 @@ private:
     /// Intended to be run in its own thread, m_thread_sync, and can be
     /// interrupted with m_interrupt. Once the index gets in sync, the m_synced
     /// flag is set and the BlockConnected ValidationInterface callback takes
-    /// over and the sync thread exits.
+    /// over and the sync thread exits. Blocks are read and prepared ahead on
+    /// worker threads, and written in chain order on the sync thread.
     void ThreadSync();
 
     /// Write the current index state (eg. chain block locator and subclass-specific items) to disk.
@@ -87,6 +97,18 @@ protected:
     /// Write update index entries for a newly connected block.
     virtual bool WriteBlock(const CBlock& block, const CBlockIndex* pindex) { return true; }
 
+    /// Compute index data for a block during the initial sync, ahead of WritePreparedBlock.
+    /// Called on sync worker threads, for several blocks at a time, so it must not depend
+    /// on the index state updated by writing earlier blocks.
+    virtual std::unique_ptr<PreparedBlock> PrepareBlock(const CBlock& block, const CBlockIndex* pindex) const { return nullptr; }
+
+    /// Write index entries for a block during the initial sync. Blocks are written in chain
+    /// order, and entries added to batch are written together with those of following blocks.
+    virtual bool WritePreparedBlock(const CBlock& block, const CBlockIndex* pindex, const PreparedBlock* prepared, CDBBatch& batch)
+    {
+        return WriteBlock(block, pindex);
+    }
+
     /// Virtual method called internally by Commit that can be overridden to atomically
     /// commit more index state.
     virtual bool CommitInternal(CDBBatch& batch);
@@ -103,7 +103,7 @@ BlockFilterIndex::BlockFilterIndex(BlockFilterType filter_type,
     fs::create_directories(path);
 
     m_name = filter_name + " block filter index";
-    m_db = MakeUnique<BaseIndex::DB>(path / "db", n_cache_size, f_memory, f_wipe);
+    m_db = MakeUnique<BaseIndex::DB>(path / "db", n_cache_size, f_memory, f_wipe, /*f_obfuscate*/ false, "blockfilterindex/" + filter_name);
     m_filter_fileseq = MakeUnique<FlatFileSeq>(std::move(path), "fltr", FLTR_FILE_CHUNK_SIZE);
 }
 
@@ -208,32 +208,33 @@ size_t BlockFilterIndex::WriteFilterToDisk(FlatFilePos& pos, const BlockFilter&
     return data_size;
 }
 
-bool BlockFilterIndex::WriteBlock(const CBlock& block, const CBlockIndex* pindex)
+namespace {
+/** A block filter computed ahead of the initial sync writing it. */
+struct PreparedFilter : public BaseIndex::PreparedBlock
 {
-    CBlockUndo block_undo;
-    uint256 prev_header;
-
-    if (pindex->nHeight > 0) {
-        if (!UndoReadFromDisk(block_undo, pindex)) {
-            return false;
-        }
-
-        std::pair<uint256, DBVal> read_out;
-        if (!m_db->Read(DBHeightKey(pindex->nHeight - 1), read_out)) {
-            return false;
-        }
+    BlockFilter filter;
+};
+} // namespace
 
-        uint256 expected_block_hash = pindex->pprev->GetBlockHash();
-        if (read_out.first != expected_block_hash) {
-            return error("%s: previous block header belongs to unexpected block %s; expected %s",
-                         __func__, read_out.first.ToString(), expected_block_hash.ToString());
-        }
+static bool ReadPrevHeader(const CDBWrapper& db, const CBlockIndex* pindex, uint256& prev_header)
+{
+    std::pair<uint256, DBVal> read_out;
+    if (!db.Read(DBHeightKey(pindex->nHeight - 1), read_out)) {
+        return false;
+    }
 
-        prev_header = read_out.second.header;
+    uint256 expected_block_hash = pindex->pprev->GetBlockHash();
+    if (read_out.first != expected_block_hash) {
+        return error("%s: previous block header belongs to unexpected block %s; expected %s",
+                     __func__, read_out.first.ToString(), expected_block_hash.ToString());
     }
 
-    BlockFilter filter(m_filter_type, block, block_undo);
+    prev_header = read_out.second.header;
+    return true;
+}
 
+bool BlockFilterIndex::WriteFilter(const BlockFilter& filter, const CBlockIndex* pindex, const uint256& prev_header, CDBBatch& batch)
+{
     size_t bytes_written = WriteFilterToDisk(m_next_filter_pos, filter);
     if (bytes_written == 0) return false;
 
@@ -243,14 +244,65 @@ bool BlockFilterIndex::WriteBlock(const CBlock& block, const CBlockIndex* pindex
     value.second.header = filter.ComputeHeader(prev_header);
     value.second.pos = m_next_filter_pos;
 
-    if (!m_db->Write(DBHeightKey(pindex->nHeight), value)) {
-        return false;
-    }
+    batch.Write(DBHeightKey(pindex->nHeight), value);
 
     m_next_filter_pos.nPos += bytes_written;
+    m_last_header = value.second.header;
+    m_last_header_index = pindex;
     return true;
 }
 
+bool BlockFilterIndex::WriteBlock(const CBlock& block, const CBlockIndex* pindex)
+{
+    CBlockUndo block_undo;
+    uint256 prev_header;
+
+    if (pindex->nHeight > 0) {
+        if (m_filter_type != BlockFilterType::MWEB && !UndoReadFromDisk(block_undo, pindex)) {
+            return false;
+        }
+        if (!ReadPrevHeader(*m_db, pindex, prev_header)) {
+            return false;
+        }
+    }
+
+    BlockFilter filter(m_filter_type, block, block_undo);
+
+    CDBBatch batch(*m_db);
+    return WriteFilter(filter, pindex, prev_header, batch) && m_db->WriteBatch(batch);
+}
+
+std::unique_ptr<BaseIndex::PreparedBlock> BlockFilterIndex::PrepareBlock(const CBlock& block, const CBlockIndex* pindex) const
+{
+    // MWEB filters are built from the block alone, so they don't need its undo data.
+    CBlockUndo block_undo;
+    if (m_filter_type != BlockFilterType::MWEB && pindex->nHeight > 0 && !UndoReadFromDisk(block_undo, pindex)) {
+        return nullptr;
+    }
+
+    auto prepared = MakeUnique<PreparedFilter>();
+    prepared->filter = BlockFilter(m_filter_type, block, block_undo);
+    return prepared;
+}
+
+bool BlockFilterIndex::WritePreparedBlock(const CBlock& block, const CBlockIndex* pindex, const PreparedBlock* prepared, CDBBatch& batch)
+{
+    const auto* prepared_filter = dynamic_cast<const PreparedFilter*>(prepared);
+    if (!prepared_filter) return false; // undo data couldn't be read
+
+    // The previous filter's entry may still be waiting in the batch.
+    uint256 prev_header;
+    if (pindex->nHeight > 0) {
+        if (m_last_header_index != nullptr && m_last_header_index == pindex->pprev) {
+            prev_header = m_last_header;
+        } else if (!ReadPrevHeader(*m_db, pindex, prev_header)) {
+            return false;
+        }
+    }
+
+    return WriteFilter(prepared_filter->filter, pindex, prev_header, batch);
+}
+
 static bool CopyHeightIndexToHashIndex(CDBIterator& db_it, CDBBatch& batch,
                                        const std::string& index_name,
                                        int start_height, int stop_height)
@@ -38,6 +38,14 @@ private:
     bool ReadFilterFromDisk(const FlatFilePos& pos, BlockFilter& filter) const;
     size_t WriteFilterToDisk(FlatFilePos& pos, const BlockFilter& filter);
 
+    /// Append the filter to the filter files and add its entry to batch.
+    bool WriteFilter(const BlockFilter& filter, const CBlockIndex* pindex, const uint256& prev_header, CDBBatch& batch);
+
+    /// Header of the last filter written, and its block. During the initial sync the filter's
+    /// entry may still be in a batch that hasn't been written to the database.
+    uint256 m_last_header;
+    const CBlockIndex* m_last_header_index{nullptr};
+
     Mutex m_cs_headers_cache;
     /** cache of block hash to filter header, to avoid disk access when responding to getcfcheckpt. */
     std::unordered_map<uint256, uint256, FilterHeaderHasher> m_headers_cache GUARDED_BY(m_cs_headers_cache);
@@ -49,6 +57,10 @@ protected:
 
     bool WriteBlock(const CBlock& block, const CBlockIndex* pindex) override;
 
+    std::unique_ptr<PreparedBlock> PrepareBlock(const CBlock& block, const CBlockIndex* pindex) const override;
+
+    bool WritePreparedBlock(const CBlock& block, const CBlockIndex* pindex, const PreparedBlock* prepared, CDBBatch& batch) override;
+
     bool Rewind(const CBlockIndex* current_tip, const CBlockIndex* new_tip) override;
 
     BaseIndex::DB& GetDB() const override { return *m_db; }
@@ -0,0 +1,125 @@
+// Copyright (c) 2021 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <chainparams.h>
+#include <index/mwebindex.h>
+#include <util/system.h>
+#include <validation.h>
+
+/* The database is keyed by a one byte type followed by the 32 byte ID, written without
+ * a length prefix, and positions are written as VARINTs. Kernel, output and spent output
+ * entries for a block therefore take around 36 bytes each.
+ */
+constexpr char DB_MWEB_KERNEL = 'k';
+constexpr char DB_MWEB_OUTPUT = 'o';
+constexpr char DB_MWEB_SPENT = 's';
+
+std::unique_ptr<MWEBIndex> g_mwebindex;
+
+/** Access to the MWEB index database (indexes/mwebindex/) */
+class MWEBIndex::DB : public BaseIndex::DB
+{
+public:
+    explicit DB(size_t n_cache_size, bool f_memory = false, bool f_wipe = false);
+
+    /// Read the block position of the entry of the given type and ID. Returns false if the
+    /// ID is not indexed.
+    bool ReadPos(char type, const mw::Hash& id, MWEBIndexPos& pos) const;
+};
+
+MWEBIndex::DB::DB(size_t n_cache_size, bool f_memory, bool f_wipe) :
+    BaseIndex::DB(GetDataDir() / "indexes" / "mwebindex", n_cache_size, f_memory, f_wipe, /*f_obfuscate*/ false, "mwebindex")
+{}
+
+bool MWEBIndex::DB::ReadPos(char type, const mw::Hash& id, MWEBIndexPos& pos) const
+{
+    return Read(std::make_pair(type, id), pos);
+}
+
+MWEBIndex::MWEBIndex(size_t n_cache_size, bool f_memory, bool f_wipe)
+    : m_db(MakeUnique<MWEBIndex::DB>(n_cache_size, f_memory, f_wipe))
+{}
+
+MWEBIndex::~MWEBIndex() {}
+
+static void WriteMWEBPositions(const CBlock& block, const CBlockIndex* pindex, CDBBatch& batch)
+{
+    if (block.mweb_block.IsNull()) return;
+
+    const mw::Block::CPtr& mweb_block = block.mweb_block.m_block;
+    uint32_t index = 0;
+    for (const Kernel& kernel : mweb_block->GetKernels()) {
+        batch.Write(std::make_pair(DB_MWEB_KERNEL, kernel.GetKernelID()), MWEBIndexPos(pindex->nHeight, index++));
+    }
+    index = 0;
+    for (const Output& output : mweb_block->GetOutputs()) {
+        batch.Write(std::make_pair(DB_MWEB_OUTPUT, output.GetOutputID()), MWEBIndexPos(pindex->nHeight, index++));
+    }
+    index = 0;
+    for (const Input& input : mweb_block->GetInputs()) {
+        batch.Write(std::make_pair(DB_MWEB_SPENT, input.GetOutputID()), MWEBIndexPos(pindex->nHeight, index++));
+    }
+}
+
+bool MWEBIndex::WriteBlock(const CBlock& block, const CBlockIndex* pindex)
+{
+    CDBBatch batch(*m_db);
+    WriteMWEBPositions(block, pindex, batch);
+    return m_db->WriteBatch(batch);
+}
+
+bool MWEBIndex::WritePreparedBlock(const CBlock& block, const CBlockIndex* pindex, const PreparedBlock* prepared, CDBBatch& batch)
+{
+    WriteMWEBPositions(block, pindex, batch);
+    return true;
+}
+
+bool MWEBIndex::Rewind(const CBlockIndex* current_tip, const CBlockIndex* new_tip)
+{
+    assert(current_tip->GetAncestor(new_tip->nHeight) == new_tip);
+
+    // Erase the entries of the disconnected blocks, so that lookups never point at a
+    // height whose block on the active chain doesn't contain the ID. An output spent
+    // in a disconnected block keeps its entry for the block that created it.
+    CDBBatch batch(*m_db);
+    for (const CBlockIndex* pindex = current_tip; pindex != new_tip; pindex = pindex->pprev) {
+        CBlock block;
+        if (!ReadBlockFromDisk(block, pindex, Params().GetConsensus())) {
+            return error("%s: Failed to read block %s from disk",
+                         __func__, pindex->GetBlockHash().ToString());
+        }
+        if (block.mweb_block.IsNull()) continue;
+
+        const mw::Block::CPtr& mweb_block = block.mweb_block.m_block;
+        for (const Kernel& kernel : mweb_block->GetKernels()) {
+            batch.Erase(std::make_pair(DB_MWEB_KERNEL, kernel.GetKernelID()));
+        }
+        for (const Output& output : mweb_block->GetOutputs()) {
+            batch.Erase(std::make_pair(DB_MWEB_OUTPUT, output.GetOutputID()));
+        }
+        for (const Input& input : mweb_block->GetInputs()) {
+            batch.Erase(std::make_pair(DB_MWEB_SPENT, input.GetOutputID()));
+        }
+    }
+    if (!m_db->WriteBatch(batch)) return false;
+
+    return BaseIndex::Rewind(current_tip, new_tip);
+}
+
+BaseIndex::DB& MWEBIndex::GetDB() const { return *m_db; }
+
+bool MWEBIndex::FindKernel(const mw::Hash& kernel_id, MWEBIndexPos& pos) const
+{
+    return m_db->ReadPos(DB_MWEB_KERNEL, kernel_id, pos);
+}
+
+bool MWEBIndex::FindOutput(const mw::Hash& output_id, MWEBIndexPos& pos) const
+{
+    return m_db->ReadPos(DB_MWEB_OUTPUT, output_id, pos);
+}
+
+bool MWEBIndex::FindSpend(const mw::Hash& output_id, MWEBIndexPos& pos) const
+{
+    return m_db->ReadPos(DB_MWEB_SPENT, output_id, pos);
+}
@@ -0,0 +1,76 @@
+// Copyright (c) 2021 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_INDEX_MWEBINDEX_H
+#define BITCOIN_INDEX_MWEBINDEX_H
+
+#include <chain.h>
+#include <index/base.h>
+#include <mw/models/crypto/Hash.h>
+#include <serialize.h>
+
+static constexpr bool DEFAULT_MWEBINDEX{false};
+
+/** Position of a kernel, output or spent output within a block's MWEB body. */
+struct MWEBIndexPos
+{
+    int nHeight{-1};
+    uint32_t nIndex{0};
+
+    MWEBIndexPos() = default;
+    MWEBIndexPos(int nHeightIn, uint32_t nIndexIn) : nHeight(nHeightIn), nIndex(nIndexIn) {}
+
+    SERIALIZE_METHODS(MWEBIndexPos, obj)
+    {
+        READWRITE(VARINT_MODE(obj.nHeight, VarIntMode::NONNEGATIVE_SIGNED), VARINT(obj.nIndex));
+    }
+
+    bool IsNull() const { return nHeight < 0; }
+};
+
+/**
+ * MWEBIndex is used to look up MWEB kernels and outputs included in the
+ * blockchain by ID. The index is written to a LevelDB database and records
+ * the height and body position of each kernel, output and spent output.
+ */
+class MWEBIndex final : public BaseIndex
+{
+protected:
+    class DB;
+
+private:
+    const std::unique_ptr<DB> m_db;
+
+protected:
+    bool WriteBlock(const CBlock& block, const CBlockIndex* pindex) override;
+
+    bool WritePreparedBlock(const CBlock& block, const CBlockIndex* pindex, const PreparedBlock* prepared, CDBBatch& batch) override;
+
+    bool Rewind(const CBlockIndex* current_tip, const CBlockIndex* new_tip) override;
+
+    BaseIndex::DB& GetDB() const override;
+
+    const char* GetName() const override { return "mwebindex"; }
+
+public:
+    /// Constructs the index, which becomes available to be queried.
+    explicit MWEBIndex(size_t n_cache_size, bool f_memory = false, bool f_wipe = false);
+
+    // Destructor is declared because this class contains a unique_ptr to an incomplete type.
+    virtual ~MWEBIndex() override;
+
+    /// Look up the block position of the kernel with the given ID.
+    bool FindKernel(const mw::Hash& kernel_id, MWEBIndexPos& pos) const;
+
+    /// Look up the block position the output with the given ID was created at.
+    bool FindOutput(const mw::Hash& output_id, MWEBIndexPos& pos) const;
+
+    /// Look up the block position of the input spending the output with the given ID.
+    bool FindSpend(const mw::Hash& output_id, MWEBIndexPos& pos) const;
+};
+
+/// The global MWEB index, used by the MWEB lookup RPCs. May be null.
+extern std::unique_ptr<MWEBIndex> g_mwebindex;
+
+#endif // BITCOIN_INDEX_MWEBINDEX_H
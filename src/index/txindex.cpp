@@ -37,7 +37,7 @@ public:
 };
 
 TxIndex::DB::DB(size_t n_cache_size, bool f_memory, bool f_wipe) :
-    BaseIndex::DB(GetDataDir() / "indexes" / "txindex", n_cache_size, f_memory, f_wipe)
+    BaseIndex::DB(GetDataDir() / "indexes" / "txindex", n_cache_size, f_memory, f_wipe, /*f_obfuscate*/ false, "txindex")
 {}
 
 bool TxIndex::DB::ReadTxPos(const uint256 &txid, CDiskTxPos& pos) const
@@ -211,11 +211,8 @@ bool TxIndex::Init()
     return BaseIndex::Init();
 }
 
-bool TxIndex::WriteBlock(const CBlock& block, const CBlockIndex* pindex)
+static std::vector<std::pair<uint256, CDiskTxPos>> GetTxPositions(const CBlock& block, const CBlockIndex* pindex)
 {
-    // Exclude genesis block transaction because outputs are not spendable.
-    if (pindex->nHeight == 0) return true;
-
     CDiskTxPos pos(pindex->GetBlockPos(), GetSizeOfCompactSize(block.vtx.size()));
     std::vector<std::pair<uint256, CDiskTxPos>> vPos;
     vPos.reserve(block.vtx.size());
@@ -223,7 +220,44 @@ bool TxIndex::WriteBlock(const CBlock& block, const CBlockIndex* pindex)
         vPos.emplace_back(tx->GetHash(), pos);
         pos.nTxOffset += ::GetSerializeSize(*tx, CLIENT_VERSION);
     }
-    return m_db->WriteTxs(vPos);
+    return vPos;
+}
+
+bool TxIndex::WriteBlock(const CBlock& block, const CBlockIndex* pindex)
+{
+    // Exclude genesis block transaction because outputs are not spendable.
+    if (pindex->nHeight == 0) return true;
+
+    return m_db->WriteTxs(GetTxPositions(block, pindex));
+}
+
+namespace {
+struct PreparedTxPositions : public BaseIndex::PreparedBlock
+{
+    std::vector<std::pair<uint256, CDiskTxPos>> positions;
+};
+} // namespace
+
+std::unique_ptr<BaseIndex::PreparedBlock> TxIndex::PrepareBlock(const CBlock& block, const CBlockIndex* pindex) const
+{
+    auto prepared = MakeUnique<PreparedTxPositions>();
+    // Exclude genesis block transaction because outputs are not spendable.
+    if (pindex->nHeight > 0) prepared->positions = GetTxPositions(block, pindex);
+    return prepared;
+}
+
+bool TxIndex::WritePreparedBlock(const CBlock& block, const CBlockIndex* pindex, const PreparedBlock* prepared, CDBBatch& batch)
+{
+    // Exclude genesis block transaction because outputs are not spendable.
+    if (pindex->nHeight == 0) return true;
+
+    std::vector<std::pair<uint256, CDiskTxPos>> positions;
+    const auto* prepared_positions = dynamic_cast<const PreparedTxPositions*>(prepared);
+    if (!prepared_positions) positions = GetTxPositions(block, pindex);
+    for (const auto& tuple : prepared_positions ? prepared_positions->positions : positions) {
+        batch.Write(std::make_pair(DB_TXINDEX, tuple.first), tuple.second);
+    }
+    return true;
 }
 
 BaseIndex::DB& TxIndex::GetDB() const { return *m_db; }
@@ -6,6 +6,7 @@
 
 #include <chain.h>
 #include <chainparams.h>
+#include <index/blockfilterindex.h>
 #include <interfaces/handler.h>
 #include <interfaces/wallet.h>
 #include <net.h>
@@ -46,6 +47,11 @@ bool FillBlock(const CBlockIndex* index, const FoundBlock& block, UniqueLock<Rec
     if (block.m_time) *block.m_time = index->GetBlockTime();
     if (block.m_max_time) *block.m_max_time = index->GetBlockTimeMax();
     if (block.m_mtp_time) *block.m_mtp_time = index->GetMedianTimePast();
+    if (block.m_locator) *block.m_locator = ::ChainActive().GetLocator(index);
+    if (block.m_mweb_outputs) {
+        const uint64_t prev_txos = index->pprev && index->pprev->mweb_header ? index->pprev->mweb_header->GetNumTXOs() : 0;
+        *block.m_mweb_outputs = index->mweb_header && index->mweb_header->GetNumTXOs() > prev_txos;
+    }
     if (block.m_data) {
         REVERSE_LOCK(lock);
         if (!ReadBlockFromDisk(*block.m_data, index, Params().GetConsensus())) block.m_data->SetNull();
@@ -249,6 +255,20 @@ public:
         // output uninitialized.
         return FillBlock(ancestor, ancestor_out, lock) & FillBlock(block1, block1_out, lock) & FillBlock(block2, block2_out, lock);
     }
+    bool hasBlockFilterIndex(BlockFilterType filter_type) override
+    {
+        return GetBlockFilterIndex(filter_type) != nullptr;
+    }
+    Optional<bool> blockFilterMatchesAny(BlockFilterType filter_type, const uint256& block_hash, const GCSFilter::ElementSet& filter_set) override
+    {
+        const BlockFilterIndex* block_filter_index = GetBlockFilterIndex(filter_type);
+        if (!block_filter_index) return nullopt;
+
+        BlockFilter filter;
+        const CBlockIndex* index = WITH_LOCK(cs_main, return LookupBlockIndex(block_hash));
+        if (index == nullptr || !block_filter_index->LookupFilter(index, filter)) return nullopt;
+        return filter.GetFilter().MatchAny(filter_set);
+    }
     void findCoins(std::map<COutPoint, Coin>& coins) override { return FindCoins(m_node, coins); }
     double guessVerificationProgress(const uint256& block_hash) override
     {
@@ -329,6 +349,10 @@ public:
     {
         return ::feeEstimator.estimateSmartFee(num_blocks, calc, conservative);
     }
+    CFeeRate estimateSmartMWEBFee(int num_blocks, bool conservative) override
+    {
+        return ::feeEstimator.estimateSmartMWEBFee(num_blocks, nullptr, conservative);
+    }
     unsigned int estimateMaxBlocks() override
     {
         return ::feeEstimator.HighestTargetTracked(FeeEstimateHorizon::LONG_HALFLIFE);
@@ -5,6 +5,7 @@
 #ifndef BITCOIN_INTERFACES_CHAIN_H
 #define BITCOIN_INTERFACES_CHAIN_H
 
+#include <blockfilter.h>           // For BlockFilterType and GCSFilter::ElementSet
 #include <optional.h>               // For Optional and nullopt
 #include <primitives/transaction.h> // For CTransactionRef
 #include <util/settings.h>          // For util::SettingsValue
@@ -44,6 +45,10 @@ public:
     FoundBlock& time(int64_t& time) { m_time = &time; return *this; }
     FoundBlock& maxTime(int64_t& max_time) { m_max_time = &max_time; return *this; }
     FoundBlock& mtpTime(int64_t& mtp_time) { m_mtp_time = &mtp_time; return *this; }
+    //! Return a locator for the block, as seen from the active chain.
+    FoundBlock& locator(CBlockLocator& locator) { m_locator = &locator; return *this; }
+    //! Return whether the block created any MWEB outputs.
+    FoundBlock& mwebOutputs(bool& mweb_outputs) { m_mweb_outputs = &mweb_outputs; return *this; }
     //! Read block data from disk. If the block exists but doesn't have data
     //! (for example due to pruning), the CBlock variable will be set to null.
     FoundBlock& data(CBlock& data) { m_data = &data; return *this; }
@@ -53,6 +58,8 @@ public:
     int64_t* m_time = nullptr;
     int64_t* m_max_time = nullptr;
     int64_t* m_mtp_time = nullptr;
+    CBlockLocator* m_locator = nullptr;
+    bool* m_mweb_outputs = nullptr;
     CBlock* m_data = nullptr;
 };
 
@@ -153,6 +160,14 @@ public:
         const FoundBlock& block1_out={},
         const FoundBlock& block2_out={}) = 0;
 
+    //! Return whether a block filter index of the given type is enabled.
+    virtual bool hasBlockFilterIndex(BlockFilterType filter_type) = 0;
+
+    //! Return whether the block's filter of the given type matches any of the
+    //! elements, or nullopt if the filter isn't available (e.g. the index
+    //! hasn't synced to the block yet).
+    virtual Optional<bool> blockFilterMatchesAny(BlockFilterType filter_type, const uint256& block_hash, const GCSFilter::ElementSet& filter_set) = 0;
+
     //! Look up unspent output information. Returns coins in the mempool and in
     //! the current chain UTXO set. Iterates through all the keys in the map and
     //! populates the values.
@@ -195,6 +210,9 @@ public:
     //! Estimate smart fee.
     virtual CFeeRate estimateSmartFee(int num_blocks, bool conservative, FeeCalculation* calc = nullptr) = 0;
 
+    //! Estimate smart fee per 1000 units of MWEB weight for MWEB-only transactions.
+    virtual CFeeRate estimateSmartMWEBFee(int num_blocks, bool conservative) = 0;
+
     //! Fee estimator max target.
     virtual unsigned int estimateMaxBlocks() = 0;
 
@@ -2,6 +2,7 @@
 
 #include <mw/models/tx/UTXO.h>
 #include <mw/interfaces/db_interface.h>
+#include <functional>
 #include <unordered_map>
 
 // Forward Declarations
@@ -41,6 +42,15 @@ public:
 	//
 	void RemoveAllUTXOs();
 
+	//
+	// Calls the visitor for every UTXO visible to the iterator, along with the size of its database entry.
+	// The iterator should be created up front, so that the walk reflects a consistent snapshot of the database.
+	//
+	static void ForEachUTXO(
+		mw::DBIterator& iter,
+		const std::function<void(const UTXO::CPtr&, const size_t)>& visitor
+	);
+
 private:
 	std::unique_ptr<Database> m_pDatabase;
 };
\ No newline at end of file
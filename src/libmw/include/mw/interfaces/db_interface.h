@@ -33,6 +33,7 @@ public:
     virtual void Seek(const std::string& key) = 0;
     virtual void Next() = 0;
     virtual bool GetKey(std::string& key) const = 0;
+    virtual bool GetValue(std::vector<uint8_t>& value) const = 0;
     virtual bool Valid() const = 0;
 };
 
@@ -28,6 +28,11 @@ public:
     // used to calculate the spend key when the wallet becomes unlocked.
     bool RewindOutput(const Output& output, mw::Coin& coin) const;
 
+    // Cheap pre-filter for RewindOutput that only checks the output's view tag.
+    // Outputs that fail this can't belong to the wallet. Only uses the scan secret,
+    // so it's safe to call while the keychain is being locked or unlocked.
+    bool MatchesViewTag(const Output& output) const;
+
     // Calculates the output secret key for the given coin.
     // If the address index is known, it calculates from the keychain's master spend key.
     // If not, it attempts to lookup the spend key in the database.
@@ -53,6 +58,9 @@ public:
     void Unlock(const SecretKey& spend_secret) { m_spendSecret = spend_secret; }
     
 private:
+    // Calculates the output's shared secret, and returns it only if it matches the output's view tag.
+    boost::optional<PublicKey> CalculateSharedSecret(const Output& output) const;
+
     const LegacyScriptPubKeyMan& m_spk_man;
     SecretKey m_scanSecret;
     SecretKey m_spendSecret;
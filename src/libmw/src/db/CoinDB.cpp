@@ -44,4 +44,15 @@ void CoinDB::RemoveUTXOs(const std::vector<mw::Hash>& output_ids)
 void CoinDB::RemoveAllUTXOs()
 {
     m_pDatabase->DeleteAll(UTXO_TABLE);
+}
+
+void CoinDB::ForEachUTXO(mw::DBIterator& iter, const std::function<void(const UTXO::CPtr&, const size_t)>& visitor)
+{
+    // Output IDs are stored as fixed-length hex strings, so "00..00" is the lowest possible key.
+    Database::ForEach<UTXO>(
+        iter,
+        UTXO_TABLE,
+        std::string(mw::Hash::size() * 2, '0'),
+        [&visitor](const DBEntry<UTXO>& entry, const size_t entry_size) { visitor(entry.item, entry_size); }
+    );
 }
\ No newline at end of file
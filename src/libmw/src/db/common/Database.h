@@ -7,6 +7,7 @@
 #include <mw/interfaces/db_interface.h>
 #include <vector>
 #include <cassert>
+#include <functional>
 #include <memory>
 
 class Database
@@ -72,6 +73,39 @@ public:
         }
     }
 
+    //
+    // Visits every entry in the table whose item key has the same length as first_key,
+    // as seen by the given iterator's snapshot. Keys are length-prefixed when serialized,
+    // so only entries with equal key lengths are contiguous.
+    //
+    template<typename T,
+        typename SFINAE = typename std::enable_if_t<std::is_base_of<Traits::ISerializable, T>::value>>
+    static void ForEach(
+        mw::DBIterator& iter,
+        const DBTable& table,
+        const std::string& first_key,
+        const std::function<void(const DBEntry<T>&, const size_t)>& visitor)
+    {
+        const std::string seek_key = table.BuildKey(first_key);
+
+        iter.Seek(seek_key);
+        while (iter.Valid()) {
+            std::string key;
+            if (!iter.GetKey(key) || key.size() != seek_key.size() || key.front() != table.GetPrefix()) {
+                break;
+            }
+
+            std::vector<uint8_t> item_vec;
+            if (iter.GetValue(item_vec)) {
+                T item;
+                CDataStream(item_vec, SER_DISK, PROTOCOL_VERSION) >> item;
+                visitor(DBEntry<T>(key.substr(1), std::move(item)), key.size() + item_vec.size());
+            }
+
+            iter.Next();
+        }
+    }
+
     void DeleteAll(const DBTable& table)
     {
         auto pBatch = m_pDB->CreateBatch();
@@ -7,20 +7,34 @@
 
 MW_NAMESPACE
 
-bool Keychain::RewindOutput(const Output& output, mw::Coin& coin) const
+boost::optional<PublicKey> Keychain::CalculateSharedSecret(const Output& output) const
 {
     if (!output.HasStandardFields()) {
-        return false;
+        return boost::none;
     }
 
     assert(!GetScanSecret().IsNull());
     PublicKey shared_secret = output.Ke().Mul(GetScanSecret());
-    uint8_t view_tag = Hashed(EHashTag::TAG, shared_secret)[0];
-    if (view_tag != output.GetViewTag()) {
+    if (Hashed(EHashTag::TAG, shared_secret)[0] != output.GetViewTag()) {
+        return boost::none;
+    }
+
+    return boost::make_optional(std::move(shared_secret));
+}
+
+bool Keychain::MatchesViewTag(const Output& output) const
+{
+    return !!CalculateSharedSecret(output);
+}
+
+bool Keychain::RewindOutput(const Output& output, mw::Coin& coin) const
+{
+    boost::optional<PublicKey> shared_secret = CalculateSharedSecret(output);
+    if (!shared_secret) {
         return false;
     }
 
-    SecretKey t = Hashed(EHashTag::DERIVE, shared_secret);
+    SecretKey t = Hashed(EHashTag::DERIVE, *shared_secret);
     PublicKey B_i = output.Ko().Div(Hashed(EHashTag::OUT_KEY, t));
 
     // Check if B_i belongs to wallet
@@ -0,0 +1,59 @@
+// Copyright (c) 2021 The Catcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <mw/db/CoinDB.h>
+#include <mw/models/wallet/StealthAddress.h>
+
+#include <test_framework/TestMWEB.h>
+
+#include <set>
+
+BOOST_FIXTURE_TEST_SUITE(TestCoinDB, MWEBTestingSetup)
+
+BOOST_AUTO_TEST_CASE(ForEachUTXO)
+{
+    auto pDatabase = GetDB();
+
+    std::vector<UTXO::CPtr> utxos;
+    for (size_t i = 0; i < 5; i++) {
+        BlindingFactor blind;
+        Output output = Output::Create(&blind, SecretKey::Random(), StealthAddress::Random(), 1000 + i);
+        utxos.push_back(std::make_shared<const UTXO>((int32_t)i, mmr::LeafIndex::At(i), std::move(output)));
+    }
+
+    CoinDB(pDatabase.get()).AddUTXOs(utxos);
+
+    // Entries in other tables must not be visited.
+    auto pBatch = pDatabase->CreateBatch();
+    pBatch->Write("L0", {0, 1, 2});
+    pBatch->Write("V" + std::string(64, 'f'), {0, 1, 2});
+    pBatch->Commit();
+
+    // UTXOs written after the iterator is opened are not part of its snapshot.
+    auto pIter = pDatabase->NewIterator();
+    CoinDB(pDatabase.get()).RemoveUTXOs({utxos[4]->GetOutputID()});
+
+    std::set<mw::Hash> visited;
+    size_t total_size = 0;
+    CoinDB::ForEachUTXO(*pIter, [&](const UTXO::CPtr& pUTXO, const size_t entry_size) {
+        visited.insert(pUTXO->GetOutputID());
+        total_size += entry_size;
+    });
+
+    BOOST_REQUIRE(visited.size() == utxos.size());
+    for (const UTXO::CPtr& pUTXO : utxos) {
+        BOOST_REQUIRE(visited.count(pUTXO->GetOutputID()) == 1);
+    }
+    BOOST_REQUIRE(total_size > utxos.size() * 65);
+
+    // A fresh iterator no longer sees the removed UTXO.
+    visited.clear();
+    CoinDB::ForEachUTXO(*pDatabase->NewIterator(), [&](const UTXO::CPtr& pUTXO, const size_t) {
+        visited.insert(pUTXO->GetOutputID());
+    });
+    BOOST_REQUIRE(visited.size() == utxos.size() - 1);
+    BOOST_REQUIRE(visited.count(utxos[4]->GetOutputID()) == 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
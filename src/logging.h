@@ -57,6 +57,7 @@ namespace BCLog {
         LEVELDB     = (1 << 20),
         VALIDATION  = (1 << 21),
         RETARGETTING = (1 << 22),
+        STRATUM     = (1 << 23),
         ALL         = ~(uint32_t)0,
     };
 
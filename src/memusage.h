@@ -7,6 +7,7 @@
 
 #include <indirectmap.h>
 #include <prevector.h>
+#include <support/allocators/pool.h>
 
 #include <stdlib.h>
 
@@ -167,6 +168,19 @@ static inline size_t DynamicUsage(const std::unordered_map<X, Y, Z>& m)
     return MallocUsage(sizeof(unordered_node<std::pair<const X, Y> >)) * m.size() + MallocUsage(sizeof(void*) * m.bucket_count());
 }
 
+template<typename X, typename Y, typename Z, typename P, std::size_t MAX_BLOCK_SIZE_BYTES, std::size_t ALIGN_BYTES>
+static inline size_t DynamicUsage(const std::unordered_map<X, Y, Z, P, PoolAllocator<std::pair<const X, Y>, MAX_BLOCK_SIZE_BYTES, ALIGN_BYTES>>& m)
+{
+    // The nodes are in the chunks of the pool, whether in use or free. The chunks are
+    // tracked in a std::list, with two pointers per list node besides the chunk's.
+    const auto* resource = m.get_allocator().resource();
+    const size_t chunks_usage = (MallocUsage(resource->ChunkSizeBytes()) + MallocUsage(sizeof(void*) * 3)) * resource->NumAllocatedChunks();
+    // A bucket array small enough for the pool is in one of the chunks already
+    const size_t buckets_bytes = sizeof(void*) * m.bucket_count();
+    const size_t buckets_usage = resource->IsFreeListUsable(buckets_bytes, alignof(void*)) ? 0 : MallocUsage(buckets_bytes);
+    return MallocUsage(sizeof(*resource)) + chunks_usage + buckets_usage;
+}
+
 }
 
 #endif // BITCOIN_MEMUSAGE_H
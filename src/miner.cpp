@@ -220,9 +220,12 @@ bool BlockAssembler::TestPackage(uint64_t packageSize, int64_t packageSigOpsCost
         return false;
     if (nBlockSigOpsCost + packageSigOpsCost >= MAX_BLOCK_SIGOPS_COST)
         return false;
-    if (nBlockMWEBWeight + packageMWEBWeight >= mw::MAX_MINE_WEIGHT)
-        return false;
-    return true;
+    return TestPackageMWEB(packageMWEBWeight);
+}
+
+bool BlockAssembler::TestPackageMWEB(int64_t packageMWEBWeight) const
+{
+    return nBlockMWEBWeight + packageMWEBWeight < mw::MAX_MINE_WEIGHT;
 }
 
 // Perform transaction-level checks before adding to block:
@@ -252,14 +255,9 @@ bool BlockAssembler::AddToBlock(CTxMemPool::txiter iter)
         return false;
     }
 
-    CTransactionRef pTx = iter->GetSharedTx();
-    if (!pTx->IsMWEBOnly()) {
-        if (pTx->HasMWEBTx()) {
-            CMutableTransaction mutable_tx(*pTx);
-            mutable_tx.mweb_tx.SetNull();
-            pTx = MakeTransactionRef(std::move(mutable_tx));
-        }
-
+    // MWEB: The mempool entry caches the tx with its MWEB data stripped, as it's included in vtx.
+    const CTransactionRef& pTx = iter->GetBlockTx();
+    if (pTx) {
         pblocktemplate->block.vtx.emplace_back(pTx);
         // MWEB: Should probably recalculate fee (for vTxFees) and sigopcost (for vTxSigOpsCost) without MWEB data?
         // Then we could use actual fee and sigop cost for hogex.
@@ -340,6 +338,9 @@ void BlockAssembler::SortForBlock(const CTxMemPool::setEntries& package, std::ve
 
 // This transaction selection algorithm orders the mempool based
 // on feerate of a transaction including all unconfirmed ancestors.
+// A package's size for the feerate counts both its vsize and its MWEB
+// weight (see MWEB_WEIGHT_PACKING_VSIZE), so packages are scored by the
+// share of both block limits they take up.
 // Since we don't remove transactions from the mempool as we select them
 // for block inclusion, we need an alternate method of updating the feerate
 // of a transaction with its not-yet-selected ancestors as we go.
@@ -366,8 +367,17 @@ void BlockAssembler::addPackageTxs(int &nPackagesSelected, int &nDescendantsUpda
     // Limit the number of attempts to add transactions to the block when it is
     // close to full; this is just a simple heuristic to finish quickly if the
     // mempool has a lot of entries.
+    // The block weight and the MWEB weight fill up independently, so packages
+    // with and without MWEB data are given up on separately: once one of the
+    // two is full, packages needing it are skipped without being evaluated,
+    // and the rest of the mempool is still searched for packages that fit the
+    // other.
     const int64_t MAX_CONSECUTIVE_FAILURES = 1000;
+    const int64_t MWEB_CLOSE_TO_FULL = mw::MAX_MINE_WEIGHT - (2 * mw::STANDARD_OUTPUT_WEIGHT + mw::KERNEL_WITH_STEALTH_WEIGHT);
     int64_t nConsecutiveFailed = 0;
+    int64_t nConsecutiveMWEBFailed = 0;
+    bool fBlockFull = false;
+    bool fMWEBFull = !fIncludeMWEB;
 
     while (mi != m_mempool.mapTx.get<ancestor_score>().end() || !mapModifiedTx.empty()) {
         // First try to find a new transaction in mapTx to evaluate.
@@ -423,6 +433,21 @@ void BlockAssembler::addPackageTxs(int &nPackagesSelected, int &nDescendantsUpda
             return;
         }
 
+        // Every MWEB transaction has a kernel, so none fit once the remaining
+        // MWEB weight is smaller than that.
+        const bool fHasMWEB = packageMWEBWeight > 0;
+        if (fHasMWEB && !fMWEBFull && !TestPackageMWEB(mw::BASE_KERNEL_WEIGHT)) {
+            fMWEBFull = true;
+        }
+
+        if (fHasMWEB ? fMWEBFull : fBlockFull) {
+            if (fUsingModified) {
+                mapModifiedTx.get<ancestor_score>().erase(modit);
+                failedTx.insert(iter);
+            }
+            continue;
+        }
+
         if (!TestPackage(packageSize, packageSigOpsCost, packageMWEBWeight)) {
             if (fUsingModified) {
                 // Since we always look at the best entry in mapModifiedTx,
@@ -432,11 +457,20 @@ void BlockAssembler::addPackageTxs(int &nPackagesSelected, int &nDescendantsUpda
                 failedTx.insert(iter);
             }
 
-            ++nConsecutiveFailed;
-
-            if (nConsecutiveFailed > MAX_CONSECUTIVE_FAILURES && nBlockWeight >
+            // Give up on a kind of package if we're close to full and haven't
+            // succeeded in a while. Packages with MWEB data also count the
+            // block weight, as they need room in both.
+            if (fHasMWEB) {
+                if (++nConsecutiveMWEBFailed > MAX_CONSECUTIVE_FAILURES &&
+                        (nBlockMWEBWeight > MWEB_CLOSE_TO_FULL || nBlockWeight > nBlockMaxWeight - 4000)) {
+                    fMWEBFull = true;
+                }
+            } else if (++nConsecutiveFailed > MAX_CONSECUTIVE_FAILURES && nBlockWeight >
                     nBlockMaxWeight - 4000) {
-                // Give up if we're close to full and haven't succeeded in a while
+                fBlockFull = true;
+            }
+
+            if (fBlockFull && fMWEBFull) {
                 break;
             }
             continue;
@@ -460,7 +494,11 @@ void BlockAssembler::addPackageTxs(int &nPackagesSelected, int &nDescendantsUpda
         }
 
         // This transaction will make it in; reset the failed counter.
-        nConsecutiveFailed = 0;
+        if (fHasMWEB) {
+            nConsecutiveMWEBFailed = 0;
+        } else {
+            nConsecutiveFailed = 0;
+        }
 
         // Package can be added. Sort the entries in a valid order.
         std::vector<CTxMemPool::txiter> sortedEntries;
@@ -491,6 +529,146 @@ void BlockAssembler::addPackageTxs(int &nPackagesSelected, int &nDescendantsUpda
     }
 }
 
+BlockTemplateCache::BlockTemplateCache(const CTxMemPool& mempool, const CChainParams& params, std::chrono::seconds refresh_interval)
+    : m_mempool(mempool), m_chainparams(params), m_refresh_interval(refresh_interval) {}
+
+BlockTemplateCache::~BlockTemplateCache()
+{
+    Stop();
+}
+
+void BlockTemplateCache::Start()
+{
+    assert(!m_thread.joinable());
+    {
+        LOCK(m_mutex);
+        m_stop = false;
+    }
+    m_thread = std::thread(&TraceThread<std::function<void()>>, "gbtcache", std::bind(&BlockTemplateCache::ThreadRefresh, this));
+}
+
+void BlockTemplateCache::Stop()
+{
+    {
+        LOCK(m_mutex);
+        m_stop = true;
+    }
+    m_cond.notify_all();
+    if (m_thread.joinable()) m_thread.join();
+}
+
+BlockTemplateCache::Entry BlockTemplateCache::Get()
+{
+    AssertLockHeld(cs_main);
+    const unsigned int transactions_updated = m_mempool.GetTransactionsUpdated();
+    {
+        LOCK(m_mutex);
+        m_last_request = std::chrono::steady_clock::now();
+        if (m_entry.block_template && m_entry.pindexPrev == ::ChainActive().Tip() &&
+            (m_entry.transactions_updated == transactions_updated ||
+             GetTime() - m_entry.time <= count_seconds(m_refresh_interval))) {
+            return m_entry;
+        }
+    }
+    return Build("request");
+}
+
+BlockTemplateCache::Entry BlockTemplateCache::Build(const char* reason)
+{
+    AssertLockHeld(cs_main);
+
+    // Store the tip and mempool state used before CreateNewBlock, to avoid races
+    Entry entry;
+    entry.pindexPrev = ::ChainActive().Tip();
+    entry.transactions_updated = m_mempool.GetTransactionsUpdated();
+    entry.time = GetTime();
+
+    CScript scriptDummy = CScript() << OP_TRUE;
+    entry.block_template = BlockAssembler(m_mempool, m_chainparams).CreateNewBlock(scriptDummy);
+
+    if (entry.block_template) {
+        LogPrint(BCLog::RPC, "Built block template (%s) on %s with %u transactions\n", reason, entry.pindexPrev->GetBlockHash().ToString(), entry.block_template->block.vtx.size());
+    }
+
+    LOCK(m_mutex);
+    if (entry.block_template) {
+        m_entry = entry;
+    }
+    m_next_refresh = std::chrono::steady_clock::now() + m_refresh_interval;
+    return entry;
+}
+
+void BlockTemplateCache::UpdatedBlockTip(const CBlockIndex* pindexNew, const CBlockIndex* pindexFork, bool fInitialDownload)
+{
+    if (fInitialDownload) return;
+    {
+        LOCK(m_mutex);
+        m_tip_changed = true;
+    }
+    m_cond.notify_all();
+}
+
+void BlockTemplateCache::TransactionAddedToMempool(const CTransactionRef& tx, uint64_t mempool_sequence)
+{
+    {
+        LOCK(m_mutex);
+        m_mempool_changed = true;
+    }
+    m_cond.notify_all();
+}
+
+void BlockTemplateCache::TransactionRemovedFromMempool(const CTransactionRef& tx, MemPoolRemovalReason reason, uint64_t mempool_sequence)
+{
+    {
+        LOCK(m_mutex);
+        m_mempool_changed = true;
+    }
+    m_cond.notify_all();
+}
+
+bool BlockTemplateCache::IsRequested() const
+{
+    return m_last_request && std::chrono::steady_clock::now() - *m_last_request < BLOCK_TEMPLATE_IDLE_TIMEOUT;
+}
+
+void BlockTemplateCache::ThreadRefresh()
+{
+    while (true) {
+        {
+            WAIT_LOCK(m_mutex, lock);
+            while (!m_stop && !(IsRequested() && m_tip_changed)) {
+                if (IsRequested() && m_mempool_changed) {
+                    if (std::chrono::steady_clock::now() >= m_next_refresh) break;
+                    m_cond.wait_until(lock, m_next_refresh);
+                } else {
+                    m_cond.wait(lock);
+                }
+            }
+            if (m_stop) return;
+            m_tip_changed = false;
+            m_mempool_changed = false;
+        }
+
+        LOCK(cs_main);
+        if (::ChainstateActive().IsInitialBlockDownload()) continue;
+        {
+            // Notifications are delivered asynchronously, so getblocktemplate
+            // may already have built a template for this state.
+            const unsigned int transactions_updated = m_mempool.GetTransactionsUpdated();
+            LOCK(m_mutex);
+            if (m_entry.block_template && m_entry.pindexPrev == ::ChainActive().Tip() &&
+                m_entry.transactions_updated == transactions_updated) {
+                continue;
+            }
+        }
+        try {
+            Build("background");
+        } catch (const std::runtime_error& e) {
+            LogPrintf("%s: failed to build block template: %s\n", __func__, e.what());
+        }
+    }
+}
+
 void IncrementExtraNonce(CBlock* pblock, const CBlockIndex* pindexPrev, unsigned int& nExtraNonce)
 {
     // Update nExtraNonce
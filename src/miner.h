@@ -8,12 +8,17 @@
 
 #include <optional.h>
 #include <primitives/block.h>
+#include <sync.h>
 #include <txmempool.h>
 #include <validation.h>
+#include <validationinterface.h>
 #include <mweb/mweb_miner.h>
 
+#include <chrono>
+#include <condition_variable>
 #include <memory>
 #include <stdint.h>
+#include <thread>
 
 #include <boost/multi_index_container.hpp>
 #include <boost/multi_index/ordered_index.hpp>
@@ -25,6 +30,10 @@ class CScript;
 namespace Consensus { struct Params; };
 
 static const bool DEFAULT_PRINTPRIORITY = false;
+/** Default for -blocktemplaterefresh, in seconds. 0 builds the template when getblocktemplate is called. */
+static const int64_t DEFAULT_BLOCK_TEMPLATE_REFRESH = 0;
+/** Templates stop being rebuilt in the background when none were requested for this long. */
+static constexpr std::chrono::minutes BLOCK_TEMPLATE_IDLE_TIMEOUT{5};
 
 struct CBlockTemplate
 {
@@ -193,6 +202,8 @@ private:
     void onlyUnconfirmed(CTxMemPool::setEntries& testSet);
     /** Test if a new package would "fit" in the block */
     bool TestPackage(uint64_t packageSize, int64_t packageSigOpsCost, int64_t packageMWEBWeight) const;
+    /** Test if a package's MWEB weight would "fit" in the block's MWEB weight limit */
+    bool TestPackageMWEB(int64_t packageMWEBWeight) const;
     /** Perform checks on each transaction in a package:
       * locktime, premature-witness, serialized size (if necessary)
       * These checks should always succeed, and they're here
@@ -209,6 +220,69 @@ private:
     int UpdatePackagesForAdded(const CTxMemPool::setEntries& alreadyAdded, indexed_modified_transaction_set& mapModifiedTx) EXCLUSIVE_LOCKS_REQUIRED(m_mempool.cs);
 };
 
+/**
+ * Keeps a block template for the current tip up to date on a background thread,
+ * so that getblocktemplate doesn't assemble a block (including aggregating the
+ * MWEB transactions and building the HogEx) while holding cs_main and the mempool
+ * lock. The template is rebuilt as soon as the tip changes, and after the mempool
+ * changes at most once per refresh interval. Nothing is built in the background
+ * unless a template was requested within BLOCK_TEMPLATE_IDLE_TIMEOUT.
+ */
+class BlockTemplateCache final : public CValidationInterface
+{
+public:
+    struct Entry {
+        std::shared_ptr<const CBlockTemplate> block_template;
+        //! The tip the template was built on
+        CBlockIndex* pindexPrev{nullptr};
+        //! CTxMemPool::GetTransactionsUpdated() when the template was built
+        unsigned int transactions_updated{0};
+        //! GetTime() when the template was built
+        int64_t time{0};
+    };
+
+    BlockTemplateCache(const CTxMemPool& mempool, const CChainParams& params, std::chrono::seconds refresh_interval);
+    ~BlockTemplateCache();
+
+    void Start();
+    void Stop();
+
+    /**
+     * Return a template for the current tip. The cached template is returned if
+     * the mempool hasn't changed since it was built or it is younger than the
+     * refresh interval; otherwise a new one is built.
+     */
+    Entry Get() EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+
+protected:
+    void UpdatedBlockTip(const CBlockIndex* pindexNew, const CBlockIndex* pindexFork, bool fInitialDownload) override;
+    void TransactionAddedToMempool(const CTransactionRef& tx, uint64_t mempool_sequence) override;
+    void TransactionRemovedFromMempool(const CTransactionRef& tx, MemPoolRemovalReason reason, uint64_t mempool_sequence) override;
+
+private:
+    const CTxMemPool& m_mempool;
+    const CChainParams& m_chainparams;
+    const std::chrono::seconds m_refresh_interval;
+
+    Mutex m_mutex;
+    std::condition_variable m_cond;
+    Entry m_entry GUARDED_BY(m_mutex);
+    //! When a template was last requested
+    Optional<std::chrono::steady_clock::time_point> m_last_request GUARDED_BY(m_mutex);
+    bool m_tip_changed GUARDED_BY(m_mutex){false};
+    bool m_mempool_changed GUARDED_BY(m_mutex){false};
+    //! Earliest time the template is rebuilt for mempool changes
+    std::chrono::steady_clock::time_point m_next_refresh GUARDED_BY(m_mutex);
+    bool m_stop GUARDED_BY(m_mutex){false};
+    std::thread m_thread;
+
+    /** Build a template on the current tip and make it the cached one. reason is logged. */
+    Entry Build(const char* reason) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+    /** Whether a template was requested recently enough to keep rebuilding it. */
+    bool IsRequested() const EXCLUSIVE_LOCKS_REQUIRED(m_mutex);
+    void ThreadRefresh();
+};
+
 /** Modify the extranonce in a block */
 void IncrementExtraNonce(CBlock* pblock, const CBlockIndex* pindexPrev, unsigned int& nExtraNonce);
 int64_t UpdateTime(CBlockHeader* pblock, const Consensus::Params& consensusParams, const CBlockIndex* pindexPrev);
@@ -2,6 +2,10 @@
 
 #include <dbwrapper.h>
 #include <mw/interfaces/db_interface.h>
+#include <optional.h>
+#include <sync.h>
+
+#include <map>
 
 namespace MWEB {
 
@@ -31,6 +35,32 @@ private:
     std::shared_ptr<CDBBatch> m_pBatch;
 };
 
+/** Writes that aren't committed to the database yet. Erased keys map to nullopt. */
+using PendingWrites = std::map<std::string, Optional<std::vector<uint8_t>>>;
+
+/** A batch that records its writes, so they can be committed later as part of another batch. */
+class PendingBatch : public mw::DBBatch
+{
+public:
+    explicit PendingBatch(PendingWrites& writes)
+        : m_writes(writes) {}
+
+    void Write(const std::string& key, const std::vector<uint8_t>& value) final
+    {
+        m_writes[key] = value;
+    }
+
+    void Erase(const std::string& key) final
+    {
+        m_writes[key] = nullopt;
+    }
+
+    void Commit() final {}
+
+private:
+    PendingWrites& m_writes;
+};
+
 class DBIterator : public mw::DBIterator
 {
 public:
@@ -52,6 +82,11 @@ public:
         return m_pIterator->GetKey(key);
     }
 
+    bool GetValue(std::vector<uint8_t>& value) const final
+    {
+        return m_pIterator->GetValue(value);
+    }
+
     bool Valid() const final
     {
         return m_pIterator->Valid();
@@ -68,9 +103,26 @@ public:
 
     bool Read(const std::string& key, std::vector<uint8_t>& value) const final
     {
+        std::shared_ptr<const PendingWrites> pending = WITH_LOCK(m_mutex, return m_pending);
+        if (pending) {
+            auto iter = pending->find(key);
+            if (iter != pending->end()) {
+                if (!iter->second) return false;
+                value = *iter->second;
+                return true;
+            }
+        }
         return m_pDB->Read(key, value);
     }
 
+    /// Make reads return the given writes until they are committed, after which this
+    /// must be called with null. Iterators don't see them.
+    void SetPendingWrites(std::shared_ptr<const PendingWrites> pending)
+    {
+        LOCK(m_mutex);
+        m_pending = std::move(pending);
+    }
+
     std::unique_ptr<mw::DBIterator> NewIterator() final
     {
         return std::unique_ptr<mw::DBIterator>(new MWEB::DBIterator(m_pDB->NewIterator()));
@@ -83,6 +135,8 @@ public:
 
 private:
     CDBWrapper* m_pDB;
+    mutable Mutex m_mutex;
+    std::shared_ptr<const PendingWrites> m_pending GUARDED_BY(m_mutex);
 };
 
 } // namespace MWEB
\ No newline at end of file
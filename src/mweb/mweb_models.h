@@ -10,6 +10,7 @@
 #include <mw/models/tx/Transaction.h>
 #include <serialize.h>
 #include <tinyformat.h>
+#include <uint256.h>
 
 #include <memory>
 #include <vector>
@@ -102,6 +103,39 @@ struct Block {
     void SetNull() noexcept { m_block.reset(); }
 };
 
+/// <summary>
+/// The MWEB data of a block in the compact form published to ZMQ and REST clients:
+/// the MWEB header, the amount held by the extension block after the block, and the
+/// block's kernels, peg-ins and peg-outs. Inputs and outputs are left out.
+/// Peg-outs are read from the kernels, which must match the HogEx peg-out outputs.
+/// </summary>
+struct BlockSummary {
+    uint256 block_hash;
+    int32_t height{-1};
+    CAmount mweb_amount{0};
+    mw::Header::CPtr header;
+    std::vector<Kernel> kernels;
+    std::vector<PegInCoin> pegins;
+    std::vector<PegOutCoin> pegouts;
+
+    BlockSummary() = default;
+    BlockSummary(const uint256& block_hash_in, int32_t height_in, CAmount mweb_amount_in, const Block& block)
+        : block_hash(block_hash_in), height(height_in), mweb_amount(mweb_amount_in), header(block.GetMWEBHeader())
+    {
+        if (!block.IsNull()) {
+            kernels = block.m_block->GetKernels();
+            pegins = block.m_block->GetPegIns();
+            pegouts = block.m_block->GetPegOuts();
+        }
+    }
+
+    SERIALIZE_METHODS(BlockSummary, obj)
+    {
+        READWRITE(obj.block_hash, obj.height, VARINT_MODE(obj.mweb_amount, VarIntMode::NONNEGATIVE_SIGNED));
+        READWRITE(WrapOptionalPtr(obj.header), obj.kernels, obj.pegins, obj.pegouts);
+    }
+};
+
 /// <summary>
 /// A convenience wrapper around a possibly-null MWEB transcation.
 /// </summary>
@@ -5,6 +5,22 @@
 
 using namespace MWEB;
 
+Wallet::CoinWriteBatch::CoinWriteBatch(Wallet& wallet)
+    : m_wallet(wallet)
+{
+    if (m_wallet.m_coin_batch == nullptr) {
+        m_batch = MakeUnique<WalletBatch>(m_wallet.m_pWallet->GetDatabase());
+        m_wallet.m_coin_batch = m_batch.get();
+    }
+}
+
+Wallet::CoinWriteBatch::~CoinWriteBatch()
+{
+    if (m_batch) {
+        m_wallet.m_coin_batch = nullptr;
+    }
+}
+
 bool Wallet::UpgradeCoins()
 {
     mw::Keychain::Ptr keychain = GetKeychain();
@@ -24,7 +40,7 @@ bool Wallet::UpgradeCoins()
 
                 // If spend key was populated, update the database and m_coins map.
                 if (coin.HasSpendKey()) {
-                    m_coins[coin.output_id] = coin;
+                    AddCoin(coin);
 
                     WalletBatch batch(m_pWallet->GetDatabase());
                     batch.WriteMWEBCoin(coin);
@@ -69,8 +85,8 @@ bool Wallet::RewindOutput(const Output& output, mw::Coin& coin)
         return false;
     }
 
-    m_coins[coin.output_id] = coin;
-    WalletBatch(m_pWallet->GetDatabase()).WriteMWEBCoin(coin);
+    AddCoin(coin);
+    WriteCoin(coin);
     return true;
 }
 
@@ -107,20 +123,21 @@ bool Wallet::GetStealthAddress(const uint32_t index, StealthAddress& address) co
 
 void Wallet::LoadToWallet(const mw::Coin& coin)
 {
-    m_coins[coin.output_id] = coin;
+    AddCoin(coin);
 }
 
 void Wallet::SaveToWallet(const std::vector<mw::Coin>& coins)
 {
-    WalletBatch batch(m_pWallet->GetDatabase());
+    CoinWriteBatch batch(*this);
     for (const mw::Coin& coin : coins) {
-        m_coins[coin.output_id] = coin;
-        batch.WriteMWEBCoin(coin);
+        AddCoin(coin);
+        WriteCoin(coin);
     }
 }
 
 bool Wallet::GetCoin(const mw::Hash& output_id, mw::Coin& coin) const
 {
+    LOCK(m_coins_mutex);
     auto iter = m_coins.find(output_id);
     if (iter != m_coins.end()) {
         coin = iter->second;
@@ -131,6 +148,21 @@ bool Wallet::GetCoin(const mw::Hash& output_id, mw::Coin& coin) const
     return false;
 }
 
+void Wallet::AddCoin(const mw::Coin& coin)
+{
+    LOCK(m_coins_mutex);
+    m_coins[coin.output_id] = coin;
+}
+
+void Wallet::WriteCoin(const mw::Coin& coin)
+{
+    if (m_coin_batch != nullptr) {
+        m_coin_batch->WriteMWEBCoin(coin);
+    } else {
+        WalletBatch(m_pWallet->GetDatabase()).WriteMWEBCoin(coin);
+    }
+}
+
 mw::Keychain::Ptr Wallet::GetKeychain() const
 {
     auto spk_man = m_pWallet->GetScriptPubKeyMan(OutputType::MWEB, false);
@@ -7,26 +7,58 @@
 #include <mw/models/wallet/Coin.h>
 #include <mw/models/wallet/StealthAddress.h>
 #include <mw/wallet/Keychain.h>
+#include <crypto/common.h>
 #include <streams.h>
+#include <sync.h>
 #include <util/strencodings.h>
 #include <boost/optional.hpp>
 #include <boost/variant.hpp>
-#include <map>
+#include <memory>
 #include <set>
+#include <unordered_map>
 
 class CWallet;
+class WalletBatch;
 
 namespace MWEB {
 
+/**
+ * Output IDs are blake3 hashes, so their leading bytes are already uniformly distributed.
+ */
+struct OutputIdHasher
+{
+    size_t operator()(const mw::Hash& output_id) const { return ReadLE64(output_id.data()); }
+};
+
 class Wallet
 {
     CWallet* m_pWallet;
-    std::map<mw::Hash, mw::Coin> m_coins;
+
+    mutable Mutex m_coins_mutex;
+    std::unordered_map<mw::Hash, mw::Coin, OutputIdHasher> m_coins GUARDED_BY(m_coins_mutex);
+
+    //! Batch shared by all coin writes while a CoinWriteBatch is in scope. Only used with cs_wallet held.
+    WalletBatch* m_coin_batch{nullptr};
 
 public:
     Wallet(CWallet* pWallet)
         : m_pWallet(pWallet) {}
 
+    /**
+     * RAII helper that routes the coin writes made during its lifetime (e.g. all outputs
+     * rewound while connecting a block) through a single WalletBatch, rather than opening
+     * and flushing a new batch per coin. Nested instances reuse the outermost batch.
+     */
+    class CoinWriteBatch
+    {
+        Wallet& m_wallet;
+        std::unique_ptr<WalletBatch> m_batch;
+
+    public:
+        explicit CoinWriteBatch(Wallet& wallet);
+        ~CoinWriteBatch();
+    };
+
     bool IsChange(const StealthAddress& address) const;
     bool GetCoin(const mw::Hash& output_id, mw::Coin& coin) const;
 
@@ -44,8 +76,11 @@ public:
     void LoadToWallet(const mw::Coin& coin);
     void SaveToWallet(const std::vector<mw::Coin>& coins);
 
-private:
     mw::Keychain::Ptr GetKeychain() const;
+
+private:
+    void AddCoin(const mw::Coin& coin) LOCKS_EXCLUDED(m_coins_mutex);
+    void WriteCoin(const mw::Coin& coin);
 };
 
 struct WalletTxInfo
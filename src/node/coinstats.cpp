@@ -5,14 +5,27 @@
 
 #include <node/coinstats.h>
 
+#include <chainparams.h>
 #include <coins.h>
 #include <hash.h>
 #include <serialize.h>
 #include <uint256.h>
 #include <util/system.h>
+#include <util/threadpool.h>
 #include <validation.h>
 
+#include <mw/consensus/KernelSumValidator.h>
+#include <mw/db/CoinDB.h>
+
+#include <algorithm>
+#include <future>
 #include <map>
+#include <thread>
+
+//! Minimum number of MWEB commitments summed by each thread of the supply audit
+static const size_t MIN_COMMITMENTS_PER_THREAD = 4096;
+//! Maximum number of threads reading MWEB blocks for the supply audit
+static const size_t MAX_MWEB_BLOCK_READ_THREADS = 16;
 
 static uint64_t GetBogoSize(const CScript& scriptPubKey)
 {
@@ -52,18 +65,145 @@ static void ApplyStats(CCoinsStats& stats, std::nullptr_t, const uint256& hash,
     }
 }
 
+//! Walk the MWEB UTXO table, collecting the UTXO commitments if they are needed for the supply audit
+static void ApplyMWEBStats(mw::DBIterator& iter, uint64_t& utxo_count, uint64_t& disk_size, std::vector<Commitment>* commitments, const std::function<void()>& interruption_point)
+{
+    CoinDB::ForEachUTXO(iter, [&](const UTXO::CPtr& utxo, const size_t entry_size) {
+        interruption_point();
+        utxo_count++;
+        disk_size += entry_size;
+        if (commitments) {
+            commitments->push_back(utxo->GetCommitment());
+        }
+    });
+}
+
+//! Collect the kernels of every MWEB block in the chain ending at pindex, oldest first.
+//! The blocks are read on a pool of threads, each of which reads every n-th block.
+static bool ReadMWEBKernels(const CBlockIndex* pindex, std::vector<Kernel>& kernels, const std::function<void()>& interruption_point)
+{
+    std::vector<const CBlockIndex*> mweb_blocks;
+    for (; pindex != nullptr && pindex->mweb_header != nullptr; pindex = pindex->pprev) {
+        mweb_blocks.push_back(pindex);
+    }
+    std::reverse(mweb_blocks.begin(), mweb_blocks.end());
+
+    // Each block's kernels get their own slot, so that they can be joined in chain
+    // order. ValidateState rejects a supply that goes negative along the way.
+    std::vector<std::vector<Kernel>> block_kernels(mweb_blocks.size());
+    const Consensus::Params& consensus_params = Params().GetConsensus();
+    ThreadPool read_pool("mwebread", ReadAheadThreadCount(MAX_MWEB_BLOCK_READ_THREADS));
+    const size_t num_tasks = read_pool.WorkerCount();
+    std::vector<std::future<bool>> reads;
+    for (size_t i = 0; i < num_tasks; ++i) {
+        reads.push_back(read_pool.Submit([&, i]() {
+            for (size_t j = i; j < mweb_blocks.size(); j += num_tasks) {
+                interruption_point();
+                CBlock block;
+                if (!ReadBlockFromDisk(block, mweb_blocks[j], consensus_params)) {
+                    return error("ReadMWEBKernels: failed to read block %s from disk", mweb_blocks[j]->GetBlockHash().ToString());
+                }
+                if (!block.mweb_block.IsNull()) {
+                    block_kernels[j] = block.mweb_block.m_block->GetKernels();
+                }
+            }
+            return true;
+        }));
+    }
+    bool ret = true;
+    for (auto& read : reads) {
+        ret &= read.get();
+    }
+    if (!ret) return false;
+
+    for (const std::vector<Kernel>& kernels_in_block : block_kernels) {
+        kernels.insert(kernels.end(), kernels_in_block.cbegin(), kernels_in_block.cend());
+    }
+    return true;
+}
+
+//! Sum the commitments on several threads. Pedersen commitments are additively
+//! homomorphic, so the partial sums can be combined in any order.
+static std::vector<Commitment> SumCommitments(const std::vector<Commitment>& commitments)
+{
+    const size_t num_threads = std::max<size_t>(1, std::min<size_t>(GetNumCores(), commitments.size() / MIN_COMMITMENTS_PER_THREAD));
+    const size_t chunk_size = (commitments.size() + num_threads - 1) / num_threads;
+
+    std::vector<Commitment> partial_sums(num_threads);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < num_threads; i++) {
+        threads.emplace_back([&, i]() {
+            const auto begin = commitments.cbegin() + std::min(commitments.size(), i * chunk_size);
+            const auto end = commitments.cbegin() + std::min(commitments.size(), (i + 1) * chunk_size);
+            partial_sums[i] = Pedersen::AddCommitments(std::vector<Commitment>(begin, end));
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    return partial_sums;
+}
+
+bool CheckMWEBSums(const CBlockIndex* pindex, const std::vector<Commitment>& utxo_commitments, const std::vector<Kernel>& kernels)
+{
+    CAmount kernel_supply = 0;
+    for (const Kernel& kernel : kernels) {
+        kernel_supply += kernel.GetSupplyChange();
+    }
+    if (kernel_supply != pindex->mweb_amount) {
+        LogPrintf("%s: kernel supply %d does not match recorded MWEB amount %d\n", __func__, kernel_supply, pindex->mweb_amount);
+        return false;
+    }
+
+    try {
+        KernelSumValidator::ValidateState(SumCommitments(utxo_commitments), kernels, pindex->mweb_header->GetKernelOffset());
+    } catch (const std::exception& e) {
+        LogPrintf("%s: MWEB commitment sum mismatch: %s\n", __func__, e.what());
+        return false;
+    }
+    return true;
+}
+
 //! Calculate statistics about the unspent transaction output set
 template <typename T>
-static bool GetUTXOStats(CCoinsView* view, CCoinsStats& stats, T hash_obj, const std::function<void()>& interruption_point)
+static bool GetUTXOStats(CCoinsView* view, CCoinsStats& stats, T hash_obj, const std::function<void()>& interruption_point, const bool verify_mweb_sums)
 {
     stats = CCoinsStats();
-    std::unique_ptr<CCoinsViewCursor> pcursor(view->Cursor());
-    assert(pcursor);
-
-    stats.hashBlock = pcursor->GetBestBlock();
+    std::unique_ptr<CCoinsViewCursor> pcursor;
+    std::unique_ptr<mw::DBIterator> mweb_iter;
+    const CBlockIndex* pindex;
     {
+        // Open both snapshots under cs_main, so that no flush can land between them.
         LOCK(cs_main);
-        stats.nHeight = LookupBlockIndex(stats.hashBlock)->nHeight;
+        pcursor.reset(view->Cursor());
+        mw::ICoinsView::Ptr mweb_view = view->GetMWEBView();
+        if (mweb_view && mweb_view->GetDatabase()) {
+            mweb_iter = mweb_view->GetDatabase()->NewIterator();
+        }
+        assert(pcursor);
+
+        stats.hashBlock = pcursor->GetBestBlock();
+        pindex = LookupBlockIndex(stats.hashBlock);
+        stats.nHeight = pindex->nHeight;
+        stats.mweb_amount = pindex->mweb_amount;
+    }
+
+    // Walk the MWEB UTXO set and the MWEB kernels while the transparent UTXO set is walked below.
+    uint64_t mweb_utxo_count = 0;
+    uint64_t mweb_disk_size = 0;
+    std::vector<Commitment> mweb_commitments;
+    std::vector<Kernel> mweb_kernels;
+    std::future<void> mweb_utxo_walk;
+    std::future<bool> mweb_kernel_walk;
+    if (mweb_iter) {
+        mweb_utxo_walk = std::async(std::launch::async, [&]() {
+            ApplyMWEBStats(*mweb_iter, mweb_utxo_count, mweb_disk_size, verify_mweb_sums ? &mweb_commitments : nullptr, interruption_point);
+        });
+        if (verify_mweb_sums) {
+            mweb_kernel_walk = std::async(std::launch::async, [&]() {
+                return ReadMWEBKernels(pindex, mweb_kernels, interruption_point);
+            });
+        }
     }
 
     PrepareHash(hash_obj, stats);
@@ -94,18 +234,35 @@ static bool GetUTXOStats(CCoinsView* view, CCoinsStats& stats, T hash_obj, const
     FinalizeHash(hash_obj, stats);
 
     stats.nDiskSize = view->EstimateSize();
+
+    if (mweb_utxo_walk.valid()) {
+        mweb_utxo_walk.get();
+        stats.mweb_utxo_count = mweb_utxo_count;
+        stats.mweb_disk_size = mweb_disk_size;
+    }
+    if (mweb_kernel_walk.valid()) {
+        if (!mweb_kernel_walk.get()) {
+            return error("%s: unable to read MWEB kernels", __func__);
+        }
+        stats.mweb_sums_checked = true;
+        if (pindex->mweb_header == nullptr) {
+            stats.mweb_sums_valid = stats.mweb_utxo_count == 0 && stats.mweb_amount == 0;
+        } else {
+            stats.mweb_sums_valid = CheckMWEBSums(pindex, mweb_commitments, mweb_kernels);
+        }
+    }
     return true;
 }
 
-bool GetUTXOStats(CCoinsView* view, CCoinsStats& stats, CoinStatsHashType hash_type, const std::function<void()>& interruption_point)
+bool GetUTXOStats(CCoinsView* view, CCoinsStats& stats, CoinStatsHashType hash_type, const std::function<void()>& interruption_point, const bool verify_mweb_sums)
 {
     switch (hash_type) {
     case(CoinStatsHashType::HASH_SERIALIZED): {
         CHashWriter ss(SER_GETHASH, PROTOCOL_VERSION);
-        return GetUTXOStats(view, stats, ss, interruption_point);
+        return GetUTXOStats(view, stats, ss, interruption_point, verify_mweb_sums);
     }
     case(CoinStatsHashType::NONE): {
-        return GetUTXOStats(view, stats, nullptr, interruption_point);
+        return GetUTXOStats(view, stats, nullptr, interruption_point, verify_mweb_sums);
     }
     } // no default case, so the compiler can warn about missing cases
     assert(false);
@@ -9,9 +9,14 @@
 #include <amount.h>
 #include <uint256.h>
 
+#include <mw/models/crypto/Commitment.h>
+#include <mw/models/tx/Kernel.h>
+
 #include <cstdint>
 #include <functional>
+#include <vector>
 
+class CBlockIndex;
 class CCoinsView;
 
 enum class CoinStatsHashType {
@@ -32,9 +37,29 @@ struct CCoinsStats
 
     //! The number of coins contained.
     uint64_t coins_count{0};
+
+    //! The number of MWEB UTXOs contained.
+    uint64_t mweb_utxo_count{0};
+    //! The size of the MWEB UTXO table entries on disk.
+    uint64_t mweb_disk_size{0};
+    //! The MWEB balance recorded in the block index.
+    CAmount mweb_amount{0};
+
+    //! Whether the MWEB commitment sums were audited.
+    bool mweb_sums_checked{false};
+    //! Whether the MWEB UTXO commitments sum to the kernel excesses plus the recorded mweb_amount.
+    bool mweb_sums_valid{false};
 };
 
-//! Calculate statistics about the unspent transaction output set
-bool GetUTXOStats(CCoinsView* view, CCoinsStats& stats, const CoinStatsHashType hash_type, const std::function<void()>& interruption_point = {});
+//! Calculate statistics about the unspent transaction output set.
+//! The MWEB UTXO set is walked in parallel with the transparent one, and if
+//! verify_mweb_sums is set, its commitments are audited against the kernels
+//! of every MWEB block in the active chain.
+bool GetUTXOStats(CCoinsView* view, CCoinsStats& stats, const CoinStatsHashType hash_type, const std::function<void()>& interruption_point = {}, const bool verify_mweb_sums = false);
+
+//! Check that the MWEB UTXO commitments minus the MWEB balance recorded at pindex equal
+//! the kernel excesses plus the total kernel offset of its MWEB header, and that the
+//! kernels account for that balance.
+bool CheckMWEBSums(const CBlockIndex* pindex, const std::vector<Commitment>& utxo_commitments, const std::vector<Kernel>& kernels);
 
 #endif // BITCOIN_NODE_COINSTATS_H
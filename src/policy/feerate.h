@@ -14,6 +14,9 @@
 const std::string CURRENCY_UNIT = "CAT"; // One formatted unit
 const std::string CURRENCY_ATOM = "sat"; // One indivisible minimum value unit
 
+/** Fee in satoshis required per unit of MWEB weight */
+static constexpr CAmount BASE_MWEB_FEE = 100;
+
 /* Used to determine type of fee estimation requested */
 enum class FeeEstimateMode {
     UNSET,        //!< Use default settings based on other criteria
@@ -474,9 +474,10 @@ bool CBlockPolicyEstimator::removeTx(uint256 hash, bool inBlock)
     LOCK(m_cs_fee_estimator);
     std::map<uint256, TxStatsInfo>::iterator pos = mapMemPoolTxs.find(hash);
     if (pos != mapMemPoolTxs.end()) {
-        feeStats->removeTx(pos->second.blockHeight, nBestSeenHeight, pos->second.bucketIndex, inBlock);
-        shortStats->removeTx(pos->second.blockHeight, nBestSeenHeight, pos->second.bucketIndex, inBlock);
-        longStats->removeTx(pos->second.blockHeight, nBestSeenHeight, pos->second.bucketIndex, inBlock);
+        const bool mweb = pos->second.mweb;
+        GetStats(FeeEstimateHorizon::MED_HALFLIFE, mweb).removeTx(pos->second.blockHeight, nBestSeenHeight, pos->second.bucketIndex, inBlock);
+        GetStats(FeeEstimateHorizon::SHORT_HALFLIFE, mweb).removeTx(pos->second.blockHeight, nBestSeenHeight, pos->second.bucketIndex, inBlock);
+        GetStats(FeeEstimateHorizon::LONG_HALFLIFE, mweb).removeTx(pos->second.blockHeight, nBestSeenHeight, pos->second.bucketIndex, inBlock);
         mapMemPoolTxs.erase(hash);
         return true;
     } else {
@@ -500,12 +501,36 @@ CBlockPolicyEstimator::CBlockPolicyEstimator()
     feeStats = std::unique_ptr<TxConfirmStats>(new TxConfirmStats(buckets, bucketMap, MED_BLOCK_PERIODS, MED_DECAY, MED_SCALE));
     shortStats = std::unique_ptr<TxConfirmStats>(new TxConfirmStats(buckets, bucketMap, SHORT_BLOCK_PERIODS, SHORT_DECAY, SHORT_SCALE));
     longStats = std::unique_ptr<TxConfirmStats>(new TxConfirmStats(buckets, bucketMap, LONG_BLOCK_PERIODS, LONG_DECAY, LONG_SCALE));
+
+    static_assert(MIN_MWEB_BUCKET_FEERATE > 0, "Min MWEB feerate must be nonzero");
+    bucketIndex = 0;
+    for (double bucketBoundary = MIN_MWEB_BUCKET_FEERATE; bucketBoundary <= MAX_MWEB_BUCKET_FEERATE; bucketBoundary *= FEE_SPACING, bucketIndex++) {
+        mwebBuckets.push_back(bucketBoundary);
+        mwebBucketMap[bucketBoundary] = bucketIndex;
+    }
+    mwebBuckets.push_back(INF_FEERATE);
+    mwebBucketMap[INF_FEERATE] = bucketIndex;
+    assert(mwebBucketMap.size() == mwebBuckets.size());
+
+    mwebFeeStats = std::unique_ptr<TxConfirmStats>(new TxConfirmStats(mwebBuckets, mwebBucketMap, MED_BLOCK_PERIODS, MED_DECAY, MED_SCALE));
+    mwebShortStats = std::unique_ptr<TxConfirmStats>(new TxConfirmStats(mwebBuckets, mwebBucketMap, SHORT_BLOCK_PERIODS, SHORT_DECAY, SHORT_SCALE));
+    mwebLongStats = std::unique_ptr<TxConfirmStats>(new TxConfirmStats(mwebBuckets, mwebBucketMap, LONG_BLOCK_PERIODS, LONG_DECAY, LONG_SCALE));
 }
 
 CBlockPolicyEstimator::~CBlockPolicyEstimator()
 {
 }
 
+/** Feerates are stored and reported as BTC-per-kb, and those of MWEB-only
+ * transactions as BTC per 1000 units of MWEB weight */
+static double TrackedFeeRate(const CTxMemPoolEntry& entry)
+{
+    if (entry.GetTx().IsMWEBOnly()) {
+        return (double)(entry.GetFee() * 1000 / (CAmount)std::max<uint64_t>(entry.GetMWEBWeight(), 1));
+    }
+    return (double)CFeeRate(entry.GetFee(), entry.GetTxSize(), entry.GetMWEBWeight()).GetFeePerK();
+}
+
 void CBlockPolicyEstimator::processTransaction(const CTxMemPoolEntry& entry, bool validFeeEstimate)
 {
     LOCK(m_cs_fee_estimator);
@@ -533,15 +558,16 @@ void CBlockPolicyEstimator::processTransaction(const CTxMemPoolEntry& entry, boo
     }
     trackedTxs++;
 
-    // Feerates are stored and reported as BTC-per-kb:
-    CFeeRate feeRate(entry.GetFee(), entry.GetTxSize(), entry.GetMWEBWeight());
+    const bool mweb = entry.GetTx().IsMWEBOnly();
+    const double feeRate = TrackedFeeRate(entry);
 
     mapMemPoolTxs[hash].blockHeight = txHeight;
-    unsigned int bucketIndex = feeStats->NewTx(txHeight, (double)feeRate.GetFeePerK());
+    mapMemPoolTxs[hash].mweb = mweb;
+    unsigned int bucketIndex = GetStats(FeeEstimateHorizon::MED_HALFLIFE, mweb).NewTx(txHeight, feeRate);
     mapMemPoolTxs[hash].bucketIndex = bucketIndex;
-    unsigned int bucketIndex2 = shortStats->NewTx(txHeight, (double)feeRate.GetFeePerK());
+    unsigned int bucketIndex2 = GetStats(FeeEstimateHorizon::SHORT_HALFLIFE, mweb).NewTx(txHeight, feeRate);
     assert(bucketIndex == bucketIndex2);
-    unsigned int bucketIndex3 = longStats->NewTx(txHeight, (double)feeRate.GetFeePerK());
+    unsigned int bucketIndex3 = GetStats(FeeEstimateHorizon::LONG_HALFLIFE, mweb).NewTx(txHeight, feeRate);
     assert(bucketIndex == bucketIndex3);
 }
 
@@ -563,12 +589,12 @@ bool CBlockPolicyEstimator::processBlockTx(unsigned int nBlockHeight, const CTxM
         return false;
     }
 
-    // Feerates are stored and reported as BTC-per-kb:
-    CFeeRate feeRate(entry->GetFee(), entry->GetTxSize(), entry->GetMWEBWeight());
+    const bool mweb = entry->GetTx().IsMWEBOnly();
+    const double feeRate = TrackedFeeRate(*entry);
 
-    feeStats->Record(blocksToConfirm, (double)feeRate.GetFeePerK());
-    shortStats->Record(blocksToConfirm, (double)feeRate.GetFeePerK());
-    longStats->Record(blocksToConfirm, (double)feeRate.GetFeePerK());
+    GetStats(FeeEstimateHorizon::MED_HALFLIFE, mweb).Record(blocksToConfirm, feeRate);
+    GetStats(FeeEstimateHorizon::SHORT_HALFLIFE, mweb).Record(blocksToConfirm, feeRate);
+    GetStats(FeeEstimateHorizon::LONG_HALFLIFE, mweb).Record(blocksToConfirm, feeRate);
     return true;
 }
 
@@ -594,11 +620,17 @@ void CBlockPolicyEstimator::processBlock(unsigned int nBlockHeight,
     feeStats->ClearCurrent(nBlockHeight);
     shortStats->ClearCurrent(nBlockHeight);
     longStats->ClearCurrent(nBlockHeight);
+    mwebFeeStats->ClearCurrent(nBlockHeight);
+    mwebShortStats->ClearCurrent(nBlockHeight);
+    mwebLongStats->ClearCurrent(nBlockHeight);
 
     // Decay all exponential averages
     feeStats->UpdateMovingAverages();
     shortStats->UpdateMovingAverages();
     longStats->UpdateMovingAverages();
+    mwebFeeStats->UpdateMovingAverages();
+    mwebShortStats->UpdateMovingAverages();
+    mwebLongStats->UpdateMovingAverages();
 
     unsigned int countedTxs = 0;
     // Update averages with data points from current block
@@ -687,6 +719,24 @@ unsigned int CBlockPolicyEstimator::HighestTargetTracked(FeeEstimateHorizon hori
     }
 }
 
+TxConfirmStats& CBlockPolicyEstimator::GetStats(FeeEstimateHorizon horizon, bool mweb) const
+{
+    switch (horizon) {
+    case FeeEstimateHorizon::SHORT_HALFLIFE: {
+        return mweb ? *mwebShortStats : *shortStats;
+    }
+    case FeeEstimateHorizon::MED_HALFLIFE: {
+        return mweb ? *mwebFeeStats : *feeStats;
+    }
+    case FeeEstimateHorizon::LONG_HALFLIFE: {
+        return mweb ? *mwebLongStats : *longStats;
+    }
+    default: {
+        throw std::out_of_range("CBlockPolicyEstimator::GetStats unknown FeeEstimateHorizon");
+    }
+    }
+}
+
 unsigned int CBlockPolicyEstimator::BlockSpan() const
 {
     if (firstRecordedHeight == 0) return 0;
@@ -715,32 +765,35 @@ unsigned int CBlockPolicyEstimator::MaxUsableEstimate() const
  * time horizon which tracks confirmations up to the desired target.  If
  * checkShorterHorizon is requested, also allow short time horizon estimates
  * for a lower target to reduce the given answer */
-double CBlockPolicyEstimator::estimateCombinedFee(unsigned int confTarget, double successThreshold, bool checkShorterHorizon, EstimationResult *result) const
+double CBlockPolicyEstimator::estimateCombinedFee(unsigned int confTarget, double successThreshold, bool checkShorterHorizon, bool mweb, EstimationResult *result) const
 {
+    const TxConfirmStats& short_stats = GetStats(FeeEstimateHorizon::SHORT_HALFLIFE, mweb);
+    const TxConfirmStats& med_stats = GetStats(FeeEstimateHorizon::MED_HALFLIFE, mweb);
+    const TxConfirmStats& long_stats = GetStats(FeeEstimateHorizon::LONG_HALFLIFE, mweb);
     double estimate = -1;
-    if (confTarget >= 1 && confTarget <= longStats->GetMaxConfirms()) {
+    if (confTarget >= 1 && confTarget <= long_stats.GetMaxConfirms()) {
         // Find estimate from shortest time horizon possible
-        if (confTarget <= shortStats->GetMaxConfirms()) { // short horizon
-            estimate = shortStats->EstimateMedianVal(confTarget, SUFFICIENT_TXS_SHORT, successThreshold, nBestSeenHeight, result);
+        if (confTarget <= short_stats.GetMaxConfirms()) { // short horizon
+            estimate = short_stats.EstimateMedianVal(confTarget, SUFFICIENT_TXS_SHORT, successThreshold, nBestSeenHeight, result);
         }
-        else if (confTarget <= feeStats->GetMaxConfirms()) { // medium horizon
-            estimate = feeStats->EstimateMedianVal(confTarget, SUFFICIENT_FEETXS, successThreshold, nBestSeenHeight, result);
+        else if (confTarget <= med_stats.GetMaxConfirms()) { // medium horizon
+            estimate = med_stats.EstimateMedianVal(confTarget, SUFFICIENT_FEETXS, successThreshold, nBestSeenHeight, result);
         }
         else { // long horizon
-            estimate = longStats->EstimateMedianVal(confTarget, SUFFICIENT_FEETXS, successThreshold, nBestSeenHeight, result);
+            estimate = long_stats.EstimateMedianVal(confTarget, SUFFICIENT_FEETXS, successThreshold, nBestSeenHeight, result);
         }
         if (checkShorterHorizon) {
             EstimationResult tempResult;
             // If a lower confTarget from a more recent horizon returns a lower answer use it.
-            if (confTarget > feeStats->GetMaxConfirms()) {
-                double medMax = feeStats->EstimateMedianVal(feeStats->GetMaxConfirms(), SUFFICIENT_FEETXS, successThreshold, nBestSeenHeight, &tempResult);
+            if (confTarget > med_stats.GetMaxConfirms()) {
+                double medMax = med_stats.EstimateMedianVal(med_stats.GetMaxConfirms(), SUFFICIENT_FEETXS, successThreshold, nBestSeenHeight, &tempResult);
                 if (medMax > 0 && (estimate == -1 || medMax < estimate)) {
                     estimate = medMax;
                     if (result) *result = tempResult;
                 }
             }
-            if (confTarget > shortStats->GetMaxConfirms()) {
-                double shortMax = shortStats->EstimateMedianVal(shortStats->GetMaxConfirms(), SUFFICIENT_TXS_SHORT, successThreshold, nBestSeenHeight, &tempResult);
+            if (confTarget > short_stats.GetMaxConfirms()) {
+                double shortMax = short_stats.EstimateMedianVal(short_stats.GetMaxConfirms(), SUFFICIENT_TXS_SHORT, successThreshold, nBestSeenHeight, &tempResult);
                 if (shortMax > 0 && (estimate == -1 || shortMax < estimate)) {
                     estimate = shortMax;
                     if (result) *result = tempResult;
@@ -754,15 +807,18 @@ double CBlockPolicyEstimator::estimateCombinedFee(unsigned int confTarget, doubl
 /** Ensure that for a conservative estimate, the DOUBLE_SUCCESS_PCT is also met
  * at 2 * target for any longer time horizons.
  */
-double CBlockPolicyEstimator::estimateConservativeFee(unsigned int doubleTarget, EstimationResult *result) const
+double CBlockPolicyEstimator::estimateConservativeFee(unsigned int doubleTarget, bool mweb, EstimationResult *result) const
 {
+    const TxConfirmStats& short_stats = GetStats(FeeEstimateHorizon::SHORT_HALFLIFE, mweb);
+    const TxConfirmStats& med_stats = GetStats(FeeEstimateHorizon::MED_HALFLIFE, mweb);
+    const TxConfirmStats& long_stats = GetStats(FeeEstimateHorizon::LONG_HALFLIFE, mweb);
     double estimate = -1;
     EstimationResult tempResult;
-    if (doubleTarget <= shortStats->GetMaxConfirms()) {
-        estimate = feeStats->EstimateMedianVal(doubleTarget, SUFFICIENT_FEETXS, DOUBLE_SUCCESS_PCT, nBestSeenHeight, result);
+    if (doubleTarget <= short_stats.GetMaxConfirms()) {
+        estimate = med_stats.EstimateMedianVal(doubleTarget, SUFFICIENT_FEETXS, DOUBLE_SUCCESS_PCT, nBestSeenHeight, result);
     }
-    if (doubleTarget <= feeStats->GetMaxConfirms()) {
-        double longEstimate = longStats->EstimateMedianVal(doubleTarget, SUFFICIENT_FEETXS, DOUBLE_SUCCESS_PCT, nBestSeenHeight, &tempResult);
+    if (doubleTarget <= med_stats.GetMaxConfirms()) {
+        double longEstimate = long_stats.EstimateMedianVal(doubleTarget, SUFFICIENT_FEETXS, DOUBLE_SUCCESS_PCT, nBestSeenHeight, &tempResult);
         if (longEstimate > estimate) {
             estimate = longEstimate;
             if (result) *result = tempResult;
@@ -781,7 +837,23 @@ double CBlockPolicyEstimator::estimateConservativeFee(unsigned int doubleTarget,
 CFeeRate CBlockPolicyEstimator::estimateSmartFee(int confTarget, FeeCalculation *feeCalc, bool conservative) const
 {
     LOCK(m_cs_fee_estimator);
+    double median = estimateSmartFeeRate(confTarget, feeCalc, conservative, /* mweb */ false);
+    if (median < 0) return CFeeRate(0); // error condition
+
+    return CFeeRate(llround(median));
+}
+
+CFeeRate CBlockPolicyEstimator::estimateSmartMWEBFee(int confTarget, FeeCalculation *feeCalc, bool conservative) const
+{
+    LOCK(m_cs_fee_estimator);
+    double median = estimateSmartFeeRate(confTarget, feeCalc, conservative, /* mweb */ true);
+    if (median < 0) return CFeeRate(0); // error condition
 
+    return CFeeRate(llround(median));
+}
+
+double CBlockPolicyEstimator::estimateSmartFeeRate(int confTarget, FeeCalculation *feeCalc, bool conservative, bool mweb) const
+{
     if (feeCalc) {
         feeCalc->desiredTarget = confTarget;
         feeCalc->returnedTarget = confTarget;
@@ -792,7 +864,7 @@ CFeeRate CBlockPolicyEstimator::estimateSmartFee(int confTarget, FeeCalculation
 
     // Return failure if trying to analyze a target we're not tracking
     if (confTarget <= 0 || (unsigned int)confTarget > longStats->GetMaxConfirms()) {
-        return CFeeRate(0);  // error condition
+        return -1;  // error condition
     }
 
     // It's not possible to get reasonable estimates for confTarget of 1
@@ -804,7 +876,7 @@ CFeeRate CBlockPolicyEstimator::estimateSmartFee(int confTarget, FeeCalculation
     }
     if (feeCalc) feeCalc->returnedTarget = confTarget;
 
-    if (confTarget <= 1) return CFeeRate(0); // error condition
+    if (confTarget <= 1) return -1; // error condition
 
     assert(confTarget > 0); //estimateCombinedFee and estimateConservativeFee take unsigned ints
     /** true is passed to estimateCombined fee for target/2 and target so
@@ -817,13 +889,13 @@ CFeeRate CBlockPolicyEstimator::estimateSmartFee(int confTarget, FeeCalculation
      * the purpose of conservative estimates is not to let short term
      * fluctuations lower our estimates by too much.
      */
-    double halfEst = estimateCombinedFee(confTarget/2, HALF_SUCCESS_PCT, true, &tempResult);
+    double halfEst = estimateCombinedFee(confTarget/2, HALF_SUCCESS_PCT, true, mweb, &tempResult);
     if (feeCalc) {
         feeCalc->est = tempResult;
         feeCalc->reason = FeeReason::HALF_ESTIMATE;
     }
     median = halfEst;
-    double actualEst = estimateCombinedFee(confTarget, SUCCESS_PCT, true, &tempResult);
+    double actualEst = estimateCombinedFee(confTarget, SUCCESS_PCT, true, mweb, &tempResult);
     if (actualEst > median) {
         median = actualEst;
         if (feeCalc) {
@@ -831,7 +903,7 @@ CFeeRate CBlockPolicyEstimator::estimateSmartFee(int confTarget, FeeCalculation
             feeCalc->reason = FeeReason::FULL_ESTIMATE;
         }
     }
-    double doubleEst = estimateCombinedFee(2 * confTarget, DOUBLE_SUCCESS_PCT, !conservative, &tempResult);
+    double doubleEst = estimateCombinedFee(2 * confTarget, DOUBLE_SUCCESS_PCT, !conservative, mweb, &tempResult);
     if (doubleEst > median) {
         median = doubleEst;
         if (feeCalc) {
@@ -841,7 +913,7 @@ CFeeRate CBlockPolicyEstimator::estimateSmartFee(int confTarget, FeeCalculation
     }
 
     if (conservative || median == -1) {
-        double consEst =  estimateConservativeFee(2 * confTarget, &tempResult);
+        double consEst =  estimateConservativeFee(2 * confTarget, mweb, &tempResult);
         if (consEst > median) {
             median = consEst;
             if (feeCalc) {
@@ -851,9 +923,7 @@ CFeeRate CBlockPolicyEstimator::estimateSmartFee(int confTarget, FeeCalculation
         }
     }
 
-    if (median < 0) return CFeeRate(0); // error condition
-
-    return CFeeRate(llround(median));
+    return median;
 }
 
 
@@ -874,6 +944,10 @@ bool CBlockPolicyEstimator::Write(CAutoFile& fileout) const
         feeStats->Write(fileout);
         shortStats->Write(fileout);
         longStats->Write(fileout);
+        fileout << mwebBuckets;
+        mwebFeeStats->Write(fileout);
+        mwebShortStats->Write(fileout);
+        mwebLongStats->Write(fileout);
     }
     catch (const std::exception&) {
         LogPrintf("CBlockPolicyEstimator::Write(): unable to write policy estimator data (non-fatal)\n");
@@ -917,6 +991,26 @@ bool CBlockPolicyEstimator::Read(CAutoFile& filein)
             fileShortStats->Read(filein, nVersionThatWrote, numBuckets);
             fileLongStats->Read(filein, nVersionThatWrote, numBuckets);
 
+            // Files written before MWEB-only transactions were tracked separately end here
+            std::vector<double> fileMWEBBuckets;
+            std::unique_ptr<TxConfirmStats> fileMWEBFeeStats(new TxConfirmStats(mwebBuckets, mwebBucketMap, MED_BLOCK_PERIODS, MED_DECAY, MED_SCALE));
+            std::unique_ptr<TxConfirmStats> fileMWEBShortStats(new TxConfirmStats(mwebBuckets, mwebBucketMap, SHORT_BLOCK_PERIODS, SHORT_DECAY, SHORT_SCALE));
+            std::unique_ptr<TxConfirmStats> fileMWEBLongStats(new TxConfirmStats(mwebBuckets, mwebBucketMap, LONG_BLOCK_PERIODS, LONG_DECAY, LONG_SCALE));
+            bool fileHasMWEBStats = true;
+            try {
+                filein >> fileMWEBBuckets;
+            } catch (const std::ios_base::failure&) {
+                fileHasMWEBStats = false;
+            }
+            if (fileHasMWEBStats) {
+                size_t numMWEBBuckets = fileMWEBBuckets.size();
+                if (numMWEBBuckets <= 1 || numMWEBBuckets > 1000)
+                    throw std::runtime_error("Corrupt estimates file. Must have between 2 and 1000 MWEB feerate buckets");
+                fileMWEBFeeStats->Read(filein, nVersionThatWrote, numMWEBBuckets);
+                fileMWEBShortStats->Read(filein, nVersionThatWrote, numMWEBBuckets);
+                fileMWEBLongStats->Read(filein, nVersionThatWrote, numMWEBBuckets);
+            }
+
             // Fee estimates file parsed correctly
             // Copy buckets from file and refresh our bucketmap
             buckets = fileBuckets;
@@ -930,6 +1024,17 @@ bool CBlockPolicyEstimator::Read(CAutoFile& filein)
             shortStats = std::move(fileShortStats);
             longStats = std::move(fileLongStats);
 
+            if (fileHasMWEBStats) {
+                mwebBuckets = fileMWEBBuckets;
+                mwebBucketMap.clear();
+                for (unsigned int i = 0; i < mwebBuckets.size(); i++) {
+                    mwebBucketMap[mwebBuckets[i]] = i;
+                }
+                mwebFeeStats = std::move(fileMWEBFeeStats);
+                mwebShortStats = std::move(fileMWEBShortStats);
+                mwebLongStats = std::move(fileMWEBLongStats);
+            }
+
             nBestSeenHeight = nFileBestSeenHeight;
             historicalFirst = nFileHistoricalFirst;
             historicalBest = nFileHistoricalBest;
@@ -120,6 +120,11 @@ struct FeeCalculation
  *  We want to be able to estimate feerates that are needed on tx's to be included in
  * a certain number of blocks.  Every time a block is added to the best chain, this class records
  * stats on the transactions included in that block
+ *
+ * MWEB-only transactions take no space in the canonical block, only MWEB weight, which
+ * has its own block limit. They are tracked in a separate set of data sets, bucketed by
+ * their fee per 1000 units of MWEB weight, so they neither skew the feerates of other
+ * transactions nor take them as their own.
  */
 class CBlockPolicyEstimator
 {
@@ -172,6 +177,12 @@ private:
      */
     static constexpr double FEE_SPACING = 1.05;
 
+    /** Minimum and Maximum values for tracking fees per 1000 units of MWEB weight
+     * The minimum is the fee every MWEB transaction has to pay.
+     */
+    static constexpr double MIN_MWEB_BUCKET_FEERATE = BASE_MWEB_FEE * 1000;
+    static constexpr double MAX_MWEB_BUCKET_FEERATE = 1e8;
+
 public:
     /** Create new BlockPolicyEstimator and initialize stats tracking classes with default values */
     CBlockPolicyEstimator();
@@ -197,6 +208,12 @@ public:
      */
     CFeeRate estimateSmartFee(int confTarget, FeeCalculation *feeCalc, bool conservative) const;
 
+    /** Estimate the fee per 1000 units of MWEB weight needed for an MWEB-only
+     *  transaction to be included in a block within confTarget blocks, in the
+     *  same way as estimateSmartFee.
+     */
+    CFeeRate estimateSmartMWEBFee(int confTarget, FeeCalculation *feeCalc, bool conservative) const;
+
     /** Return a specific fee estimate calculation with a given success
      * threshold and time horizon, and optionally return detailed data about
      * calculation
@@ -227,7 +244,8 @@ private:
     {
         unsigned int blockHeight;
         unsigned int bucketIndex;
-        TxStatsInfo() : blockHeight(0), bucketIndex(0) {}
+        bool mweb; // tracked in the MWEB data sets
+        TxStatsInfo() : blockHeight(0), bucketIndex(0), mweb(false) {}
     };
 
     // map of txids to information about that transaction
@@ -237,20 +255,29 @@ private:
     std::unique_ptr<TxConfirmStats> feeStats PT_GUARDED_BY(m_cs_fee_estimator);
     std::unique_ptr<TxConfirmStats> shortStats PT_GUARDED_BY(m_cs_fee_estimator);
     std::unique_ptr<TxConfirmStats> longStats PT_GUARDED_BY(m_cs_fee_estimator);
+    std::unique_ptr<TxConfirmStats> mwebFeeStats PT_GUARDED_BY(m_cs_fee_estimator);
+    std::unique_ptr<TxConfirmStats> mwebShortStats PT_GUARDED_BY(m_cs_fee_estimator);
+    std::unique_ptr<TxConfirmStats> mwebLongStats PT_GUARDED_BY(m_cs_fee_estimator);
 
     unsigned int trackedTxs GUARDED_BY(m_cs_fee_estimator);
     unsigned int untrackedTxs GUARDED_BY(m_cs_fee_estimator);
 
     std::vector<double> buckets GUARDED_BY(m_cs_fee_estimator); // The upper-bound of the range for the bucket (inclusive)
     std::map<double, unsigned int> bucketMap GUARDED_BY(m_cs_fee_estimator); // Map of bucket upper-bound to index into all vectors by bucket
+    std::vector<double> mwebBuckets GUARDED_BY(m_cs_fee_estimator); // As buckets, for the MWEB data sets
+    std::map<double, unsigned int> mwebBucketMap GUARDED_BY(m_cs_fee_estimator);
 
     /** Process a transaction confirmed in a block*/
     bool processBlockTx(unsigned int nBlockHeight, const CTxMemPoolEntry* entry) EXCLUSIVE_LOCKS_REQUIRED(m_cs_fee_estimator);
 
+    /** Return the data set of the given horizon, of MWEB-only transactions if mweb is set */
+    TxConfirmStats& GetStats(FeeEstimateHorizon horizon, bool mweb) const EXCLUSIVE_LOCKS_REQUIRED(m_cs_fee_estimator);
+    /** Helper for estimateSmartFee and estimateSmartMWEBFee */
+    double estimateSmartFeeRate(int confTarget, FeeCalculation *feeCalc, bool conservative, bool mweb) const EXCLUSIVE_LOCKS_REQUIRED(m_cs_fee_estimator);
     /** Helper for estimateSmartFee */
-    double estimateCombinedFee(unsigned int confTarget, double successThreshold, bool checkShorterHorizon, EstimationResult *result) const EXCLUSIVE_LOCKS_REQUIRED(m_cs_fee_estimator);
+    double estimateCombinedFee(unsigned int confTarget, double successThreshold, bool checkShorterHorizon, bool mweb, EstimationResult *result) const EXCLUSIVE_LOCKS_REQUIRED(m_cs_fee_estimator);
     /** Helper for estimateSmartFee */
-    double estimateConservativeFee(unsigned int doubleTarget, EstimationResult *result) const EXCLUSIVE_LOCKS_REQUIRED(m_cs_fee_estimator);
+    double estimateConservativeFee(unsigned int doubleTarget, bool mweb, EstimationResult *result) const EXCLUSIVE_LOCKS_REQUIRED(m_cs_fee_estimator);
     /** Number of blocks of data recorded while fee estimates have been running */
     unsigned int BlockSpan() const EXCLUSIVE_LOCKS_REQUIRED(m_cs_fee_estimator);
     /** Number of blocks of recorded fee estimate data represented in saved data file */
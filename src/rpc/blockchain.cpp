@@ -12,8 +12,10 @@
 #include <coins.h>
 #include <consensus/validation.h>
 #include <core_io.h>
+#include <dbwrapper.h>
 #include <hash.h>
 #include <index/blockfilterindex.h>
+#include <index/mwebindex.h>
 #include <node/coinstats.h>
 #include <node/context.h>
 #include <node/utxo_snapshot.h>
@@ -42,6 +44,8 @@
 #include <univalue.h>
 
 #include <condition_variable>
+#include <list>
+#include <map>
 #include <memory>
 #include <mutex>
 
@@ -179,9 +183,11 @@ UniValue blockToJSON(const CBlock& block, const CBlockIndex* tip, const CBlockIn
 
     UniValue result(UniValue::VOBJ);
     result.pushKV("hash", blockindex->GetBlockHash().GetHex());
-    const CBlockIndex* pnext;
-    int confirmations = ComputeNextBlockAndDepth(tip, blockindex, pnext);
-    result.pushKV("confirmations", confirmations);
+    const CBlockIndex* pnext = nullptr;
+    if (tip) {
+        int confirmations = ComputeNextBlockAndDepth(tip, blockindex, pnext);
+        result.pushKV("confirmations", confirmations);
+    }
     result.pushKV("strippedsize", (int)::GetSerializeSize(block, PROTOCOL_VERSION | SERIALIZE_TRANSACTION_NO_WITNESS | SERIALIZE_NO_MWEB));
     result.pushKV("size", (int)::GetSerializeSize(block, PROTOCOL_VERSION));
     result.pushKV("weight", (int)::GetBlockWeight(block));
@@ -299,6 +305,128 @@ UniValue blockToJSON(const CBlock& block, const CBlockIndex* tip, const CBlockIn
     return result;
 }
 
+namespace {
+/** Recently served block responses, see GetBlockResponse() */
+class BlockResponseCache
+{
+    using Key = std::pair<uint256, BlockResponseFormat>;
+    struct Entry {
+        Key key;
+        std::shared_ptr<const BlockResponse> response;
+        size_t usage;
+    };
+
+    Mutex m_mutex;
+    //! Most recently used at the front
+    std::list<Entry> m_entries GUARDED_BY(m_mutex);
+    std::map<Key, std::list<Entry>::iterator> m_index GUARDED_BY(m_mutex);
+    size_t m_usage GUARDED_BY(m_mutex){0};
+    size_t m_max_usage GUARDED_BY(m_mutex){DEFAULT_RPC_BLOCK_CACHE_SIZE << 20};
+
+    void Erase(std::list<Entry>::iterator it) EXCLUSIVE_LOCKS_REQUIRED(m_mutex)
+    {
+        m_usage -= it->usage;
+        m_index.erase(it->key);
+        m_entries.erase(it);
+    }
+
+    void Trim() EXCLUSIVE_LOCKS_REQUIRED(m_mutex)
+    {
+        while (m_usage > m_max_usage) {
+            Erase(std::prev(m_entries.end()));
+        }
+    }
+
+public:
+    std::shared_ptr<const BlockResponse> Get(const Key& key)
+    {
+        LOCK(m_mutex);
+        auto it = m_index.find(key);
+        if (it == m_index.end()) return nullptr;
+        m_entries.splice(m_entries.begin(), m_entries, it->second);
+        return it->second->response;
+    }
+
+    void Put(const Key& key, std::shared_ptr<const BlockResponse> response)
+    {
+        const size_t usage = response->data.size();
+
+        LOCK(m_mutex);
+        if (usage > m_max_usage) return;
+        auto it = m_index.find(key);
+        if (it != m_index.end()) Erase(it->second);
+        m_entries.push_front(Entry{key, std::move(response), usage});
+        m_index.emplace(key, m_entries.begin());
+        m_usage += usage;
+        Trim();
+    }
+
+    void SetMaxUsage(size_t max_usage)
+    {
+        LOCK(m_mutex);
+        m_max_usage = max_usage;
+        Trim();
+    }
+};
+
+BlockResponseCache g_block_response_cache;
+} // namespace
+
+void SetBlockResponseCacheSize(size_t max_bytes)
+{
+    g_block_response_cache.SetMaxUsage(max_bytes);
+}
+
+std::shared_ptr<const BlockResponse> GetBlockResponse(const CBlockIndex* blockindex, BlockResponseFormat format)
+{
+    AssertLockNotHeld(cs_main);
+
+    const auto key = std::make_pair(blockindex->GetBlockHash(), format);
+    if (auto cached = g_block_response_cache.Get(key)) {
+        return cached;
+    }
+
+    CBlock block;
+    if (!ReadBlockFromDisk(block, blockindex, Params().GetConsensus())) {
+        return nullptr;
+    }
+
+    auto response = std::make_shared<BlockResponse>();
+    if (format == BlockResponseFormat::JSON || format == BlockResponseFormat::JSON_TX_DETAILS) {
+        response->data = blockToJSON(block, /* tip */ nullptr, blockindex, format == BlockResponseFormat::JSON_TX_DETAILS).write();
+    } else {
+        CDataStream ssBlock(SER_NETWORK, PROTOCOL_VERSION | RPCSerializationFlags());
+        ssBlock << block;
+        response->data = format == BlockResponseFormat::HEX ? HexStr(ssBlock) : ssBlock.str();
+    }
+
+    g_block_response_cache.Put(key, response);
+    return response;
+}
+
+std::string BlockResponseJSON(const BlockResponse& response, const CBlockIndex* tip, const CBlockIndex* blockindex)
+{
+    AssertLockNotHeld(cs_main);
+
+    const CBlockIndex* pnext;
+    const int confirmations = ComputeNextBlockAndDepth(tip, blockindex, pnext);
+
+    // Put the fields back where blockToJSON() writes them: confirmations right
+    // after the leading "hash" field and nextblockhash last.
+    const size_t hash_end = response.data.find(',');
+    assert(hash_end != std::string::npos && response.data.back() == '}');
+    std::string json;
+    json.reserve(response.data.size() + 128);
+    json.append(response.data, 0, hash_end);
+    json += strprintf(",\"confirmations\":%d", confirmations);
+    json.append(response.data, hash_end, response.data.size() - hash_end - 1);
+    if (pnext) {
+        json += strprintf(",\"nextblockhash\":\"%s\"", pnext->GetBlockHash().GetHex());
+    }
+    json += '}';
+    return json;
+}
+
 static RPCHelpMan getblockcount()
 {
     return RPCHelpMan{"getblockcount",
@@ -551,55 +679,40 @@ static std::vector<RPCResult> MempoolEntryDescription() { return {
     RPCResult{RPCResult::Type::BOOL, "unbroadcast", "Whether this transaction is currently unbroadcast (initial broadcast not yet acknowledged by any peers)"},
 };}
 
-static void entryToJSON(const CTxMemPool& pool, UniValue& info, const CTxMemPoolEntry& e) EXCLUSIVE_LOCKS_REQUIRED(pool.cs)
+static void entryToJSON(UniValue& info, const TxMempoolEntryInfo& e)
 {
-    AssertLockHeld(pool.cs);
-
     UniValue fees(UniValue::VOBJ);
-    fees.pushKV("base", ValueFromAmount(e.GetFee()));
-    fees.pushKV("modified", ValueFromAmount(e.GetModifiedFee()));
-    fees.pushKV("ancestor", ValueFromAmount(e.GetModFeesWithAncestors()));
-    fees.pushKV("descendant", ValueFromAmount(e.GetModFeesWithDescendants()));
+    fees.pushKV("base", ValueFromAmount(e.fee));
+    fees.pushKV("modified", ValueFromAmount(e.modified_fee));
+    fees.pushKV("ancestor", ValueFromAmount(e.mod_fees_with_ancestors));
+    fees.pushKV("descendant", ValueFromAmount(e.mod_fees_with_descendants));
     info.pushKV("fees", fees);
 
-    info.pushKV("vsize", (int)e.GetTxSize());
-    info.pushKV("weight", (int)e.GetTxWeight());
-    info.pushKV("mwebweight", (int)e.GetMWEBWeight());
-    info.pushKV("fee", ValueFromAmount(e.GetFee()));
-    info.pushKV("modifiedfee", ValueFromAmount(e.GetModifiedFee()));
-    info.pushKV("time", count_seconds(e.GetTime()));
-    info.pushKV("height", (int)e.GetHeight());
-    info.pushKV("descendantcount", e.GetCountWithDescendants());
-    info.pushKV("descendantsize", e.GetSizeWithDescendants());
-    info.pushKV("descendantmwebweight", e.GetMWEBWeightWithDescendants());
-    info.pushKV("descendantfees", e.GetModFeesWithDescendants());
-    info.pushKV("ancestorcount", e.GetCountWithAncestors());
-    info.pushKV("ancestorsize", e.GetSizeWithAncestors());
-    info.pushKV("ancestormwebweight", e.GetMWEBWeightWithAncestors());
-    info.pushKV("ancestorfees", e.GetModFeesWithAncestors());
-    info.pushKV("wtxid", pool.vTxHashes[e.vTxHashesIdx].first.ToString());
-    const CTransaction& tx = e.GetTx();
-    std::set<std::string> setDepends;
-    for (const CTxIn& txin : tx.vin)
-    {
-        if (pool.exists(txin.prevout.hash))
-            setDepends.insert(txin.prevout.hash.ToString());
-    }
-
-    uint256 created_tx_hash;
-    for (const mw::Hash& spent_id : tx.mweb_tx.GetSpentIDs()) {
-        if (pool.GetCreatedTx(spent_id, created_tx_hash)) {
-            setDepends.insert(created_tx_hash.ToString());
-        }
-    }
+    info.pushKV("vsize", (int)e.vsize);
+    info.pushKV("weight", (int)e.weight);
+    info.pushKV("mwebweight", (int)e.mweb_weight);
+    info.pushKV("fee", ValueFromAmount(e.fee));
+    info.pushKV("modifiedfee", ValueFromAmount(e.modified_fee));
+    info.pushKV("time", count_seconds(e.time));
+    info.pushKV("height", (int)e.height);
+    info.pushKV("descendantcount", e.count_with_descendants);
+    info.pushKV("descendantsize", e.size_with_descendants);
+    info.pushKV("descendantmwebweight", e.mweb_weight_with_descendants);
+    info.pushKV("descendantfees", e.mod_fees_with_descendants);
+    info.pushKV("ancestorcount", e.count_with_ancestors);
+    info.pushKV("ancestorsize", e.size_with_ancestors);
+    info.pushKV("ancestormwebweight", e.mweb_weight_with_ancestors);
+    info.pushKV("ancestorfees", e.mod_fees_with_ancestors);
+    info.pushKV("wtxid", e.tx->GetWitnessHash().ToString());
+    const CTransaction& tx = *e.tx;
 
     if (tx.HasMWEBTx()) {
         UniValue mweb_info(UniValue::VOBJ);
 
         UniValue mweb_weight(UniValue::VOBJ);
-        mweb_weight.pushKV("base", (int)e.GetMWEBWeight());
-        mweb_weight.pushKV("ancestor", (int)e.GetMWEBWeightWithAncestors());
-        mweb_weight.pushKV("descendant", (int)e.GetMWEBWeightWithDescendants());
+        mweb_weight.pushKV("base", (int)e.mweb_weight);
+        mweb_weight.pushKV("ancestor", (int)e.mweb_weight_with_ancestors);
+        mweb_weight.pushKV("descendant", (int)e.mweb_weight_with_descendants);
         mweb_info.pushKV("weight", mweb_weight);
 
         mweb_info.pushKV("fee", ValueFromAmount(tx.mweb_tx.GetFee()));
@@ -646,6 +759,11 @@ static void entryToJSON(const CTxMemPool& pool, UniValue& info, const CTxMemPool
         info.pushKV("mweb", mweb_info);
     }
 
+    std::set<std::string> setDepends;
+    for (const uint256& dep : e.depends) {
+        setDepends.insert(dep.ToString());
+    }
+
     UniValue depends(UniValue::VARR);
     for (const std::string& dep : setDepends)
     {
@@ -655,25 +773,14 @@ static void entryToJSON(const CTxMemPool& pool, UniValue& info, const CTxMemPool
     info.pushKV("depends", depends);
 
     UniValue spent(UniValue::VARR);
-    const CTxMemPool::txiter& it = pool.mapTx.find(tx.GetHash());
-    const CTxMemPoolEntry::Children& children = it->GetMemPoolChildrenConst();
-    for (const CTxMemPoolEntry& child : children) {
-        spent.push_back(child.GetTx().GetHash().ToString());
+    for (const uint256& child : e.spent_by) {
+        spent.push_back(child.ToString());
     }
 
     info.pushKV("spentby", spent);
 
-    // Add opt-in RBF status
-    bool rbfStatus = false;
-    RBFTransactionState rbfState = IsRBFOptIn(tx, pool);
-    if (rbfState == RBFTransactionState::UNKNOWN) {
-        throw JSONRPCError(RPC_MISC_ERROR, "Transaction is not in mempool");
-    } else if (rbfState == RBFTransactionState::REPLACEABLE_BIP125) {
-        rbfStatus = true;
-    }
-
-    info.pushKV("bip125-replaceable", rbfStatus);
-    info.pushKV("unbroadcast", pool.IsUnbroadcastTx(tx.GetHash()));
+    info.pushKV("bip125-replaceable", e.bip125_replaceable);
+    info.pushKV("unbroadcast", e.unbroadcast);
 }
 
 UniValue MempoolToJSON(const CTxMemPool& pool, bool verbose, bool include_mempool_sequence)
@@ -682,16 +789,16 @@ UniValue MempoolToJSON(const CTxMemPool& pool, bool verbose, bool include_mempoo
         if (include_mempool_sequence) {
             throw JSONRPCError(RPC_INVALID_PARAMETER, "Verbose results cannot contain mempool sequence values.");
         }
-        LOCK(pool.cs);
+        // The snapshot is formatted without holding pool.cs, so mempool acceptance isn't blocked
+        const std::shared_ptr<const TxMempoolSnapshot> snapshot = pool.GetSnapshot();
         UniValue o(UniValue::VOBJ);
-        for (const CTxMemPoolEntry& e : pool.mapTx) {
-            const uint256& hash = e.GetTx().GetHash();
+        for (const TxMempoolEntryInfo& e : snapshot->entries) {
             UniValue info(UniValue::VOBJ);
-            entryToJSON(pool, info, e);
+            entryToJSON(info, e);
             // Mempool has unique entries so there is no advantage in using
             // UniValue::pushKV, which checks if the key already exists in O(N).
             // UniValue::__pushKV is used instead which currently is O(1).
-            o.__pushKV(hash.ToString(), info);
+            o.__pushKV(e.tx->GetHash().ToString(), info);
         }
         return o;
     } else {
@@ -822,7 +929,7 @@ static RPCHelpMan getmempoolancestors()
             const CTxMemPoolEntry &e = *ancestorIt;
             const uint256& _hash = e.GetTx().GetHash();
             UniValue info(UniValue::VOBJ);
-            entryToJSON(mempool, info, e);
+            entryToJSON(info, mempool.GetEntryInfo(e));
             o.pushKV(_hash.ToString(), info);
         }
         return o;
@@ -887,7 +994,7 @@ static RPCHelpMan getmempooldescendants()
             const CTxMemPoolEntry &e = *descendantIt;
             const uint256& _hash = e.GetTx().GetHash();
             UniValue info(UniValue::VOBJ);
-            entryToJSON(mempool, info, e);
+            entryToJSON(info, mempool.GetEntryInfo(e));
             o.pushKV(_hash.ToString(), info);
         }
         return o;
@@ -923,7 +1030,7 @@ static RPCHelpMan getmempoolentry()
 
     const CTxMemPoolEntry &e = *it;
     UniValue info(UniValue::VOBJ);
-    entryToJSON(mempool, info, e);
+    entryToJSON(info, mempool.GetEntryInfo(e));
     return info;
 },
     };
@@ -1122,7 +1229,6 @@ static RPCHelpMan getblock()
             verbosity = request.params[1].get_bool() ? 1 : 0;
     }
 
-    CBlock block;
     const CBlockIndex* pblockindex;
     const CBlockIndex* tip;
     {
@@ -1134,18 +1240,25 @@ static RPCHelpMan getblock()
             throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Block not found");
         }
 
-        block = GetBlockChecked(pblockindex);
+        if (IsBlockPruned(pblockindex)) {
+            throw JSONRPCError(RPC_MISC_ERROR, "Block not available (pruned data)");
+        }
     }
 
-    if (verbosity <= 0)
-    {
-        CDataStream ssBlock(SER_NETWORK, PROTOCOL_VERSION | RPCSerializationFlags());
-        ssBlock << block;
-        std::string strHex = HexStr(ssBlock);
-        return strHex;
+    const BlockResponseFormat format = verbosity <= 0 ? BlockResponseFormat::HEX :
+                                       verbosity == 1 ? BlockResponseFormat::JSON : BlockResponseFormat::JSON_TX_DETAILS;
+    const std::shared_ptr<const BlockResponse> response = GetBlockResponse(pblockindex, format);
+    if (!response) {
+        // Block not found on disk. This could be because we have the block
+        // header in our index but not yet have the block or did not accept the
+        // block.
+        throw JSONRPCError(RPC_MISC_ERROR, "Block not found on disk");
     }
 
-    return blockToJSON(block, tip, pblockindex, verbosity >= 2);
+    if (format == BlockResponseFormat::HEX) {
+        return response->data;
+    }
+    return ReturnJSON(request, BlockResponseJSON(*response, tip, pblockindex));
 },
     };
 }
@@ -1214,6 +1327,7 @@ static RPCHelpMan gettxoutsetinfo()
                 "Note this call may take some time.\n",
                 {
                     {"hash_type", RPCArg::Type::STR, /* default */ "hash_serialized_2", "Which UTXO set hash should be calculated. Options: 'hash_serialized_2' (the legacy algorithm), 'none'."},
+                    {"verify_mweb", RPCArg::Type::BOOL, /* default */ "false", "Audit the MWEB UTXO commitments against the kernels of every MWEB block. Not available in prune mode."},
                 },
                 RPCResult{
                     RPCResult::Type::OBJ, "", "",
@@ -1226,23 +1340,32 @@ static RPCHelpMan gettxoutsetinfo()
                         {RPCResult::Type::STR_HEX, "hash_serialized_2", "The serialized hash (only present if 'hash_serialized_2' hash_type is chosen)"},
                         {RPCResult::Type::NUM, "disk_size", "The estimated size of the chainstate on disk"},
                         {RPCResult::Type::STR_AMOUNT, "total_amount", "The total amount"},
+                        {RPCResult::Type::NUM, "mweb_utxos", "The number of unspent MWEB outputs"},
+                        {RPCResult::Type::NUM, "mweb_disk_size", "The size of the MWEB UTXO entries on disk"},
+                        {RPCResult::Type::STR_AMOUNT, "mweb_amount", "The total amount pegged into MWEB"},
+                        {RPCResult::Type::BOOL, "mweb_sums_valid", "Whether the MWEB UTXO commitments match the kernel sums and mweb_amount (only present if verify_mweb is true)"},
                     }},
                 RPCExamples{
                     HelpExampleCli("gettxoutsetinfo", "")
+            + HelpExampleCli("gettxoutsetinfo", "none true")
             + HelpExampleRpc("gettxoutsetinfo", "")
                 },
         [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
 {
     UniValue ret(UniValue::VOBJ);
 
+    const CoinStatsHashType hash_type = ParseHashType(request.params[0], CoinStatsHashType::HASH_SERIALIZED);
+    const bool verify_mweb = request.params[1].isNull() ? false : request.params[1].get_bool();
+    if (verify_mweb && fPruneMode) {
+        throw JSONRPCError(RPC_MISC_ERROR, "verify_mweb is not available in prune mode, because it reads every MWEB block");
+    }
+
     CCoinsStats stats;
     ::ChainstateActive().ForceFlushStateToDisk();
 
-    const CoinStatsHashType hash_type = ParseHashType(request.params[0], CoinStatsHashType::HASH_SERIALIZED);
-
     CCoinsView* coins_view = WITH_LOCK(cs_main, return &ChainstateActive().CoinsDB());
     NodeContext& node = EnsureNodeContext(request.context);
-    if (GetUTXOStats(coins_view, stats, hash_type, node.rpc_interruption_point)) {
+    if (GetUTXOStats(coins_view, stats, hash_type, node.rpc_interruption_point, verify_mweb)) {
         ret.pushKV("height", (int64_t)stats.nHeight);
         ret.pushKV("bestblock", stats.hashBlock.GetHex());
         ret.pushKV("transactions", (int64_t)stats.nTransactions);
@@ -1253,6 +1376,12 @@ static RPCHelpMan gettxoutsetinfo()
         }
         ret.pushKV("disk_size", stats.nDiskSize);
         ret.pushKV("total_amount", ValueFromAmount(stats.nTotalAmount));
+        ret.pushKV("mweb_utxos", (int64_t)stats.mweb_utxo_count);
+        ret.pushKV("mweb_disk_size", stats.mweb_disk_size);
+        ret.pushKV("mweb_amount", ValueFromAmount(stats.mweb_amount));
+        if (stats.mweb_sums_checked) {
+            ret.pushKV("mweb_sums_valid", stats.mweb_sums_valid);
+        }
     } else {
         throw JSONRPCError(RPC_INTERNAL_ERROR, "Unable to read UTXO set");
     }
@@ -2536,6 +2665,153 @@ static RPCHelpMan getblockfilter()
     };
 }
 
+static RPCHelpMan getmweblocation()
+{
+    const std::vector<RPCResult> pos_result{
+        {RPCResult::Type::STR_HEX, "blockhash", "the hash of the block"},
+        {RPCResult::Type::NUM, "height", "the height of the block"},
+        {RPCResult::Type::NUM, "index", "the position within the block's MWEB kernels, outputs or inputs"},
+    };
+    return RPCHelpMan{"getmweblocation",
+                "\nLook up the blocks an MWEB kernel or output ID was included and spent in.\n"
+                "Requires -mwebindex.\n",
+                {
+                    {"id", RPCArg::Type::STR_HEX, RPCArg::Optional::NO, "The MWEB kernel ID or output ID"},
+                },
+                RPCResult{
+                    RPCResult::Type::OBJ, "", "",
+                    {
+                        {RPCResult::Type::OBJ, "kernel", /* optional */ true, "The block including the kernel with this ID", pos_result},
+                        {RPCResult::Type::OBJ, "output", /* optional */ true, "The block creating the output with this ID", pos_result},
+                        {RPCResult::Type::OBJ, "spent", /* optional */ true, "The block spending the output with this ID", pos_result},
+                    }},
+                RPCExamples{
+                    HelpExampleCli("getmweblocation", "\"9e1fbe4dc7a6d1b0fa5ceeff5bb03c4b1b2e52b5e1cc0f2c5f1ea1a6cde4e2d1\"") +
+                    HelpExampleRpc("getmweblocation", "\"9e1fbe4dc7a6d1b0fa5ceeff5bb03c4b1b2e52b5e1cc0f2c5f1ea1a6cde4e2d1\"")
+                },
+        [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
+{
+    std::vector<unsigned char> id_bytes = ParseHexV(request.params[0], "id");
+    if (id_bytes.size() != mw::Hash::size()) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, strprintf("id must be of length %d (not %d)", mw::Hash::size() * 2, id_bytes.size() * 2));
+    }
+    const mw::Hash id(std::move(id_bytes));
+
+    if (!g_mwebindex) {
+        throw JSONRPCError(RPC_MISC_ERROR, "Requires -mwebindex");
+    }
+    const bool index_ready = g_mwebindex->BlockUntilSyncedToCurrentChain();
+
+    MWEBIndexPos kernel_pos, output_pos, spent_pos;
+    const bool found_kernel = g_mwebindex->FindKernel(id, kernel_pos);
+    const bool found_output = g_mwebindex->FindOutput(id, output_pos);
+    const bool found_spent = g_mwebindex->FindSpend(id, spent_pos);
+    if (!found_kernel && !found_output && !found_spent) {
+        if (!index_ready) {
+            throw JSONRPCError(RPC_MISC_ERROR, "No such MWEB kernel or output. MWEB index is still syncing.");
+        }
+        throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No such MWEB kernel or output");
+    }
+
+    UniValue ret(UniValue::VOBJ);
+    LOCK(cs_main);
+    const auto push_pos = [&](const std::string& key, const MWEBIndexPos& pos) {
+        const CBlockIndex* pindex = ::ChainActive()[pos.nHeight];
+        if (!pindex) return;
+        UniValue entry(UniValue::VOBJ);
+        entry.pushKV("blockhash", pindex->GetBlockHash().GetHex());
+        entry.pushKV("height", pos.nHeight);
+        entry.pushKV("index", (uint64_t)pos.nIndex);
+        ret.pushKV(key, entry);
+    };
+    if (found_kernel) push_pos("kernel", kernel_pos);
+    if (found_output) push_pos("output", output_pos);
+    if (found_spent) push_pos("spent", spent_pos);
+    return ret;
+},
+    };
+}
+
+static RPCHelpMan getdbstats()
+{
+    return RPCHelpMan{"getdbstats",
+                "\nReturns statistics of the open databases, to tune them with -dboption.\n",
+                {
+                    {"db_name", RPCArg::Type::STR, RPCArg::Optional::OMITTED_NAMED_ARG, "Only return the statistics of the database with this name."},
+                },
+                RPCResult{
+                    RPCResult::Type::OBJ_DYN, "", "",
+                    {
+                        {RPCResult::Type::OBJ, "name", "The name of the database",
+                        {
+                            {RPCResult::Type::STR, "engine", "The storage engine of the database"},
+                            {RPCResult::Type::NUM, "reads", "Number of point reads of keys since the database was opened"},
+                            {RPCResult::Type::NUM, "block_cache_hits", "Number of data blocks found in the block cache, by point reads and iterators"},
+                            {RPCResult::Type::NUM, "block_cache_misses", "Number of data blocks read from disk, by point reads and iterators"},
+                            {RPCResult::Type::NUM, "block_cache_hit_rate", "Share of the data blocks that were found in the block cache"},
+                            {RPCResult::Type::NUM, "read_amplification", "Average number of data blocks looked up per point read"},
+                            {RPCResult::Type::NUM, "compactions", "Number of compactions that merged files into the next level"},
+                            {RPCResult::Type::NUM, "memtable_flushes", "Number of write buffers written to level 0"},
+                            {RPCResult::Type::NUM, "memory_usage", "Approximate memory usage of the caches and write buffers in bytes"},
+                            {RPCResult::Type::ARR, "levels", "The levels that have files or were compacted into",
+                            {
+                                {RPCResult::Type::OBJ, "", "",
+                                {
+                                    {RPCResult::Type::NUM, "level", "The level"},
+                                    {RPCResult::Type::NUM, "files", "Number of table files"},
+                                    {RPCResult::Type::NUM, "size_mib", "Size of the table files in MiB"},
+                                    {RPCResult::Type::NUM, "compaction_secs", "Time spent compacting into this level in seconds"},
+                                    {RPCResult::Type::NUM, "compaction_read_mib", "Data read by those compactions in MiB"},
+                                    {RPCResult::Type::NUM, "compaction_write_mib", "Data written by those compactions in MiB"},
+                                }},
+                            }},
+                        }},
+                    }},
+                RPCExamples{
+                    HelpExampleCli("getdbstats", "")
+                  + HelpExampleRpc("getdbstats", "")
+                  + HelpExampleCli("getdbstats", "chainstate")
+                  + HelpExampleRpc("getdbstats", "chainstate")
+                },
+        [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
+{
+    const std::string db_name = request.params[0].isNull() ? "" : request.params[0].get_str();
+
+    UniValue result(UniValue::VOBJ);
+    ForEachDBWrapper([&](const CDBWrapper& db) {
+        if (!db_name.empty() && db.GetName() != db_name) return;
+
+        const DBStats stats = db.GetStats();
+        const uint64_t block_lookups = stats.block_cache_hits + stats.block_cache_misses;
+        UniValue entry(UniValue::VOBJ);
+        entry.pushKV("engine", stats.engine);
+        entry.pushKV("reads", stats.reads);
+        entry.pushKV("block_cache_hits", stats.block_cache_hits);
+        entry.pushKV("block_cache_misses", stats.block_cache_misses);
+        entry.pushKV("block_cache_hit_rate", block_lookups ? double(stats.block_cache_hits) / block_lookups : 0.0);
+        entry.pushKV("read_amplification", stats.reads ? double(block_lookups) / stats.reads : 0.0);
+        entry.pushKV("compactions", stats.compactions);
+        entry.pushKV("memtable_flushes", stats.memtable_flushes);
+        entry.pushKV("memory_usage", (uint64_t)stats.memory_usage);
+        UniValue levels(UniValue::VARR);
+        for (const DBStats::Level& level : stats.levels) {
+            UniValue level_entry(UniValue::VOBJ);
+            level_entry.pushKV("level", level.level);
+            level_entry.pushKV("files", level.files);
+            level_entry.pushKV("size_mib", level.size_mib);
+            level_entry.pushKV("compaction_secs", level.compaction_secs);
+            level_entry.pushKV("compaction_read_mib", level.compaction_read_mib);
+            level_entry.pushKV("compaction_write_mib", level.compaction_write_mib);
+            levels.push_back(level_entry);
+        }
+        entry.pushKV("levels", levels);
+        result.pushKV(db.GetName(), entry);
+    });
+    return result;
+},
+    };
+}
+
 /**
  * Serialize the UTXO set to a file for loading elsewhere.
  *
@@ -2666,7 +2942,7 @@ static const CRPCCommand commands[] =
     { "blockchain",         "getmempoolinfo",         &getmempoolinfo,         {} },
     { "blockchain",         "getrawmempool",          &getrawmempool,          {"verbose", "mempool_sequence"} },
     { "blockchain",         "gettxout",               &gettxout,               {"txid","n","include_mempool"} },
-    { "blockchain",         "gettxoutsetinfo",        &gettxoutsetinfo,        {"hash_type"} },
+    { "blockchain",         "gettxoutsetinfo",        &gettxoutsetinfo,        {"hash_type", "verify_mweb"} },
     { "blockchain",         "pruneblockchain",        &pruneblockchain,        {"height"} },
     { "blockchain",         "savemempool",            &savemempool,            {} },
     { "blockchain",         "verifychain",            &verifychain,            {"checklevel","nblocks"} },
@@ -2674,6 +2950,8 @@ static const CRPCCommand commands[] =
     { "blockchain",         "preciousblock",          &preciousblock,          {"blockhash"} },
     { "blockchain",         "scantxoutset",           &scantxoutset,           {"action", "scanobjects"} },
     { "blockchain",         "getblockfilter",         &getblockfilter,         {"blockhash", "filtertype"} },
+    { "blockchain",         "getmweblocation",        &getmweblocation,        {"id"} },
+    { "blockchain",         "getdbstats",             &getdbstats,             {"db_name"} },
 
     /* Not shown in help */
     { "hidden",             "invalidateblock",        &invalidateblock,        {"blockhash"} },
@@ -8,7 +8,11 @@
 #include <amount.h>
 #include <sync.h>
 
+#include <univalue.h>
+
+#include <memory>
 #include <stdint.h>
+#include <string>
 #include <vector>
 
 extern RecursiveMutex cs_main;
@@ -26,6 +30,9 @@ class Ref;
 
 static constexpr int NUM_GETBLOCKSTATS_PERCENTILES = 5;
 
+/** Default for -rpcblockcache, in MiB */
+static const unsigned int DEFAULT_RPC_BLOCK_CACHE_SIZE = 64;
+
 /**
  * Get the difficulty of the net wrt to the given block index.
  *
@@ -37,9 +44,40 @@ double GetDifficulty(const CBlockIndex* blockindex);
 /** Callback for when block tip changed. */
 void RPCNotifyBlockChange(const CBlockIndex*);
 
-/** Block description to JSON */
+/** Block description to JSON. Without a tip, confirmations and nextblockhash are left out. */
 UniValue blockToJSON(const CBlock& block, const CBlockIndex* tip, const CBlockIndex* blockindex, bool txDetails = false) LOCKS_EXCLUDED(cs_main);
 
+/** The forms in which getblock and the REST block endpoints serve a block */
+enum class BlockResponseFormat {
+    BINARY,
+    HEX,
+    JSON,
+    JSON_TX_DETAILS,
+};
+
+struct BlockResponse {
+    /**
+     * The serialized block or its hex encoding. For the JSON formats, the JSON
+     * text without the fields that depend on the active chain, which
+     * BlockResponseJSON() adds.
+     */
+    std::string data;
+};
+
+/** Sets the memory limit of the block response cache. 0 disables it. */
+void SetBlockResponseCacheSize(size_t max_bytes);
+
+/**
+ * Reads and formats a block for getblock and REST, keeping recently served
+ * responses in an LRU cache keyed by block hash and format. Nothing cached
+ * depends on the tip, so entries stay valid across new blocks and reorgs.
+ * Returns nullptr if the block can't be read from disk.
+ */
+std::shared_ptr<const BlockResponse> GetBlockResponse(const CBlockIndex* blockindex, BlockResponseFormat format) LOCKS_EXCLUDED(cs_main);
+
+/** The JSON text of a block from a JSON format response, with the confirmations and next block at the given tip. */
+std::string BlockResponseJSON(const BlockResponse& response, const CBlockIndex* tip, const CBlockIndex* blockindex) LOCKS_EXCLUDED(cs_main);
+
 /** Mempool information to JSON */
 UniValue MempoolInfoToJSON(const CTxMemPool& pool);
 
@@ -735,7 +735,17 @@ static RPCHelpMan getblocktemplate()
     static CBlockIndex* pindexPrev;
     static int64_t nStart;
     static std::unique_ptr<CBlockTemplate> pblocktemplate;
-    if (pindexPrev != ::ChainActive().Tip() ||
+    if (node.template_cache) {
+        // The template is kept up to date in the background; take a copy, as
+        // the header and version are adjusted below.
+        BlockTemplateCache::Entry cached = node.template_cache->Get();
+        if (!cached.block_template)
+            throw JSONRPCError(RPC_OUT_OF_MEMORY, "Out of memory");
+        pblocktemplate = MakeUnique<CBlockTemplate>(*cached.block_template);
+        nTransactionsUpdatedLast = cached.transactions_updated;
+        nStart = cached.time;
+        pindexPrev = cached.pindexPrev;
+    } else if (pindexPrev != ::ChainActive().Tip() ||
         (mempool.GetTransactionsUpdated() != nTransactionsUpdatedLast && GetTime() - nStart > 5))
     {
         // Clear pindexPrev so future calls make a new block, despite any failures from here on
@@ -1054,11 +1064,14 @@ static RPCHelpMan estimatesmartfee()
             "       \"UNSET\"\n"
             "       \"ECONOMICAL\"\n"
             "       \"CONSERVATIVE\""},
+                    {"mweb", RPCArg::Type::BOOL, /* default */ "false", "Also estimate the fee per 1000 units of MWEB weight needed\n"
+            "                   by MWEB-only transactions, which are tracked separately."},
                 },
                 RPCResult{
                     RPCResult::Type::OBJ, "", "",
                     {
                         {RPCResult::Type::NUM, "feerate", /* optional */ true, "estimate fee rate in " + CURRENCY_UNIT + "/kB (only present if no errors were encountered)"},
+                        {RPCResult::Type::NUM, "mweb_feerate", /* optional */ true, "estimate fee rate of MWEB-only transactions in " + CURRENCY_UNIT + " per 1000 units of MWEB weight (only present if mweb is set and an estimate was found)"},
                         {RPCResult::Type::ARR, "errors", /* optional */ true, "Errors encountered during processing (if there are any)",
                             {
                                 {RPCResult::Type::STR, "", "error"},
@@ -1071,10 +1084,11 @@ static RPCHelpMan estimatesmartfee()
                     }},
                 RPCExamples{
                     HelpExampleCli("estimatesmartfee", "6")
+            + HelpExampleCli("estimatesmartfee", "6 \"ECONOMICAL\" true")
                 },
         [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
 {
-    RPCTypeCheck(request.params, {UniValue::VNUM, UniValue::VSTR});
+    RPCTypeCheck(request.params, {UniValue::VNUM, UniValue::VSTR, UniValue::VBOOL});
     RPCTypeCheckArgument(request.params[0], UniValue::VNUM);
     unsigned int max_target = ::feeEstimator.HighestTargetTracked(FeeEstimateHorizon::LONG_HALFLIFE);
     unsigned int conf_target = ParseConfirmTarget(request.params[0], max_target);
@@ -1095,6 +1109,16 @@ static RPCHelpMan estimatesmartfee()
         result.pushKV("feerate", ValueFromAmount(feeRate.GetFeePerK()));
     } else {
         errors.push_back("Insufficient data or no feerate found");
+    }
+    if (!request.params[2].isNull() && request.params[2].get_bool()) {
+        CFeeRate mwebFeeRate = ::feeEstimator.estimateSmartMWEBFee(conf_target, nullptr, conservative);
+        if (mwebFeeRate != CFeeRate(0)) {
+            result.pushKV("mweb_feerate", ValueFromAmount(mwebFeeRate.GetFeePerK()));
+        } else {
+            errors.push_back("Insufficient data or no MWEB feerate found");
+        }
+    }
+    if (!errors.empty()) {
         result.pushKV("errors", errors);
     }
     result.pushKV("blocks", feeCalc.returnedTarget);
@@ -1239,7 +1263,7 @@ static const CRPCCommand commands[] =
     { "generating",         "generatetodescriptor",   &generatetodescriptor,   {"num_blocks","descriptor","maxtries"} },
     { "generating",         "generateblock",          &generateblock,          {"output","transactions"} },
 
-    { "util",               "estimatesmartfee",       &estimatesmartfee,       {"conf_target", "estimate_mode"} },
+    { "util",               "estimatesmartfee",       &estimatesmartfee,       {"conf_target", "estimate_mode", "mweb"} },
 
     { "hidden",             "estimaterawfee",         &estimaterawfee,         {"conf_target", "threshold"} },
     { "hidden",             "generate",               &generate,               {} },
@@ -48,6 +48,12 @@ std::string JSONRPCReply(const UniValue& result, const UniValue& error, const Un
     return reply.write() + "\n";
 }
 
+std::string JSONRPCRawReply(const std::string& result, const UniValue& id)
+{
+    // The members in the order JSONRPCReplyObj() adds them
+    return "{\"result\":" + result + ",\"error\":null,\"id\":" + id.write() + "}\n";
+}
+
 UniValue JSONRPCError(int code, const std::string& message)
 {
     UniValue error(UniValue::VOBJ);
@@ -17,6 +17,8 @@ class Ref;
 UniValue JSONRPCRequestObj(const std::string& strMethod, const UniValue& params, const UniValue& id);
 UniValue JSONRPCReplyObj(const UniValue& result, const UniValue& error, const UniValue& id);
 std::string JSONRPCReply(const UniValue& result, const UniValue& error, const UniValue& id);
+//! A reply like JSONRPCReply() without an error, whose result is already serialized
+std::string JSONRPCRawReply(const std::string& result, const UniValue& id);
 UniValue JSONRPCError(int code, const std::string& message);
 
 /** Generate a new RPC authentication cookie and write it to disk */
@@ -38,6 +40,9 @@ public:
     std::string URI;
     std::string authUser;
     std::string peerAddr;
+    //! Set by callers that write a result a method stores here into the reply as is,
+    //! see ReturnJSON(). Only the HTTP server does, so methods must not rely on it.
+    std::string* raw_result{nullptr};
     const util::Ref& context;
 
     JSONRPCRequest(const util::Ref& context) : id(NullUniValue), params(NullUniValue), fHelp(false), context(context) {}
@@ -47,7 +52,7 @@ public:
     //! added or removed above.
     JSONRPCRequest(const JSONRPCRequest& other, const util::Ref& context)
         : id(other.id), strMethod(other.strMethod), params(other.params), fHelp(other.fHelp), URI(other.URI),
-          authUser(other.authUser), peerAddr(other.peerAddr), context(context)
+          authUser(other.authUser), peerAddr(other.peerAddr), raw_result(other.raw_result), context(context)
     {
     }
 
@@ -5,6 +5,7 @@
 
 #include <rpc/server.h>
 
+#include <httpserver.h>
 #include <rpc/util.h>
 #include <shutdown.h>
 #include <sync.h>
@@ -214,6 +215,31 @@ static RPCHelpMan getrpcinfo()
                             }},
                         }},
                         {RPCResult::Type::STR, "logpath", "The complete file path to the debug log"},
+                        {RPCResult::Type::ARR, "latency_buckets", "Upper bounds in microseconds of the latency histogram buckets. The last bucket counts the rest",
+                        {
+                            {RPCResult::Type::NUM, "", "Upper bound in microseconds"},
+                        }},
+                        {RPCResult::Type::ARR, "work_queues", "The HTTP work classes, in the order idle workers pick up requests from them",
+                        {
+                            {RPCResult::Type::OBJ, "", "",
+                            {
+                                {RPCResult::Type::STR, "name", "The name of the work class"},
+                                {RPCResult::Type::NUM, "priority", "The priority of the work class"},
+                                {RPCResult::Type::NUM, "threads", "The maximum number of requests of the class running at once"},
+                                {RPCResult::Type::NUM, "depth", "The maximum number of queued requests, beyond which requests are rejected"},
+                                {RPCResult::Type::NUM, "queued", "The number of queued requests"},
+                                {RPCResult::Type::NUM, "active", "The number of running requests"},
+                                {RPCResult::Type::NUM, "rejected", "The number of requests rejected since startup"},
+                                {RPCResult::Type::ARR, "queue_wait", "Histogram of the time requests waited in the queue",
+                                {
+                                    {RPCResult::Type::NUM, "", "The number of requests in the bucket"},
+                                }},
+                                {RPCResult::Type::ARR, "exec", "Histogram of the time requests took to run",
+                                {
+                                    {RPCResult::Type::NUM, "", "The number of requests in the bucket"},
+                                }},
+                            }},
+                        }},
                     }
                 },
                 RPCExamples{
@@ -237,6 +263,32 @@ static RPCHelpMan getrpcinfo()
     UniValue log_path(UniValue::VSTR, path);
     result.pushKV("logpath", log_path);
 
+    UniValue latency_buckets(UniValue::VARR);
+    for (int64_t bound : HTTP_LATENCY_BUCKETS) {
+        latency_buckets.push_back(bound);
+    }
+    result.pushKV("latency_buckets", latency_buckets);
+
+    UniValue work_queues(UniValue::VARR);
+    for (const HTTPWorkClassInfo& info : GetHTTPWorkClassInfo()) {
+        UniValue entry(UniValue::VOBJ);
+        entry.pushKV("name", info.name);
+        entry.pushKV("priority", info.priority);
+        entry.pushKV("threads", info.max_active);
+        entry.pushKV("depth", (uint64_t)info.max_depth);
+        entry.pushKV("queued", (uint64_t)info.queued);
+        entry.pushKV("active", info.active);
+        entry.pushKV("rejected", info.rejected);
+        UniValue queue_wait(UniValue::VARR);
+        for (uint64_t count : info.queue_wait) queue_wait.push_back(count);
+        entry.pushKV("queue_wait", queue_wait);
+        UniValue exec(UniValue::VARR);
+        for (uint64_t count : info.exec) exec.push_back(count);
+        entry.pushKV("exec", exec);
+        work_queues.push_back(entry);
+    }
+    result.pushKV("work_queues", work_queues);
+
     return result;
 }
     };
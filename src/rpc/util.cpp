@@ -326,6 +326,19 @@ UniValue JSONRPCTransactionError(TransactionError terr, const std::string& err_s
     }
 }
 
+UniValue ReturnJSON(const JSONRPCRequest& request, std::string json)
+{
+    if (request.raw_result) {
+        *request.raw_result = std::move(json);
+        return NullUniValue;
+    }
+    UniValue result;
+    if (!result.read(json)) {
+        throw JSONRPCError(RPC_INTERNAL_ERROR, "Failed to parse result");
+    }
+    return result;
+}
+
 /**
  * A pair of strings that can be aligned (through padding) with other Sections
  * later on
@@ -96,6 +96,13 @@ unsigned int ParseConfirmTarget(const UniValue& value, unsigned int max_target);
 RPCErrorCode RPCErrorFromTransactionError(TransactionError terr);
 UniValue JSONRPCTransactionError(TransactionError terr, const std::string& err_string = "");
 
+/**
+ * Return serialized JSON as the result of request. If the caller takes raw results,
+ * it is written into the reply as is, instead of building a UniValue tree of it only
+ * to write it out again, and null is returned. Otherwise it is parsed.
+ */
+UniValue ReturnJSON(const JSONRPCRequest& request, std::string json);
+
 //! Parse a JSON range specified as int64, or [int64, int64]
 std::pair<int64_t, int64_t> ParseDescriptorRange(const UniValue& value);
 
@@ -5,10 +5,13 @@
 
 #include <script/sigcache.h>
 
+#include <clientversion.h>
 #include <pubkey.h>
 #include <random.h>
+#include <streams.h>
 #include <uint256.h>
 #include <util/system.h>
+#include <util/time.h>
 
 #include <cuckoocache.h>
 #include <boost/thread/shared_mutex.hpp>
@@ -22,6 +25,7 @@ namespace {
 class CSignatureCache
 {
 private:
+    uint256 m_nonce;
      //! Entries are SHA256(nonce || 'E' or 'S' || 31 zero bytes || signature hash || public key || signature):
     CSHA256 m_salted_hasher_ecdsa;
     CSHA256 m_salted_hasher_schnorr;
@@ -32,7 +36,18 @@ private:
 public:
     CSignatureCache()
     {
-        uint256 nonce = GetRandHash();
+        SetNonce(GetRandHash());
+    }
+
+    const uint256& GetNonce() const { return m_nonce; }
+
+    //! Replace the nonce, which invalidates all entries computed with the previous one.
+    //! Must not be called while other threads are using the cache.
+    void SetNonce(const uint256& nonce)
+    {
+        m_nonce = nonce;
+        m_salted_hasher_ecdsa = CSHA256();
+        m_salted_hasher_schnorr = CSHA256();
         // We want the nonce to be 64 bytes long to force the hasher to process
         // this chunk, which makes later hash computations more efficient. We
         // just write our 32-byte entropy, and then pad with 'E' for ECDSA and
@@ -71,6 +86,22 @@ public:
         boost::unique_lock<boost::shared_mutex> lock(cs_sigcache);
         setValid.insert(entry);
     }
+    void SetMany(const std::vector<uint256>& entries)
+    {
+        boost::unique_lock<boost::shared_mutex> lock(cs_sigcache);
+        for (const uint256& entry : entries) {
+            setValid.insert(entry);
+        }
+    }
+
+    std::vector<uint256> GetAll()
+    {
+        std::vector<uint256> entries;
+        boost::shared_lock<boost::shared_mutex> lock(cs_sigcache);
+        setValid.for_each([&entries](const uint256& entry) { entries.push_back(entry); });
+        return entries;
+    }
+
     uint32_t setup_bytes(size_t n)
     {
         return setValid.setup_bytes(n);
@@ -98,6 +129,130 @@ void InitSignatureCache()
             (nElems*sizeof(uint256)) >>20, (nMaxCacheSize*2)>>20, nElems);
 }
 
+static const uint64_t SALTED_CACHE_DUMP_VERSION = 2;
+//! Number of entries inserted into a cache at a time while it is loaded, so that
+//! validation isn't locked out of the cache for the whole load
+static const size_t SALTED_CACHE_LOAD_BATCH = 4096;
+
+/** Read the header of a saved cache. A cache saved by another client version is
+ * removed, as the script checks its entries stand for may have changed. */
+static bool ReadSaltedCacheHeader(CAutoFile& file, const fs::path& path, uint256& nonce)
+{
+    uint64_t version;
+    int32_t client_version{0};
+    file >> version;
+    if (version == SALTED_CACHE_DUMP_VERSION) file >> client_version;
+    if (version != SALTED_CACHE_DUMP_VERSION || client_version != CLIENT_VERSION) {
+        LogPrintf("Discarding %s, which was saved by another client version\n", path.string());
+        file.fclose();
+        fs::remove(path);
+        return false;
+    }
+    file >> nonce;
+    return true;
+}
+
+bool ReadSaltedCacheNonce(const fs::path& path, uint256& nonce)
+{
+    CAutoFile file(fsbridge::fopen(path, "rb"), SER_DISK, CLIENT_VERSION);
+    if (file.IsNull()) return false;
+
+    try {
+        if (!ReadSaltedCacheHeader(file, path, nonce)) return false;
+    } catch (const std::exception& e) {
+        LogPrintf("Failed to read cache nonce from %s: %s. Continuing anyway.\n", path.string(), e.what());
+        return false;
+    }
+    return true;
+}
+
+bool LoadSaltedCacheEntries(const fs::path& path, const uint256& nonce, const std::function<void(const std::vector<uint256>&)>& insert)
+{
+    CAutoFile file(fsbridge::fopen(path, "rb"), SER_DISK, CLIENT_VERSION);
+    if (file.IsNull()) return false;
+
+    try {
+        uint256 file_nonce;
+        if (!ReadSaltedCacheHeader(file, path, file_nonce)) return false;
+        // Entries salted with another nonce would never be hit
+        if (file_nonce != nonce) return false;
+        uint64_t num;
+        file >> num;
+        std::vector<uint256> entries;
+        entries.reserve(std::min<uint64_t>(num, SALTED_CACHE_LOAD_BATCH));
+        while (num--) {
+            uint256 entry;
+            file >> entry;
+            entries.push_back(entry);
+            if (entries.size() == SALTED_CACHE_LOAD_BATCH || num == 0) {
+                insert(entries);
+                entries.clear();
+            }
+        }
+    } catch (const std::exception& e) {
+        LogPrintf("Failed to read cache entries from %s: %s. Continuing anyway.\n", path.string(), e.what());
+        return false;
+    }
+    return true;
+}
+
+bool DumpSaltedCacheEntries(const fs::path& path, const uint256& nonce, const std::vector<uint256>& entries)
+{
+    fs::path path_new = path;
+    path_new += ".new";
+    try {
+        FILE* filestr = fsbridge::fopen(path_new, "wb");
+        if (!filestr) {
+            return false;
+        }
+
+        CAutoFile file(filestr, SER_DISK, CLIENT_VERSION);
+        file << SALTED_CACHE_DUMP_VERSION << int32_t{CLIENT_VERSION} << nonce << (uint64_t)entries.size();
+        for (const uint256& entry : entries) {
+            file << entry;
+        }
+
+        if (!FileCommit(file.Get()))
+            throw std::runtime_error("FileCommit failed");
+        file.fclose();
+        if (!RenameOver(path_new, path))
+            throw std::runtime_error("Rename failed");
+    } catch (const std::exception& e) {
+        LogPrintf("Failed to dump cache to %s: %s. Continuing anyway.\n", path.string(), e.what());
+        return false;
+    }
+    return true;
+}
+
+bool ReadSignatureCacheNonce()
+{
+    uint256 nonce;
+    if (!ReadSaltedCacheNonce(GetDataDir() / SIGCACHE_FILENAME, nonce)) return false;
+    signatureCache.SetNonce(nonce);
+    return true;
+}
+
+bool LoadSignatureCache()
+{
+    int64_t start = GetTimeMicros();
+    size_t count = 0;
+    bool ret = LoadSaltedCacheEntries(GetDataDir() / SIGCACHE_FILENAME, signatureCache.GetNonce(), [&count](const std::vector<uint256>& entries) {
+        signatureCache.SetMany(entries);
+        count += entries.size();
+    });
+    if (ret) LogPrintf("Loaded %u signature cache entries: %.2fms\n", count, (GetTimeMicros() - start) * 0.001);
+    return ret;
+}
+
+bool DumpSignatureCache()
+{
+    int64_t start = GetTimeMicros();
+    std::vector<uint256> entries = signatureCache.GetAll();
+    if (!DumpSaltedCacheEntries(GetDataDir() / SIGCACHE_FILENAME, signatureCache.GetNonce(), entries)) return false;
+    LogPrintf("Dumped %u signature cache entries: %.2fms\n", entries.size(), (GetTimeMicros() - start) * 0.001);
+    return true;
+}
+
 bool CachingTransactionSignatureChecker::VerifyECDSASignature(const std::vector<unsigned char>& vchSig, const CPubKey& pubkey, const uint256& sighash) const
 {
     uint256 entry;
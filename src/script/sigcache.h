@@ -6,9 +6,11 @@
 #ifndef BITCOIN_SCRIPT_SIGCACHE_H
 #define BITCOIN_SCRIPT_SIGCACHE_H
 
+#include <fs.h>
 #include <script/interpreter.h>
 #include <span.h>
 
+#include <functional>
 #include <vector>
 
 // DoS prevention: limit cache size to 32MB (over 1000000 entries on 64-bit
@@ -17,6 +19,9 @@
 static const unsigned int DEFAULT_MAX_SIG_CACHE_SIZE = 32;
 // Maximum sig cache size allowed
 static const int64_t MAX_MAX_SIG_CACHE_SIZE = 16384;
+// Whether to save the signature and script execution caches on shutdown and load them on restart
+static const bool DEFAULT_PERSIST_SIGCACHE = false;
+static const char* const SIGCACHE_FILENAME = "sigcache.dat";
 
 class CPubKey;
 
@@ -55,4 +60,25 @@ public:
 
 void InitSignatureCache();
 
+/** Salt the signature cache with the nonce of the cache saved on disk, so that the
+ * saved entries can be loaded with LoadSignatureCache. Must be called before the
+ * cache is first used. */
+bool ReadSignatureCacheNonce();
+/** Insert the entries of the signature cache saved on disk. This can run on a
+ * background thread while the cache is in use. */
+bool LoadSignatureCache();
+/** Save the signature cache to disk. */
+bool DumpSignatureCache();
+
+/**
+ * Salted caches are saved as the client version and the nonce their entries were
+ * computed with, followed by the entries. Entries stay valid as long as the cache is
+ * salted with the same nonce after a restart of the same client version.
+ */
+bool ReadSaltedCacheNonce(const fs::path& path, uint256& nonce);
+/** Read the entries of a saved cache in batches and pass them to insert. Returns false
+ * if the file can't be read or wasn't saved with the given nonce. */
+bool LoadSaltedCacheEntries(const fs::path& path, const uint256& nonce, const std::function<void(const std::vector<uint256>&)>& insert);
+bool DumpSaltedCacheEntries(const fs::path& path, const uint256& nonce, const std::vector<uint256>& entries);
+
 #endif // BITCOIN_SCRIPT_SIGCACHE_H
@@ -0,0 +1,754 @@
+// Copyright (c) 2021 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <stratum.h>
+
+#include <arith_uint256.h>
+#include <chain.h>
+#include <chainparams.h>
+#include <crypto/common.h>
+#include <crypto/scrypt.h>
+#include <hash.h>
+#include <key_io.h>
+#include <logging.h>
+#include <miner.h>
+#include <netbase.h>
+#include <node/context.h>
+#include <node/ui_interface.h>
+#include <pow.h>
+#include <primitives/block.h>
+#include <script/standard.h>
+#include <streams.h>
+#include <sync.h>
+#include <timedata.h>
+#include <util/strencodings.h>
+#include <util/system.h>
+#include <util/threadnames.h>
+#include <util/threadpool.h>
+#include <util/translation.h>
+#include <validation.h>
+#include <validationinterface.h>
+#include <version.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include <event2/buffer.h>
+#include <event2/bufferevent.h>
+#include <event2/event.h>
+#include <event2/listener.h>
+#include <event2/thread.h>
+#include <event2/util.h>
+
+#include <support/events.h>
+
+#include <univalue.h>
+
+//! Size of the extranonce assigned to each connection
+static const size_t EXTRANONCE1_SIZE = 4;
+//! Size of the extranonce rolled by the miner
+static const size_t EXTRANONCE2_SIZE = 4;
+//! Maximum length of a request line; longer lines disconnect the miner
+static const size_t MAX_STRATUM_LINE_LENGTH = 16 * 1024;
+//! Maximum number of shares waiting for a verifier thread; more are rejected as busy
+static const size_t MAX_STRATUM_QUEUED_SHARES = 1000;
+//! Maximum number of shares remembered per job to reject duplicates. Once a job has
+//! this many, further shares for it are rejected and the next refresh replaces it.
+static const size_t MAX_STRATUM_JOB_SHARES = 10000;
+//! Maximum number of jobs built on the current tip that shares are accepted for; the oldest is dropped first
+static const size_t MAX_STRATUM_JOBS_PER_TIP = 8;
+
+namespace {
+
+/** A unit of work built from a block template. */
+struct StratumJob
+{
+    std::string id;
+    std::unique_ptr<CBlockTemplate> block_template;
+    int64_t min_time{0};
+    //! Serialized coinbase transaction before and after the extranonces
+    std::vector<unsigned char> coinb1;
+    std::vector<unsigned char> coinb2;
+    //! Hashes combined with the coinbase txid to compute the merkle root
+    std::vector<uint256> merkle_branch;
+
+    Mutex cs_submitted;
+    //! Hashes of the headers submitted for this job, to reject duplicate shares
+    std::set<uint256> submitted GUARDED_BY(cs_submitted);
+};
+
+/** A connected miner. Only used on the event loop thread, except for Send(). */
+struct StratumClient
+{
+    struct bufferevent* const bev;
+    CService addr;
+    std::vector<unsigned char> extranonce1;
+    bool subscribed{false};
+    bool authorized{false};
+
+    explicit StratumClient(struct bufferevent* bev_in) : bev(bev_in) {}
+    ~StratumClient() { bufferevent_free(bev); }
+
+    /** Queue a message for the miner. Safe to call from any thread. */
+    void Send(const UniValue& message)
+    {
+        const std::string line = message.write() + "\n";
+        bufferevent_write(bev, line.data(), line.size());
+    }
+};
+
+/** A share waiting to be checked by a verifier thread. */
+struct StratumShare
+{
+    std::shared_ptr<StratumClient> client;
+    UniValue id;
+    std::shared_ptr<StratumJob> job;
+    std::vector<unsigned char> extranonce2;
+    uint32_t ntime;
+    uint32_t nonce;
+};
+
+/** Builds a new job whenever the tip changes. */
+class StratumNotifier final : public CValidationInterface
+{
+protected:
+    void UpdatedBlockTip(const CBlockIndex* pindexNew, const CBlockIndex* pindexFork, bool fInitialDownload) override;
+};
+
+} // namespace
+
+/** Stratum module state */
+
+//! libevent event loop
+static struct event_base* g_stratum_base = nullptr;
+//! Listening sockets
+static std::vector<struct evconnlistener*> g_stratum_listeners;
+//! Timer that builds a new job for mempool changes; also fired for new tips
+static struct event* g_stratum_refresh = nullptr;
+//! Sends the current job to the miners once it's built
+static struct event* g_stratum_notify = nullptr;
+static std::thread g_stratum_thread;
+//! Builds jobs, which holds cs_main, off the event loop thread
+static std::unique_ptr<ThreadPool> g_stratum_job_builder;
+static std::atomic<bool> g_job_build_queued{false};
+static std::vector<std::thread> g_stratum_verifiers;
+static std::unique_ptr<StratumNotifier> g_stratum_notifier;
+
+static NodeContext* g_stratum_node = nullptr;
+//! Coinbase payout script
+static CScript g_stratum_script;
+static int64_t g_stratum_difficulty = DEFAULT_STRATUM_DIFFICULTY;
+static arith_uint256 g_share_target;
+
+static Mutex g_stratum_mutex;
+static std::condition_variable g_stratum_cond;
+//! Shares waiting for a verifier thread
+static std::deque<StratumShare> g_stratum_shares GUARDED_BY(g_stratum_mutex);
+static bool g_stratum_interrupted GUARDED_BY(g_stratum_mutex) = false;
+//! Jobs shares can be submitted for, which are the latest ones built on the current tip, oldest first
+static std::deque<std::shared_ptr<StratumJob>> g_stratum_jobs GUARDED_BY(g_stratum_mutex);
+static std::shared_ptr<StratumJob> g_stratum_current_job GUARDED_BY(g_stratum_mutex);
+//! Whether a job for a new tip was built since the miners were last notified
+static bool g_stratum_notify_clean GUARDED_BY(g_stratum_mutex) = false;
+
+// Only used on the event loop thread.
+static std::map<struct bufferevent*, std::shared_ptr<StratumClient>> g_stratum_clients;
+static uint32_t g_next_extranonce1 = 0;
+
+// Only used on the job builder thread.
+static uint64_t g_next_job_id = 0;
+static const CBlockIndex* g_job_tip = nullptr;
+static unsigned int g_job_transactions_updated = 0;
+
+static UniValue StratumReply(const UniValue& id, const UniValue& result, const UniValue& error)
+{
+    UniValue reply(UniValue::VOBJ);
+    reply.pushKV("id", id);
+    reply.pushKV("result", result);
+    reply.pushKV("error", error);
+    return reply;
+}
+
+static UniValue StratumError(int code, const std::string& message)
+{
+    UniValue error(UniValue::VARR);
+    error.push_back(code);
+    error.push_back(message);
+    error.push_back(NullUniValue);
+    return error;
+}
+
+static UniValue StratumNotification(const std::string& method, const UniValue& params)
+{
+    UniValue notification(UniValue::VOBJ);
+    notification.pushKV("id", NullUniValue);
+    notification.pushKV("method", method);
+    notification.pushKV("params", params);
+    return notification;
+}
+
+/** Stratum sends the previous block hash as eight 32-bit words, each byte-swapped. */
+static std::string StratumPrevHash(const uint256& hash)
+{
+    std::vector<unsigned char> words(hash.begin(), hash.end());
+    for (size_t i = 0; i < words.size(); i += 4) {
+        std::reverse(words.begin() + i, words.begin() + i + 4);
+    }
+    return HexStr(words);
+}
+
+/** Return the hashes needed to compute the merkle root of the block from its coinbase txid. */
+static std::vector<uint256> CoinbaseMerkleBranch(const CBlock& block)
+{
+    std::vector<uint256> hashes(block.vtx.size());
+    for (size_t i = 1; i < block.vtx.size(); i++) {
+        hashes[i] = block.vtx[i]->GetHash();
+    }
+
+    std::vector<uint256> branch;
+    while (hashes.size() > 1) {
+        branch.push_back(hashes[1]);
+        // The first hash of each level depends on the coinbase, and is left null.
+        std::vector<uint256> next((hashes.size() + 1) / 2);
+        for (size_t i = 1; i < next.size(); i++) {
+            const uint256& left = hashes[2 * i];
+            const uint256& right = 2 * i + 1 < hashes.size() ? hashes[2 * i + 1] : left;
+            next[i] = Hash(left, right);
+        }
+        hashes.swap(next);
+    }
+    return branch;
+}
+
+static std::shared_ptr<StratumJob> CreateStratumJob() EXCLUSIVE_LOCKS_REQUIRED(cs_main)
+{
+    auto job = std::make_shared<StratumJob>();
+    job->block_template = BlockAssembler(*g_stratum_node->mempool, Params()).CreateNewBlock(g_stratum_script);
+    if (!job->block_template) return nullptr;
+
+    const CBlock& block = job->block_template->block;
+    const CBlockIndex* pindexPrev = ::ChainActive().Tip();
+    job->min_time = pindexPrev->GetMedianTimePast() + 1;
+
+    // Leave room for the extranonces right after the height in the coinbase
+    // scriptSig, and split the serialized coinbase around them.
+    CMutableTransaction coinbase(*block.vtx[0]);
+    const CScript prefix = CScript() << (pindexPrev->nHeight + 1);
+    coinbase.vin[0].scriptSig = prefix;
+    coinbase.vin[0].scriptSig << std::vector<unsigned char>(EXTRANONCE1_SIZE + EXTRANONCE2_SIZE);
+
+    CDataStream ss(SER_NETWORK, PROTOCOL_VERSION | SERIALIZE_TRANSACTION_NO_WITNESS);
+    ss << coinbase;
+    // nVersion, the vin count, the null prevout, the scriptSig length, the
+    // height and the push opcode of the extranonces.
+    const size_t offset = 4 + GetSizeOfCompactSize(1) + 36 + GetSizeOfCompactSize(coinbase.vin[0].scriptSig.size()) + prefix.size() + 1;
+    job->coinb1.assign(ss.begin(), ss.begin() + offset);
+    job->coinb2.assign(ss.begin() + offset + EXTRANONCE1_SIZE + EXTRANONCE2_SIZE, ss.end());
+
+    job->merkle_branch = CoinbaseMerkleBranch(block);
+    job->id = strprintf("%x", ++g_next_job_id);
+    return job;
+}
+
+static UniValue JobNotification(const StratumJob& job, bool clean)
+{
+    const CBlock& block = job.block_template->block;
+
+    UniValue branch(UniValue::VARR);
+    for (const uint256& hash : job.merkle_branch) {
+        branch.push_back(HexStr(hash));
+    }
+
+    UniValue params(UniValue::VARR);
+    params.push_back(job.id);
+    params.push_back(StratumPrevHash(block.hashPrevBlock));
+    params.push_back(HexStr(job.coinb1));
+    params.push_back(HexStr(job.coinb2));
+    params.push_back(branch);
+    params.push_back(strprintf("%08x", block.nVersion));
+    params.push_back(strprintf("%08x", block.nBits));
+    params.push_back(strprintf("%08x", std::max(job.min_time, GetAdjustedTime())));
+    params.push_back(clean);
+    return StratumNotification("mining.notify", params);
+}
+
+static UniValue DifficultyNotification()
+{
+    UniValue params(UniValue::VARR);
+    params.push_back(g_stratum_difficulty);
+    return StratumNotification("mining.set_difficulty", params);
+}
+
+/** Whether the job has taken as many shares as it can check for duplicates. */
+static bool StratumJobFull(const std::shared_ptr<StratumJob>& job)
+{
+    if (!job) return false;
+    LOCK(job->cs_submitted);
+    return job->submitted.size() >= MAX_STRATUM_JOB_SHARES;
+}
+
+/** Build a new job if the tip or the mempool changed, or the current job is full. */
+static void BuildStratumJob()
+{
+    // Cleared first, so that a refresh while building queues another build.
+    g_job_build_queued = false;
+    const bool current_job_full = StratumJobFull(WITH_LOCK(g_stratum_mutex, return g_stratum_current_job));
+
+    std::shared_ptr<StratumJob> job;
+    bool clean;
+    {
+        LOCK(cs_main);
+        if (::ChainstateActive().IsInitialBlockDownload()) return;
+        const CBlockIndex* tip = ::ChainActive().Tip();
+        const unsigned int transactions_updated = g_stratum_node->mempool->GetTransactionsUpdated();
+        if (tip == g_job_tip && transactions_updated == g_job_transactions_updated && !current_job_full) return;
+        try {
+            job = CreateStratumJob();
+        } catch (const std::runtime_error& e) {
+            LogPrintf("Stratum: failed to create block template: %s\n", e.what());
+            return;
+        }
+        if (!job) return;
+        clean = tip != g_job_tip;
+        g_job_tip = tip;
+        g_job_transactions_updated = transactions_updated;
+    }
+
+    {
+        LOCK(g_stratum_mutex);
+        if (clean) g_stratum_jobs.clear();
+        g_stratum_jobs.push_back(job);
+        if (g_stratum_jobs.size() > MAX_STRATUM_JOBS_PER_TIP) g_stratum_jobs.pop_front();
+        g_stratum_current_job = job;
+        g_stratum_notify_clean |= clean;
+    }
+    LogPrint(BCLog::STRATUM, "Stratum: new job %s with %u transactions\n", job->id, job->block_template->block.vtx.size());
+    event_active(g_stratum_notify, 0, 0);
+}
+
+/** Queue a job build. Templates are built while holding cs_main, so not on the event loop thread. */
+static void stratum_refresh_cb(evutil_socket_t, short, void*)
+{
+    if (g_job_build_queued.exchange(true)) return;
+    g_stratum_job_builder->Submit(BuildStratumJob);
+}
+
+/** Send the current job to all miners. */
+static void stratum_notify_cb(evutil_socket_t, short, void*)
+{
+    std::shared_ptr<StratumJob> job;
+    bool clean;
+    {
+        LOCK(g_stratum_mutex);
+        job = g_stratum_current_job;
+        clean = g_stratum_notify_clean;
+        g_stratum_notify_clean = false;
+    }
+    if (!job) return;
+
+    const UniValue notification = JobNotification(*job, clean);
+    for (const auto& entry : g_stratum_clients) {
+        if (entry.second->subscribed) entry.second->Send(notification);
+    }
+}
+
+void StratumNotifier::UpdatedBlockTip(const CBlockIndex* pindexNew, const CBlockIndex* pindexFork, bool fInitialDownload)
+{
+    if (fInitialDownload) return;
+    event_active(g_stratum_refresh, 0, 0);
+}
+
+static void StratumDisconnect(struct bufferevent* bev)
+{
+    auto it = g_stratum_clients.find(bev);
+    if (it == g_stratum_clients.end()) return;
+    LogPrint(BCLog::STRATUM, "Stratum: miner %s disconnected\n", it->second->addr.ToString());
+    bufferevent_disable(bev, EV_READ | EV_WRITE);
+    bufferevent_setcb(bev, nullptr, nullptr, nullptr, nullptr);
+    // Shares still being checked hold on to the client until they are answered.
+    g_stratum_clients.erase(it);
+}
+
+/** Parse a 32-bit value sent by the miner as 8 hex digits. */
+static bool ParseStratumUInt32(const UniValue& value, uint32_t& out)
+{
+    if (!value.isStr() || value.get_str().size() != 8 || !IsHex(value.get_str())) return false;
+    out = ReadBE32(ParseHex(value.get_str()).data());
+    return true;
+}
+
+static UniValue HandleSubmit(const std::shared_ptr<StratumClient>& client, const UniValue& id, const UniValue& params)
+{
+    if (!client->authorized) return StratumError(24, "Unauthorized worker");
+    if (!client->subscribed) return StratumError(25, "Not subscribed");
+    if (params.size() < 5 || !params[1].isStr() || !params[2].isStr()) return StratumError(20, "Invalid parameters");
+
+    StratumShare share;
+    share.client = client;
+    share.id = id;
+    const std::string& extranonce2 = params[2].get_str();
+    if (extranonce2.size() != EXTRANONCE2_SIZE * 2 || !IsHex(extranonce2)) return StratumError(20, "Invalid extranonce2");
+    share.extranonce2 = ParseHex(extranonce2);
+    if (!ParseStratumUInt32(params[3], share.ntime)) return StratumError(20, "Invalid ntime");
+    if (!ParseStratumUInt32(params[4], share.nonce)) return StratumError(20, "Invalid nonce");
+
+    {
+        LOCK(g_stratum_mutex);
+        if (g_stratum_interrupted) return StratumError(20, "Shutting down");
+        const std::string& job_id = params[1].get_str();
+        auto it = std::find_if(g_stratum_jobs.begin(), g_stratum_jobs.end(), [&](const std::shared_ptr<StratumJob>& job) { return job->id == job_id; });
+        if (it == g_stratum_jobs.end()) return StratumError(21, "Job not found");
+        share.job = *it;
+        if (share.ntime < share.job->min_time || share.ntime > GetAdjustedTime() + MAX_FUTURE_BLOCK_TIME) {
+            return StratumError(20, "ntime out of range");
+        }
+        if (g_stratum_shares.size() >= MAX_STRATUM_QUEUED_SHARES) return StratumError(20, "Busy");
+        g_stratum_shares.push_back(std::move(share));
+    }
+    g_stratum_cond.notify_one();
+    // Answered by the verifier thread
+    return NullUniValue;
+}
+
+static void HandleStratumRequest(const std::shared_ptr<StratumClient>& client, const std::string& line)
+{
+    UniValue request;
+    if (!request.read(line) || !request.isObject()) {
+        LogPrint(BCLog::STRATUM, "Stratum: invalid request from %s\n", client->addr.ToString());
+        StratumDisconnect(client->bev);
+        return;
+    }
+    const UniValue& id = find_value(request, "id");
+    const UniValue& method = find_value(request, "method");
+    const UniValue& params = find_value(request, "params");
+    if (!method.isStr() || !params.isArray()) {
+        client->Send(StratumReply(id, NullUniValue, StratumError(20, "Invalid request")));
+        return;
+    }
+
+    if (method.get_str() == "mining.subscribe") {
+        client->subscribed = true;
+        UniValue subscription(UniValue::VARR);
+        for (const char* notification : {"mining.set_difficulty", "mining.notify"}) {
+            UniValue entry(UniValue::VARR);
+            entry.push_back(notification);
+            entry.push_back(HexStr(client->extranonce1));
+            subscription.push_back(entry);
+        }
+        UniValue result(UniValue::VARR);
+        result.push_back(subscription);
+        result.push_back(HexStr(client->extranonce1));
+        result.push_back((int)EXTRANONCE2_SIZE);
+        client->Send(StratumReply(id, result, NullUniValue));
+        client->Send(DifficultyNotification());
+
+        std::shared_ptr<StratumJob> job = WITH_LOCK(g_stratum_mutex, return g_stratum_current_job);
+        if (job) client->Send(JobNotification(*job, true));
+    } else if (method.get_str() == "mining.authorize") {
+        // Any worker name is accepted; access is limited with -stratumbind.
+        client->authorized = true;
+        client->Send(StratumReply(id, true, NullUniValue));
+    } else if (method.get_str() == "mining.submit") {
+        const UniValue error = HandleSubmit(client, id, params);
+        if (!error.isNull()) client->Send(StratumReply(id, NullUniValue, error));
+    } else {
+        client->Send(StratumReply(id, NullUniValue, StratumError(20, "Method not found")));
+    }
+}
+
+static void stratum_read_cb(struct bufferevent* bev, void*)
+{
+    auto it = g_stratum_clients.find(bev);
+    if (it == g_stratum_clients.end()) return;
+    const std::shared_ptr<StratumClient> client = it->second;
+
+    struct evbuffer* input = bufferevent_get_input(bev);
+    while (true) {
+        size_t len;
+        char* line = evbuffer_readln(input, &len, EVBUFFER_EOL_CRLF);
+        if (!line) break;
+        const std::string request(line, len);
+        free(line);
+        HandleStratumRequest(client, request);
+        if (!g_stratum_clients.count(bev)) return;
+    }
+    if (evbuffer_get_length(input) > MAX_STRATUM_LINE_LENGTH) {
+        LogPrint(BCLog::STRATUM, "Stratum: request from %s too long\n", client->addr.ToString());
+        StratumDisconnect(bev);
+    }
+}
+
+static void stratum_event_cb(struct bufferevent* bev, short events, void*)
+{
+    if (events & (BEV_EVENT_EOF | BEV_EVENT_ERROR)) {
+        StratumDisconnect(bev);
+    }
+}
+
+static void stratum_accept_cb(struct evconnlistener*, evutil_socket_t fd, struct sockaddr* addr, int, void*)
+{
+    struct bufferevent* bev = bufferevent_socket_new(g_stratum_base, fd, BEV_OPT_CLOSE_ON_FREE | BEV_OPT_THREADSAFE);
+    if (!bev) {
+        evutil_closesocket(fd);
+        return;
+    }
+    auto client = std::make_shared<StratumClient>(bev);
+    client->addr.SetSockAddr(addr);
+    client->extranonce1.resize(EXTRANONCE1_SIZE);
+    WriteLE32(client->extranonce1.data(), g_next_extranonce1++);
+    g_stratum_clients.emplace(bev, client);
+
+    bufferevent_setcb(bev, stratum_read_cb, nullptr, stratum_event_cb, nullptr);
+    bufferevent_enable(bev, EV_READ | EV_WRITE);
+    LogPrint(BCLog::STRATUM, "Stratum: miner connected from %s\n", client->addr.ToString());
+}
+
+/** Submit the block found by a share to validation. */
+static void SubmitStratumBlock(const StratumJob& job, const CBlockHeader& header, const std::vector<unsigned char>& coinbase_data)
+{
+    auto block = std::make_shared<CBlock>(job.block_template->block);
+
+    CMutableTransaction coinbase;
+    CDataStream ss(coinbase_data, SER_NETWORK, PROTOCOL_VERSION | SERIALIZE_TRANSACTION_NO_WITNESS);
+    ss >> coinbase;
+    // The witness reserved value isn't part of the serialization sent to miners.
+    coinbase.vin[0].scriptWitness = block->vtx[0]->vin[0].scriptWitness;
+    block->vtx[0] = MakeTransactionRef(std::move(coinbase));
+    block->hashMerkleRoot = header.hashMerkleRoot;
+    block->nTime = header.nTime;
+    block->nNonce = header.nNonce;
+
+    bool new_block;
+    const bool accepted = g_stratum_node->chainman->ProcessNewBlock(Params(), block, /* fForceProcessing */ true, /* fNewBlock */ &new_block);
+    LogPrintf("Stratum: found block %s, %s\n", block->GetHash().ToString(), accepted ? "accepted" : "rejected");
+}
+
+/** Check a share, and submit the block if it meets the network target. */
+static UniValue CheckShare(const StratumShare& share, char* scratchpad)
+{
+    StratumJob& job = *share.job;
+    const CBlock& block = job.block_template->block;
+
+    std::vector<unsigned char> coinbase_data(job.coinb1);
+    coinbase_data.insert(coinbase_data.end(), share.client->extranonce1.begin(), share.client->extranonce1.end());
+    coinbase_data.insert(coinbase_data.end(), share.extranonce2.begin(), share.extranonce2.end());
+    coinbase_data.insert(coinbase_data.end(), job.coinb2.begin(), job.coinb2.end());
+
+    CBlockHeader header;
+    header.nVersion = block.nVersion;
+    header.hashPrevBlock = block.hashPrevBlock;
+    header.hashMerkleRoot = Hash(coinbase_data);
+    for (const uint256& hash : job.merkle_branch) {
+        header.hashMerkleRoot = Hash(header.hashMerkleRoot, hash);
+    }
+    header.nTime = share.ntime;
+    header.nBits = block.nBits;
+    header.nNonce = share.nonce;
+
+    {
+        LOCK(job.cs_submitted);
+        if (job.submitted.size() >= MAX_STRATUM_JOB_SHARES) return StratumError(21, "Job full, wait for the next job");
+        if (!job.submitted.insert(header.GetHash()).second) return StratumError(22, "Duplicate share");
+    }
+
+    CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
+    ss << header;
+    uint256 pow_hash;
+    scrypt_1024_1_1_256_sp(ss.data(), (char*)pow_hash.begin(), scratchpad);
+
+    if (CheckProofOfWork(pow_hash, header.nBits, Params().GetConsensus())) {
+        SubmitStratumBlock(job, header, coinbase_data);
+    } else if (UintToArith256(pow_hash) > g_share_target) {
+        return StratumError(23, "Low difficulty share");
+    }
+    return NullUniValue;
+}
+
+/** Check submitted shares until interrupted. Each thread has its own scrypt scratchpad. */
+static void StratumVerifierThread(int worker_num)
+{
+    util::ThreadRename(strprintf("stratum.%i", worker_num));
+    std::vector<char> scratchpad(SCRYPT_SCRATCHPAD_SIZE);
+    while (true) {
+        StratumShare share;
+        {
+            WAIT_LOCK(g_stratum_mutex, lock);
+            g_stratum_cond.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(g_stratum_mutex) { return g_stratum_interrupted || !g_stratum_shares.empty(); });
+            if (g_stratum_interrupted) return;
+            share = std::move(g_stratum_shares.front());
+            g_stratum_shares.pop_front();
+        }
+        const UniValue error = CheckShare(share, scratchpad.data());
+        share.client->Send(StratumReply(share.id, error.isNull(), error));
+    }
+}
+
+static void ThreadStratum(struct event_base* base)
+{
+    util::ThreadRename("stratum");
+    LogPrint(BCLog::STRATUM, "Entering stratum event loop\n");
+    event_base_dispatch(base);
+    LogPrint(BCLog::STRATUM, "Exited stratum event loop\n");
+}
+
+static bool StratumBindAddresses(struct event_base* base)
+{
+    const int port = gArgs.GetArg("-stratumport", DEFAULT_STRATUM_PORT);
+    std::vector<std::pair<std::string, int>> endpoints;
+    if (gArgs.IsArgSet("-stratumbind")) {
+        for (const std::string& bind : gArgs.GetArgs("-stratumbind")) {
+            int bind_port = port;
+            std::string host;
+            SplitHostPort(bind, bind_port, host);
+            endpoints.emplace_back(host, bind_port);
+        }
+    } else { // Default to loopback
+        endpoints.emplace_back("::1", port);
+        endpoints.emplace_back("127.0.0.1", port);
+    }
+
+    for (const auto& endpoint : endpoints) {
+        LogPrint(BCLog::STRATUM, "Binding stratum on address %s port %i\n", endpoint.first, endpoint.second);
+        CService service;
+        struct sockaddr_storage sockaddr;
+        socklen_t len = sizeof(sockaddr);
+        if (!Lookup(endpoint.first, service, endpoint.second, false) || !service.GetSockAddr((struct sockaddr*)&sockaddr, &len)) {
+            LogPrintf("Binding stratum on address %s port %i failed.\n", endpoint.first, endpoint.second);
+            continue;
+        }
+        struct evconnlistener* listener = evconnlistener_new_bind(base, stratum_accept_cb, nullptr,
+            LEV_OPT_CLOSE_ON_FREE | LEV_OPT_REUSEABLE, -1, (struct sockaddr*)&sockaddr, len);
+        if (!listener) {
+            LogPrintf("Binding stratum on address %s port %i failed.\n", endpoint.first, endpoint.second);
+            continue;
+        }
+        if (service.IsBindAny()) {
+            LogPrintf("WARNING: the stratum server accepts work from anyone who can connect to it\n");
+        }
+        g_stratum_listeners.push_back(listener);
+    }
+    return !g_stratum_listeners.empty();
+}
+
+bool InitStratumServer(NodeContext& node)
+{
+    const std::string address = gArgs.GetArg("-stratumaddress", "");
+    const CTxDestination destination = DecodeDestination(address);
+    if (!IsValidDestination(destination)) {
+        return InitError(strprintf(_("-stratum requires a valid -stratumaddress to pay the coinbase to, got '%s'"), address));
+    }
+    g_stratum_script = GetScriptForDestination(destination);
+
+    g_stratum_difficulty = gArgs.GetArg("-stratumdifficulty", DEFAULT_STRATUM_DIFFICULTY);
+    if (g_stratum_difficulty < 1) {
+        return InitError(strprintf(_("Invalid -stratumdifficulty: %d"), g_stratum_difficulty));
+    }
+    g_share_target = UintToArith256(Params().GetConsensus().powLimit) / arith_uint256(g_stratum_difficulty);
+
+#ifdef WIN32
+    evthread_use_windows_threads();
+#else
+    evthread_use_pthreads();
+#endif
+
+    raii_event_base base_ctr = obtain_event_base();
+    if (!StratumBindAddresses(base_ctr.get())) {
+        return InitError(_("Unable to bind any endpoint for the stratum server"));
+    }
+
+    g_stratum_refresh = event_new(base_ctr.get(), -1, EV_PERSIST, stratum_refresh_cb, nullptr);
+    g_stratum_notify = event_new(base_ctr.get(), -1, 0, stratum_notify_cb, nullptr);
+    struct timeval interval;
+    interval.tv_sec = std::max<int64_t>(gArgs.GetArg("-stratumjobinterval", DEFAULT_STRATUM_JOB_INTERVAL), 1);
+    interval.tv_usec = 0;
+    event_add(g_stratum_refresh, &interval);
+
+    g_stratum_node = &node;
+    // transfer ownership to the stratum server via .release()
+    g_stratum_base = base_ctr.release();
+
+    g_stratum_notifier = MakeUnique<StratumNotifier>();
+    RegisterValidationInterface(g_stratum_notifier.get());
+    LogPrintf("Stratum: share difficulty %d\n", g_stratum_difficulty);
+    return true;
+}
+
+void StartStratumServer()
+{
+    const int threads = std::max((int)gArgs.GetArg("-stratumthreads", DEFAULT_STRATUM_THREADS), 1);
+    LogPrintf("Stratum: starting %d share verifier threads\n", threads);
+    {
+        LOCK(g_stratum_mutex);
+        g_stratum_interrupted = false;
+    }
+    for (int i = 0; i < threads; i++) {
+        g_stratum_verifiers.emplace_back(StratumVerifierThread, i);
+    }
+    g_stratum_job_builder = MakeUnique<ThreadPool>("stratumjob", 1);
+    g_stratum_thread = std::thread(ThreadStratum, g_stratum_base);
+    // Build the first job
+    event_active(g_stratum_refresh, 0, 0);
+}
+
+void InterruptStratumServer()
+{
+    {
+        LOCK(g_stratum_mutex);
+        g_stratum_interrupted = true;
+    }
+    g_stratum_cond.notify_all();
+}
+
+void StopStratumServer()
+{
+    if (g_stratum_notifier) {
+        UnregisterValidationInterface(g_stratum_notifier.get());
+        g_stratum_notifier.reset();
+    }
+    InterruptStratumServer();
+    for (auto& thread : g_stratum_verifiers) {
+        thread.join();
+    }
+    g_stratum_verifiers.clear();
+
+    if (g_stratum_base) {
+        event_base_loopbreak(g_stratum_base);
+        if (g_stratum_thread.joinable()) g_stratum_thread.join();
+    }
+    // Waits for a job being built; queued builds are dropped.
+    g_stratum_job_builder.reset();
+    g_job_build_queued = false;
+    for (struct evconnlistener* listener : g_stratum_listeners) {
+        evconnlistener_free(listener);
+    }
+    g_stratum_listeners.clear();
+    {
+        LOCK(g_stratum_mutex);
+        g_stratum_shares.clear();
+        g_stratum_jobs.clear();
+        g_stratum_current_job.reset();
+        g_stratum_notify_clean = false;
+    }
+    g_stratum_clients.clear();
+    if (g_stratum_refresh) {
+        event_free(g_stratum_refresh);
+        g_stratum_refresh = nullptr;
+    }
+    if (g_stratum_notify) {
+        event_free(g_stratum_notify);
+        g_stratum_notify = nullptr;
+    }
+    if (g_stratum_base) {
+        event_base_free(g_stratum_base);
+        g_stratum_base = nullptr;
+    }
+    g_stratum_node = nullptr;
+}
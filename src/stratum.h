@@ -0,0 +1,38 @@
+// Copyright (c) 2021 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_STRATUM_H
+#define BITCOIN_STRATUM_H
+
+#include <stdint.h>
+
+struct NodeContext;
+
+static const bool DEFAULT_STRATUM = false;
+static const uint16_t DEFAULT_STRATUM_PORT = 3333;
+static const int DEFAULT_STRATUM_THREADS = 4;
+static const int64_t DEFAULT_STRATUM_DIFFICULTY = 1;
+/** Seconds between job updates for new mempool transactions */
+static const int64_t DEFAULT_STRATUM_JOB_INTERVAL = 30;
+
+/**
+ * The stratum work server pushes jobs built from the node's block templates to
+ * connected miners, checks the shares they submit on a pool of verifier threads
+ * and submits the blocks found directly to validation.
+ *
+ * Share difficulty is relative to the chain's proof-of-work limit: a share meets
+ * difficulty d if its scrypt hash is at most powLimit / d.
+ */
+
+/** Initialize the stratum server: parse the options and bind the listening sockets.
+ * Returns false on failure, after reporting the error to the user. */
+bool InitStratumServer(NodeContext& node);
+/** Start the stratum event loop and share verifier threads. */
+void StartStratumServer();
+/** Stop accepting shares, so that no more blocks are submitted. */
+void InterruptStratumServer();
+/** Disconnect all miners and stop the stratum threads. */
+void StopStratumServer();
+
+#endif // BITCOIN_STRATUM_H
@@ -8,8 +8,11 @@
 
 #include <chain.h>
 #include <rpc/blockchain.h>
+#include <script/standard.h>
+#include <streams.h>
 #include <test/util/setup_common.h>
 #include <util/string.h>
+#include <validation.h>
 
 /* Equality between doubles is imprecise. Comparison should be done
  * with a small threshold of tolerance, rather than exact equality.
@@ -74,4 +77,49 @@ BOOST_AUTO_TEST_CASE(get_difficulty_for_very_high_target)
     TestDifficulty(0x12345678, 5913134931067755359633408.0);
 }
 
+BOOST_FIXTURE_TEST_CASE(block_response_cache, TestChain100Setup)
+{
+    const CBlockIndex* tip = WITH_LOCK(cs_main, return ::ChainActive().Tip());
+    const CBlockIndex* blockindex = tip->pprev;
+
+    // Unchanged blocks are served from the cache
+    auto hex = GetBlockResponse(blockindex, BlockResponseFormat::HEX);
+    BOOST_REQUIRE(hex);
+    BOOST_CHECK(GetBlockResponse(blockindex, BlockResponseFormat::HEX) == hex);
+    auto binary = GetBlockResponse(blockindex, BlockResponseFormat::BINARY);
+    BOOST_REQUIRE(binary);
+    BOOST_CHECK_EQUAL(HexStr(binary->data), hex->data);
+
+    CBlock block;
+    CDataStream ss(ParseHex(hex->data), SER_NETWORK, PROTOCOL_VERSION);
+    ss >> block;
+    BOOST_CHECK(block.GetHash() == blockindex->GetBlockHash());
+
+    // JSON responses match blockToJSON() at the tip they are served at
+    auto json = GetBlockResponse(blockindex, BlockResponseFormat::JSON);
+    BOOST_REQUIRE(json);
+    BOOST_CHECK(GetBlockResponse(blockindex, BlockResponseFormat::JSON) == json);
+    BOOST_CHECK(!blockToJSON(block, nullptr, blockindex).exists("confirmations"));
+    BOOST_CHECK_EQUAL(BlockResponseJSON(*json, tip, blockindex), blockToJSON(block, tip, blockindex).write());
+    auto details = GetBlockResponse(blockindex, BlockResponseFormat::JSON_TX_DETAILS);
+    BOOST_REQUIRE(details);
+    BOOST_CHECK_EQUAL(BlockResponseJSON(*details, tip, blockindex), blockToJSON(block, tip, blockindex, true).write());
+
+    // A new tip changes the confirmations, but the cached response is still used
+    CreateAndProcessBlock({}, GetScriptForRawPubKey(coinbaseKey.GetPubKey()));
+    const CBlockIndex* new_tip = WITH_LOCK(cs_main, return ::ChainActive().Tip());
+    BOOST_CHECK(new_tip != tip);
+    BOOST_CHECK(GetBlockResponse(blockindex, BlockResponseFormat::JSON) == json);
+    UniValue result;
+    BOOST_REQUIRE(result.read(BlockResponseJSON(*json, new_tip, blockindex)));
+    BOOST_CHECK_EQUAL(result["confirmations"].get_int(), 3);
+    BOOST_CHECK_EQUAL(result["nextblockhash"].get_str(), tip->GetBlockHash().GetHex());
+    BOOST_CHECK_EQUAL(BlockResponseJSON(*json, new_tip, blockindex), blockToJSON(block, new_tip, blockindex).write());
+
+    // With the cache disabled every call builds a new response
+    SetBlockResponseCacheSize(0);
+    BOOST_CHECK(GetBlockResponse(blockindex, BlockResponseFormat::HEX) != hex);
+    SetBlockResponseCacheSize(DEFAULT_RPC_BLOCK_CACHE_SIZE << 20);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -12,6 +12,8 @@
 #include <univalue.h>
 #include <util/strencodings.h>
 
+#include <test_framework/TxBuilder.h>
+
 #include <boost/test/unit_test.hpp>
 
 BOOST_AUTO_TEST_SUITE(blockfilter_tests)
@@ -125,6 +127,37 @@ BOOST_AUTO_TEST_CASE(blockfilter_basic_test)
     BOOST_CHECK(default_ctor_block_filter_1.GetEncodedFilter() == default_ctor_block_filter_2.GetEncodedFilter());
 }
 
+BOOST_AUTO_TEST_CASE(blockfilter_mweb_test)
+{
+    // Blocks without MWEB data have empty MWEB filters
+    CBlock block;
+    BlockFilter empty_filter(BlockFilterType::MWEB, block, CBlockUndo());
+    BOOST_CHECK_EQUAL(empty_filter.GetFilter().GetN(), 0U);
+
+    test::Tx tx = test::TxBuilder()
+        .AddInput(5'000'000)
+        .AddOutput(3'000'000)
+        .AddOutput(1'000'000)
+        .AddPlainKernel(1'000'000)
+        .Build();
+    block.mweb_block = MWEB::Block(std::make_shared<mw::Block>(nullptr, tx.GetTransaction()->GetBody()));
+
+    BlockFilter filter(BlockFilterType::MWEB, block, CBlockUndo());
+    const GCSFilter& gcs_filter = filter.GetFilter();
+    BOOST_CHECK_EQUAL(gcs_filter.GetN(), 3U);
+    for (const Output& output : tx.GetTransaction()->GetOutputs()) {
+        BOOST_CHECK(gcs_filter.Match(MWEBFilterElement(output.GetOutputID())));
+    }
+    for (const Input& input : tx.GetTransaction()->GetInputs()) {
+        BOOST_CHECK(gcs_filter.Match(MWEBFilterElement(input.GetOutputID())));
+    }
+    BOOST_CHECK(!gcs_filter.Match(MWEBFilterElement(mw::Hash(InsecureRand256().begin()))));
+
+    // Round-trip through the filter's encoding
+    BlockFilter decoded(BlockFilterType::MWEB, filter.GetBlockHash(), filter.GetEncodedFilter());
+    BOOST_CHECK(decoded.GetFilter().Match(MWEBFilterElement(tx.GetTransaction()->GetOutputs().front().GetOutputID())));
+}
+
 BOOST_AUTO_TEST_CASE(blockfilters_json_test)
 {
     UniValue json;
@@ -182,11 +215,14 @@ BOOST_AUTO_TEST_CASE(blockfilters_json_test)
 BOOST_AUTO_TEST_CASE(blockfilter_type_names)
 {
     BOOST_CHECK_EQUAL(BlockFilterTypeName(BlockFilterType::BASIC), "basic");
+    BOOST_CHECK_EQUAL(BlockFilterTypeName(BlockFilterType::MWEB), "mweb");
     BOOST_CHECK_EQUAL(BlockFilterTypeName(static_cast<BlockFilterType>(255)), "");
 
     BlockFilterType filter_type;
     BOOST_CHECK(BlockFilterTypeByName("basic", filter_type));
     BOOST_CHECK_EQUAL(filter_type, BlockFilterType::BASIC);
+    BOOST_CHECK(BlockFilterTypeByName("mweb", filter_type));
+    BOOST_CHECK_EQUAL(filter_type, BlockFilterType::MWEB);
 
     BOOST_CHECK(!BlockFilterTypeByName("unknown", filter_type));
 }
@@ -57,6 +57,22 @@ struct FailingCheck {
     };
 };
 
+struct FailingIdCheck {
+    size_t check_id;
+    bool fails;
+    FailingIdCheck(size_t check_id_in, bool fails_in) : check_id(check_id_in), fails(fails_in){};
+    FailingIdCheck() : check_id(0), fails(false){};
+    bool operator()()
+    {
+        return !fails;
+    }
+    void swap(FailingIdCheck& x)
+    {
+        std::swap(check_id, x.check_id);
+        std::swap(fails, x.fails);
+    };
+};
+
 struct UniqueCheck {
     static Mutex m;
     static std::unordered_multiset<size_t> results GUARDED_BY(m);
@@ -137,6 +153,7 @@ std::atomic<size_t> MemoryCheck::fake_allocated_memory{0};
 typedef CCheckQueue<FakeCheckCheckCompletion> Correct_Queue;
 typedef CCheckQueue<FakeCheck> Standard_Queue;
 typedef CCheckQueue<FailingCheck> Failing_Queue;
+typedef CCheckQueue<FailingIdCheck> FailingId_Queue;
 typedef CCheckQueue<UniqueCheck> Unique_Queue;
 typedef CCheckQueue<MemoryCheck> Memory_Queue;
 typedef CCheckQueue<FrozenCleanupCheck> FrozenCleanup_Queue;
@@ -240,6 +257,43 @@ BOOST_AUTO_TEST_CASE(test_CheckQueue_Catches_Failure)
     tg.interrupt_all();
     tg.join_all();
 }
+// Test that the check that failed is handed back, and not kept for later runs
+BOOST_AUTO_TEST_CASE(test_CheckQueue_Returns_Failed_Check)
+{
+    auto fail_queue = MakeUnique<FailingId_Queue>(QUEUE_BATCH_SIZE);
+
+    boost::thread_group tg;
+    for (auto x = 0; x < SCRIPT_CHECK_THREADS; ++x) {
+       tg.create_thread([&]{fail_queue->Thread();});
+    }
+
+    for (size_t i = 0; i < 100; ++i) {
+        const size_t fail_id = InsecureRandRange(1000);
+        {
+            CCheckQueueControl<FailingIdCheck> control(fail_queue.get());
+            std::vector<FailingIdCheck> vChecks;
+            for (size_t id = 0; id < 1000; ++id) {
+                vChecks.emplace_back(id, id == fail_id);
+            }
+            control.Add(vChecks);
+            FailingIdCheck failed;
+            BOOST_REQUIRE(!control.Wait(&failed));
+            BOOST_REQUIRE(failed.fails);
+            BOOST_REQUIRE_EQUAL(failed.check_id, fail_id);
+        }
+        {
+            CCheckQueueControl<FailingIdCheck> control(fail_queue.get());
+            std::vector<FailingIdCheck> vChecks(100);
+            control.Add(vChecks);
+            FailingIdCheck failed;
+            BOOST_REQUIRE(control.Wait(&failed));
+            BOOST_REQUIRE(!failed.fails);
+        }
+    }
+    tg.interrupt_all();
+    tg.join_all();
+}
+
 // Test that a block validation which fails does not interfere with
 // future blocks, ie, the bad state is cleared.
 BOOST_AUTO_TEST_CASE(test_CheckQueue_Recovers_From_Failure)
@@ -913,4 +913,37 @@ BOOST_AUTO_TEST_CASE(ccoins_write)
                     CheckWriteCoins(parent_value, child_value, parent_value, parent_flags, child_flags, parent_flags);
 }
 
+static void CheckAddFetchedCoin(CAmount cache_value, CAmount fetched_value, CAmount expected_value, char cache_flags, char expected_flags)
+{
+    SingleEntryCacheTest test(ABSENT, cache_value, cache_flags);
+    std::vector<std::pair<COutPoint, Coin>> fetched;
+    Coin coin;
+    SetCoinsValue(fetched_value, coin);
+    fetched.emplace_back(OUTPOINT, std::move(coin));
+    test.cache.AddFetchedCoins(std::move(fetched));
+    test.cache.SelfTest();
+
+    CAmount result_value;
+    char result_flags;
+    GetCoinsMapEntry(test.cache.map(), result_value, result_flags);
+    BOOST_CHECK_EQUAL(result_value, expected_value);
+    BOOST_CHECK_EQUAL(result_flags, expected_flags);
+}
+
+BOOST_AUTO_TEST_CASE(ccoins_add_fetched)
+{
+    /* Check AddFetchedCoins behavior, adding a coin read from the base view to
+     * the cache, and checking the resulting entry in the cache. Existing entries
+     * are never replaced.
+     *
+     *                   Cache   Fetched Result  Cache        Result
+     *                   Value   Value   Value   Flags        Flags
+     */
+    CheckAddFetchedCoin(ABSENT, VALUE1, VALUE1, NO_ENTRY   , 0          );
+    CheckAddFetchedCoin(ABSENT, SPENT , ABSENT, NO_ENTRY   , NO_ENTRY   );
+    for (const CAmount cache_value : {SPENT, VALUE2})
+        for (const char cache_flags : FLAGS)
+            CheckAddFetchedCoin(cache_value, VALUE1, cache_value, cache_flags, cache_flags);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
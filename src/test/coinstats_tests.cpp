@@ -0,0 +1,90 @@
+// Copyright (c) 2021 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <chain.h>
+#include <node/coinstats.h>
+
+#include <test_framework/Miner.h>
+#include <test_framework/TestMWEB.h>
+#include <test_framework/TxBuilder.h>
+
+#include <algorithm>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(coinstats_tests, MWEBTestingSetup)
+
+BOOST_AUTO_TEST_CASE(check_mweb_sums)
+{
+    test::Miner miner(GetDataDir());
+
+    // Block 1 - 1 pegin
+    test::Tx pegin_tx = test::Tx::CreatePegIn(5'000'000);
+    const test::MinedBlock block1 = miner.MineBlock(1, {pegin_tx});
+
+    // Block 2 - spends the pegin output, pegs out one of the new outputs and pegs in again
+    test::Tx standard_tx = test::TxBuilder()
+        .AddInput(pegin_tx.GetOutputs().front())
+        .AddOutput(2'500'000).AddOutput(2'000'000)
+        .AddPlainKernel(500'000)
+        .Build();
+    test::Tx pegin_tx2 = test::Tx::CreatePegIn(3'000'000);
+    test::Tx pegout_tx = test::Tx::CreatePegOut(standard_tx.GetOutputs()[1], 100'000);
+    const test::MinedBlock block2 = miner.MineBlock(2, {standard_tx, pegin_tx2, pegout_tx});
+
+    // The pegout has no outputs, so the UTXO set holds the other two new outputs
+    std::vector<Commitment> utxo_commitments{
+        standard_tx.GetOutputs()[0].GetCommitment(),
+        pegin_tx2.GetOutputs().front().GetCommitment()
+    };
+    std::vector<Kernel> kernels = block1.GetBlock()->GetKernels();
+    kernels.insert(kernels.end(), block2.GetBlock()->GetKernels().cbegin(), block2.GetBlock()->GetKernels().cend());
+
+    CBlockIndex index;
+    index.mweb_header = block2.GetHeader();
+    index.mweb_amount = 0;
+    for (const Kernel& kernel : kernels) {
+        index.mweb_amount += kernel.GetSupplyChange();
+    }
+    BOOST_CHECK_EQUAL(index.mweb_amount, 5'000'000 - 500'000 + 3'000'000 - 2'000'000);
+    BOOST_CHECK(CheckMWEBSums(&index, utxo_commitments, kernels));
+
+    // A missing UTXO
+    std::vector<Commitment> missing_utxo(utxo_commitments.begin() + 1, utxo_commitments.end());
+    BOOST_CHECK(!CheckMWEBSums(&index, missing_utxo, kernels));
+
+    // An extra UTXO
+    std::vector<Commitment> extra_utxo = utxo_commitments;
+    extra_utxo.push_back(pegin_tx.GetOutputs().front().GetCommitment());
+    BOOST_CHECK(!CheckMWEBSums(&index, extra_utxo, kernels));
+
+    // A UTXO swapped for one of another value
+    std::vector<Commitment> tampered_utxo = utxo_commitments;
+    tampered_utxo[0] = standard_tx.GetOutputs()[1].GetCommitment();
+    BOOST_CHECK(!CheckMWEBSums(&index, tampered_utxo, kernels));
+
+    // A missing kernel changes the supply
+    std::vector<Kernel> missing_kernel(kernels.begin(), kernels.end() - 1);
+    BOOST_CHECK(!CheckMWEBSums(&index, utxo_commitments, missing_kernel));
+
+    // A kernel swapped for one with the same supply change but another excess
+    std::vector<Kernel> tampered_kernel = kernels;
+    const Kernel& pegin_kernel2 = pegin_tx2.GetKernels().front();
+    auto iter = std::find(tampered_kernel.begin(), tampered_kernel.end(), pegin_kernel2);
+    BOOST_REQUIRE(iter != tampered_kernel.end());
+    *iter = test::Tx::CreatePegIn(3'000'000).GetKernels().front();
+    BOOST_CHECK(!CheckMWEBSums(&index, utxo_commitments, tampered_kernel));
+
+    // Kernels that pay out more than was pegged in so far
+    std::vector<Kernel> reordered_kernels = kernels;
+    std::reverse(reordered_kernels.begin(), reordered_kernels.end());
+    std::stable_partition(reordered_kernels.begin(), reordered_kernels.end(), [](const Kernel& kernel) { return kernel.GetSupplyChange() < 0; });
+    BOOST_CHECK(!CheckMWEBSums(&index, utxo_commitments, reordered_kernels));
+
+    // A recorded MWEB amount that the kernels don't account for
+    index.mweb_amount += 1;
+    BOOST_CHECK(!CheckMWEBSums(&index, utxo_commitments, kernels));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -2,11 +2,16 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 #include <boost/test/unit_test.hpp>
+#include <clientversion.h>
 #include <cuckoocache.h>
 #include <deque>
+#include <fs.h>
 #include <random.h>
 #include <script/sigcache.h>
+#include <streams.h>
 #include <test/util/setup_common.h>
+#include <util/system.h>
+#include <set>
 #include <thread>
 
 /** Test Suite for CuckooCache
@@ -363,4 +368,71 @@ BOOST_AUTO_TEST_CASE(cuckoocache_generations)
     test_cache_generations<CuckooCache::cache<uint256, SignatureCacheHasher>>();
 }
 
+/* Test that for_each visits exactly the elements that are stored and not
+ * erased.
+ */
+BOOST_AUTO_TEST_CASE(cuckoocache_for_each)
+{
+    SeedInsecureRand(SeedRand::ZEROS);
+    CuckooCache::cache<uint256, SignatureCacheHasher> cc{};
+    cc.setup_bytes(1 << 20);
+    std::vector<uint256> hashes;
+    for (int x = 0; x < 1000; ++x) {
+        hashes.push_back(InsecureRand256());
+        cc.insert(hashes.back());
+    }
+    for (int x = 0; x < 500; ++x) {
+        cc.contains(hashes[x], true);
+    }
+
+    std::set<uint256> visited;
+    cc.for_each([&visited](const uint256& e) { BOOST_CHECK(visited.insert(e).second); });
+    BOOST_CHECK_EQUAL(visited.size(), 500U);
+    for (int x = 500; x < 1000; ++x) {
+        BOOST_CHECK(visited.count(hashes[x]));
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE(salted_cache_file, BasicTestingSetup)
+{
+    const fs::path path = GetDataDir() / "cache.dat";
+    const uint256 nonce = InsecureRand256();
+    std::vector<uint256> entries;
+    for (int x = 0; x < 10000; ++x) {
+        entries.push_back(InsecureRand256());
+    }
+    BOOST_CHECK(DumpSaltedCacheEntries(path, nonce, entries));
+
+    uint256 read_nonce;
+    BOOST_CHECK(ReadSaltedCacheNonce(path, read_nonce));
+    BOOST_CHECK(read_nonce == nonce);
+
+    // Entries are read back in order, in batches
+    std::vector<uint256> loaded;
+    size_t batches = 0;
+    BOOST_CHECK(LoadSaltedCacheEntries(path, nonce, [&](const std::vector<uint256>& batch) {
+        loaded.insert(loaded.end(), batch.begin(), batch.end());
+        ++batches;
+    }));
+    BOOST_CHECK(loaded == entries);
+    BOOST_CHECK(batches > 1);
+
+    // Entries salted with another nonce are not loaded
+    loaded.clear();
+    BOOST_CHECK(!LoadSaltedCacheEntries(path, InsecureRand256(), [&](const std::vector<uint256>& batch) {
+        loaded.insert(loaded.end(), batch.begin(), batch.end());
+    }));
+    BOOST_CHECK(loaded.empty());
+
+    BOOST_CHECK(!ReadSaltedCacheNonce(GetDataDir() / "missing.dat", read_nonce));
+
+    // A cache saved by another client version is discarded
+    {
+        CAutoFile file(fsbridge::fopen(path, "wb"), SER_DISK, CLIENT_VERSION);
+        file << uint64_t{2} << int32_t{CLIENT_VERSION + 1} << nonce << uint64_t{0};
+    }
+    BOOST_CHECK(!ReadSaltedCacheNonce(path, read_nonce));
+    BOOST_CHECK(!fs::exists(path));
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -3,10 +3,12 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include <dbwrapper.h>
+#include <test/util/dbengine.h>
 #include <test/util/setup_common.h>
 #include <uint256.h>
 #include <util/memory.h>
 
+#include <algorithm>
 #include <memory>
 
 #include <boost/test/unit_test.hpp>
@@ -399,6 +401,119 @@ BOOST_AUTO_TEST_CASE(iterator_string_ordering)
     }
 }
 
+BOOST_AUTO_TEST_CASE(map_engine)
+{
+    fs::path ph = GetDataDir() / "map_engine";
+    CDBWrapper leveldb(ph, (1 << 20), true, false, true);
+    CDBWrapper map(MakeUnique<MapDBEngine>(), "map", true);
+    BOOST_CHECK(!is_null_key(dbwrapper_private::GetObfuscateKey(map)));
+
+    // Both engines order and erase keys alike
+    for (CDBWrapper* dbw : {&leveldb, &map}) {
+        CDBBatch batch(*dbw);
+        for (int x = 0; x < 1000; ++x) {
+            batch.Write(std::make_pair('t', x), uint32_t(x * x));
+        }
+        BOOST_CHECK(dbw->WriteBatch(batch));
+        BOOST_CHECK(dbw->Erase(std::make_pair('t', 500)));
+    }
+
+    std::unique_ptr<CDBIterator> it_leveldb(leveldb.NewIterator());
+    std::unique_ptr<CDBIterator> it_map(map.NewIterator());
+
+    // Like LevelDB iterators, the iterator doesn't see later writes
+    BOOST_CHECK(map.Write(std::make_pair('t', 500), uint32_t(0)));
+
+    it_leveldb->Seek(std::make_pair('t', 0));
+    it_map->Seek(std::make_pair('t', 0));
+    int count = 0;
+    for (; it_leveldb->Valid(); it_leveldb->Next(), it_map->Next(), ++count) {
+        BOOST_REQUIRE(it_map->Valid());
+        std::pair<char, int> key_leveldb, key_map;
+        uint32_t value_leveldb, value_map;
+        BOOST_REQUIRE(it_leveldb->GetKey(key_leveldb) && it_map->GetKey(key_map));
+        BOOST_REQUIRE(it_leveldb->GetValue(value_leveldb) && it_map->GetValue(value_map));
+        BOOST_CHECK(key_leveldb == key_map);
+        BOOST_CHECK_EQUAL(value_leveldb, value_map);
+    }
+    BOOST_CHECK(!it_map->Valid());
+    BOOST_CHECK_EQUAL(count, 999);
+
+    uint32_t value;
+    BOOST_CHECK(map.Read(std::make_pair('t', 500), value));
+    BOOST_CHECK_EQUAL(value, 0U);
+    BOOST_CHECK(!map.Exists(std::make_pair('u', 0)));
+    BOOST_CHECK_EQUAL(map.GetStats().engine, "map");
+    BOOST_CHECK_EQUAL(map.GetStats().reads, 3U);
+}
+
+BOOST_AUTO_TEST_CASE(db_options)
+{
+    ArgsManager args;
+    const auto parse = [&](std::vector<const char*> argv) {
+        args.ClearArgs();
+        args.AddArg("-dboption=<db>:<option>=<value>", "", ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+        argv.insert(argv.begin(), "ignored");
+        std::string error;
+        BOOST_REQUIRE(args.ParseParameters(argv.size(), argv.data(), error));
+    };
+
+    parse({"-dboption=chainstate:bloombits=0", "-dboption=chainstate:blocksize=16",
+           "-dboption=txindex:maxfilesize=32", "-dboption=chainstate:blockcachepercent=80"});
+    DBOptions options;
+    std::string error;
+    BOOST_CHECK(ReadDBOptions(args, "chainstate", options, error));
+    BOOST_CHECK_EQUAL(options.bloom_bits, 0);
+    BOOST_CHECK_EQUAL(options.block_size, 16U << 10);
+    BOOST_CHECK_EQUAL(options.max_file_size, DBOptions{}.max_file_size);
+    BOOST_CHECK_EQUAL(options.block_cache_percent, 80);
+    options = DBOptions{};
+    BOOST_CHECK(ReadDBOptions(args, "txindex", options, error));
+    BOOST_CHECK_EQUAL(options.max_file_size, 32U << 20);
+    BOOST_CHECK_EQUAL(options.bloom_bits, DBOptions{}.bloom_bits);
+
+    for (const char* invalid : {"-dboption=chainstate", "-dboption=chainstate:bloombits", "-dboption=chainstate:bloombits=x",
+                                "-dboption=chainstate:bloom=10", "-dboption=chainstate:bloombits=65",
+                                "-dboption=txindex:blockcachepercent=100"}) {
+        parse({invalid});
+        BOOST_CHECK(!ReadDBOptions(args, "chainstate", options, error));
+        BOOST_CHECK(!error.empty());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(db_stats)
+{
+    fs::path ph = GetDataDir() / "db_stats";
+    CDBWrapper dbw(ph, (1 << 20), true, false, false, "stats");
+    // Each round writes the write buffer to a table file. The first file is put
+    // in a level below that is free, and the second one is compacted into it.
+    for (int round = 0; round < 2; ++round) {
+        for (int x = 0; x < 1000; ++x) {
+            BOOST_CHECK(dbw.Write(x, uint256{}));
+        }
+        dbw.CompactRange(0, 1000);
+    }
+    uint256 value;
+    for (int x = 0; x < 1000; ++x) {
+        BOOST_CHECK(dbw.Read(x, value));
+    }
+
+    const DBStats stats = dbw.GetStats();
+    BOOST_CHECK_EQUAL(stats.engine, "leveldb");
+    // The obfuscation key is read when opening
+    BOOST_CHECK_EQUAL(stats.reads, 1001U);
+    BOOST_CHECK_GE(stats.block_cache_hits + stats.block_cache_misses, 1000U);
+    BOOST_CHECK_GT(stats.block_cache_hits, stats.block_cache_misses);
+    BOOST_CHECK_GE(stats.memtable_flushes, 2U);
+    BOOST_CHECK_GE(stats.compactions, 1U);
+    BOOST_REQUIRE(!stats.levels.empty());
+    BOOST_CHECK(std::any_of(stats.levels.begin(), stats.levels.end(), [](const DBStats::Level& level) { return level.files > 0; }));
+
+    int found = 0;
+    ForEachDBWrapper([&](const CDBWrapper& db) { found += db.GetName() == "stats"; });
+    BOOST_CHECK_EQUAL(found, 1);
+}
+
 BOOST_AUTO_TEST_CASE(unicodepath)
 {
     // Attempt to create a database with a UTF8 character in the path.
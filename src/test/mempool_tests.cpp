@@ -2,15 +2,27 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
+#include <arith_uint256.h>
+#include <blockencodings.h>
+#include <chainparams.h>
+#include <consensus/merkle.h>
+#include <consensus/validation.h>
+#include <core_memusage.h>
 #include <policy/policy.h>
+#include <pow.h>
 #include <primitives/block.h>
+#include <script/standard.h>
 #include <txmempool.h>
 #include <util/system.h>
 #include <util/time.h>
+#include <validation.h>
 
 #include <test/util/setup_common.h>
+#include <test_framework/TxBuilder.h>
 
 #include <boost/test/unit_test.hpp>
+
+#include <algorithm>
 #include <vector>
 
 BOOST_FIXTURE_TEST_SUITE(mempool_tests, TestingSetup)
@@ -421,6 +433,34 @@ BOOST_AUTO_TEST_CASE(MempoolAncestorIndexingTest)
     CheckSort<ancestor_score>(pool, sortedOrder);
 }
 
+BOOST_AUTO_TEST_CASE(MempoolAncestorScoreMWEBTest)
+{
+    CTxMemPool pool;
+    LOCK2(cs_main, pool.cs);
+    TestMemPoolEntryHelper entry;
+
+    CMutableTransaction plain_tx;
+    plain_tx.vout.resize(1);
+    plain_tx.vout[0].scriptPubKey = CScript() << OP_11 << OP_EQUAL;
+    plain_tx.vout[0].nValue = 10 * COIN;
+    CTxMemPoolEntry plain_entry = entry.Fee(10000LL).FromTx(plain_tx);
+
+    CMutableTransaction mweb_only_tx;
+    mweb_only_tx.mweb_tx = MWEB::Tx(test::TxBuilder().AddInput(20).AddOutput(15).AddPlainKernel(5).Build().GetTransaction());
+    const CTxMemPoolEntry mweb_size_entry = entry.FromTx(mweb_only_tx);
+    BOOST_REQUIRE(mweb_size_entry.GetMWEBWeight() > 0);
+
+    // The MWEB-only tx pays more per vbyte than the plain tx, but less once its
+    // MWEB weight is counted, so it's sorted after it
+    const CAmount mweb_fee = 10000LL * (mweb_size_entry.GetTxSize() + mweb_size_entry.GetMWEBWeight() * MWEB_WEIGHT_PACKING_VSIZE / 2) / plain_entry.GetTxSize();
+    BOOST_CHECK_GT(mweb_fee * plain_entry.GetTxSize(), 10000LL * mweb_size_entry.GetTxSize());
+    pool.addUnchecked(plain_entry);
+    pool.addUnchecked(entry.Fee(mweb_fee).FromTx(mweb_only_tx));
+
+    std::vector<std::string> sortedOrder{plain_tx.GetHash().ToString(), mweb_only_tx.GetHash().ToString()};
+    CheckSort<ancestor_score>(pool, sortedOrder);
+}
+
 
 BOOST_AUTO_TEST_CASE(MempoolSizeLimitTest)
 {
@@ -789,4 +829,172 @@ BOOST_AUTO_TEST_CASE(MempoolAncestryTests)
     BOOST_CHECK_EQUAL(descendants, 4ULL);
 }
 
+BOOST_AUTO_TEST_CASE(MempoolBlockTxTest)
+{
+    TestMemPoolEntryHelper entry;
+
+    // Plain transactions are included in blocks as-is
+    CMutableTransaction plain_tx;
+    plain_tx.vin.resize(1);
+    plain_tx.vin[0].scriptSig = CScript() << OP_11;
+    plain_tx.vout.resize(1);
+    plain_tx.vout[0].scriptPubKey = CScript() << OP_11 << OP_EQUAL;
+    plain_tx.vout[0].nValue = 10 * COIN;
+    CTransactionRef plain_ref = MakeTransactionRef(plain_tx);
+    BOOST_CHECK(entry.FromTx(plain_ref).GetBlockTx() == plain_ref);
+
+    // Peg-in transactions are included in blocks without their MWEB data, which isn't
+    // committed to by the wtxid
+    test::Tx pegin = test::Tx::CreatePegIn(10 * COIN);
+    CMutableTransaction pegin_tx;
+    pegin_tx.vin.resize(1);
+    pegin_tx.vin[0].scriptSig = CScript() << OP_11;
+    pegin_tx.vout.resize(1);
+    pegin_tx.vout[0].scriptPubKey = GetScriptForPegin(pegin.GetPegInCoin().GetKernelID());
+    pegin_tx.vout[0].nValue = 10 * COIN;
+    pegin_tx.mweb_tx = MWEB::Tx(pegin.GetTransaction());
+    CTransactionRef pegin_ref = MakeTransactionRef(pegin_tx);
+
+    CTxMemPoolEntry pegin_entry = entry.FromTx(pegin_ref);
+    CTransactionRef block_tx = pegin_entry.GetBlockTx();
+    BOOST_REQUIRE(block_tx);
+    BOOST_CHECK(!block_tx->HasMWEBTx());
+    BOOST_CHECK(block_tx->GetHash() == pegin_ref->GetHash());
+    BOOST_CHECK(block_tx->GetWitnessHash() == pegin_ref->GetWitnessHash());
+    BOOST_CHECK(pegin_entry.DynamicMemoryUsage() > RecursiveDynamicUsage(pegin_ref));
+
+    // MWEB-only transactions are aggregated into the extension block
+    CMutableTransaction mweb_only_tx;
+    mweb_only_tx.mweb_tx = MWEB::Tx(test::TxBuilder().AddInput(20).AddOutput(15).AddPlainKernel(5).Build().GetTransaction());
+    BOOST_CHECK(entry.FromTx(mweb_only_tx).GetBlockTx() == nullptr);
+}
+
+BOOST_FIXTURE_TEST_CASE(MempoolBlockReconstructionTest, RegTestingSetup)
+{
+    TestMemPoolEntryHelper entry;
+    CTxMemPool pool;
+
+    test::Tx pegin = test::Tx::CreatePegIn(10 * COIN);
+    CMutableTransaction pegin_tx;
+    pegin_tx.vin.resize(1);
+    pegin_tx.vin[0].prevout = COutPoint(InsecureRand256(), 0);
+    pegin_tx.vout.resize(1);
+    pegin_tx.vout[0].scriptPubKey = GetScriptForPegin(pegin.GetPegInCoin().GetKernelID());
+    pegin_tx.vout[0].nValue = 10 * COIN;
+    pegin_tx.mweb_tx = MWEB::Tx(pegin.GetTransaction());
+    CTransactionRef pegin_ref = MakeTransactionRef(pegin_tx);
+    {
+        LOCK2(cs_main, pool.cs);
+        pool.addUnchecked(entry.FromTx(pegin_ref));
+    }
+
+    CMutableTransaction coinbase_tx;
+    coinbase_tx.vin.resize(1);
+    coinbase_tx.vin[0].scriptSig = CScript() << OP_1 << OP_1;
+    coinbase_tx.vout.resize(1);
+    coinbase_tx.vout[0].nValue = 42;
+
+    CBlock block;
+    block.nVersion = 1;
+    block.hashPrevBlock = InsecureRand256();
+    block.nBits = UintToArith256(Params().GetConsensus().powLimit).GetCompact();
+    block.vtx = {MakeTransactionRef(coinbase_tx), pegin_ref};
+
+    // A block containing the mempool tx as-is, with its MWEB data, is rejected as mutated
+    BlockValidationState state;
+    block.hashMerkleRoot = BlockMerkleRoot(block);
+    while (!CheckProofOfWork(block.GetPoWHash(), block.nBits, Params().GetConsensus())) ++block.nNonce;
+    BOOST_CHECK(!CheckBlock(block, state, Params().GetConsensus()));
+    BOOST_CHECK_EQUAL(state.GetRejectReason(), "unexpected-mweb-data");
+
+    block.vtx[1] = GetBlockTransaction(pegin_ref);
+    block.hashMerkleRoot = BlockMerkleRoot(block);
+    while (!CheckProofOfWork(block.GetPoWHash(), block.nBits, Params().GetConsensus())) ++block.nNonce;
+
+    // The peg-in tx is matched by its wtxid, and the block is reconstructed with the stripped tx
+    CBlockHeaderAndShortTxIDs cmpctblock(block, true);
+    PartiallyDownloadedBlock partial_block(&pool, cmpctblock.mweb_block);
+    BOOST_CHECK(partial_block.InitData(cmpctblock, {}) == READ_STATUS_OK);
+    BOOST_CHECK(partial_block.IsTxAvailable(1));
+
+    CBlock reconstructed;
+    BOOST_CHECK(partial_block.FillBlock(reconstructed, {}) == READ_STATUS_OK);
+    BOOST_CHECK(reconstructed.GetHash() == block.GetHash());
+    BOOST_CHECK(!reconstructed.vtx[1]->HasMWEBTx());
+}
+
+BOOST_AUTO_TEST_CASE(MempoolSnapshotTest)
+{
+    CTxMemPool pool;
+    TestMemPoolEntryHelper entry;
+
+    CMutableTransaction tx1;
+    tx1.vin.resize(1);
+    tx1.vin[0].scriptSig = CScript() << OP_11;
+    tx1.vout.resize(1);
+    tx1.vout[0].scriptPubKey = CScript() << OP_11 << OP_EQUAL;
+    tx1.vout[0].nValue = 10 * COIN;
+
+    CMutableTransaction tx2;
+    tx2.vin.resize(1);
+    tx2.vin[0].prevout = COutPoint(tx1.GetHash(), 0);
+    tx2.vin[0].scriptSig = CScript() << OP_11;
+    tx2.vout.resize(1);
+    tx2.vout[0].scriptPubKey = CScript() << OP_11 << OP_EQUAL;
+    tx2.vout[0].nValue = 9 * COIN;
+
+    {
+        LOCK2(cs_main, pool.cs);
+        pool.addUnchecked(entry.Fee(10000LL).FromTx(tx1));
+        pool.addUnchecked(entry.Fee(10000LL).FromTx(tx2));
+    }
+
+    const auto find_entry = [](const TxMempoolSnapshot& snapshot, const CMutableTransaction& tx) {
+        const auto it = std::find_if(snapshot.entries.begin(), snapshot.entries.end(),
+                                     [&](const TxMempoolEntryInfo& e) { return e.tx->GetHash() == tx.GetHash(); });
+        BOOST_REQUIRE(it != snapshot.entries.end());
+        return *it;
+    };
+
+    // Unchanged mempool hands out the same snapshot while it's in use
+    std::shared_ptr<const TxMempoolSnapshot> snapshot = pool.GetSnapshot();
+    BOOST_CHECK(pool.GetSnapshot() == snapshot);
+    BOOST_REQUIRE_EQUAL(snapshot->entries.size(), 2U);
+    {
+        LOCK(pool.cs);
+        BOOST_CHECK(snapshot->entries[0].tx->GetHash() == pool.mapTx.begin()->GetTx().GetHash());
+    }
+    BOOST_CHECK(find_entry(*snapshot, tx1).spent_by == std::vector<uint256>{tx2.GetHash()});
+    BOOST_CHECK(find_entry(*snapshot, tx2).depends == std::set<uint256>{tx1.GetHash()});
+    BOOST_CHECK_EQUAL(find_entry(*snapshot, tx2).count_with_ancestors, 2U);
+    BOOST_CHECK(!find_entry(*snapshot, tx2).unbroadcast);
+
+    // Fee deltas and unbroadcast changes invalidate it
+    pool.PrioritiseTransaction(tx2.GetHash(), 5000LL);
+    std::shared_ptr<const TxMempoolSnapshot> prioritised = pool.GetSnapshot();
+    BOOST_CHECK(prioritised != snapshot);
+    BOOST_CHECK_EQUAL(find_entry(*prioritised, tx2).modified_fee, 15000LL);
+    BOOST_CHECK_EQUAL(prioritised->sequence, snapshot->sequence);
+
+    pool.AddUnbroadcastTx(tx2.GetHash());
+    std::shared_ptr<const TxMempoolSnapshot> unbroadcast = pool.GetSnapshot();
+    BOOST_CHECK(unbroadcast != prioritised);
+    BOOST_CHECK(find_entry(*unbroadcast, tx2).unbroadcast);
+
+    {
+        LOCK(pool.cs);
+        pool.removeRecursive(CTransaction(tx1), MemPoolRemovalReason::REPLACED);
+    }
+    std::shared_ptr<const TxMempoolSnapshot> removed = pool.GetSnapshot();
+    BOOST_CHECK(removed->entries.empty());
+    BOOST_CHECK(removed->sequence > unbroadcast->sequence);
+
+    // The mempool doesn't keep a snapshot, and the transactions in it, alive once it's released
+    std::weak_ptr<const TxMempoolSnapshot> released = unbroadcast;
+    snapshot.reset();
+    prioritised.reset();
+    unbroadcast.reset();
+    BOOST_CHECK(released.expired());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,97 @@
+// Copyright (c) 2021 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <index/mwebindex.h>
+#include <streams.h>
+#include <test/util/setup_common.h>
+#include <util/time.h>
+#include <validation.h>
+#include <validationinterface.h>
+
+#include <test_framework/TxBuilder.h>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_SUITE(mwebindex_tests)
+
+BOOST_AUTO_TEST_CASE(mwebindex_pos_serialization)
+{
+    CDataStream ss(SER_DISK, CLIENT_VERSION);
+    ss << MWEBIndexPos(1000, 3);
+    BOOST_CHECK_EQUAL(ss.size(), 3U);
+
+    MWEBIndexPos pos;
+    BOOST_CHECK(pos.IsNull());
+    ss >> pos;
+    BOOST_CHECK_EQUAL(pos.nHeight, 1000);
+    BOOST_CHECK_EQUAL(pos.nIndex, 3U);
+}
+
+BOOST_FIXTURE_TEST_CASE(mwebindex_initial_sync, TestChain100Setup)
+{
+    MWEBIndex mwebindex(1 << 20, true);
+
+    // BlockUntilSyncedToCurrentChain should return false before mwebindex is started.
+    BOOST_CHECK(!mwebindex.BlockUntilSyncedToCurrentChain());
+
+    mwebindex.Start();
+
+    // Allow MWEB index to catch up with the block index.
+    constexpr int64_t timeout_ms = 10 * 1000;
+    int64_t time_start = GetTimeMillis();
+    while (!mwebindex.BlockUntilSyncedToCurrentChain()) {
+        BOOST_REQUIRE(time_start + timeout_ms > GetTimeMillis());
+        UninterruptibleSleep(std::chrono::milliseconds{100});
+    }
+
+    MWEBIndexPos pos;
+    const mw::Hash unknown_id(InsecureRand256().begin());
+    BOOST_CHECK(!mwebindex.FindKernel(unknown_id, pos));
+    BOOST_CHECK(!mwebindex.FindOutput(unknown_id, pos));
+    BOOST_CHECK(!mwebindex.FindSpend(unknown_id, pos));
+
+    // Connect a block with MWEB data on top of the tip.
+    test::Tx tx = test::TxBuilder()
+        .AddInput(5'000'000)
+        .AddOutput(3'000'000)
+        .AddOutput(1'000'000)
+        .AddPlainKernel(1'000'000)
+        .Build();
+    auto block = std::make_shared<CBlock>();
+    block->mweb_block = MWEB::Block(std::make_shared<mw::Block>(nullptr, tx.GetTransaction()->GetBody()));
+
+    CBlockIndex block_index;
+    block_index.pprev = WITH_LOCK(cs_main, return ::ChainActive().Tip());
+    block_index.nHeight = block_index.pprev->nHeight + 1;
+    GetMainSignals().BlockConnected(block, &block_index);
+    SyncWithValidationInterfaceQueue();
+
+    const mw::Block::CPtr& mweb_block = block->mweb_block.m_block;
+    for (size_t i = 0; i < mweb_block->GetKernels().size(); i++) {
+        BOOST_REQUIRE(mwebindex.FindKernel(mweb_block->GetKernels()[i].GetKernelID(), pos));
+        BOOST_CHECK_EQUAL(pos.nHeight, block_index.nHeight);
+        BOOST_CHECK_EQUAL(pos.nIndex, i);
+    }
+    for (size_t i = 0; i < mweb_block->GetOutputs().size(); i++) {
+        const mw::Hash& output_id = mweb_block->GetOutputs()[i].GetOutputID();
+        BOOST_REQUIRE(mwebindex.FindOutput(output_id, pos));
+        BOOST_CHECK_EQUAL(pos.nHeight, block_index.nHeight);
+        BOOST_CHECK_EQUAL(pos.nIndex, i);
+        BOOST_CHECK(!mwebindex.FindSpend(output_id, pos));
+    }
+    for (size_t i = 0; i < mweb_block->GetInputs().size(); i++) {
+        const mw::Hash& output_id = mweb_block->GetInputs()[i].GetOutputID();
+        BOOST_REQUIRE(mwebindex.FindSpend(output_id, pos));
+        BOOST_CHECK_EQUAL(pos.nHeight, block_index.nHeight);
+        BOOST_CHECK_EQUAL(pos.nIndex, i);
+    }
+
+    // shutdown sequence (c.f. Shutdown() in init.cpp)
+    mwebindex.Stop();
+
+    // Let scheduler events finish running to avoid accessing any memory related to mwebindex after it is destructed
+    SyncWithValidationInterfaceQueue();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -2,13 +2,17 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
+#include <clientversion.h>
 #include <policy/fees.h>
 #include <policy/policy.h>
+#include <streams.h>
 #include <txmempool.h>
 #include <uint256.h>
+#include <util/system.h>
 #include <util/time.h>
 
 #include <test/util/setup_common.h>
+#include <test_framework/TxBuilder.h>
 
 #include <boost/test/unit_test.hpp>
 
@@ -180,4 +184,61 @@ BOOST_AUTO_TEST_CASE(BlockPolicyEstimates)
     }
 }
 
+BOOST_AUTO_TEST_CASE(MWEBPolicyEstimates)
+{
+    CBlockPolicyEstimator feeEst;
+    CTxMemPool mpool(&feeEst);
+    LOCK2(cs_main, mpool.cs);
+    TestMemPoolEntryHelper entry;
+
+    CMutableTransaction tx;
+    tx.vin.resize(1);
+    tx.vout.resize(1);
+    tx.vout[0].nValue = 0;
+    const CAmount fee = 20000;
+    const CFeeRate feeRate(fee, GetVirtualTransactionSize(CTransaction(tx)), 0);
+
+    // MWEB-only transactions paying 5 times the minimum MWEB fee
+    const CAmount mwebFee = 5 * BASE_MWEB_FEE * 20;
+    CFeeRate mwebFeeRate;
+
+    CBlock block;
+    int blocknum = 0;
+    while (blocknum < 50) {
+        for (int k = 0; k < 4; k++) {
+            tx.vin[0].prevout.n = 100 * blocknum + k;
+            mpool.addUnchecked(entry.Fee(fee).Time(GetTime()).Height(blocknum).FromTx(tx));
+            block.vtx.push_back(mpool.get(tx.GetHash()));
+
+            CMutableTransaction mweb_tx;
+            mweb_tx.mweb_tx = MWEB::Tx(test::TxBuilder().AddInput(mwebFee + 5).AddOutput(5).AddPlainKernel(mwebFee).Build().GetTransaction());
+            BOOST_REQUIRE(CTransaction(mweb_tx).IsMWEBOnly());
+            const uint64_t weight = mweb_tx.mweb_tx.GetMWEBWeight();
+            mwebFeeRate = CFeeRate(mwebFee * 1000 / (CAmount)weight);
+            mpool.addUnchecked(entry.Fee(mwebFee).Time(GetTime()).Height(blocknum).FromTx(mweb_tx));
+            block.vtx.push_back(mpool.get(CTransaction(mweb_tx).GetHash()));
+        }
+        mpool.removeForBlock(block, ++blocknum, nullptr);
+        block.vtx.clear();
+    }
+
+    // Each kind of transaction only shows up in its own estimate
+    BOOST_CHECK_EQUAL(feeEst.estimateSmartFee(2, nullptr, false).GetFeePerK(), feeRate.GetFeePerK());
+    BOOST_CHECK_EQUAL(feeEst.estimateSmartMWEBFee(2, nullptr, false).GetFeePerK(), mwebFeeRate.GetFeePerK());
+
+    // Estimates survive a round trip through the estimates file
+    fs::path path = GetDataDir() / "fee_estimates.dat";
+    {
+        CAutoFile file(fsbridge::fopen(path, "wb"), SER_DISK, CLIENT_VERSION);
+        BOOST_REQUIRE(feeEst.Write(file));
+    }
+    CBlockPolicyEstimator readEst;
+    {
+        CAutoFile file(fsbridge::fopen(path, "rb"), SER_DISK, CLIENT_VERSION);
+        BOOST_REQUIRE(readEst.Read(file));
+    }
+    BOOST_CHECK_EQUAL(readEst.estimateSmartFee(2, nullptr, false).GetFeePerK(), feeRate.GetFeePerK());
+    BOOST_CHECK_EQUAL(readEst.estimateSmartMWEBFee(2, nullptr, false).GetFeePerK(), mwebFeeRate.GetFeePerK());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
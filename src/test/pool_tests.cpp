@@ -0,0 +1,123 @@
+// Copyright (c) 2021 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <memusage.h>
+#include <support/allocators/pool.h>
+#include <test/util/setup_common.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+BOOST_FIXTURE_TEST_SUITE(pool_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(basic_allocating)
+{
+    PoolResource<8, 8> resource(64);
+    BOOST_CHECK_EQUAL(resource.ChunkSizeBytes(), 64U);
+    BOOST_CHECK_EQUAL(resource.NumAllocatedChunks(), 0U);
+
+    // Blocks are handed out one after another from the chunk
+    void* block = resource.Allocate(8, 8);
+    BOOST_CHECK_EQUAL(resource.NumAllocatedChunks(), 1U);
+    void* next = resource.Allocate(8, 8);
+    BOOST_CHECK_EQUAL(static_cast<char*>(next) - static_cast<char*>(block), 8);
+
+    // A freed block is reused by the next allocation of its size, also when smaller
+    resource.Deallocate(block, 8, 8);
+    BOOST_CHECK_EQUAL(resource.Allocate(8, 8), block);
+    resource.Deallocate(block, 8, 8);
+    BOOST_CHECK_EQUAL(resource.Allocate(1, 1), block);
+
+    // Too large and overaligned blocks don't come from the pool
+    void* large = resource.Allocate(16, 8);
+    resource.Deallocate(large, 16, 8);
+    BOOST_CHECK_EQUAL(resource.NumAllocatedChunks(), 1U);
+
+    // A new chunk is allocated when the chunk is used up
+    for (int i = 0; i < 6; ++i) {
+        resource.Allocate(8, 8);
+    }
+    BOOST_CHECK_EQUAL(resource.NumAllocatedChunks(), 1U);
+    resource.Allocate(8, 8);
+    BOOST_CHECK_EQUAL(resource.NumAllocatedChunks(), 2U);
+}
+
+BOOST_AUTO_TEST_CASE(chunk_rest_is_reused)
+{
+    // 4 blocks of 16 bytes don't fit into 56, so 8 bytes are left over
+    PoolResource<16, 8> resource(56);
+    std::vector<void*> blocks;
+    for (int i = 0; i < 3; ++i) {
+        blocks.push_back(resource.Allocate(16, 8));
+    }
+    resource.Allocate(16, 8);
+    BOOST_CHECK_EQUAL(resource.NumAllocatedChunks(), 2U);
+    BOOST_CHECK_EQUAL(resource.Allocate(8, 8), static_cast<char*>(blocks.back()) + 16);
+}
+
+BOOST_AUTO_TEST_CASE(pooled_unordered_map)
+{
+    using Map = std::unordered_map<uint64_t, uint64_t, std::hash<uint64_t>, std::equal_to<uint64_t>,
+                                   PoolAllocator<std::pair<const uint64_t, uint64_t>, 64>>;
+    Map map;
+    for (uint64_t i = 0; i < 10000; ++i) {
+        map.emplace(i, i);
+    }
+    const auto* resource = map.get_allocator().resource();
+    const size_t chunks = resource->NumAllocatedChunks();
+    BOOST_CHECK_GT(chunks, 0U);
+    BOOST_CHECK_GE(memusage::DynamicUsage(map), chunks * resource->ChunkSizeBytes());
+
+    // Erased nodes are reused before a new chunk is allocated
+    for (uint64_t i = 0; i < 10000; ++i) {
+        map.erase(i);
+        map.emplace(i + 10000, i);
+    }
+    BOOST_CHECK_EQUAL(resource->NumAllocatedChunks(), chunks);
+
+    // The pool moves with the map
+    Map moved(std::move(map));
+    BOOST_CHECK_EQUAL(moved.get_allocator().resource(), resource);
+    BOOST_CHECK_EQUAL(moved.size(), 10000U);
+    BOOST_CHECK_EQUAL(moved.at(15000), 5000U);
+
+    // A new map gets a new pool
+    Map other;
+    BOOST_CHECK(other.get_allocator() != moved.get_allocator());
+}
+
+BOOST_AUTO_TEST_CASE(pooled_unordered_map_usage)
+{
+    // Blocks of up to 128 bytes are pooled, which includes bucket arrays of up to 16 buckets
+    using Map = std::unordered_map<uint64_t, uint64_t, std::hash<uint64_t>, std::equal_to<uint64_t>,
+                                   PoolAllocator<std::pair<const uint64_t, uint64_t>, 128>>;
+    Map map;
+    const auto* resource = map.get_allocator().resource();
+    const auto pool_usage = [&] {
+        const size_t chunk_usage = memusage::MallocUsage(resource->ChunkSizeBytes()) + memusage::MallocUsage(sizeof(void*) * 3);
+        return memusage::MallocUsage(sizeof(*resource)) + chunk_usage * resource->NumAllocatedChunks();
+    };
+
+    bool pooled_buckets{false};
+    bool allocated_buckets{false};
+    for (uint64_t i = 0; i < 100; ++i) {
+        map.emplace(i, i);
+        const size_t buckets_bytes = sizeof(void*) * map.bucket_count();
+        if (buckets_bytes <= 128) {
+            // The bucket array is in a chunk, so it's not counted twice
+            pooled_buckets |= map.bucket_count() > 1;
+            BOOST_CHECK_EQUAL(memusage::DynamicUsage(map), pool_usage());
+        } else {
+            allocated_buckets = true;
+            BOOST_CHECK_EQUAL(memusage::DynamicUsage(map), pool_usage() + memusage::MallocUsage(buckets_bytes));
+        }
+    }
+    BOOST_CHECK(pooled_buckets);
+    BOOST_CHECK(allocated_buckets);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -12,6 +12,7 @@
 #include <test/util/setup_common.h>
 #include <util/ref.h>
 #include <util/time.h>
+#include <validation.h>
 
 #include <boost/algorithm/string.hpp>
 #include <boost/test/unit_test.hpp>
@@ -424,4 +425,37 @@ BOOST_AUTO_TEST_CASE(rpc_getblockstats_calculate_percentiles_by_weight)
     }
 }
 
+BOOST_AUTO_TEST_CASE(rpc_getblock_raw_result)
+{
+    const std::string hash = CallRPC("getblockhash 0").get_str();
+
+    // In-process callers get a UniValue object
+    const UniValue block = CallRPC("getblock " + hash);
+    BOOST_CHECK(block.isObject());
+    BOOST_CHECK_EQUAL(find_value(block, "hash").get_str(), hash);
+
+    // Callers that take raw results get the same object serialized
+    util::Ref context{m_node};
+    JSONRPCRequest request(context);
+    std::string raw_result;
+    request.strMethod = "getblock";
+    request.params = RPCConvertValues("getblock", {hash});
+    request.raw_result = &raw_result;
+    BOOST_CHECK(tableRPC.execute(request).isNull());
+    BOOST_CHECK_EQUAL(raw_result, block.write());
+    BOOST_CHECK_EQUAL(JSONRPCRawReply(raw_result, UniValue(1)), JSONRPCReply(block, NullUniValue, UniValue(1)));
+}
+
+BOOST_AUTO_TEST_CASE(rpc_gettxoutsetinfo_verify_mweb)
+{
+    UniValue stats = CallRPC("gettxoutsetinfo none true");
+    BOOST_CHECK(find_value(stats, "mweb_sums_valid").get_bool());
+
+    // The audit reads every MWEB block, so a pruned node rejects it up front
+    fPruneMode = true;
+    BOOST_CHECK_EXCEPTION(CallRPC("gettxoutsetinfo none true"), std::runtime_error, HasReason("verify_mweb is not available in prune mode"));
+    BOOST_CHECK_NO_THROW(CallRPC("gettxoutsetinfo none"));
+    fPruneMode = false;
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,65 @@
+// Copyright (c) 2021 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <util/threadpool.h>
+
+#include <test/util/setup_common.h>
+#include <util/memory.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <atomic>
+#include <future>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+BOOST_FIXTURE_TEST_SUITE(threadpool_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(results_in_order)
+{
+    ThreadPool pool("test", 4);
+    BOOST_CHECK_EQUAL(pool.WorkerCount(), 4U);
+
+    std::vector<std::future<int>> results;
+    for (int i = 0; i < 100; ++i) {
+        results.push_back(pool.Submit([i] { return i * i; }));
+    }
+    for (int i = 0; i < 100; ++i) {
+        BOOST_CHECK_EQUAL(results[i].get(), i * i);
+    }
+
+    // Exceptions are passed on to the consumer
+    std::future<int> failed = pool.Submit([]() -> int { throw std::runtime_error("failed"); });
+    BOOST_CHECK_THROW(failed.get(), std::runtime_error);
+
+    // At least one worker is started
+    BOOST_CHECK_EQUAL(ThreadPool("test", 0).WorkerCount(), 1U);
+}
+
+BOOST_AUTO_TEST_CASE(destroy_drops_queued_tasks)
+{
+    auto pool = MakeUnique<ThreadPool>("test", 1);
+    std::promise<void> started;
+    std::promise<void> release;
+    std::atomic<int> ran{0};
+    std::future<void> running = pool->Submit([&] {
+        started.set_value();
+        release.get_future().wait();
+        ++ran;
+    });
+    std::future<void> queued = pool->Submit([&] { ++ran; });
+    started.get_future().wait();
+
+    // The queued task is dropped right away, and destroying the pool waits for the running one
+    std::thread destroy([&] { pool.reset(); });
+    queued.wait();
+    release.set_value();
+    destroy.join();
+    running.get();
+    BOOST_CHECK_EQUAL(ran, 1);
+    BOOST_CHECK_THROW(queued.get(), std::future_error);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
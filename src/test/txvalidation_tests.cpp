@@ -3,9 +3,16 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include <consensus/validation.h>
+#include <fs.h>
+#include <key.h>
 #include <primitives/transaction.h>
+#include <script/interpreter.h>
 #include <script/script.h>
+#include <streams.h>
 #include <test/util/setup_common.h>
+#include <txmempool.h>
+#include <util/system.h>
+#include <util/time.h>
 #include <validation.h>
 
 #include <boost/test/unit_test.hpp>
@@ -51,4 +58,89 @@ BOOST_FIXTURE_TEST_CASE(tx_mempool_reject_coinbase, TestChain100Setup)
     BOOST_CHECK(state.GetResult() == TxValidationResult::TX_CONSENSUS);
 }
 
+/**
+ * Ensure that a mempool.dat spanning several load batches is imported in file
+ * order: expired entries are skipped wherever they fall in a batch, and fee
+ * deltas are applied whichever batch their transaction is checked in.
+ */
+BOOST_FIXTURE_TEST_CASE(load_mempool_batches, TestChain100Setup)
+{
+    const CScript scriptPubKey = CScript() << ToByteVector(coinbaseKey.GetPubKey()) << OP_CHECKSIG;
+    const auto sign = [&](CMutableTransaction& tx) {
+        std::vector<unsigned char> vchSig;
+        const uint256 hash = SignatureHash(scriptPubKey, tx, 0, SIGHASH_ALL, 0, SigVersion::BASE);
+        BOOST_CHECK(coinbaseKey.Sign(hash, vchSig));
+        vchSig.push_back((unsigned char)SIGHASH_ALL);
+        tx.vin[0].scriptSig = CScript() << vchSig;
+    };
+
+    // Fan a mature coinbase out into enough outputs for three load batches
+    const size_t num_txs = 300;
+    const CAmount fee = CENT;
+    CMutableTransaction fan_out;
+    fan_out.nVersion = 1;
+    fan_out.vin.resize(1);
+    fan_out.vin[0].prevout = COutPoint(m_coinbase_txns[0]->GetHash(), 0);
+    fan_out.vout.resize(num_txs);
+    for (CTxOut& out : fan_out.vout) {
+        out.nValue = m_coinbase_txns[0]->vout[0].nValue / (num_txs + 1);
+        out.scriptPubKey = scriptPubKey;
+    }
+    sign(fan_out);
+    CreateAndProcessBlock({fan_out}, scriptPubKey);
+
+    std::vector<CTransactionRef> txs;
+    for (size_t i = 0; i < num_txs; ++i) {
+        CMutableTransaction spend;
+        spend.nVersion = 1;
+        spend.vin.resize(1);
+        spend.vin[0].prevout = COutPoint(fan_out.GetHash(), i);
+        spend.vout.resize(1);
+        spend.vout[0].nValue = fan_out.vout[i].nValue - fee;
+        spend.vout[0].scriptPubKey = scriptPubKey;
+        sign(spend);
+        txs.push_back(MakeTransactionRef(spend));
+    }
+
+    // Entries 5 and 130 have expired, 10 and 200 carry a fee delta in their
+    // own entry, and 299 is also prioritised by the trailing delta map, which
+    // is read after the last batch. The expired entry 130 is prioritised too.
+    const int64_t now = GetTime();
+    const std::map<size_t, int64_t> entry_deltas{{10, 1000}, {130, 1500}, {200, 2000}, {299, 500}};
+    const uint256 unknown_txid = InsecureRand256();
+    const std::map<uint256, CAmount> map_deltas{{txs[299]->GetHash(), 3000}, {unknown_txid, 4000}};
+    {
+        CAutoFile file(fsbridge::fopen(GetDataDir() / "mempool.dat", "wb"), SER_DISK, CLIENT_VERSION);
+        file << uint64_t{1} << uint64_t{num_txs};
+        for (size_t i = 0; i < num_txs; ++i) {
+            const auto delta = entry_deltas.find(i);
+            file << *txs[i];
+            file << int64_t{i == 5 || i == 130 ? 0 : now};
+            file << int64_t{delta == entry_deltas.end() ? 0 : delta->second};
+        }
+        file << map_deltas;
+        file << std::set<uint256>{txs[42]->GetHash(), txs[130]->GetHash()};
+    }
+
+    CTxMemPool& pool = *m_node.mempool;
+    BOOST_CHECK(LoadMempool(pool));
+
+    LOCK2(cs_main, pool.cs);
+    BOOST_CHECK_EQUAL(pool.size(), num_txs - 2);
+    BOOST_CHECK(!pool.exists(txs[5]->GetHash()));
+    BOOST_CHECK(!pool.exists(txs[130]->GetHash()));
+    BOOST_CHECK(pool.exists(txs[4]->GetHash()));
+    BOOST_CHECK(pool.exists(txs[131]->GetHash()));
+
+    BOOST_CHECK_EQUAL(pool.get_iter_from_wtxid(txs[0]->GetWitnessHash())->GetModifiedFee(), fee);
+    BOOST_CHECK_EQUAL(pool.get_iter_from_wtxid(txs[10]->GetWitnessHash())->GetModifiedFee(), fee + 1000);
+    BOOST_CHECK_EQUAL(pool.get_iter_from_wtxid(txs[200]->GetWitnessHash())->GetModifiedFee(), fee + 2000);
+    BOOST_CHECK_EQUAL(pool.get_iter_from_wtxid(txs[299]->GetWitnessHash())->GetModifiedFee(), fee + 500 + 3000);
+    BOOST_CHECK_EQUAL(pool.mapDeltas.at(txs[130]->GetHash()), 1500);
+    BOOST_CHECK_EQUAL(pool.mapDeltas.at(unknown_txid), 4000);
+
+    // Only the unbroadcast transaction that made it into the mempool is kept
+    BOOST_CHECK(pool.GetUnbroadcastTxs() == std::set<uint256>{txs[42]->GetHash()});
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -371,4 +371,65 @@ BOOST_FIXTURE_TEST_CASE(checkinputs_test, TestChain100Setup)
     }
 }
 
+BOOST_FIXTURE_TEST_CASE(mempool_parallel_script_checks, TestChain100Setup)
+{
+    // Transactions with many inputs are verified on the script-checking threads
+    // when entering the mempool. Make sure they still get the serial verdict.
+    CScript p2pk_scriptPubKey = CScript() << ToByteVector(coinbaseKey.GetPubKey()) << OP_CHECKSIG;
+    const unsigned int num_inputs = MEMPOOL_PARALLEL_SCRIPT_CHECK_MIN_INPUTS + 4;
+
+    CMutableTransaction fanout_tx;
+    fanout_tx.nVersion = 1;
+    fanout_tx.vin.resize(1);
+    fanout_tx.vin[0].prevout = COutPoint(m_coinbase_txns[0]->GetHash(), 0);
+    fanout_tx.vout.resize(num_inputs);
+    for (CTxOut& txout : fanout_tx.vout) {
+        txout.nValue = 1 * COIN;
+        txout.scriptPubKey = p2pk_scriptPubKey;
+    }
+    {
+        std::vector<unsigned char> vchSig;
+        uint256 hash = SignatureHash(p2pk_scriptPubKey, fanout_tx, 0, SIGHASH_ALL, 0, SigVersion::BASE);
+        BOOST_CHECK(coinbaseKey.Sign(hash, vchSig));
+        vchSig.push_back((unsigned char)SIGHASH_ALL);
+        fanout_tx.vin[0].scriptSig << vchSig;
+    }
+    CreateAndProcessBlock({fanout_tx}, p2pk_scriptPubKey);
+
+    CMutableTransaction consolidate_tx;
+    consolidate_tx.nVersion = 1;
+    consolidate_tx.vin.resize(num_inputs);
+    for (unsigned int i = 0; i < num_inputs; i++) {
+        consolidate_tx.vin[i].prevout = COutPoint(fanout_tx.GetHash(), i);
+    }
+    consolidate_tx.vout.resize(1);
+    consolidate_tx.vout[0].nValue = (num_inputs - 1) * COIN;
+    consolidate_tx.vout[0].scriptPubKey = p2pk_scriptPubKey;
+    for (unsigned int i = 0; i < num_inputs; i++) {
+        std::vector<unsigned char> vchSig;
+        uint256 hash = SignatureHash(p2pk_scriptPubKey, consolidate_tx, i, SIGHASH_ALL, 0, SigVersion::BASE);
+        BOOST_CHECK(coinbaseKey.Sign(hash, vchSig));
+        vchSig.push_back((unsigned char)SIGHASH_ALL);
+        consolidate_tx.vin[i].scriptSig = CScript() << vchSig;
+    }
+
+    const auto ToMemPool = [this](const CMutableTransaction& tx, TxValidationState& state) {
+        LOCK(cs_main);
+        return AcceptToMemoryPool(*m_node.mempool, state, MakeTransactionRef(tx),
+            nullptr /* plTxnReplaced */, true /* bypass_limits */);
+    };
+
+    // A single bad signature in the middle is reported like a serial check would
+    CMutableTransaction bad_tx = consolidate_tx;
+    bad_tx.vin[num_inputs / 2].scriptSig = consolidate_tx.vin[0].scriptSig;
+    TxValidationState bad_state;
+    BOOST_CHECK(!ToMemPool(bad_tx, bad_state));
+    BOOST_CHECK_EQUAL(bad_state.GetResult(), TxValidationResult::TX_CONSENSUS);
+    BOOST_CHECK_EQUAL(bad_state.GetRejectReason(), "mandatory-script-verify-flag-failed (Signature must be zero for failed CHECK(MULTI)SIG operation)");
+
+    TxValidationState state;
+    BOOST_CHECK(ToMemPool(consolidate_tx, state));
+    BOOST_CHECK(m_node.mempool->exists(consolidate_tx.GetHash()));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
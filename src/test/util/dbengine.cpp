@@ -0,0 +1,108 @@
+// Copyright (c) 2021 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <test/util/dbengine.h>
+
+#include <memusage.h>
+
+#include <leveldb/iterator.h>
+
+#include <iterator>
+
+namespace {
+
+class MapIterator final : public leveldb::Iterator
+{
+private:
+    const std::shared_ptr<const MapDBEngine::Map> m_map;
+    MapDBEngine::Map::const_iterator m_it;
+
+public:
+    explicit MapIterator(std::shared_ptr<const MapDBEngine::Map> map) : m_map(std::move(map)), m_it(m_map->end()) {}
+
+    bool Valid() const override { return m_it != m_map->end(); }
+    void SeekToFirst() override { m_it = m_map->begin(); }
+    void SeekToLast() override { m_it = m_map->empty() ? m_map->end() : std::prev(m_map->end()); }
+    void Seek(const leveldb::Slice& target) override { m_it = m_map->lower_bound(target.ToString()); }
+    void Next() override { ++m_it; }
+    void Prev() override { m_it = m_it == m_map->begin() ? m_map->end() : std::prev(m_it); }
+    leveldb::Slice key() const override { return m_it->first; }
+    leveldb::Slice value() const override { return m_it->second; }
+    leveldb::Status status() const override { return leveldb::Status::OK(); }
+};
+
+class MapWriter final : public leveldb::WriteBatch::Handler
+{
+private:
+    MapDBEngine::Map& m_map;
+
+public:
+    explicit MapWriter(MapDBEngine::Map& map) : m_map(map) {}
+
+    void Put(const leveldb::Slice& key, const leveldb::Slice& value) override
+    {
+        m_map[key.ToString()] = value.ToString();
+    }
+
+    void Delete(const leveldb::Slice& key) override
+    {
+        m_map.erase(key.ToString());
+    }
+};
+
+} // namespace
+
+leveldb::Status MapDBEngine::Get(const leveldb::Slice& key, std::string* value) const
+{
+    ++m_reads;
+    LOCK(m_mutex);
+    const auto it = m_map->find(key.ToString());
+    if (it == m_map->end()) return leveldb::Status::NotFound(key);
+    *value = it->second;
+    return leveldb::Status::OK();
+}
+
+leveldb::Status MapDBEngine::Write(const leveldb::WriteBatch& batch, bool sync)
+{
+    LOCK(m_mutex);
+    if (m_map.use_count() > 1) {
+        m_map = std::make_shared<Map>(*m_map);
+    }
+    MapWriter writer(*m_map);
+    return batch.Iterate(&writer);
+}
+
+leveldb::Iterator* MapDBEngine::NewIterator() const
+{
+    return new MapIterator(WITH_LOCK(m_mutex, return m_map));
+}
+
+uint64_t MapDBEngine::EstimateSize(const leveldb::Slice& begin, const leveldb::Slice& end) const
+{
+    LOCK(m_mutex);
+    uint64_t size = 0;
+    for (auto it = m_map->lower_bound(begin.ToString()); it != m_map->end() && it->first < end.ToString(); ++it) {
+        size += it->first.size() + it->second.size();
+    }
+    return size;
+}
+
+size_t MapDBEngine::DynamicMemoryUsage() const
+{
+    LOCK(m_mutex);
+    size_t usage = memusage::DynamicUsage(*m_map);
+    for (const auto& entry : *m_map) {
+        usage += entry.first.capacity() + entry.second.capacity();
+    }
+    return usage;
+}
+
+DBStats MapDBEngine::GetStats() const
+{
+    DBStats stats;
+    stats.engine = "map";
+    stats.reads = m_reads;
+    stats.memory_usage = DynamicMemoryUsage();
+    return stats;
+}
@@ -0,0 +1,44 @@
+// Copyright (c) 2021 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_TEST_UTIL_DBENGINE_H
+#define BITCOIN_TEST_UTIL_DBENGINE_H
+
+#include <dbwrapper.h>
+#include <sync.h>
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <string>
+
+/**
+ * A database engine that keeps the keys in a std::map, to compare LevelDB against.
+ *
+ * Nothing is written to disk. An iterator keeps the map it was created on alive, and
+ * the next write copies the map, so iterators see a consistent view like in LevelDB.
+ */
+class MapDBEngine final : public DBEngine
+{
+public:
+    using Map = std::map<std::string, std::string>;
+
+private:
+    mutable Mutex m_mutex;
+    std::shared_ptr<Map> m_map GUARDED_BY(m_mutex);
+    mutable std::atomic<uint64_t> m_reads{0};
+
+public:
+    MapDBEngine() : m_map(std::make_shared<Map>()) {}
+
+    leveldb::Status Get(const leveldb::Slice& key, std::string* value) const override;
+    leveldb::Status Write(const leveldb::WriteBatch& batch, bool sync) override;
+    leveldb::Iterator* NewIterator() const override;
+    uint64_t EstimateSize(const leveldb::Slice& begin, const leveldb::Slice& end) const override;
+    void CompactRange(const leveldb::Slice* begin, const leveldb::Slice* end) override {}
+    size_t DynamicMemoryUsage() const override;
+    DBStats GetStats() const override;
+};
+
+#endif // BITCOIN_TEST_UTIL_DBENGINE_H
@@ -56,89 +56,43 @@ BOOST_AUTO_TEST_CASE(getcoinscachesizestate)
     constexpr size_t MAX_COINS_CACHE_BYTES = 1024;
 
     // Without any coins in the cache, we shouldn't need to flush.
+    print_view_mem_usage(view);
     BOOST_CHECK_EQUAL(
         chainstate.GetCoinsCacheSizeState(&tx_pool, MAX_COINS_CACHE_BYTES, /*max_mempool_size_bytes*/ 0),
         CoinsCacheSizeState::OK);
 
-    // If the initial memory allocations of cacheCoins don't match these common
-    // cases, we can't really continue to make assertions about memory usage.
-    // End the test early.
-    if (view.DynamicMemoryUsage() != 32 && view.DynamicMemoryUsage() != 16) {
-        // Add a bunch of coins to see that we at least flip over to CRITICAL.
-
-        for (int i{0}; i < 1000; ++i) {
-            COutPoint res = add_coin(view);
-            BOOST_CHECK_EQUAL(view.AccessCoin(res).DynamicMemoryUsage(), COIN_SIZE);
-        }
-
-        BOOST_CHECK_EQUAL(
-            chainstate.GetCoinsCacheSizeState(&tx_pool, MAX_COINS_CACHE_BYTES, /*max_mempool_size_bytes*/ 0),
-            CoinsCacheSizeState::CRITICAL);
-
-        BOOST_TEST_MESSAGE("Exiting cache flush tests early due to unsupported arch");
-        return;
-    }
-
+    // The entries of the cache are allocated from a pool, a chunk at a time, and
+    // the first chunk doesn't fit.
+    COutPoint res = add_coin(view);
     print_view_mem_usage(view);
-    BOOST_CHECK_EQUAL(view.DynamicMemoryUsage(), is_64_bit ? 32U : 16U);
-
-    // We should be able to add COINS_UNTIL_CRITICAL coins to the cache before going CRITICAL.
-    // This is contingent not only on the dynamic memory usage of the Coins
-    // that we're adding (COIN_SIZE bytes per), but also on how much memory the
-    // cacheCoins (unordered_map) preallocates.
-    constexpr int COINS_UNTIL_CRITICAL{3};
-
-    for (int i{0}; i < COINS_UNTIL_CRITICAL; ++i) {
-        COutPoint res = add_coin(view);
-        print_view_mem_usage(view);
-        BOOST_CHECK_EQUAL(view.AccessCoin(res).DynamicMemoryUsage(), COIN_SIZE);
-        BOOST_CHECK_EQUAL(
-            chainstate.GetCoinsCacheSizeState(&tx_pool, MAX_COINS_CACHE_BYTES, /*max_mempool_size_bytes*/ 0),
-            CoinsCacheSizeState::OK);
-    }
-
-    // Adding some additional coins will push us over the edge to CRITICAL.
-    for (int i{0}; i < 4; ++i) {
-        add_coin(view);
-        print_view_mem_usage(view);
-        if (chainstate.GetCoinsCacheSizeState(&tx_pool, MAX_COINS_CACHE_BYTES, /*max_mempool_size_bytes*/ 0) ==
-            CoinsCacheSizeState::CRITICAL) {
-            break;
-        }
-    }
-
+    BOOST_CHECK_EQUAL(view.AccessCoin(res).DynamicMemoryUsage(), COIN_SIZE);
+    const size_t chunk_usage = view.DynamicMemoryUsage();
+    BOOST_CHECK_GT(chunk_usage, CCoinsMap::allocator_type::ResourceType::DEFAULT_CHUNK_SIZE_BYTES);
     BOOST_CHECK_EQUAL(
         chainstate.GetCoinsCacheSizeState(&tx_pool, MAX_COINS_CACHE_BYTES, /*max_mempool_size_bytes*/ 0),
         CoinsCacheSizeState::CRITICAL);
 
     // Passing non-zero max mempool usage should allow us more headroom.
+    const size_t mempool_bytes = 2 * chunk_usage;
     BOOST_CHECK_EQUAL(
-        chainstate.GetCoinsCacheSizeState(&tx_pool, MAX_COINS_CACHE_BYTES, /*max_mempool_size_bytes*/ 1 << 10),
+        chainstate.GetCoinsCacheSizeState(&tx_pool, MAX_COINS_CACHE_BYTES, mempool_bytes),
         CoinsCacheSizeState::OK);
 
-    for (int i{0}; i < 3; ++i) {
+    // More coins fit into the chunk, and only add the memory of their scripts. Leave
+    // the room for a few resizes of the bucket array.
+    for (int i{0}; i < 100; ++i) {
         add_coin(view);
-        print_view_mem_usage(view);
-        BOOST_CHECK_EQUAL(
-            chainstate.GetCoinsCacheSizeState(&tx_pool, MAX_COINS_CACHE_BYTES, /*max_mempool_size_bytes*/ 1 << 10),
-            CoinsCacheSizeState::OK);
     }
-
-    // Adding another coin with the additional mempool room will put us >90%
-    // but not yet critical.
-    add_coin(view);
     print_view_mem_usage(view);
+    BOOST_CHECK_LT(view.DynamicMemoryUsage(), chunk_usage + 100 * COIN_SIZE + 4096);
+    BOOST_CHECK_EQUAL(
+        chainstate.GetCoinsCacheSizeState(&tx_pool, MAX_COINS_CACHE_BYTES, mempool_bytes),
+        CoinsCacheSizeState::OK);
 
-    // Only perform these checks on 64 bit hosts; I haven't done the math for 32.
-    if (is_64_bit) {
-        float usage_percentage = (float)view.DynamicMemoryUsage() / (MAX_COINS_CACHE_BYTES + (1 << 10));
-        BOOST_TEST_MESSAGE("CoinsTip usage percentage: " << usage_percentage);
-        BOOST_CHECK(usage_percentage >= 0.9);
-        BOOST_CHECK(usage_percentage < 1);
-        BOOST_CHECK_EQUAL(
-            chainstate.GetCoinsCacheSizeState(&tx_pool, MAX_COINS_CACHE_BYTES, 1 << 10),
-            CoinsCacheSizeState::LARGE);
-    }
+    // Within 10% of the limit, we are LARGE but not yet CRITICAL.
+    BOOST_CHECK_EQUAL(
+        chainstate.GetCoinsCacheSizeState(&tx_pool, view.DynamicMemoryUsage() * 20 / 19, /*max_mempool_size_bytes*/ 0),
+        CoinsCacheSizeState::LARGE);
 
     // Using the default max_* values permits way more coins to be added.
     for (int i{0}; i < 1000; ++i) {
@@ -148,20 +102,67 @@ BOOST_AUTO_TEST_CASE(getcoinscachesizestate)
             CoinsCacheSizeState::OK);
     }
 
-    // Flushing the view doesn't take us back to OK because cacheCoins has
-    // preallocated memory that doesn't get reclaimed even after flush.
-
     BOOST_CHECK_EQUAL(
         chainstate.GetCoinsCacheSizeState(&tx_pool, MAX_COINS_CACHE_BYTES, 0),
         CoinsCacheSizeState::CRITICAL);
 
+    // Flushing the view releases the pool, which takes us back to OK.
     view.SetBestBlock(InsecureRand256());
     BOOST_CHECK(view.Flush());
     print_view_mem_usage(view);
 
     BOOST_CHECK_EQUAL(
         chainstate.GetCoinsCacheSizeState(&tx_pool, MAX_COINS_CACHE_BYTES, 0),
-        CoinsCacheSizeState::CRITICAL);
+        CoinsCacheSizeState::OK);
+}
+
+//! Test that the coins handed over to a background write can be read until and after
+//! they are committed.
+//!
+//! @sa CCoinsViewWriteBehind
+//!
+BOOST_AUTO_TEST_CASE(write_behind)
+{
+    CTxMemPool mempool;
+    BlockManager blockman{};
+    CChainState chainstate{mempool, blockman};
+    chainstate.InitCoinsDB(/*cache_size_bytes*/ 1 << 10, /*in_memory*/ true, /*should_wipe*/ false);
+    WITH_LOCK(::cs_main, chainstate.InitCoinsCache(1 << 10));
+
+    LOCK(::cs_main);
+    auto& view = chainstate.CoinsTip();
+    auto& write_behind = chainstate.CoinsWriteBehind();
+
+    const COutPoint outp{InsecureRand256(), 0};
+    Coin newcoin;
+    newcoin.nHeight = 1;
+    newcoin.out.nValue = 42;
+    newcoin.out.scriptPubKey.assign((uint32_t)56, 1);
+    view.AddCoin(outp, std::move(newcoin), false);
+    const uint256 best_block = InsecureRand256();
+    view.SetBestBlock(best_block);
+
+    BOOST_CHECK(write_behind.StartWrite(view));
+    BOOST_CHECK_EQUAL(view.GetCacheSize(), 0U);
+    BOOST_CHECK(write_behind.GetBestBlock() == best_block);
+    // Read from the snapshot or the database, depending on the progress of the write
+    BOOST_CHECK_EQUAL(view.AccessCoin(outp).out.nValue, 42);
+
+    BOOST_CHECK(write_behind.Wait());
+    BOOST_CHECK(chainstate.CoinsDB().GetBestBlock() == best_block);
+    BOOST_CHECK(chainstate.CoinsDB().HaveCoin(outp));
+
+    // Spends are handed over the same way
+    BOOST_CHECK(view.SpendCoin(outp));
+    BOOST_CHECK(write_behind.StartWrite(view));
+    BOOST_CHECK(!view.HaveCoin(outp));
+    BOOST_CHECK(write_behind.Wait());
+    BOOST_CHECK(!chainstate.CoinsDB().HaveCoin(outp));
+
+    // A synchronous write still works after a background one
+    view.AddCoin(outp, Coin(CTxOut(1, CScript()), 2, false, false), false);
+    BOOST_CHECK(view.Flush());
+    BOOST_CHECK(chainstate.CoinsDB().HaveCoin(outp));
 }
 
 BOOST_AUTO_TEST_SUITE_END()
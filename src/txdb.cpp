@@ -5,6 +5,7 @@
 
 #include <txdb.h>
 
+#include <logging/timer.h>
 #include <node/ui_interface.h>
 #include <pow.h>
 #include <mweb/mweb_db.h>
@@ -42,7 +43,7 @@ struct CoinEntry {
 }
 
 CCoinsViewDB::CCoinsViewDB(fs::path ldb_path, size_t nCacheSize, bool fMemory, bool fWipe) :
-    m_db(MakeUnique<CDBWrapper>(ldb_path, nCacheSize, fMemory, fWipe, true)),
+    m_db(MakeUnique<CDBWrapper>(ldb_path, nCacheSize, fMemory, fWipe, true, "chainstate")),
     m_ldb_path(ldb_path),
     m_is_memory(fMemory) { }
 
@@ -52,7 +53,7 @@ void CCoinsViewDB::ResizeCache(size_t new_cache_size)
     // filesystem lock.
     m_db.reset();
     m_db = MakeUnique<CDBWrapper>(
-        m_ldb_path, new_cache_size, m_is_memory, /*fWipe*/ false, /*obfuscate*/ true);
+        m_ldb_path, new_cache_size, m_is_memory, /*fWipe*/ false, /*obfuscate*/ true, "chainstate");
     GetMWEBView()->SetDatabase(std::make_shared<MWEB::DBWrapper>(GetDB()));
 }
 
@@ -94,6 +95,31 @@ std::vector<uint256> CCoinsViewDB::GetHeadBlocks() const {
 }
 
 bool CCoinsViewDB::BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock, const mw::CoinsViewCache::Ptr& derivedView) {
+    bool ret = WriteCoins(mapCoins, hashBlock, /* erase */ true, [&](const std::shared_ptr<CDBBatch>& batch) {
+        // MWEB: Flushes MWEB coins & MMRs
+        derivedView->Flush(std::make_unique<MWEB::DBBatch>(m_db.get(), batch));
+    });
+    derivedView->Compact(); // MWEB: Cleanup old MMR files
+    return ret;
+}
+
+bool CCoinsViewDB::WriteSnapshot(CCoinsMap& mapCoins, const uint256& hashBlock, const MWEB::PendingWrites& mweb_writes)
+{
+    bool ret = WriteCoins(mapCoins, hashBlock, /* erase */ false, [&](const std::shared_ptr<CDBBatch>& batch) {
+        for (const auto& write : mweb_writes) {
+            if (write.second) {
+                batch->Write(write.first, *write.second);
+            } else {
+                batch->Erase(write.first);
+            }
+        }
+    });
+    GetMWEBView()->Compact(); // MWEB: Cleanup old MMR files
+    return ret;
+}
+
+bool CCoinsViewDB::WriteCoins(CCoinsMap& mapCoins, const uint256& hashBlock, bool erase, const std::function<void(const std::shared_ptr<CDBBatch>&)>& write_mweb)
+{
     std::shared_ptr<CDBBatch> batch = std::make_shared<CDBBatch>(*m_db);
     size_t count = 0;
     size_t changed = 0;
@@ -129,7 +155,7 @@ bool CCoinsViewDB::BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock, con
         }
         count++;
         CCoinsMap::iterator itOld = it++;
-        mapCoins.erase(itOld);
+        if (erase) mapCoins.erase(itOld);
         if (batch->SizeEstimate() > batch_size) {
             LogPrint(BCLog::COINDB, "Writing partial batch of %.2f MiB\n", batch->SizeEstimate() * (1.0 / 1048576.0));
             m_db->WriteBatch(*batch);
@@ -144,8 +170,7 @@ bool CCoinsViewDB::BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock, con
         }
     }
 
-    // MWEB: Flushes MWEB coins & MMRs
-    derivedView->Flush(std::make_unique<MWEB::DBBatch>(m_db.get(), batch));
+    write_mweb(batch);
 
     // In the last batch, mark the database as consistent with hashBlock again.
     batch->Erase(DB_HEAD_BLOCKS);
@@ -153,7 +178,6 @@ bool CCoinsViewDB::BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock, con
 
     LogPrint(BCLog::COINDB, "Writing final batch of %.2f MiB\n", batch->SizeEstimate() * (1.0 / 1048576.0));
     bool ret = m_db->WriteBatch(*batch);
-    derivedView->Compact(); // MWEB: Cleanup old MMR files
     LogPrint(BCLog::COINDB, "Committed %u changed transaction outputs (out of %u) to coin database...\n", (unsigned int)changed, (unsigned int)count);
     return ret;
 }
@@ -163,7 +187,103 @@ size_t CCoinsViewDB::EstimateSize() const
     return m_db->EstimateSize(DB_COIN, (char)(DB_COIN+1));
 }
 
-CBlockTreeDB::CBlockTreeDB(size_t nCacheSize, bool fMemory, bool fWipe) : CDBWrapper(GetDataDir() / "blocks" / "index", nCacheSize, fMemory, fWipe) {
+CCoinsViewWriteBehind::~CCoinsViewWriteBehind()
+{
+    Wait();
+}
+
+std::shared_ptr<const CCoinsViewWriteBehind::Snapshot> CCoinsViewWriteBehind::GetSnapshot() const
+{
+    LOCK(m_mutex);
+    return m_snapshot;
+}
+
+bool CCoinsViewWriteBehind::GetCoin(const COutPoint& outpoint, Coin& coin) const
+{
+    std::shared_ptr<const Snapshot> snapshot = GetSnapshot();
+    if (snapshot) {
+        CCoinsMap::const_iterator it = snapshot->coins.find(outpoint);
+        if (it != snapshot->coins.end()) {
+            coin = it->second.coin;
+            return !coin.IsSpent();
+        }
+    }
+    return base->GetCoin(outpoint, coin);
+}
+
+bool CCoinsViewWriteBehind::HaveCoin(const OutputIndex& index) const
+{
+    std::shared_ptr<const Snapshot> snapshot = GetSnapshot();
+    if (snapshot && index.type() == typeid(COutPoint)) {
+        CCoinsMap::const_iterator it = snapshot->coins.find(boost::get<COutPoint>(index));
+        if (it != snapshot->coins.end()) {
+            return !it->second.coin.IsSpent();
+        }
+    }
+    // MWEB coins are read through the pending writes of the MWEB database
+    return base->HaveCoin(index);
+}
+
+uint256 CCoinsViewWriteBehind::GetBestBlock() const
+{
+    std::shared_ptr<const Snapshot> snapshot = GetSnapshot();
+    return snapshot ? snapshot->hashBlock : base->GetBestBlock();
+}
+
+bool CCoinsViewWriteBehind::BatchWrite(CCoinsMap& mapCoins, const uint256& hashBlock, const mw::CoinsViewCache::Ptr& derivedView)
+{
+    if (!std::exchange(m_taking_snapshot, false)) {
+        return Wait() && base->BatchWrite(mapCoins, hashBlock, derivedView);
+    }
+
+    // The snapshot takes the pool of mapCoins along with its entries. The cache gets a
+    // new map with a new pool after this returns, so the pools are never shared.
+    auto snapshot = std::make_shared<Snapshot>(std::move(mapCoins), hashBlock);
+
+    // MWEB: Flushes MWEB coins & MMRs, but only records the database writes. Until they
+    // are committed, the MWEB database reads them from the snapshot.
+    derivedView->Flush(std::make_unique<MWEB::PendingBatch>(snapshot->mweb_writes));
+    auto mweb_db = std::dynamic_pointer_cast<MWEB::DBWrapper>(m_db.GetMWEBView()->GetDatabase());
+    assert(mweb_db);
+    mweb_db->SetPendingWrites(std::shared_ptr<const MWEB::PendingWrites>(snapshot, &snapshot->mweb_writes));
+    WITH_LOCK(m_mutex, m_snapshot = snapshot);
+
+    m_write = std::async(std::launch::async, [this, snapshot, mweb_db] {
+        bool ret = false;
+        try {
+            LOG_TIME_MILLIS_WITH_CATEGORY(strprintf("write coins snapshot to disk (%d coins)", snapshot->coins.size()), BCLog::BENCH);
+            ret = m_db.WriteSnapshot(snapshot->coins, snapshot->hashBlock, snapshot->mweb_writes);
+        } catch (const std::exception& e) {
+            LogPrintf("Error writing coins snapshot to disk: %s\n", e.what());
+        }
+        // On failure, keep reading from the snapshot until the node shuts down
+        if (ret) {
+            mweb_db->SetPendingWrites(nullptr);
+            LOCK(m_mutex);
+            m_snapshot.reset();
+        }
+        return ret;
+    });
+    return true;
+}
+
+bool CCoinsViewWriteBehind::StartWrite(CCoinsViewCache& cache)
+{
+    if (!Wait()) return false;
+    // The cache passes its contents to BatchWrite() first thing
+    m_taking_snapshot = true;
+    return cache.Flush();
+}
+
+bool CCoinsViewWriteBehind::Wait()
+{
+    if (m_write.valid() && !m_write.get()) {
+        m_write_failed = true;
+    }
+    return !m_write_failed;
+}
+
+CBlockTreeDB::CBlockTreeDB(size_t nCacheSize, bool fMemory, bool fWipe) : CDBWrapper(GetDataDir() / "blocks" / "index", nCacheSize, fMemory, fWipe, /*obfuscate*/ false, "blockindex") {
 }
 
 bool CBlockTreeDB::ReadBlockFileInfo(int nFile, CBlockFileInfo &info) {
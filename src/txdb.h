@@ -10,8 +10,12 @@
 #include <dbwrapper.h>
 #include <chain.h>
 #include <mw/node/CoinsView.h>
+#include <mweb/mweb_db.h>
 #include <primitives/block.h>
+#include <sync.h>
 
+#include <functional>
+#include <future>
 #include <memory>
 #include <string>
 #include <utility>
@@ -62,6 +66,10 @@ public:
     uint256 GetBestBlock() const override;
     std::vector<uint256> GetHeadBlocks() const override;
     bool BatchWrite(CCoinsMap& mapCoins, const uint256& hashBlock, const mw::CoinsViewCache::Ptr& derivedView) override;
+    //! Like BatchWrite, but leave mapCoins unchanged, so that other threads can read it
+    //! during the write. The MWEB coins and MMRs were already flushed, with their database
+    //! writes recorded in mweb_writes, which are committed with the best block.
+    bool WriteSnapshot(CCoinsMap& mapCoins, const uint256& hashBlock, const MWEB::PendingWrites& mweb_writes);
     CCoinsViewCursor *Cursor() const override;
     CDBWrapper* GetDB() noexcept { return m_db.get(); }
     void SetMWEBView(const mw::ICoinsView::Ptr& view) { mweb_view = view; }
@@ -74,6 +82,64 @@ public:
 
     //! Dynamically alter the underlying leveldb cache size.
     void ResizeCache(size_t new_cache_size) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+
+private:
+    bool WriteCoins(CCoinsMap& mapCoins, const uint256& hashBlock, bool erase, const std::function<void(const std::shared_ptr<CDBBatch>&)>& write_mweb);
+};
+
+/**
+ * CCoinsView that can write the coins cache above it to the coin database on a
+ * background thread, so that validation doesn't wait for the write.
+ *
+ * StartWrite() takes the contents of the cache as an immutable snapshot and leaves
+ * the cache empty. Until the snapshot is committed, reads from the cache that miss
+ * are answered from the snapshot before the database. The MWEB coins and MMR files
+ * are flushed during StartWrite(), but their database writes are held back and
+ * committed in the final batch of the snapshot, together with the best block, so
+ * that the chainstate is as consistent after a crash as with a synchronous write.
+ *
+ * Only one write runs at a time: StartWrite() and BatchWrite(), the synchronous
+ * write, wait for the previous one first. Cursors only see committed writes. While
+ * a write is running, the snapshot and the refilled cache can use up to twice the
+ * size of the cache.
+ */
+class CCoinsViewWriteBehind final : public CCoinsViewBacked
+{
+public:
+    CCoinsViewWriteBehind(CCoinsView* view, CCoinsViewDB& db) : CCoinsViewBacked(view), m_db(db) {}
+    //! Waits for the running write, if any
+    ~CCoinsViewWriteBehind();
+
+    bool GetCoin(const COutPoint& outpoint, Coin& coin) const override;
+    bool HaveCoin(const OutputIndex& index) const override;
+    uint256 GetBestBlock() const override;
+    bool BatchWrite(CCoinsMap& mapCoins, const uint256& hashBlock, const mw::CoinsViewCache::Ptr& derivedView) override;
+
+    //! Hand the contents of cache, which must be backed by this view, over to a
+    //! background write. Returns false if the previous write failed.
+    bool StartWrite(CCoinsViewCache& cache);
+    //! Wait for the running write, if any. Returns false if it failed.
+    bool Wait();
+
+private:
+    struct Snapshot {
+        Snapshot(CCoinsMap&& coins_in, const uint256& hash_block_in) : coins(std::move(coins_in)), hashBlock(hash_block_in) {}
+
+        CCoinsMap coins;
+        uint256 hashBlock;
+        MWEB::PendingWrites mweb_writes;
+    };
+
+    std::shared_ptr<const Snapshot> GetSnapshot() const;
+
+    CCoinsViewDB& m_db;
+    mutable Mutex m_mutex;
+    //! The snapshot being written, if any
+    std::shared_ptr<const Snapshot> m_snapshot GUARDED_BY(m_mutex);
+    std::future<bool> m_write;
+    bool m_write_failed{false};
+    //! Set while StartWrite() flushes the cache, to make BatchWrite() take the snapshot
+    bool m_taking_snapshot{false};
 };
 
 /** Specialization of CCoinsViewCursor to iterate over a CCoinsViewDB */
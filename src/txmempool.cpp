@@ -12,6 +12,7 @@
 #include <validation.h>
 #include <policy/policy.h>
 #include <policy/fees.h>
+#include <policy/rbf.h>
 #include <policy/settings.h>
 #include <reverse_iterator.h>
 #include <util/system.h>
@@ -19,10 +20,26 @@
 #include <util/time.h>
 #include <validationinterface.h>
 
+CTransactionRef GetBlockTransaction(const CTransactionRef& tx)
+{
+    if (tx->IsMWEBOnly()) {
+        return nullptr;
+    }
+
+    if (tx->HasMWEBTx()) {
+        CMutableTransaction mutable_tx(*tx);
+        mutable_tx.mweb_tx.SetNull();
+        return MakeTransactionRef(std::move(mutable_tx));
+    }
+
+    return tx;
+}
+
 CTxMemPoolEntry::CTxMemPoolEntry(const CTransactionRef& _tx, const CAmount& _nFee,
                                  int64_t _nTime, unsigned int _entryHeight,
                                  bool _spendsCoinbase, int64_t _sigOpsCost, LockPoints lp)
-    : tx(_tx), nFee(_nFee), nTxWeight(GetTransactionWeight(*tx)), mweb_weight(tx->mweb_tx.GetMWEBWeight()), nUsageSize(RecursiveDynamicUsage(tx)), nTime(_nTime), entryHeight(_entryHeight),
+    : tx(_tx), m_block_tx(GetBlockTransaction(_tx)), nFee(_nFee), nTxWeight(GetTransactionWeight(*tx)), mweb_weight(tx->mweb_tx.GetMWEBWeight()),
+    nUsageSize(RecursiveDynamicUsage(tx) + (m_block_tx && m_block_tx != tx ? RecursiveDynamicUsage(m_block_tx) : 0)), nTime(_nTime), entryHeight(_entryHeight),
     spendsCoinbase(_spendsCoinbase), sigOpCost(_sigOpsCost), lockPoints(lp), m_epoch(0)
 {
     nCountWithDescendants = 1;
@@ -897,6 +914,90 @@ std::vector<TxMempoolInfo> CTxMemPool::infoAll() const
     return ret;
 }
 
+TxMempoolEntryInfo CTxMemPool::GetEntryInfo(const CTxMemPoolEntry& e) const
+{
+    AssertLockHeld(cs);
+
+    TxMempoolEntryInfo info;
+    info.tx = e.GetSharedTx();
+    info.fee = e.GetFee();
+    info.modified_fee = e.GetModifiedFee();
+    info.vsize = e.GetTxSize();
+    info.weight = e.GetTxWeight();
+    info.mweb_weight = e.GetMWEBWeight();
+    info.time = e.GetTime();
+    info.height = e.GetHeight();
+    info.count_with_descendants = e.GetCountWithDescendants();
+    info.size_with_descendants = e.GetSizeWithDescendants();
+    info.mweb_weight_with_descendants = e.GetMWEBWeightWithDescendants();
+    info.mod_fees_with_descendants = e.GetModFeesWithDescendants();
+    info.count_with_ancestors = e.GetCountWithAncestors();
+    info.size_with_ancestors = e.GetSizeWithAncestors();
+    info.mweb_weight_with_ancestors = e.GetMWEBWeightWithAncestors();
+    info.mod_fees_with_ancestors = e.GetModFeesWithAncestors();
+
+    const CTransaction& tx = e.GetTx();
+    for (const CTxIn& txin : tx.vin) {
+        if (exists(txin.prevout.hash)) {
+            info.depends.insert(txin.prevout.hash);
+        }
+    }
+    for (const mw::Hash& spent_id : tx.mweb_tx.GetSpentIDs()) {
+        auto iter = mapTxOutputs_MWEB.find(spent_id);
+        if (iter != mapTxOutputs_MWEB.end()) {
+            info.depends.insert(iter->second->GetHash());
+        }
+    }
+
+    for (const CTxMemPoolEntry& child : e.GetMemPoolChildrenConst()) {
+        info.spent_by.push_back(child.GetTx().GetHash());
+    }
+
+    info.bip125_replaceable = IsRBFOptIn(tx, *this) == RBFTransactionState::REPLACEABLE_BIP125;
+    info.unbroadcast = IsUnbroadcastTx(tx.GetHash());
+    return info;
+}
+
+std::shared_ptr<const TxMempoolSnapshot> CTxMemPool::GetCachedSnapshot() const
+{
+    LOCK(m_snapshot_mutex);
+    auto snapshot = m_snapshot.lock();
+    if (snapshot && snapshot->transactions_updated == GetTransactionsUpdated() && snapshot->unbroadcast_updates == m_unbroadcast_updates) {
+        return snapshot;
+    }
+    return nullptr;
+}
+
+std::shared_ptr<const TxMempoolSnapshot> CTxMemPool::GetSnapshot() const
+{
+    if (auto snapshot = GetCachedSnapshot()) {
+        return snapshot;
+    }
+
+    // Only one reader rebuilds; the others wait here and then pick up its result.
+    LOCK(m_snapshot_build_mutex);
+    if (auto snapshot = GetCachedSnapshot()) {
+        return snapshot;
+    }
+
+    auto snapshot = std::make_shared<TxMempoolSnapshot>();
+    {
+        LOCK(cs);
+        snapshot->transactions_updated = GetTransactionsUpdated();
+        snapshot->unbroadcast_updates = m_unbroadcast_updates;
+        snapshot->sequence = GetSequence();
+
+        snapshot->entries.reserve(mapTx.size());
+        for (const CTxMemPoolEntry& e : mapTx) {
+            snapshot->entries.push_back(GetEntryInfo(e));
+        }
+    }
+
+    LOCK(m_snapshot_mutex);
+    m_snapshot = snapshot;
+    return snapshot;
+}
+
 CTransactionRef CTxMemPool::get(const uint256& hash) const
 {
     LOCK(cs);
@@ -1086,6 +1187,7 @@ void CTxMemPool::RemoveUnbroadcastTx(const uint256& txid, const bool unchecked)
 
     if (m_unbroadcast_txids.erase(txid))
     {
+        ++m_unbroadcast_updates;
         LogPrint(BCLog::MEMPOOL, "Removed %i from set of unbroadcast txns%s\n", txid.GetHex(), (unchecked ? " before confirmation that txn was sent out" : ""));
     }
 }
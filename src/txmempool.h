@@ -15,6 +15,7 @@
 
 #include <amount.h>
 #include <coins.h>
+#include <consensus/consensus.h>
 #include <crypto/siphash.h>
 #include <indirectmap.h>
 #include <optional.h>
@@ -28,6 +29,7 @@
 #include <boost/multi_index/ordered_index.hpp>
 #include <boost/multi_index/sequenced_index.hpp>
 #include <caches/Cache.h>
+#include <mw/consensus/Params.h>
 
 class CBlock;
 class CBlockIndex;
@@ -69,6 +71,14 @@ struct CompareIteratorByHash {
         return a->GetTx().GetHash() < b->GetTx().GetHash();
     }
 };
+
+/**
+ * MWEB data is aggregated into the block's extension block, so a transaction is only
+ * included in vtx with its mweb_tx stripped, and MWEB-only transactions not at all.
+ * Returns the transaction as it would appear in vtx, or nullptr for MWEB-only txs.
+ */
+CTransactionRef GetBlockTransaction(const CTransactionRef& tx);
+
 /** \class CTxMemPoolEntry
  *
  * CTxMemPoolEntry stores data about the corresponding transaction, as well
@@ -91,6 +101,7 @@ public:
 
 private:
     const CTransactionRef tx;
+    const CTransactionRef m_block_tx; //!< tx as included in a block's vtx, stripped of MWEB data (null for MWEB-only txs)
     mutable Parents m_parents;
     mutable Children m_children;
     const CAmount nFee;             //!< Cached to avoid expensive parent-transaction lookups
@@ -127,6 +138,7 @@ public:
 
     const CTransaction& GetTx() const { return *this->tx; }
     CTransactionRef GetSharedTx() const { return this->tx; }
+    const CTransactionRef& GetBlockTx() const { return m_block_tx; }
     const CAmount& GetFee() const { return nFee; }
     size_t GetTxSize() const;
     size_t GetTxWeight() const { return nTxWeight; }
@@ -327,9 +339,17 @@ public:
     }
 };
 
+/**
+ * Virtual bytes that one unit of MWEB weight counts as when packing blocks: the ratio of
+ * the block's vsize limit to the MWEB weight miners fill, so a package is scored by the
+ * share of both limits it uses.
+ */
+static constexpr uint64_t MWEB_WEIGHT_PACKING_VSIZE = (MAX_BLOCK_WEIGHT / WITNESS_SCALE_FACTOR) / mw::MAX_MINE_WEIGHT;
+
 /** \class CompareTxMemPoolEntryByAncestorScore
  *
- *  Sort an entry by min(score/size of entry's tx, score/size with all ancestors).
+ *  Sort an entry by min(score/size of entry's tx, score/size with all ancestors),
+ *  where size includes the MWEB weight at MWEB_WEIGHT_PACKING_VSIZE.
  */
 class CompareTxMemPoolEntryByAncestorFee
 {
@@ -358,15 +378,17 @@ public:
     {
         // Compare feerate with ancestors to feerate of the transaction, and
         // return the fee/size for the min.
-        double f1 = (double)a.GetModifiedFee() * a.GetSizeWithAncestors();
-        double f2 = (double)a.GetModFeesWithAncestors() * a.GetTxSize();
+        const double size_with_ancestors = a.GetSizeWithAncestors() + (double)a.GetMWEBWeightWithAncestors() * MWEB_WEIGHT_PACKING_VSIZE;
+        const double tx_size = a.GetTxSize() + (double)a.GetMWEBWeight() * MWEB_WEIGHT_PACKING_VSIZE;
+        double f1 = (double)a.GetModifiedFee() * size_with_ancestors;
+        double f2 = (double)a.GetModFeesWithAncestors() * tx_size;
 
         if (f1 > f2) {
             mod_fee = a.GetModFeesWithAncestors();
-            size = a.GetSizeWithAncestors();
+            size = size_with_ancestors;
         } else {
             mod_fee = a.GetModifiedFee();
-            size = a.GetTxSize();
+            size = tx_size;
         }
     }
 };
@@ -403,6 +425,58 @@ struct TxMempoolInfo
     int64_t nFeeDelta;
 };
 
+/**
+ * The state of a mempool entry as reported by RPC and REST, collected under
+ * CTxMemPool::cs so that it can be formatted after the lock is released.
+ */
+struct TxMempoolEntryInfo
+{
+    CTransactionRef tx;
+    CAmount fee;
+    CAmount modified_fee;
+    size_t vsize;
+    size_t weight;
+    uint64_t mweb_weight;
+    std::chrono::seconds time;
+    unsigned int height;
+
+    uint64_t count_with_descendants;
+    uint64_t size_with_descendants;
+    uint64_t mweb_weight_with_descendants;
+    CAmount mod_fees_with_descendants;
+
+    uint64_t count_with_ancestors;
+    uint64_t size_with_ancestors;
+    uint64_t mweb_weight_with_ancestors;
+    CAmount mod_fees_with_ancestors;
+
+    /** In-mempool parents, including the creators of spent MWEB outputs */
+    std::set<uint256> depends;
+    std::vector<uint256> spent_by;
+    bool bip125_replaceable;
+    bool unbroadcast;
+};
+
+/**
+ * An immutable view of the whole mempool, in the order of its txid index, which
+ * verbose getrawmempool has always listed it in.
+ * A snapshot is shared by all readers that ask for it while it's in use and the
+ * mempool is unchanged, so a burst of verbose getrawmempool calls takes cs once
+ * instead of once per call. It's freed with its last reader, so it doesn't keep
+ * evicted transactions in memory.
+ */
+struct TxMempoolSnapshot
+{
+    /** The GetTransactionsUpdated() value the snapshot was taken at */
+    unsigned int transactions_updated{0};
+    /** The number of unbroadcast set changes the snapshot was taken at */
+    uint64_t unbroadcast_updates{0};
+    /** The mempool sequence the snapshot was taken at */
+    uint64_t sequence{0};
+
+    std::vector<TxMempoolEntryInfo> entries;
+};
+
 /** Reason why a transaction was removed from the mempool,
  * this is passed to the notification signal.
  */
@@ -527,6 +601,16 @@ private:
 
     bool m_is_loaded GUARDED_BY(cs){false};
 
+    //! Incremented whenever m_unbroadcast_txids changes, which doesn't bump nTransactionsUpdated
+    std::atomic<uint64_t> m_unbroadcast_updates{0};
+
+    //! Serializes snapshot rebuilds, so that concurrent readers share one. Always taken before cs.
+    mutable Mutex m_snapshot_build_mutex;
+    mutable Mutex m_snapshot_mutex;
+    mutable std::weak_ptr<const TxMempoolSnapshot> m_snapshot GUARDED_BY(m_snapshot_mutex);
+
+    std::shared_ptr<const TxMempoolSnapshot> GetCachedSnapshot() const EXCLUSIVE_LOCKS_REQUIRED(!m_snapshot_mutex);
+
 public:
 
     static const int ROLLING_FEE_HALFLIFE = 60 * 60 * 12; // public only for testing
@@ -798,6 +882,17 @@ public:
     TxMempoolInfo info(const GenTxid& gtxid) const;
     std::vector<TxMempoolInfo> infoAll() const;
 
+    /** Collects the RPC-visible state of an entry, see TxMempoolEntryInfo. */
+    TxMempoolEntryInfo GetEntryInfo(const CTxMemPoolEntry& entry) const EXCLUSIVE_LOCKS_REQUIRED(cs);
+
+    /**
+     * Returns a consistent view of all mempool entries without holding cs while
+     * the caller processes it. The view is shared while it's in use and the mempool
+     * doesn't change.
+     * Must not be called with cs held, as rebuilding the snapshot takes cs.
+     */
+    std::shared_ptr<const TxMempoolSnapshot> GetSnapshot() const LOCKS_EXCLUDED(cs);
+
     size_t DynamicMemoryUsage() const;
 
     /** Adds a transaction to the unbroadcast set */
@@ -806,7 +901,7 @@ public:
         LOCK(cs);
         // Sanity check the transaction is in the mempool & insert into
         // unbroadcast set.
-        if (exists(txid)) m_unbroadcast_txids.insert(txid);
+        if (exists(txid) && m_unbroadcast_txids.insert(txid).second) ++m_unbroadcast_updates;
     };
 
     /** Removes a transaction from the unbroadcast set */
@@ -0,0 +1,56 @@
+// Copyright (c) 2021 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <util/threadpool.h>
+
+#include <tinyformat.h>
+#include <util/system.h>
+#include <util/threadnames.h>
+
+#include <algorithm>
+
+ThreadPool::ThreadPool(const std::string& name, size_t num_threads)
+{
+    num_threads = std::max<size_t>(1, num_threads);
+    m_workers.reserve(num_threads);
+    for (size_t n = 0; n < num_threads; ++n) {
+        m_workers.emplace_back([this, name, n] {
+            util::ThreadRename(strprintf("%s.%i", name, n));
+            Run();
+        });
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        LOCK(m_mutex);
+        m_stop = true;
+        m_tasks.clear();
+    }
+    m_cond.notify_all();
+    for (std::thread& worker : m_workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::Run()
+{
+    while (true) {
+        std::function<void()> task;
+        {
+            WAIT_LOCK(m_mutex, lock);
+            m_cond.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return m_stop || !m_tasks.empty(); });
+            if (m_stop) return;
+            task = std::move(m_tasks.front());
+            m_tasks.pop_front();
+        }
+        task();
+    }
+}
+
+size_t ReadAheadThreadCount(size_t max_threads)
+{
+    return std::max<size_t>(1, std::min<size_t>(GetNumCores(), max_threads));
+}
@@ -0,0 +1,70 @@
+// Copyright (c) 2021 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_UTIL_THREADPOOL_H
+#define BITCOIN_UTIL_THREADPOOL_H
+
+#include <sync.h>
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+ * A fixed number of worker threads, which run tasks in the order they're submitted.
+ *
+ * It's used to prepare work ahead of a thread that consumes the results in order, like
+ * reading blocks ahead of a rescan or an index sync. The consumer bounds the work in
+ * flight by keeping only a few futures per worker.
+ *
+ * Tasks that haven't started when the pool is destroyed are dropped, and their futures
+ * throw std::future_error. Destroying the pool waits for the running tasks.
+ */
+class ThreadPool
+{
+public:
+    /** Starts num_threads workers, at least one, named <name>.<n>. */
+    ThreadPool(const std::string& name, size_t num_threads);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /** Queue fn to run on a worker. An exception thrown by fn is rethrown by the future. */
+    template <typename F>
+    auto Submit(F&& fn) -> std::future<decltype(fn())>
+    {
+        using Result = decltype(fn());
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(fn));
+        std::future<Result> result = task->get_future();
+        {
+            LOCK(m_mutex);
+            m_tasks.emplace_back([task] { (*task)(); });
+        }
+        m_cond.notify_one();
+        return result;
+    }
+
+    size_t WorkerCount() const { return m_workers.size(); }
+
+private:
+    Mutex m_mutex;
+    std::condition_variable m_cond;
+    std::deque<std::function<void()>> m_tasks GUARDED_BY(m_mutex);
+    bool m_stop GUARDED_BY(m_mutex){false};
+    std::vector<std::thread> m_workers;
+
+    void Run();
+};
+
+/** Number of threads to read ahead of a consumer with: one per core, but at least 1 and at most max_threads. */
+size_t ReadAheadThreadCount(size_t max_threads);
+
+#endif // BITCOIN_UTIL_THREADPOOL_H
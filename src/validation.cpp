@@ -48,11 +48,15 @@
 #include <util/rbf.h>
 #include <util/strencodings.h>
 #include <util/system.h>
+#include <util/threadpool.h>
 #include <util/translation.h>
 #include <validationinterface.h>
 #include <warnings.h>
 
+#include <deque>
+#include <future>
 #include <string>
+#include <unordered_set>
 
 #include <boost/algorithm/string/replace.hpp>
 
@@ -202,6 +206,7 @@ CBlockIndex* FindForkInGlobalIndex(const CChain& chain, const CBlockLocator& loc
 std::unique_ptr<CBlockTreeDB> pblocktree;
 
 bool CheckInputScripts(const CTransaction& tx, TxValidationState &state, const CCoinsViewCache &inputs, unsigned int flags, bool cacheSigStore, bool cacheFullScriptStore, PrecomputedTransactionData& txdata, std::vector<CScriptCheck> *pvChecks = nullptr);
+static bool CheckInputScriptsParallel(const CTransaction& tx, TxValidationState &state, const CCoinsViewCache &inputs, unsigned int flags, bool cacheSigStore, bool cacheFullScriptStore, PrecomputedTransactionData& txdata) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 static FILE* OpenUndoFile(const FlatFilePos &pos, bool fReadOnly = false);
 static FlatFileSeq BlockFileSeq();
 static FlatFileSeq UndoFileSeq();
@@ -444,7 +449,7 @@ static bool CheckInputsFromMempoolAndCache(const CTransaction& tx, TxValidationS
     }
 
     // Call CheckInputScripts() to cache signature and script validity against current tip consensus rules.
-    return CheckInputScripts(tx, state, view, flags, /* cacheSigStore = */ true, /* cacheFullSciptStore = */ true, txdata);
+    return CheckInputScriptsParallel(tx, state, view, flags, /* cacheSigStore = */ true, /* cacheFullSciptStore = */ true, txdata);
 }
 
 namespace {
@@ -476,6 +481,8 @@ public:
         std::vector<OutputIndex>& m_coins_to_uncache;
         const bool m_test_accept;
         CAmount* m_fee_out;
+        /** Whether the context-free checks (CheckTransactionContextFree) already passed */
+        const bool m_context_free_checked{false};
     };
 
     // Single transaction acceptance
@@ -572,7 +579,7 @@ bool MemPoolAccept::PreChecks(ATMPArgs& args, Workspace& ws)
     CAmount& nConflictingFees = ws.m_conflicting_fees;
     size_t& nConflictingSize = ws.m_conflicting_size;
 
-    if (!CheckTransaction(tx, state)) {
+    if (!args.m_context_free_checked && !CheckTransaction(tx, state)) {
         return false; // state filled in by CheckTransaction
     }
 
@@ -582,7 +589,7 @@ bool MemPoolAccept::PreChecks(ATMPArgs& args, Workspace& ws)
     }
 
     // MWEB: Check MWEB tx
-    if (!MWEB::Node::CheckTransaction(tx, state)) {
+    if (!args.m_context_free_checked && !MWEB::Node::CheckTransaction(tx, state)) {
         return false; // state filled in by CheckTransaction
     }
 
@@ -961,13 +968,13 @@ bool MemPoolAccept::PolicyScriptChecks(ATMPArgs& args, Workspace& ws, Precompute
 
     // Check input scripts and signatures.
     // This is done last to help prevent CPU exhaustion denial-of-service attacks.
-    if (!CheckInputScripts(tx, state, m_view, scriptVerifyFlags, true, false, txdata)) {
+    if (!CheckInputScriptsParallel(tx, state, m_view, scriptVerifyFlags, true, false, txdata)) {
         // SCRIPT_VERIFY_CLEANSTACK requires SCRIPT_VERIFY_WITNESS, so we
         // need to turn both off, and compare against just turning off CLEANSTACK
         // to see if the failure is specifically due to witness validation.
         TxValidationState state_dummy; // Want reported failures to be from first CheckInputScripts
-        if (!tx.HasWitness() && CheckInputScripts(tx, state_dummy, m_view, scriptVerifyFlags & ~(SCRIPT_VERIFY_WITNESS | SCRIPT_VERIFY_CLEANSTACK), true, false, txdata) &&
-                !CheckInputScripts(tx, state_dummy, m_view, scriptVerifyFlags & ~SCRIPT_VERIFY_CLEANSTACK, true, false, txdata)) {
+        if (!tx.HasWitness() && CheckInputScriptsParallel(tx, state_dummy, m_view, scriptVerifyFlags & ~(SCRIPT_VERIFY_WITNESS | SCRIPT_VERIFY_CLEANSTACK), true, false, txdata) &&
+                !CheckInputScriptsParallel(tx, state_dummy, m_view, scriptVerifyFlags & ~SCRIPT_VERIFY_CLEANSTACK, true, false, txdata)) {
             // Only the witness is missing, so the transaction itself may be fine.
             state.Invalid(TxValidationResult::TX_WITNESS_STRIPPED,
                     state.GetRejectReason(), state.GetDebugMessage());
@@ -1091,10 +1098,10 @@ bool MemPoolAccept::AcceptSingleTransaction(const CTransactionRef& ptx, ATMPArgs
 /** (try to) add transaction to memory pool with a specified acceptance time **/
 static bool AcceptToMemoryPoolWithTime(const CChainParams& chainparams, CTxMemPool& pool, TxValidationState &state, const CTransactionRef &tx,
                         int64_t nAcceptTime, std::list<CTransactionRef>* plTxnReplaced,
-                        bool bypass_limits, bool test_accept, CAmount* fee_out=nullptr) EXCLUSIVE_LOCKS_REQUIRED(cs_main)
+                        bool bypass_limits, bool test_accept, CAmount* fee_out=nullptr, bool context_free_checked=false) EXCLUSIVE_LOCKS_REQUIRED(cs_main)
 {
     std::vector<OutputIndex> coins_to_uncache;
-    MemPoolAccept::ATMPArgs args { chainparams, state, nAcceptTime, plTxnReplaced, bypass_limits, coins_to_uncache, test_accept, fee_out };
+    MemPoolAccept::ATMPArgs args { chainparams, state, nAcceptTime, plTxnReplaced, bypass_limits, coins_to_uncache, test_accept, fee_out, context_free_checked };
     bool res = MemPoolAccept(pool).AcceptSingleTransaction(tx, args);
     if (!res) {
         // Remove coins that were not present in the coins cache before calling ATMPW;
@@ -1283,11 +1290,12 @@ CoinsViews::CoinsViews(
     bool in_memory,
     bool should_wipe) : m_dbview(
                             GetDataDir() / ldb_name, cache_size_bytes, in_memory, should_wipe),
-                        m_catcherview(&m_dbview) {}
+                        m_catcherview(&m_dbview),
+                        m_writebehindview(&m_catcherview, m_dbview) {}
 
 void CoinsViews::InitCache()
 {
-    m_cacheview = MakeUnique<CCoinsViewCache>(&m_catcherview);
+    m_cacheview = MakeUnique<CCoinsViewCache>(&m_writebehindview);
 }
 
 CChainState::CChainState(CTxMemPool& mempool, BlockManager& blockman, uint256 from_snapshot_blockhash)
@@ -1531,17 +1539,26 @@ int GetSpendHeight(const CCoinsViewCache& inputs)
 }
 
 
+// Accessed under cs_main
 static CuckooCache::cache<uint256, SignatureCacheHasher> g_scriptExecutionCache;
+static uint256 g_scriptExecutionCacheNonce;
 static CSHA256 g_scriptExecutionCacheHasher;
+static const char* const SCRIPT_CACHE_FILENAME = "scriptcache.dat";
 
-void InitScriptExecutionCache() {
-    // Setup the salted hasher
-    uint256 nonce = GetRandHash();
+static void SetScriptExecutionCacheNonce(const uint256& nonce)
+{
+    g_scriptExecutionCacheNonce = nonce;
     // We want the nonce to be 64 bytes long to force the hasher to process
     // this chunk, which makes later hash computations more efficient. We
     // just write our 32-byte entropy twice to fill the 64 bytes.
+    g_scriptExecutionCacheHasher = CSHA256();
     g_scriptExecutionCacheHasher.Write(nonce.begin(), 32);
     g_scriptExecutionCacheHasher.Write(nonce.begin(), 32);
+}
+
+void InitScriptExecutionCache() {
+    // Setup the salted hasher
+    SetScriptExecutionCacheNonce(GetRandHash());
     // nMaxCacheSize is unsigned. If -maxsigcachesize is set to zero,
     // setup_bytes creates the minimum possible cache (2 elements).
     size_t nMaxCacheSize = std::min(std::max((int64_t)0, gArgs.GetArg("-maxsigcachesize", DEFAULT_MAX_SIG_CACHE_SIZE) / 2), MAX_MAX_SIG_CACHE_SIZE) * ((size_t) 1 << 20);
@@ -1550,6 +1567,42 @@ void InitScriptExecutionCache() {
             (nElems*sizeof(uint256)) >>20, (nMaxCacheSize*2)>>20, nElems);
 }
 
+bool ReadScriptExecutionCacheNonce()
+{
+    uint256 nonce;
+    if (!ReadSaltedCacheNonce(GetDataDir() / SCRIPT_CACHE_FILENAME, nonce)) return false;
+    SetScriptExecutionCacheNonce(nonce);
+    return true;
+}
+
+bool LoadScriptExecutionCache()
+{
+    int64_t start = GetTimeMicros();
+    size_t count = 0;
+    bool ret = LoadSaltedCacheEntries(GetDataDir() / SCRIPT_CACHE_FILENAME, g_scriptExecutionCacheNonce, [&count](const std::vector<uint256>& entries) {
+        LOCK(cs_main);
+        for (const uint256& entry : entries) {
+            g_scriptExecutionCache.insert(entry);
+        }
+        count += entries.size();
+    });
+    if (ret) LogPrintf("Loaded %u script execution cache entries: %gs\n", count, (GetTimeMicros() - start) * MICRO);
+    return ret;
+}
+
+bool DumpScriptExecutionCache()
+{
+    int64_t start = GetTimeMicros();
+    std::vector<uint256> entries;
+    {
+        LOCK(cs_main);
+        g_scriptExecutionCache.for_each([&entries](const uint256& entry) { entries.push_back(entry); });
+    }
+    if (!DumpSaltedCacheEntries(GetDataDir() / SCRIPT_CACHE_FILENAME, g_scriptExecutionCacheNonce, entries)) return false;
+    LogPrintf("Dumped %u script execution cache entries: %gs\n", entries.size(), (GetTimeMicros() - start) * MICRO);
+    return true;
+}
+
 /**
  * Check whether all of this transaction's input scripts succeed.
  *
@@ -1569,6 +1622,44 @@ void InitScriptExecutionCache() {
  *
  * Non-static (and re-declared) in src/test/txvalidationcache_tests.cpp
  */
+static uint256 GetScriptExecutionCacheEntry(const CTransaction& tx, unsigned int flags)
+{
+    uint256 hashCacheEntry;
+    CSHA256 hasher = g_scriptExecutionCacheHasher;
+    hasher.Write(tx.GetWitnessHash().begin(), 32).Write((unsigned char*)&flags, sizeof(flags)).Finalize(hashCacheEntry.begin());
+    return hashCacheEntry;
+}
+
+/** Fill in state for a script check of tx that failed with the given flags. */
+static bool ScriptCheckFailed(const CTransaction& tx, TxValidationState &state, const CScriptCheck& check, unsigned int flags, bool cacheSigStore, PrecomputedTransactionData& txdata)
+{
+    const unsigned int i = check.GetInputIndex();
+    if (flags & STANDARD_NOT_MANDATORY_VERIFY_FLAGS) {
+        // Check whether the failure was caused by a
+        // non-mandatory script verification check, such as
+        // non-standard DER encodings or non-null dummy
+        // arguments; if so, ensure we return NOT_STANDARD
+        // instead of CONSENSUS to avoid downstream users
+        // splitting the network between upgraded and
+        // non-upgraded nodes by banning CONSENSUS-failing
+        // data providers.
+        CScriptCheck check2(txdata.m_spent_outputs[i], tx, i,
+                flags & ~STANDARD_NOT_MANDATORY_VERIFY_FLAGS, cacheSigStore, &txdata);
+        if (check2())
+            return state.Invalid(TxValidationResult::TX_NOT_STANDARD, strprintf("non-mandatory-script-verify-flag (%s)", ScriptErrorString(check.GetScriptError())));
+    }
+    // MANDATORY flag failures correspond to
+    // TxValidationResult::TX_CONSENSUS. Because CONSENSUS
+    // failures are the most serious case of validation
+    // failures, we may need to consider using
+    // RECENT_CONSENSUS_CHANGE for any script failure that
+    // could be due to non-upgraded nodes which we may want to
+    // support, to avoid splitting the network (but this
+    // depends on the details of how net_processing handles
+    // such errors).
+    return state.Invalid(TxValidationResult::TX_CONSENSUS, strprintf("mandatory-script-verify-flag-failed (%s)", ScriptErrorString(check.GetScriptError())));
+}
+
 bool CheckInputScripts(const CTransaction& tx, TxValidationState &state, const CCoinsViewCache &inputs, unsigned int flags, bool cacheSigStore, bool cacheFullScriptStore, PrecomputedTransactionData& txdata, std::vector<CScriptCheck> *pvChecks) EXCLUSIVE_LOCKS_REQUIRED(cs_main)
 {
     if (tx.IsCoinBase()) return true;
@@ -1582,9 +1673,7 @@ bool CheckInputScripts(const CTransaction& tx, TxValidationState &state, const C
     // correct (ie that the transaction hash which is in tx's prevouts
     // properly commits to the scriptPubKey in the inputs view of that
     // transaction).
-    uint256 hashCacheEntry;
-    CSHA256 hasher = g_scriptExecutionCacheHasher;
-    hasher.Write(tx.GetWitnessHash().begin(), 32).Write((unsigned char*)&flags, sizeof(flags)).Finalize(hashCacheEntry.begin());
+    const uint256 hashCacheEntry = GetScriptExecutionCacheEntry(tx, flags);
     AssertLockHeld(cs_main); //TODO: Remove this requirement by making CuckooCache not require external locks
     if (g_scriptExecutionCache.contains(hashCacheEntry, !cacheFullScriptStore)) {
         return true;
@@ -1618,30 +1707,7 @@ bool CheckInputScripts(const CTransaction& tx, TxValidationState &state, const C
             pvChecks->push_back(CScriptCheck());
             check.swap(pvChecks->back());
         } else if (!check()) {
-            if (flags & STANDARD_NOT_MANDATORY_VERIFY_FLAGS) {
-                // Check whether the failure was caused by a
-                // non-mandatory script verification check, such as
-                // non-standard DER encodings or non-null dummy
-                // arguments; if so, ensure we return NOT_STANDARD
-                // instead of CONSENSUS to avoid downstream users
-                // splitting the network between upgraded and
-                // non-upgraded nodes by banning CONSENSUS-failing
-                // data providers.
-                CScriptCheck check2(txdata.m_spent_outputs[i], tx, i,
-                        flags & ~STANDARD_NOT_MANDATORY_VERIFY_FLAGS, cacheSigStore, &txdata);
-                if (check2())
-                    return state.Invalid(TxValidationResult::TX_NOT_STANDARD, strprintf("non-mandatory-script-verify-flag (%s)", ScriptErrorString(check.GetScriptError())));
-            }
-            // MANDATORY flag failures correspond to
-            // TxValidationResult::TX_CONSENSUS. Because CONSENSUS
-            // failures are the most serious case of validation
-            // failures, we may need to consider using
-            // RECENT_CONSENSUS_CHANGE for any script failure that
-            // could be due to non-upgraded nodes which we may want to
-            // support, to avoid splitting the network (but this
-            // depends on the details of how net_processing handles
-            // such errors).
-            return state.Invalid(TxValidationResult::TX_CONSENSUS, strprintf("mandatory-script-verify-flag-failed (%s)", ScriptErrorString(check.GetScriptError())));
+            return ScriptCheckFailed(tx, state, check, flags, cacheSigStore, txdata);
         }
     }
 
@@ -1897,6 +1963,41 @@ void ThreadScriptCheck(int worker_num) {
     scriptcheckqueue.Thread();
 }
 
+/**
+ * Mempool variant of CheckInputScripts. Transactions with at least
+ * MEMPOOL_PARALLEL_SCRIPT_CHECK_MIN_INPUTS inputs have their scripts verified on
+ * the script-checking threads, so that a large consolidation doesn't stall
+ * message processing for as long. The queue is shared with ConnectBlock, which
+ * is fine as both hold cs_main.
+ */
+static bool CheckInputScriptsParallel(const CTransaction& tx, TxValidationState &state, const CCoinsViewCache &inputs, unsigned int flags, bool cacheSigStore, bool cacheFullScriptStore, PrecomputedTransactionData& txdata) EXCLUSIVE_LOCKS_REQUIRED(cs_main)
+{
+    AssertLockHeld(cs_main);
+    if (!g_parallel_script_checks || tx.vin.size() < MEMPOOL_PARALLEL_SCRIPT_CHECK_MIN_INPUTS) {
+        return CheckInputScripts(tx, state, inputs, flags, cacheSigStore, cacheFullScriptStore, txdata);
+    }
+
+    std::vector<CScriptCheck> vChecks;
+    if (!CheckInputScripts(tx, state, inputs, flags, cacheSigStore, cacheFullScriptStore, txdata, &vChecks)) {
+        return false;
+    }
+    if (vChecks.empty()) {
+        return true; // script execution cache hit
+    }
+
+    CCheckQueueControl<CScriptCheck> control(&scriptcheckqueue);
+    control.Add(vChecks);
+    CScriptCheck failed;
+    if (control.Wait(&failed)) {
+        if (cacheFullScriptStore) {
+            g_scriptExecutionCache.insert(GetScriptExecutionCacheEntry(tx, flags));
+        }
+        return true;
+    }
+    // Report the error of the first check that failed, like a serial check would
+    return ScriptCheckFailed(tx, state, failed, flags, cacheSigStore, txdata);
+}
+
 VersionBitsCache versionbitscache GUARDED_BY(cs_main);
 
 int32_t ComputeBlockVersion(const CBlockIndex* pindexPrev, const Consensus::Params& params)
@@ -1993,6 +2094,74 @@ static int64_t nTimeCallbacks = 0;
 static int64_t nTimeTotal = 0;
 static int64_t nBlocksTotal = 0;
 
+//! Maximum number of workers reading the coins spent by a block ahead of its connection
+static const size_t MAX_COINS_PREFETCH_THREADS = 16;
+//! Minimum number of coins read by each of their tasks
+static const size_t MIN_COINS_PREFETCH_PER_THREAD = 32;
+
+/**
+ * Read the coins spent by a block that aren't in the coins cache from the view below
+ * it, on the workers of pool, and add them to the cache. Otherwise each of them is a
+ * separate synchronous database read when the block is connected.
+ *
+ * The MWEB coins spent by the block are read too. There is no cache for them, so this
+ * only loads them into the database's block cache.
+ */
+static void PrefetchBlockCoins(ThreadPool& pool, const CBlock& block, CCoinsViewCache& cache, const CCoinsView& base) EXCLUSIVE_LOCKS_REQUIRED(cs_main)
+{
+    AssertLockHeld(cs_main);
+
+    std::unordered_set<uint256, SaltedTxidHasher> block_txids;
+    for (const auto& tx : block.vtx) {
+        block_txids.insert(tx->GetHash());
+    }
+    std::vector<COutPoint> outpoints;
+    for (const auto& tx : block.vtx) {
+        if (tx->IsCoinBase()) continue;
+        for (const CTxIn& txin : tx->vin) {
+            // Coins created by the block itself aren't in the database
+            if (block_txids.count(txin.prevout.hash) || cache.HaveCoinInCache(txin.prevout)) continue;
+            outpoints.push_back(txin.prevout);
+        }
+    }
+    std::vector<mw::Hash> output_ids;
+    const mw::ICoinsView::Ptr mweb_view = base.GetMWEBView();
+    if (!block.mweb_block.IsNull() && mweb_view) {
+        for (const Input& input : block.mweb_block.m_block->GetInputs()) {
+            output_ids.push_back(input.GetOutputID());
+        }
+    }
+
+    const size_t num_tasks = std::min(pool.WorkerCount(), (outpoints.size() + output_ids.size()) / MIN_COINS_PREFETCH_PER_THREAD);
+    if (num_tasks < 2) return;
+
+    // Task i reads every num_tasks-th coin, starting with the i-th. Errors are left
+    // for the reads on the validation thread to report.
+    std::vector<std::future<std::vector<std::pair<COutPoint, Coin>>>> reads;
+    for (size_t i = 0; i < num_tasks; ++i) {
+        reads.push_back(pool.Submit([&, i] {
+            std::vector<std::pair<COutPoint, Coin>> coins;
+            try {
+                for (size_t j = i; j < outpoints.size(); j += num_tasks) {
+                    Coin coin;
+                    if (base.GetCoin(outpoints[j], coin)) coins.emplace_back(outpoints[j], std::move(coin));
+                }
+                for (size_t j = i; j < output_ids.size(); j += num_tasks) {
+                    mweb_view->GetUTXO(output_ids[j]);
+                }
+            } catch (const std::exception& e) {
+                LogPrint(BCLog::COINDB, "Failed to prefetch the coins of block %s: %s\n", block.GetHash().ToString(), e.what());
+            }
+            return coins;
+        }));
+    }
+    // The coins below the cache can't change while cs_main is held (a background write
+    // only moves them from its snapshot to the database), so the coins read are current
+    for (auto& read : reads) {
+        cache.AddFetchedCoins(read.get());
+    }
+}
+
 /** Apply the effects of this block (with given index) on the UTXO set represented by coins.
  *  Validity checks that depend on the UTXO set are also done; ConnectBlock()
  *  can fail if those validity checks fail (among other reasons). */
@@ -2179,6 +2348,11 @@ bool CChainState::ConnectBlock(const CBlock& block, BlockValidationState& state,
     int64_t nTime2 = GetTimeMicros(); nTimeForks += nTime2 - nTime1;
     LogPrint(BCLog::BENCH, "    - Fork checks: %.2fms [%.2fs (%.2fms/blk)]\n", MILLI * (nTime2 - nTime1), nTimeForks * MICRO, nTimeForks * MILLI / nBlocksTotal);
 
+    if (!m_prefetch_pool) {
+        m_prefetch_pool = MakeUnique<ThreadPool>("prefetch", ReadAheadThreadCount(MAX_COINS_PREFETCH_THREADS));
+    }
+    PrefetchBlockCoins(*m_prefetch_pool, block, CoinsTip(), CoinsWriteBehind());
+
     CBlockUndo blockundo;
 
     // Precomputed transaction data pointers must not be invalidated
@@ -2446,6 +2620,11 @@ bool CChainState::FlushStateToDisk(
             if (fFlushForPrune) {
                 LOG_TIME_MILLIS_WITH_CATEGORY("unlink pruned files", BCLog::BENCH);
 
+                // A background write that is interrupted is replayed from its blocks
+                if (!CoinsWriteBehind().Wait()) {
+                    return AbortNode(state, "Failed to write to coin database");
+                }
+
                 UnlinkPrunedFiles(setFilesToPrune);
             }
             nLastWrite = nNow;
@@ -2463,8 +2642,12 @@ bool CChainState::FlushStateToDisk(
             if (!CheckDiskSpace(GetDataDir(), 48 * 2 * 2 * CoinsTip().GetCacheSize())) {
                 return AbortNode(state, "Disk space is too low!", _("Disk space is too low!"));
             }
-            // Flush the chainstate (which may refer to block index entries).
-            if (!CoinsTip().Flush())
+            // Flush the chainstate (which may refer to block index entries). The
+            // block index was written above, so that a background write that is
+            // interrupted can be replayed after a restart.
+            const bool background = mode != FlushStateMode::ALWAYS && !fFlushForPrune &&
+                gArgs.GetBoolArg("-backgroundflush", DEFAULT_BACKGROUND_FLUSH);
+            if (!(background ? CoinsWriteBehind().StartWrite(CoinsTip()) : CoinsTip().Flush()))
                 return AbortNode(state, "Failed to write to coin database");
             nLastFlush = nNow;
             full_flush_completed = true;
@@ -5130,6 +5313,10 @@ bool CChainState::ResizeCoinsCaches(size_t coinstip_size, size_t coinsdb_size)
         // Cache sizes are unchanged, no need to continue.
         return true;
     }
+    // The database is reopened, so let a background write finish first
+    if (!CoinsWriteBehind().Wait()) {
+        return false;
+    }
     size_t old_coinstip_size = m_coinstip_cache_size_bytes;
     m_coinstip_cache_size_bytes = coinstip_size;
     m_coinsdb_cache_size_bytes = coinsdb_size;
@@ -5187,6 +5374,30 @@ int VersionBitsTipStateSinceHeight(const Consensus::Params& params, Consensus::D
 }
 
 static const uint64_t MEMPOOL_DUMP_VERSION = 1;
+//! Number of transactions checked in one task while loading the mempool
+static const size_t MEMPOOL_LOAD_BATCH_SIZE = 128;
+//! Maximum number of batches checked ahead of admission while loading the mempool
+static const size_t MAX_MEMPOOL_LOAD_AHEAD = 16;
+
+/** The checks of a transaction that don't depend on the chain or the mempool, which
+ * are safe to run on any thread. This includes the MWEB signature and range proof
+ * verification. */
+static bool CheckTransactionContextFree(const CTransaction& tx, TxValidationState& state)
+{
+    return CheckTransaction(tx, state) && MWEB::Node::CheckTransaction(tx, state);
+}
+
+namespace {
+/** A transaction read from mempool.dat */
+struct MempoolLoadEntry
+{
+    CTransactionRef tx;
+    int64_t time;
+    int64_t fee_delta;
+    //! Result of CheckTransactionContextFree, if the transaction hasn't expired
+    TxValidationState state;
+};
+} // namespace
 
 bool LoadMempool(CTxMemPool& pool)
 {
@@ -5206,6 +5417,54 @@ bool LoadMempool(CTxMemPool& pool)
     int64_t unbroadcast = 0;
     int64_t nNow = GetTime();
 
+    // Transactions are read in batches, whose context-free checks run on the
+    // check_pool workers. The batches are then admitted to the mempool in file
+    // order, holding cs_main once per batch.
+    ThreadPool check_pool("loadmempool", ReadAheadThreadCount(MAX_MEMPOOL_LOAD_AHEAD));
+    const size_t check_ahead = check_pool.WorkerCount();
+    std::deque<std::future<std::vector<MempoolLoadEntry>>> checking;
+    const auto check_batch = [&](std::vector<MempoolLoadEntry> batch) {
+        checking.push_back(check_pool.Submit([batch = std::move(batch), nNow, nExpiryTimeout]() mutable {
+            for (MempoolLoadEntry& entry : batch) {
+                if (entry.time > nNow - nExpiryTimeout) CheckTransactionContextFree(*entry.tx, entry.state);
+            }
+            return std::move(batch);
+        }));
+    };
+    const auto admit_batch = [&](std::vector<MempoolLoadEntry> batch) {
+        LOCK(cs_main);
+        for (MempoolLoadEntry& entry : batch) {
+            CAmount amountdelta = entry.fee_delta;
+            if (amountdelta) {
+                pool.PrioritiseTransaction(entry.tx->GetHash(), amountdelta);
+            }
+            if (entry.time <= nNow - nExpiryTimeout) {
+                ++expired;
+                continue;
+            }
+            TxValidationState& state = entry.state;
+            if (state.IsValid()) {
+                AcceptToMemoryPoolWithTime(chainparams, pool, state, entry.tx, entry.time,
+                                           nullptr /* plTxnReplaced */, false /* bypass_limits */,
+                                           false /* test_accept */, nullptr /* fee_out */,
+                                           true /* context_free_checked */);
+            }
+            if (state.IsValid()) {
+                ++count;
+            } else {
+                // mempool may contain the transaction already, e.g. from
+                // wallet(s) having loaded it while we were processing
+                // mempool transactions; consider these as valid, instead of
+                // failed, but mark them as 'already there'
+                if (pool.exists(entry.tx->GetHash())) {
+                    ++already_there;
+                } else {
+                    ++failed;
+                }
+            }
+        }
+    };
+
     try {
         uint64_t version;
         file >> version;
@@ -5214,43 +5473,31 @@ bool LoadMempool(CTxMemPool& pool)
         }
         uint64_t num;
         file >> num;
+        std::vector<MempoolLoadEntry> batch;
         while (num--) {
-            CTransactionRef tx;
-            int64_t nTime;
-            int64_t nFeeDelta;
-            file >> tx;
-            file >> nTime;
-            file >> nFeeDelta;
-
-            CAmount amountdelta = nFeeDelta;
-            if (amountdelta) {
-                pool.PrioritiseTransaction(tx->GetHash(), amountdelta);
+            MempoolLoadEntry entry;
+            file >> entry.tx;
+            file >> entry.time;
+            file >> entry.fee_delta;
+            batch.push_back(std::move(entry));
+
+            if (batch.size() == MEMPOOL_LOAD_BATCH_SIZE || num == 0) {
+                check_batch(std::move(batch));
+                batch.clear();
             }
-            TxValidationState state;
-            if (nTime > nNow - nExpiryTimeout) {
-                LOCK(cs_main);
-                AcceptToMemoryPoolWithTime(chainparams, pool, state, tx, nTime,
-                                           nullptr /* plTxnReplaced */, false /* bypass_limits */,
-                                           false /* test_accept */);
-                if (state.IsValid()) {
-                    ++count;
-                } else {
-                    // mempool may contain the transaction already, e.g. from
-                    // wallet(s) having loaded it while we were processing
-                    // mempool transactions; consider these as valid, instead of
-                    // failed, but mark them as 'already there'
-                    if (pool.exists(tx->GetHash())) {
-                        ++already_there;
-                    } else {
-                        ++failed;
-                    }
-                }
-            } else {
-                ++expired;
+            if (checking.size() >= check_ahead) {
+                admit_batch(checking.front().get());
+                checking.pop_front();
             }
             if (ShutdownRequested())
                 return false;
         }
+        while (!checking.empty()) {
+            admit_batch(checking.front().get());
+            checking.pop_front();
+            if (ShutdownRequested())
+                return false;
+        }
         std::map<uint256, CAmount> mapDeltas;
         file >> mapDeltas;
 
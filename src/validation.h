@@ -21,6 +21,7 @@
 #include <sync.h>
 #include <txmempool.h> // For CTxMemPool::cs
 #include <txdb.h>
+#include <util/threadpool.h>
 #include <versionbits.h>
 #include <serialize.h>
 
@@ -70,12 +71,16 @@ static const unsigned int MAX_BLOCKFILE_SIZE = 0x8000000; // 128 MiB
 static const int MAX_SCRIPTCHECK_THREADS = 15;
 /** -par default (number of script-checking threads, 0 = auto) */
 static const int DEFAULT_SCRIPTCHECK_THREADS = 0;
+/** Minimum number of inputs for a transaction's mempool script checks to use the script-checking threads */
+static const unsigned int MEMPOOL_PARALLEL_SCRIPT_CHECK_MIN_INPUTS = 16;
 static const int64_t DEFAULT_MAX_TIP_AGE = 24 * 60 * 60;
 static const bool DEFAULT_CHECKPOINTS_ENABLED = true;
 static const bool DEFAULT_TXINDEX = false;
 static const char* const DEFAULT_BLOCKFILTERINDEX = "1";
 /** Default for -persistmempool */
 static const bool DEFAULT_PERSIST_MEMPOOL = true;
+/** Default for -backgroundflush */
+static const bool DEFAULT_BACKGROUND_FLUSH = false;
 /** Default for -mempoolreplacement */
 static const bool DEFAULT_ENABLE_REPLACEMENT = false;
 /** Default for using fee filter */
@@ -289,10 +294,18 @@ public:
     }
 
     ScriptError GetScriptError() const { return error; }
+    unsigned int GetInputIndex() const { return nIn; }
 };
 
 /** Initializes the script-execution cache */
 void InitScriptExecutionCache();
+/** Salt the script-execution cache with the nonce of the cache saved on disk. Must be
+ * called before the cache is first used. */
+bool ReadScriptExecutionCacheNonce();
+/** Insert the entries of the script-execution cache saved on disk. */
+bool LoadScriptExecutionCache();
+/** Save the script-execution cache to disk. */
+bool DumpScriptExecutionCache();
 
 
 /** Functions for disk access for blocks */
@@ -478,6 +491,9 @@ public:
     //! This view wraps access to the leveldb instance and handles read errors gracefully.
     CCoinsViewErrorCatcher m_catcherview GUARDED_BY(cs_main);
 
+    //! This view writes the cache to the database on a background thread, when requested.
+    CCoinsViewWriteBehind m_writebehindview GUARDED_BY(cs_main);
+
     //! This is the top layer of the cache hierarchy - it keeps as many coins in memory as
     //! can fit per the dbcache setting.
     std::unique_ptr<CCoinsViewCache> m_cacheview GUARDED_BY(cs_main);
@@ -557,6 +573,9 @@ protected:
     //! Manages the UTXO set, which is a reflection of the contents of `m_chain`.
     std::unique_ptr<CoinsViews> m_coins_views;
 
+    //! Reads the coins spent by a block ahead of its connection. Started on first use.
+    std::unique_ptr<ThreadPool> m_prefetch_pool GUARDED_BY(cs_main);
+
 public:
     explicit CChainState(CTxMemPool& mempool, BlockManager& blockman, uint256 from_snapshot_blockhash = uint256());
 
@@ -620,6 +639,12 @@ public:
         return m_coins_views->m_catcherview;
     }
 
+    //! @returns A reference to the view that writes CoinsTip() in the background.
+    CCoinsViewWriteBehind& CoinsWriteBehind() EXCLUSIVE_LOCKS_REQUIRED(cs_main)
+    {
+        return m_coins_views->m_writebehindview;
+    }
+
     //! Destructs all objects related to accessing the UTXO set.
     void ResetCoinsViews() { m_coins_views.reset(); }
 
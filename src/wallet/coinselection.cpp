@@ -356,7 +356,7 @@ void OutputGroup::SetFees(const CFeeRate effective_feerate, const CFeeRate long_
     }
 }
 
-OutputGroup OutputGroup::GetPositiveOnlyGroup()
+OutputGroup OutputGroup::GetPositiveOnlyGroup() const
 {
     OutputGroup group(*this);
     for (auto it = group.m_outputs.begin(); it != group.m_outputs.end(); ) {
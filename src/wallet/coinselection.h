@@ -147,7 +147,7 @@ struct OutputGroup
 
     //! Update the OutputGroup's fee, long_term_fee, and effective_value based on the given feerates
     void SetFees(const CFeeRate effective_feerate, const CFeeRate long_term_feerate);
-    OutputGroup GetPositiveOnlyGroup();
+    OutputGroup GetPositiveOnlyGroup() const;
 };
 
 bool SelectCoinsBnB(std::vector<OutputGroup>& utxo_pool, const CAmount& target_value, const CAmount& cost_of_change, std::set<CInputCoin>& out_set, CAmount& value_ret, CAmount not_input_fees);
@@ -20,6 +20,16 @@ CAmount GetMinimumFee(const CWallet& wallet, unsigned int nTxBytes, uint64_t mwe
     return GetMinimumFeeRate(wallet, coin_control, feeCalc).GetTotalFee(nTxBytes, mweb_weight);
 }
 
+static bool IsConservativeEstimate(const CWallet& wallet, const CCoinControl& coin_control)
+{
+    // By default estimates are economical iff we are signaling opt-in-RBF
+    bool conservative_estimate = !coin_control.m_signal_bip125_rbf.get_value_or(wallet.m_signal_rbf);
+    // Allow to override the default fee estimate mode over the CoinControl instance
+    if (coin_control.m_fee_mode == FeeEstimateMode::CONSERVATIVE) conservative_estimate = true;
+    else if (coin_control.m_fee_mode == FeeEstimateMode::ECONOMICAL) conservative_estimate = false;
+    return conservative_estimate;
+}
+
 CFeeRate GetRequiredFeeRate(const CWallet& wallet)
 {
     return std::max(wallet.m_min_fee, wallet.chain().relayMinFee());
@@ -48,13 +58,7 @@ CFeeRate GetMinimumFeeRate(const CWallet& wallet, const CCoinControl& coin_contr
     else { // 2. or 4.
         // We will use smart fee estimation
         unsigned int target = coin_control.m_confirm_target ? *coin_control.m_confirm_target : wallet.m_confirm_target;
-        // By default estimates are economical iff we are signaling opt-in-RBF
-        bool conservative_estimate = !coin_control.m_signal_bip125_rbf.get_value_or(wallet.m_signal_rbf);
-        // Allow to override the default fee estimate mode over the CoinControl instance
-        if (coin_control.m_fee_mode == FeeEstimateMode::CONSERVATIVE) conservative_estimate = true;
-        else if (coin_control.m_fee_mode == FeeEstimateMode::ECONOMICAL) conservative_estimate = false;
-
-        feerate_needed = wallet.chain().estimateSmartFee(target, conservative_estimate, feeCalc);
+        feerate_needed = wallet.chain().estimateSmartFee(target, IsConservativeEstimate(wallet, coin_control), feeCalc);
         if (feerate_needed == CFeeRate(0)) {
             // if we don't have enough data for estimateSmartFee, then use fallback fee
             feerate_needed = wallet.m_fallback_fee;
@@ -80,6 +84,18 @@ CFeeRate GetMinimumFeeRate(const CWallet& wallet, const CCoinControl& coin_contr
     return feerate_needed;
 }
 
+CFeeRate GetMWEBFeeRate(const CWallet& wallet, const CCoinControl& coin_control)
+{
+    // A feerate set by the user applies to the canonical size only, as before
+    if (coin_control.m_feerate || (!coin_control.m_confirm_target && wallet.m_pay_tx_fee != CFeeRate(0))) {
+        return CFeeRate(0);
+    }
+
+    unsigned int target = coin_control.m_confirm_target ? *coin_control.m_confirm_target : wallet.m_confirm_target;
+    // A zero estimate (not enough data) leaves the minimum MWEB fee in place
+    return wallet.chain().estimateSmartMWEBFee(target, IsConservativeEstimate(wallet, coin_control));
+}
+
 CFeeRate GetDiscardRate(const CWallet& wallet)
 {
     unsigned int highest_target = wallet.chain().estimateMaxBlocks();
@@ -37,6 +37,12 @@ CFeeRate GetRequiredFeeRate(const CWallet& wallet);
  */
 CFeeRate GetMinimumFeeRate(const CWallet& wallet, const CCoinControl& coin_control, FeeCalculation* feeCalc);
 
+/**
+ * Estimate the fee rate per 1000 units of MWEB weight, or 0 to pay the minimum MWEB fee.
+ * Only returns an estimate when smart fee estimation is used for the transaction.
+ */
+CFeeRate GetMWEBFeeRate(const CWallet& wallet, const CCoinControl& coin_control);
+
 /**
  * Return the maximum feerate for discarding change.
  */
@@ -1599,6 +1599,8 @@ static RPCHelpMan listwallettransactions()
                 "\nReturns the list of transactions as they would be displayed in the GUI.\n",
                 {
                     {"txid", RPCArg::Type::STR, RPCArg::Optional::OMITTED_NAMED_ARG, "The transaction id"},
+                    {"count", RPCArg::Type::NUM, /* default */ "all", "The number of records to return, newest first. Ignored when txid is given."},
+                    {"skip", RPCArg::Type::NUM, /* default */ "0", "The number of newest records to skip. Ignored when txid is given."},
                 },
                 RPCResult{
                     RPCResult::Type::ARR, "", "",
@@ -1630,6 +1632,8 @@ static RPCHelpMan listwallettransactions()
                 RPCExamples{
             "\nList the wallet's transaction records\n"
             + HelpExampleCli("listwallettransactions", "") +
+            "\nList the 20 records after the newest 100\n"
+            + HelpExampleCli("listwallettransactions", "\"\" 20 100") +
             "\nAs a JSON-RPC call\n"
             + HelpExampleRpc("listwallettransactions", "")
                 },
@@ -1643,13 +1647,28 @@ static RPCHelpMan listwallettransactions()
     // the user could have gotten from another RPC command prior to now
     pwallet->BlockUntilSyncedToCurrentChain();
 
+    const bool has_txid = !request.params[0].isNull() && !request.params[0].get_str().empty();
+    int count = -1;
+    if (!request.params[1].isNull()) {
+        count = request.params[1].get_int();
+        if (count < 0) throw JSONRPCError(RPC_INVALID_PARAMETER, "Negative count");
+    }
+    int skip = 0;
+    if (!request.params[2].isNull()) {
+        skip = request.params[2].get_int();
+        if (skip < 0) throw JSONRPCError(RPC_INVALID_PARAMETER, "Negative skip");
+    }
+
     UniValue ret(UniValue::VARR);
 
     {
         LOCK(pwallet->cs_wallet);
 
         std::vector<WalletTxRecord> tx_records;
-        if (request.params[0].isNull()) {
+        if (!has_txid && count >= 0) {
+            // Only build the records of the transactions the requested page can come from
+            tx_records = TxList(*pwallet).ListLatest((size_t)count + skip, ISMINE_ALL);
+        } else if (!has_txid) {
             tx_records = TxList(*pwallet).ListAll(ISMINE_ALL);
         } else {
             uint256 hash(ParseHashV(request.params[0], "txid"));
@@ -1669,7 +1688,12 @@ static RPCHelpMan listwallettransactions()
             return a.status.sortKey > b.status.sortKey;
         });
 
-        
+        if (!has_txid) {
+            const size_t begin = std::min<size_t>(skip, tx_records.size());
+            const size_t end = count < 0 ? tx_records.size() : std::min<size_t>(begin + count, tx_records.size());
+            tx_records = std::vector<WalletTxRecord>(tx_records.begin() + begin, tx_records.begin() + end);
+        }
+
         for (WalletTxRecord& tx_record : tx_records) {
             UniValue entry = tx_record.ToUniValue();
             WalletTxToJSON(pwallet->chain(), tx_record.GetWTX(), entry);
@@ -1781,8 +1805,11 @@ static RPCHelpMan listsinceblock()
 
     UniValue transactions(UniValue::VARR);
 
-    for (const std::pair<const uint256, CWalletTx>& pairWtx : wallet.mapWallet) {
-        const CWalletTx& tx = pairWtx.second;
+    // The wallet tx index is ordered by block height, with unconfirmed transactions
+    // last, so only those confirmed or conflicted after the given block are visited.
+    auto it = depth == -1 ? wallet.m_tx_list_index.begin() : wallet.m_tx_list_index.lower_bound(TxListKey{*height + 1, false, 0, uint256()});
+    for (; it != wallet.m_tx_list_index.end(); ++it) {
+        const CWalletTx& tx = *it->second;
 
         if (depth == -1 || abs(tx.GetDepthInMainChain()) < depth) {
             ListTransactions(&wallet, tx, 0, true, transactions, filter, nullptr /* filter_label */);
@@ -4781,7 +4808,7 @@ static const CRPCCommand commands[] =
     { "wallet",             "listreceivedbylabel",              &listreceivedbylabel,           {"minconf","include_empty","include_watchonly"} },
     { "wallet",             "listsinceblock",                   &listsinceblock,                {"blockhash","target_confirmations","include_watchonly","include_removed"} },
     { "wallet",             "listtransactions",                 &listtransactions,              {"label|dummy","count","skip","include_watchonly"} },
-    { "wallet",             "listwallettransactions",           &listwallettransactions,        {"txid"} },
+    { "wallet",             "listwallettransactions",           &listwallettransactions,        {"txid","count","skip"} },
     { "wallet",             "listunspent",                      &listunspent,                   {"minconf","maxconf","addresses","include_unsafe","query_options"} },
     { "wallet",             "listwalletdir",                    &listwalletdir,                 {} },
     { "wallet",             "listwallets",                      &listwallets,                   {} },
@@ -304,6 +304,31 @@ BOOST_AUTO_TEST_CASE(bnb_search_test)
         BOOST_CHECK(wallet->SelectCoins(vCoins, 10 * CENT, setCoinsRet, nValueRet, coin_control, coin_selection_params_bnb, bnb_used));
         BOOST_CHECK(bnb_used);
         BOOST_CHECK(coin_selection_params_bnb.use_bnb);
+
+        // Coins grouped up front leave out the preset input and select the same coins
+        std::vector<OutputGroup> groups = wallet->GroupAvailableCoins(vCoins, coin_control);
+        BOOST_CHECK_EQUAL(groups.size(), vCoins.size() - 1);
+        CoinSet setCoinsGrouped;
+        CAmount nValueGrouped = 0;
+        BOOST_CHECK(wallet->SelectCoins(vCoins, 10 * CENT, setCoinsGrouped, nValueGrouped, coin_control, coin_selection_params_bnb, bnb_used, &groups));
+        BOOST_CHECK(bnb_used);
+        BOOST_CHECK(setCoinsGrouped.count(vCoins.at(0).GetInputCoin()));
+        BOOST_CHECK_EQUAL(nValueGrouped, 10 * CENT);
+
+        // Effective values set on the groups up front are used as they are
+        for (OutputGroup& group : groups) {
+            group.SetFees(CFeeRate(0), CFeeRate(0));
+        }
+        coin_selection_params_bnb.m_effective_values_set = true;
+        BOOST_CHECK(wallet->SelectCoinsMinConf(5 * CENT, filter_standard, groups, setCoinsGrouped, nValueGrouped, coin_selection_params_bnb, bnb_used));
+        BOOST_CHECK_EQUAL(nValueGrouped, 5 * CENT);
+        for (OutputGroup& group : groups) {
+            group.effective_value = 0;
+            for (CInputCoin& coin : group.m_outputs) coin.effective_value = 0;
+        }
+        BOOST_CHECK(!wallet->SelectCoinsMinConf(5 * CENT, filter_standard, groups, setCoinsGrouped, nValueGrouped, coin_selection_params_bnb, bnb_used));
+        coin_selection_params_bnb.m_effective_values_set = false;
+        BOOST_CHECK(wallet->SelectCoinsMinConf(5 * CENT, filter_standard, groups, setCoinsGrouped, nValueGrouped, coin_selection_params_bnb, bnb_used));
     }
 }
 
@@ -655,4 +680,23 @@ BOOST_AUTO_TEST_CASE(SelectCoins_test)
     }
 }
 
+BOOST_AUTO_TEST_CASE(mweb_feerate_test)
+{
+    CoinSelectionParams params;
+    params.m_effective_feerate = CFeeRate(1000);
+
+    // Without an MWEB estimate, the minimum MWEB fee is paid
+    BOOST_CHECK_EQUAL(params.GetTotalFee(200, 0), 200);
+    BOOST_CHECK_EQUAL(params.GetTotalFee(200, 3), 200 + 3 * BASE_MWEB_FEE);
+
+    // An estimate below the minimum MWEB fee doesn't lower it
+    params.m_mweb_feerate = CFeeRate(BASE_MWEB_FEE * 1000 / 2);
+    BOOST_CHECK_EQUAL(params.GetTotalFee(200, 3), 200 + 3 * BASE_MWEB_FEE);
+
+    // An estimate above it applies to the MWEB weight only
+    params.m_mweb_feerate = CFeeRate(BASE_MWEB_FEE * 1000 * 2);
+    BOOST_CHECK_EQUAL(params.GetTotalFee(200, 3), 200 + 6 * BASE_MWEB_FEE);
+    BOOST_CHECK_EQUAL(params.GetTotalFee(0, 3), 6 * BASE_MWEB_FEE);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
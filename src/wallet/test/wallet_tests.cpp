@@ -13,6 +13,7 @@
 #include <node/context.h>
 #include <policy/policy.h>
 #include <rpc/server.h>
+#include <shutdown.h>
 #include <test/util/logging.h>
 #include <test/util/setup_common.h>
 #include <util/ref.h>
@@ -20,6 +21,7 @@
 #include <validation.h>
 #include <wallet/coincontrol.h>
 #include <wallet/test/wallet_test_fixture.h>
+#include <wallet/walletdb.h>
 
 #include <boost/test/unit_test.hpp>
 #include <univalue.h>
@@ -123,6 +125,23 @@ BOOST_FIXTURE_TEST_CASE(scan_for_wallet_transactions, TestChain100Setup)
         BOOST_CHECK_EQUAL(wallet.GetBalance().m_mine_immature, 100 * COIN);
     }
 
+    // Verify a serial rescan, without blocks read ahead, finds the same transactions.
+    {
+        CWallet wallet(chain.get(), "", CreateDummyWalletDatabase());
+        wallet.m_rescan_threads = 0;
+        {
+            LOCK(wallet.cs_wallet);
+            wallet.SetLastBlockProcessed(::ChainActive().Height(), ::ChainActive().Tip()->GetBlockHash());
+        }
+        AddKey(wallet, coinbaseKey);
+        WalletRescanReserver reserver(wallet);
+        reserver.reserve();
+        CWallet::ScanResult result = wallet.ScanForWalletTransactions(oldTip->GetBlockHash(), oldTip->nHeight, {} /* max_height */, reserver, false /* update */);
+        BOOST_CHECK_EQUAL(result.status, CWallet::ScanResult::SUCCESS);
+        BOOST_CHECK_EQUAL(result.last_scanned_block, newTip->GetBlockHash());
+        BOOST_CHECK_EQUAL(wallet.GetBalance().m_mine_immature, 100 * COIN);
+    }
+
     // Prune the older block file.
     {
         LOCK(cs_main);
@@ -175,6 +194,58 @@ BOOST_FIXTURE_TEST_CASE(scan_for_wallet_transactions, TestChain100Setup)
     }
 }
 
+// Verify a rescan interrupted by shutdown leaves a checkpoint in the wallet's best
+// block locator, stops holding back chain state flushes, and can resume from it.
+BOOST_FIXTURE_TEST_CASE(rescan_checkpoint, TestChain100Setup)
+{
+    NodeContext node;
+    auto chain = interfaces::MakeChain(node);
+    CWallet wallet(chain.get(), "", CreateMockWalletDatabase());
+    wallet.m_rescan_progress_interval = 0; // checkpoint before every block
+    {
+        LOCK(wallet.cs_wallet);
+        wallet.SetLastBlockProcessed(::ChainActive().Height(), ::ChainActive().Tip()->GetBlockHash());
+    }
+    AddKey(wallet, coinbaseKey);
+
+    // Each block pays its coinbase to the wallet. Request a shutdown once block 50's is found.
+    int found = 0;
+    auto handler = wallet.NotifyTransactionChanged.connect([&found](CWallet*, const uint256&, ChangeType) {
+        if (++found == 50) StartShutdown();
+    });
+    {
+        WalletRescanReserver reserver(wallet);
+        reserver.reserve();
+        CWallet::ScanResult result = wallet.ScanForWalletTransactions(::ChainActive().Genesis()->GetBlockHash(), 0 /* start_height */, {} /* max_height */, reserver, false /* update */);
+        BOOST_CHECK_EQUAL(result.status, CWallet::ScanResult::USER_ABORT);
+        BOOST_CHECK_EQUAL(*result.last_scanned_height, 50);
+    }
+    handler.disconnect();
+    AbortShutdown();
+
+    // The checkpoint was written before the last scanned block
+    CBlockLocator locator;
+    BOOST_CHECK(WalletBatch(wallet.GetDatabase()).ReadBestBlock(locator));
+    const Optional<int> checkpoint_height = chain->findLocatorFork(locator);
+    BOOST_CHECK_EQUAL(*checkpoint_height, 49);
+
+    // The rescan has stopped, so chain state flushes go through again
+    wallet.chainStateFlushed(chain->getTipLocator());
+    BOOST_CHECK(WalletBatch(wallet.GetDatabase()).ReadBestBlock(locator));
+    BOOST_CHECK_EQUAL(*chain->findLocatorFork(locator), ::ChainActive().Height());
+
+    // Resuming from the checkpoint finds the remaining coinbases
+    {
+        WalletRescanReserver reserver(wallet);
+        reserver.reserve();
+        CWallet::ScanResult result = wallet.ScanForWalletTransactions(::ChainActive()[*checkpoint_height]->GetBlockHash(), *checkpoint_height, {} /* max_height */, reserver, false /* update */);
+        BOOST_CHECK_EQUAL(result.status, CWallet::ScanResult::SUCCESS);
+        BOOST_CHECK_EQUAL(result.last_scanned_block, ::ChainActive().Tip()->GetBlockHash());
+    }
+    LOCK(wallet.cs_wallet);
+    BOOST_CHECK_EQUAL(wallet.mapWallet.size(), (size_t)::ChainActive().Height());
+}
+
 BOOST_FIXTURE_TEST_CASE(importmulti_rescan, TestChain100Setup)
 {
     // Cap last block file size, and mine new block in a new block file.
@@ -836,4 +907,43 @@ BOOST_FIXTURE_TEST_CASE(ZapSelectTx, TestChain100Setup)
     TestUnloadWallet(std::move(wallet));
 }
 
+BOOST_AUTO_TEST_CASE(mweb_coin_records)
+{
+    mw::Coin coin;
+    coin.address_index = mw::CHANGE_INDEX;
+    coin.amount = 5 * COIN;
+    coin.output_id = mw::Hash(InsecureRand256().begin());
+
+    const auto read_coin_record = [&](const mw::Hash& output_id, const CDataStream& value, std::string& err) {
+        CDataStream ssKey(SER_DISK, CLIENT_VERSION);
+        ssKey << std::make_pair(DBKeys::COIN, output_id);
+        CDataStream ssValue(value);
+        std::string type;
+        const bool ret = ReadKeyValue(&m_wallet, ssKey, ssValue, type, err);
+        BOOST_CHECK_EQUAL(type, DBKeys::COIN);
+        return ret;
+    };
+
+    CDataStream value(SER_DISK, CLIENT_VERSION);
+    value << coin;
+    std::string err;
+    BOOST_CHECK(read_coin_record(coin.output_id, value, err));
+    BOOST_CHECK(err.empty());
+    mw::Coin loaded;
+    BOOST_CHECK(m_wallet.GetCoin(coin.output_id, loaded));
+    BOOST_CHECK(loaded.IsChange());
+    BOOST_CHECK_EQUAL(loaded.amount, 5 * COIN);
+
+    // Truncated records and records stored under another output ID are corrupt
+    CDataStream truncated(value.begin(), value.end() - 1, SER_DISK, CLIENT_VERSION);
+    const mw::Hash other_id(InsecureRand256().begin());
+    BOOST_CHECK(!read_coin_record(other_id, truncated, err));
+    BOOST_CHECK_EQUAL(err, strprintf("Error reading wallet database: MWEB coin %s corrupt", other_id.ToHex()));
+    err.clear();
+    BOOST_CHECK(!read_coin_record(other_id, value, err));
+    BOOST_CHECK(!err.empty());
+    BOOST_CHECK(!m_wallet.GetCoin(other_id, loaded));
+    BOOST_CHECK(!loaded.IsMine());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
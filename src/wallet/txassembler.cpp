@@ -112,6 +112,17 @@ void TxAssembler::CreateTransaction_Locked(
 
     InitCoinSelectionParams(new_tx);
 
+    // Coin selection runs up to 4 attempts per fee iteration, all with the same feerates,
+    // so group the coins and compute their effective values up front
+    const CoinSelectionParams& params = new_tx.coin_selection_params;
+    const CFeeRate effective_feerate = params.m_subtract_fee_outputs ? CFeeRate(0) : params.m_effective_feerate;
+    new_tx.available_groups = m_wallet.GroupAvailableCoins(new_tx.available_coins, new_tx.coin_control);
+    for (OutputGroup& group : new_tx.available_groups) {
+        group.SetFees(effective_feerate, params.m_long_term_feerate);
+        (group.IsMWEB() ? new_tx.mweb_groups : new_tx.cat_groups).push_back(group);
+    }
+    new_tx.coin_selection_params.m_effective_values_set = true;
+
     bool pick_new_inputs = true;
 
     // Starts with no fee and loops until there is enough fee
@@ -162,11 +173,11 @@ void TxAssembler::CreateTransaction_Locked(
 
         // Calculate transaction size and the total necessary fee amount (includes CAT and MWEB fees)
         new_tx.bytes = CalculateMaximumTxSize(new_tx);
-        new_tx.fee_needed = new_tx.coin_selection_params.m_effective_feerate.GetTotalFee(new_tx.bytes, new_tx.mweb_weight);
+        new_tx.fee_needed = new_tx.coin_selection_params.GetTotalFee(new_tx.bytes, new_tx.mweb_weight);
 
         // Calculate the portion of the fee that should be paid on the MWEB side (using kernel fees)
         size_t pegout_bytes = MWEB::CalcPegOutBytes(new_tx.mweb_type, new_tx.recipients);
-        new_tx.mweb_fee = new_tx.coin_selection_params.m_effective_feerate.GetTotalFee(pegout_bytes, new_tx.mweb_weight);
+        new_tx.mweb_fee = new_tx.coin_selection_params.GetTotalFee(pegout_bytes, new_tx.mweb_weight);
 
         if (new_tx.total_fee < new_tx.fee_needed && !pick_new_inputs) {
             // This shouldn't happen, we should have had enough excess
@@ -352,6 +363,7 @@ void TxAssembler::InitCoinSelectionParams(InProcessTx& new_tx) const
 
     // Get the fee rate to use effective values in coin selection
     new_tx.coin_selection_params.m_effective_feerate = GetMinimumFeeRate(m_wallet, new_tx.coin_control, &new_tx.fee_calc);
+    new_tx.coin_selection_params.m_mweb_feerate = GetMWEBFeeRate(m_wallet, new_tx.coin_control);
 
     // Do not, ever, assume that it's fine to change the fee rate if the user has explicitly
     // provided one
@@ -379,6 +391,20 @@ void TxAssembler::InitCoinSelectionParams(InProcessTx& new_tx) const
     new_tx.coin_selection_params.m_subtract_fee_outputs = new_tx.subtract_fee_from_amount != 0; // If we are doing subtract fee from recipient, don't use effective values
 }
 
+/** The fee a transaction with the selected inputs is expected to pay, to compare selection strategies. */
+static CAmount SelectionFee(const std::set<CInputCoin>& selected_coins, bool bnb_used, const CoinSelectionParams& params)
+{
+    CAmount fee = params.GetTotalFee(params.tx_noinputs_size, params.mweb_nochange_weight);
+    if (!bnb_used) {
+        // Knapsack selections are assumed to need change
+        fee += params.GetTotalFee(params.change_output_size, params.mweb_change_output_weight);
+    }
+    for (const CInputCoin& coin : selected_coins) {
+        fee += coin.CalculateFee(params.m_effective_feerate);
+    }
+    return fee;
+}
+
 bool TxAssembler::AttemptCoinSelection(InProcessTx& new_tx, const CAmount& nTargetValue) const
 {
     new_tx.value_selected = 0;
@@ -398,76 +424,95 @@ bool TxAssembler::AttemptCoinSelection(InProcessTx& new_tx, const CAmount& nTarg
     static auto is_cat = [](const CInputCoin& input) { return !input.IsMWEB(); };
     static auto is_mweb = [](const CInputCoin& input) { return input.IsMWEB(); };
 
+    // Each transaction can either stay on the recipient's side or move coins across
+    // with a peg-in or peg-out. Both are selected from the same groups and effective
+    // values, and the one expected to pay the lower fee is used. On a tie, the
+    // transaction stays on one side.
+    CoinSelectionParams params_same_side = new_tx.coin_selection_params;
+    CoinSelectionParams params_cross = new_tx.coin_selection_params;
+    bool cross_possible;
     if (new_tx.recipients.front().IsMWEB()) {
-        // First try to construct an MWEB-to-MWEB transaction
-        CoinSelectionParams mweb_to_mweb = new_tx.coin_selection_params;
-        mweb_to_mweb.input_preference = InputPreference::MWEB_ONLY;
-        mweb_to_mweb.mweb_change_output_weight = mw::STANDARD_OUTPUT_WEIGHT;
-        mweb_to_mweb.mweb_nochange_weight = mw::KERNEL_WITH_STEALTH_WEIGHT + (new_tx.recipients.size() * mw::STANDARD_OUTPUT_WEIGHT);
-        mweb_to_mweb.change_output_size = 0;
-        mweb_to_mweb.change_spend_size = 0;
-        mweb_to_mweb.tx_noinputs_size = 0;
-
-        if (SelectCoins(new_tx, nTargetValue, mweb_to_mweb)) {
-            return true;
-        }
-
-        // If MWEB-to-MWEB fails, create a peg-in transaction
+        // MWEB-to-MWEB transaction
+        params_same_side.input_preference = InputPreference::MWEB_ONLY;
+        params_same_side.mweb_change_output_weight = mw::STANDARD_OUTPUT_WEIGHT;
+        params_same_side.mweb_nochange_weight = mw::KERNEL_WITH_STEALTH_WEIGHT + (new_tx.recipients.size() * mw::STANDARD_OUTPUT_WEIGHT);
+        params_same_side.change_output_size = 0;
+        params_same_side.change_spend_size = 0;
+        params_same_side.tx_noinputs_size = 0;
+
+        // Peg-in transaction, which needs at least one CAT input
         const bool change_on_mweb = MWEB::IsChangeOnMWEB(m_wallet, MWEB::TxType::PEGIN, new_tx.recipients, new_tx.coin_control.destChange);
-        CoinSelectionParams params_pegin = new_tx.coin_selection_params;
-        params_pegin.input_preference = InputPreference::ANY;
-        params_pegin.mweb_change_output_weight = change_on_mweb ? mw::STANDARD_OUTPUT_WEIGHT : 0;
-        params_pegin.mweb_nochange_weight = mw::KERNEL_WITH_STEALTH_WEIGHT + (new_tx.recipients.size() * mw::STANDARD_OUTPUT_WEIGHT);
-        params_pegin.change_output_size = change_on_mweb ? 0 : new_tx.coin_selection_params.change_output_size;
-        params_pegin.change_spend_size = change_on_mweb ? 0 : new_tx.coin_selection_params.change_spend_size;
-
-        if (SelectCoins(new_tx, nTargetValue, params_pegin)) {
-            return std::any_of(new_tx.selected_coins.cbegin(), new_tx.selected_coins.cend(), is_cat);
-        }
+        params_cross.input_preference = InputPreference::ANY;
+        params_cross.mweb_change_output_weight = change_on_mweb ? mw::STANDARD_OUTPUT_WEIGHT : 0;
+        params_cross.mweb_nochange_weight = mw::KERNEL_WITH_STEALTH_WEIGHT + (new_tx.recipients.size() * mw::STANDARD_OUTPUT_WEIGHT);
+        params_cross.change_output_size = change_on_mweb ? 0 : new_tx.coin_selection_params.change_output_size;
+        params_cross.change_spend_size = change_on_mweb ? 0 : new_tx.coin_selection_params.change_spend_size;
+        cross_possible = !new_tx.cat_groups.empty() || new_tx.coin_control.HasSelected();
     } else {
-        // First try to construct a CAT-to-CAT transaction
-        CoinSelectionParams mweb_to_mweb = new_tx.coin_selection_params;
-        mweb_to_mweb.input_preference = InputPreference::CAT_ONLY;
-        mweb_to_mweb.mweb_change_output_weight = 0;
-        mweb_to_mweb.mweb_nochange_weight = 0;
-
-        if (SelectCoins(new_tx, nTargetValue, mweb_to_mweb)) {
-            return true;
-        }
-
-        // Only supports pegging-out to one address
-        if (new_tx.recipients.size() > 1) {
-            return false;
-        }
-
-        // If CAT-to-CAT fails, create a peg-out transaction
-        CoinSelectionParams params_pegout = new_tx.coin_selection_params;
-        params_pegout.input_preference = InputPreference::ANY;
-        params_pegout.mweb_change_output_weight = mw::STANDARD_OUTPUT_WEIGHT;
-        params_pegout.mweb_nochange_weight = Weight::CalcKernelWeight(true, new_tx.recipients.front().GetScript());
-        params_pegout.change_output_size = 0;
-        params_pegout.change_spend_size = 0;
-        new_tx.tx.vout.clear();
-
-        if (SelectCoins(new_tx, nTargetValue, params_pegout)) {
-            return std::any_of(new_tx.selected_coins.cbegin(), new_tx.selected_coins.cend(), is_mweb);
+        // CAT-to-CAT transaction
+        params_same_side.input_preference = InputPreference::CAT_ONLY;
+        params_same_side.mweb_change_output_weight = 0;
+        params_same_side.mweb_nochange_weight = 0;
+
+        // Peg-out transaction, which needs at least one MWEB input and only
+        // supports pegging-out to one address
+        params_cross.input_preference = InputPreference::ANY;
+        params_cross.mweb_change_output_weight = mw::STANDARD_OUTPUT_WEIGHT;
+        params_cross.mweb_nochange_weight = Weight::CalcKernelWeight(true, new_tx.recipients.front().GetScript());
+        params_cross.change_output_size = 0;
+        params_cross.change_spend_size = 0;
+        cross_possible = new_tx.recipients.size() == 1 && (!new_tx.mweb_groups.empty() || new_tx.coin_control.HasSelected());
+    }
+
+    const bool same_side_selected = SelectCoins(new_tx, nTargetValue, params_same_side);
+    if (!cross_possible) {
+        return same_side_selected;
+    }
+
+    std::set<CInputCoin> same_side_coins;
+    const CAmount same_side_value = new_tx.value_selected;
+    const bool same_side_bnb_used = new_tx.bnb_used;
+    same_side_coins.swap(new_tx.selected_coins);
+
+    const bool is_pegin = new_tx.recipients.front().IsMWEB();
+    bool cross_selected = SelectCoins(new_tx, nTargetValue, params_cross);
+    if (cross_selected) {
+        // A selection without coins from the other side isn't a peg-in or peg-out
+        cross_selected = std::any_of(new_tx.selected_coins.cbegin(), new_tx.selected_coins.cend(), is_pegin ? is_cat : is_mweb);
+    }
+    if (cross_selected && (!same_side_selected ||
+            SelectionFee(new_tx.selected_coins, new_tx.bnb_used, params_cross) < SelectionFee(same_side_coins, same_side_bnb_used, params_same_side))) {
+        if (!is_pegin) {
+            // Recipients of a peg-out are funded through the pegout kernel
+            new_tx.tx.vout.clear();
         }
+        return true;
     }
 
-    return false;
+    new_tx.selected_coins.swap(same_side_coins);
+    new_tx.value_selected = same_side_value;
+    new_tx.bnb_used = same_side_bnb_used;
+    return same_side_selected;
 }
 
 bool TxAssembler::SelectCoins(InProcessTx& new_tx, const CAmount& nTargetValue, CoinSelectionParams& coin_selection_params) const
 {
+    const std::vector<OutputGroup>* groups = &new_tx.available_groups;
+    if (coin_selection_params.input_preference == InputPreference::CAT_ONLY) {
+        groups = &new_tx.cat_groups;
+    } else if (coin_selection_params.input_preference == InputPreference::MWEB_ONLY) {
+        groups = &new_tx.mweb_groups;
+    }
+
     new_tx.value_selected = 0;
-    if (m_wallet.SelectCoins(new_tx.available_coins, nTargetValue, new_tx.selected_coins, new_tx.value_selected, new_tx.coin_control, coin_selection_params, new_tx.bnb_used)) {
+    if (m_wallet.SelectCoins(new_tx.available_coins, nTargetValue, new_tx.selected_coins, new_tx.value_selected, new_tx.coin_control, coin_selection_params, new_tx.bnb_used, groups)) {
         return true;
     }
 
     new_tx.value_selected = 0;
     if (new_tx.bnb_used) {
         coin_selection_params.use_bnb = false;
-        return m_wallet.SelectCoins(new_tx.available_coins, nTargetValue, new_tx.selected_coins, new_tx.value_selected, new_tx.coin_control, coin_selection_params, new_tx.bnb_used);
+        return m_wallet.SelectCoins(new_tx.available_coins, nTargetValue, new_tx.selected_coins, new_tx.value_selected, new_tx.coin_control, coin_selection_params, new_tx.bnb_used, groups);
     }
 
     return false;
@@ -546,7 +591,7 @@ void TxAssembler::ReduceFee(InProcessTx& new_tx) const
     if (new_tx.change_position == -1 && new_tx.subtract_fee_from_amount == 0 && !new_tx.change_on_mweb && !new_tx.change_addr.IsMWEB()) {
         unsigned int output_buffer = 2; // Add 2 as a buffer in case increasing # of outputs changes compact size
         unsigned int tx_size_with_change = new_tx.change_on_mweb ? new_tx.bytes : new_tx.bytes + new_tx.coin_selection_params.change_output_size + output_buffer;
-        CAmount fee_needed_with_change = new_tx.coin_selection_params.m_effective_feerate.GetTotalFee(tx_size_with_change, new_tx.mweb_weight);
+        CAmount fee_needed_with_change = new_tx.coin_selection_params.GetTotalFee(tx_size_with_change, new_tx.mweb_weight);
 
         CTxOut change_prototype_txout(0, new_tx.change_addr.GetScript());
         CAmount minimum_value_for_change = GetDustThreshold(change_prototype_txout, new_tx.coin_selection_params.m_discard_feerate);
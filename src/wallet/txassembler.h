@@ -21,6 +21,10 @@ struct InProcessTx {
     CCoinControl coin_control;
     CoinSelectionParams coin_selection_params{};
     std::vector<COutputCoin> available_coins{};
+    // available_coins grouped once per transaction, and split by type for the CAT-only and MWEB-only attempts
+    std::vector<OutputGroup> available_groups{};
+    std::vector<OutputGroup> cat_groups{};
+    std::vector<OutputGroup> mweb_groups{};
     std::set<CInputCoin> selected_coins{};
     CAmount value_selected{0};
     bool bnb_used{false};
@@ -12,6 +12,20 @@ std::vector<WalletTxRecord> TxList::ListAll(const isminefilter& filter_ismine)
     return tx_records;
 }
 
+std::vector<WalletTxRecord> TxList::ListLatest(size_t num_records, const isminefilter& filter_ismine)
+{
+    std::vector<WalletTxRecord> tx_records;
+    for (auto iter = m_wallet.m_tx_list_index.rbegin(); iter != m_wallet.m_tx_list_index.rend(); iter++) {
+        if (tx_records.size() >= num_records) {
+            break;
+        }
+
+        List(tx_records, *iter->second, filter_ismine);
+    }
+
+    return tx_records;
+}
+
 std::vector<WalletTxRecord> TxList::List(const CWalletTx& wtx, const isminefilter& filter_ismine, const boost::optional<int>& nMinDepth, const boost::optional<std::string>& filter_label)
 {
     std::vector<WalletTxRecord> tx_records;
@@ -19,6 +19,10 @@ public:
         : m_wallet(wallet) {}
 
     std::vector<WalletTxRecord> ListAll(const isminefilter& filter_ismine = ISMINE_ALL);
+
+    // Lists records of the most recent transactions, newest first, until at least num_records are found.
+    // Only visits as many transactions as needed, using CWallet::m_tx_list_index.
+    std::vector<WalletTxRecord> ListLatest(size_t num_records, const isminefilter& filter_ismine = ISMINE_ALL);
     std::vector<WalletTxRecord> List(
         const CWalletTx& wtx,
         const isminefilter& filter_ismine,
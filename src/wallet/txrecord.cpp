@@ -8,6 +8,7 @@
 #include <interfaces/chain.h>
 #include <key_io.h>
 #include <util/check.h>
+#include <util/strencodings.h>
 
 #include <chrono>
 
@@ -49,10 +50,12 @@ bool WalletTxRecord::UpdateStatusIfNeeded(const uint256& block_hash)
     int block_height = m_wtx->m_confirm.block_height > 0 ? m_wtx->m_confirm.block_height : std::numeric_limits<int>::max();
     int blocks_to_maturity = m_wtx->GetBlocksToMaturity();
     
-    status.sortKey = strprintf("%010d-%01d-%010u-%s",
+    // The hash is in memory byte order, so that records of different txs are ordered like CWallet::m_tx_list_index
+    status.sortKey = strprintf("%010d-%01d-%010u-%s-%s",
                                block_height,
                                m_wtx->IsCoinBase() ? 1 : 0,
                                m_wtx->nTimeReceived,
+                               HexStr(m_wtx->GetHash()),
                                idx);
     status.countsForBalance = m_wtx->IsTrusted() && !(blocks_to_maturity > 0);
     status.depth = m_wtx->GetDepthInMainChain();
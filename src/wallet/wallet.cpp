@@ -29,6 +29,7 @@
 #include <util/moneystr.h>
 #include <util/rbf.h>
 #include <util/string.h>
+#include <util/threadpool.h>
 #include <util/translation.h>
 #include <wallet/coincontrol.h>
 #include <wallet/txassembler.h>
@@ -39,6 +40,7 @@
 
 #include <algorithm>
 #include <assert.h>
+#include <future>
 
 #include <boost/algorithm/string/replace.hpp>
 
@@ -455,6 +457,11 @@ bool CWallet::ChangeWalletPassphrase(const SecureString& strOldWalletPassphrase,
 
 void CWallet::chainStateFlushed(const CBlockLocator& loc)
 {
+    // Don't overwrite the checkpoint of a running rescan, so it can resume from it.
+    // cs_wallet is held across the write so a checkpoint can't land in between.
+    LOCK(cs_wallet);
+    if (m_rescan_checkpointed) return;
+
     WalletBatch batch(*database);
     batch.WriteBestBlock(loc);
 }
@@ -963,6 +970,7 @@ CWalletTx* CWallet::AddToWallet(CTransactionRef tx, const boost::optional<MWEB::
 
     // Break debit/credit balance caches:
     wtx.MarkDirty();
+    UpdateTxListIndex(wtx);
 
     // Notify UI of new or updated transaction
     NotifyTransactionChanged(this, hash, fInsertedNew ? CT_NEW : CT_UPDATED);
@@ -990,6 +998,18 @@ CWalletTx* CWallet::AddToWallet(CTransactionRef tx, const boost::optional<MWEB::
     return &wtx;
 }
 
+void CWallet::UpdateTxListIndex(CWalletTx& wtx)
+{
+    AssertLockHeld(cs_wallet);
+    if (wtx.m_in_tx_list) {
+        m_tx_list_index.erase(wtx.m_it_tx_list);
+    }
+
+    const int block_height = wtx.m_confirm.block_height > 0 ? wtx.m_confirm.block_height : std::numeric_limits<int>::max();
+    wtx.m_it_tx_list = m_tx_list_index.emplace(TxListKey{block_height, wtx.IsCoinBase(), wtx.nTimeReceived, wtx.GetHash()}, &wtx).first;
+    wtx.m_in_tx_list = true;
+}
+
 bool CWallet::LoadToWallet(const uint256& hash, const UpdateWalletTxFn& fill_wtx)
 {
     CWalletTx wtx_tmp(this, nullptr);
@@ -1031,6 +1051,7 @@ bool CWallet::LoadToWallet(const uint256& hash, const UpdateWalletTxFn& fill_wtx
     if (/* insertion took place */ ins.second) {
         wtx.m_it_wtxOrdered = wtxOrdered.insert(std::make_pair(wtx.nOrderPos, &wtx));
     }
+    UpdateTxListIndex(wtx);
     AddToSpends(wtx.GetHash());
     AddMWEBOrigins(wtx);
     for (const CTxInput& txin : wtx.GetInputs()) {
@@ -1155,6 +1176,7 @@ bool CWallet::AbandonTransaction(const uint256& hashTx)
             assert(!wtx.InMempool());
             wtx.setAbandoned();
             wtx.MarkDirty();
+            UpdateTxListIndex(wtx);
             batch.WriteTx(wtx);
             NotifyTransactionChanged(this, wtx.GetHash(), CT_UPDATED);
             // Iterate over all its outputs, and mark transactions in the wallet that spend them abandoned too
@@ -1254,6 +1276,7 @@ void CWallet::MarkConflicted(const uint256& hashBlock, int conflicting_height, c
             wtx.m_confirm.block_height = conflicting_height;
             wtx.setConflicted();
             wtx.MarkDirty();
+            UpdateTxListIndex(wtx);
             batch.WriteTx(wtx);
             // Iterate over all its outputs, and mark transactions in the wallet that spend them conflicted too
             for (const CTxOutput& output : wtx.GetOutputs()) {
@@ -1345,6 +1368,7 @@ void CWallet::blockConnected(const CBlock& block, int height)
 {
     const uint256& block_hash = block.GetHash();
     LOCK(cs_wallet);
+    MWEB::Wallet::CoinWriteBatch coin_batch(*mweb_wallet);
 
     m_last_block_processed_height = height;
     m_last_block_processed = block_hash;
@@ -2075,6 +2099,98 @@ int64_t CWallet::RescanFromTime(int64_t startTime, const WalletRescanReserver& r
     return startTime;
 }
 
+namespace {
+/** A block read ahead of a rescan, along with the MWEB outputs that passed the view tag check. */
+struct RescanBlock
+{
+    CBlock block;
+    bool found{false};
+    bool mweb_prescanned{false};
+    std::set<mw::Hash> mweb_candidates;
+};
+
+RescanBlock ReadRescanBlock(interfaces::Chain& chain, const uint256& block_hash, const mw::Keychain::Ptr& keychain)
+{
+    RescanBlock result;
+    result.found = chain.findBlock(block_hash, FoundBlock().data(result.block)) && !result.block.IsNull();
+    if (result.found && keychain && !result.block.mweb_block.IsNull()) {
+        for (const Output& output : result.block.mweb_block.m_block->GetOutputs()) {
+            if (keychain->MatchesViewTag(output)) {
+                result.mweb_candidates.insert(output.GetOutputID());
+            }
+        }
+        result.mweb_prescanned = true;
+    }
+    return result;
+}
+
+/**
+ * Decides from the basic and MWEB block filter indexes whether a block can contain
+ * transactions for a descriptor wallet, so a rescan only needs to read matching blocks.
+ */
+class FastWalletRescanFilter
+{
+public:
+    explicit FastWalletRescanFilter(const CWallet& wallet) : m_wallet(wallet) { Update(); }
+
+    //! Refresh the filter elements, after the wallet may have derived new scripts or received new coins.
+    void Update() EXCLUSIVE_LOCKS_REQUIRED(m_wallet.cs_wallet)
+    {
+        m_scripts.clear();
+        for (ScriptPubKeyMan* spk_man : m_wallet.GetAllScriptPubKeyMans()) {
+            const auto* desc_spk_man = dynamic_cast<const DescriptorScriptPubKeyMan*>(spk_man);
+            if (!desc_spk_man) continue;
+            for (const DestinationAddr& addr : desc_spk_man->GetScriptPubKeys()) {
+                if (addr.IsMWEB()) continue;
+                const CScript& script = addr.GetScript();
+                m_scripts.emplace(script.begin(), script.end());
+            }
+        }
+
+        m_mweb_elements.clear();
+        for (const auto& output : m_wallet.GetMWEBOutputs()) {
+            m_mweb_elements.insert(MWEBFilterElement(output.first));
+        }
+        m_mweb_receiving = m_wallet.GetMWWallet()->GetKeychain() != nullptr;
+    }
+
+    //! Whether the block may contain wallet transactions, or nullopt if its filters aren't available.
+    Optional<bool> Matches(interfaces::Chain& chain, const uint256& block_hash) const
+    {
+        Optional<bool> basic_match = chain.blockFilterMatchesAny(BlockFilterType::BASIC, block_hash, m_scripts);
+        if (!basic_match || *basic_match) return basic_match;
+
+        // Stealth outputs can't be matched against a filter without rewinding them,
+        // so every block that creates MWEB outputs is read by wallets that can receive them.
+        bool mweb_outputs = false;
+        if (m_mweb_receiving && chain.findBlock(block_hash, FoundBlock().mwebOutputs(mweb_outputs)) && mweb_outputs) {
+            return true;
+        }
+        return chain.blockFilterMatchesAny(BlockFilterType::MWEB, block_hash, m_mweb_elements);
+    }
+
+private:
+    const CWallet& m_wallet;
+    GCSFilter::ElementSet m_scripts;
+    GCSFilter::ElementSet m_mweb_elements;
+    bool m_mweb_receiving{false};
+};
+} // namespace
+
+/**
+ * Point the wallet's best block locator at block_hash, so that a rescan
+ * interrupted after this block resumes from it on the next start.
+ */
+void CWallet::WriteRescanCheckpoint(const uint256& block_hash)
+{
+    CBlockLocator locator;
+    if (!chain().findBlock(block_hash, FoundBlock().locator(locator))) return;
+    LOCK(cs_wallet);
+    m_rescan_checkpointed = true;
+    WalletBatch batch(*database);
+    batch.WriteBestBlock(locator);
+}
+
 /**
  * Scan the block chain (starting in start_block) for transactions
  * from or to us. If fUpdate is true, found transactions that already
@@ -2103,6 +2219,12 @@ CWallet::ScanResult CWallet::ScanForWalletTransactions(const uint256& start_bloc
 
     assert(reserver.isReserved());
 
+    // However the scan ends, even by an exception, stop holding back chain state flushes
+    struct RescanCheckpointReleaser {
+        CWallet& wallet;
+        ~RescanCheckpointReleaser() { LOCK(wallet.cs_wallet); wallet.m_rescan_checkpointed = false; }
+    } checkpoint_releaser{*this};
+
     uint256 block_hash = start_block;
     ScanResult result;
 
@@ -2117,6 +2239,25 @@ CWallet::ScanResult CWallet::ScanForWalletTransactions(const uint256& start_bloc
     double progress_end = chain().guessVerificationProgress(end_hash);
     double progress_current = progress_begin;
     int block_height = start_height;
+
+    // Blocks ahead of the one being scanned are read and deserialized on up to
+    // m_rescan_threads threads, which also check MWEB output view tags. Matches
+    // are still applied to the wallet in chain order below.
+    std::map<int, std::pair<uint256, std::future<RescanBlock>>> prefetched;
+    const mw::Keychain::Ptr keychain = mweb_wallet->GetKeychain();
+
+    // Descriptor wallets can skip blocks whose filters match none of their scripts or MWEB
+    // coins. Blocks are then read one at a time, as most of them are never read at all.
+    std::unique_ptr<FastWalletRescanFilter> fast_rescan_filter;
+    if (IsWalletFlagSet(WALLET_FLAG_DESCRIPTORS) && chain().hasBlockFilterIndex(BlockFilterType::BASIC) && chain().hasBlockFilterIndex(BlockFilterType::MWEB)) {
+        LOCK(cs_wallet);
+        fast_rescan_filter = MakeUnique<FastWalletRescanFilter>(*this);
+        WalletLogPrintf("Using block filter indexes to skip blocks during the rescan\n");
+    }
+    const int read_ahead = fast_rescan_filter ? 0 : m_rescan_threads;
+    std::unique_ptr<ThreadPool> read_pool;
+    if (read_ahead > 0) read_pool = MakeUnique<ThreadPool>("rescan", read_ahead);
+
     while (!fAbortRescan && !chain().shutdownRequested()) {
         if (progress_end - progress_begin > 0.0) {
             m_scanning_progress = (progress_current - progress_begin) / (progress_end - progress_begin);
@@ -2126,17 +2267,52 @@ CWallet::ScanResult CWallet::ScanForWalletTransactions(const uint256& start_bloc
         if (block_height % 100 == 0 && progress_end - progress_begin > 0.0) {
             ShowProgress(strprintf("%s " + _("Rescanning...").translated, GetDisplayName()), std::max(1, std::min(99, (int)(m_scanning_progress * 100))));
         }
-        if (GetTime() >= nNow + 60) {
+        if (GetTime() >= nNow + m_rescan_progress_interval) {
             nNow = GetTime();
             WalletLogPrintf("Still rescanning. At block %d. Progress=%f\n", block_height, progress_current);
+            if (result.status == ScanResult::SUCCESS && !result.last_scanned_block.IsNull()) {
+                WriteRescanCheckpoint(result.last_scanned_block);
+            }
+        }
+
+        Optional<bool> filter_match;
+        if (fast_rescan_filter) filter_match = fast_rescan_filter->Matches(chain(), block_hash);
+        const bool skip_block = filter_match && !*filter_match;
+
+        RescanBlock scanned;
+        auto prefetch_it = prefetched.find(block_height);
+        if (skip_block) {
+            // Don't read the block, its filters matched nothing of the wallet's
+        } else if (prefetch_it != prefetched.end() && prefetch_it->second.first == block_hash) {
+            scanned = prefetch_it->second.second.get();
+        } else {
+            scanned = ReadRescanBlock(chain(), block_hash, nullptr);
+        }
+        prefetched.erase(prefetched.begin(), prefetched.upper_bound(block_height));
+        for (int ahead = block_height + 1; ahead <= block_height + read_ahead; ++ahead) {
+            if (max_height && ahead > *max_height) break;
+            if (prefetched.count(ahead)) continue;
+            uint256 ahead_hash;
+            if (!chain().findAncestorByHeight(tip_hash, ahead, FoundBlock().hash(ahead_hash))) break;
+            prefetched.emplace(ahead, std::make_pair(ahead_hash, read_pool->Submit([this, ahead_hash, &keychain] { return ReadRescanBlock(chain(), ahead_hash, keychain); })));
         }
 
-        CBlock block;
+        const CBlock& block = scanned.block;
         bool next_block;
         uint256 next_block_hash;
         bool reorg = false;
-        if (chain().findBlock(block_hash, FoundBlock().data(block)) && !block.IsNull()) {
+        if (skip_block) {
+            next_block = chain().findNextBlock(block_hash, block_height, FoundBlock().hash(next_block_hash), &reorg);
+            if (reorg) {
+                result.last_failed_block = block_hash;
+                result.status = ScanResult::FAILURE;
+                break;
+            }
+            result.last_scanned_block = block_hash;
+            result.last_scanned_height = block_height;
+        } else if (scanned.found) {
             LOCK(cs_wallet);
+            MWEB::Wallet::CoinWriteBatch coin_batch(*mweb_wallet);
             next_block = chain().findNextBlock(block_hash, block_height, FoundBlock().hash(next_block_hash), &reorg);
             if (reorg) {
                 // Abort scan if current block is no longer active, to prevent
@@ -2166,6 +2342,10 @@ CWallet::ScanResult CWallet::ScanForWalletTransactions(const uint256& start_bloc
 
                 mw::Coin mweb_coin;
                 for (const Output& output : block.mweb_block.m_block->GetOutputs()) {
+                    // Skip outputs already ruled out by the view tag check, unless they're known coins
+                    if (scanned.mweb_prescanned && !scanned.mweb_candidates.count(output.GetOutputID()) && !GetCoin(output.GetOutputID(), mweb_coin)) {
+                        continue;
+                    }
                     if (mweb_wallet->RewindOutput(output, mweb_coin)) {
                         const CWalletTx* wtx = FindWalletTx(mweb_coin.output_id);
                         if (wtx) {
@@ -2218,6 +2398,9 @@ CWallet::ScanResult CWallet::ScanForWalletTransactions(const uint256& start_bloc
                 }
             }
 
+            // Transactions found in the block may have topped up the wallet's scripts
+            if (fast_rescan_filter) fast_rescan_filter->Update();
+
             // scan succeeded, record block as most recent successfully scanned
             result.last_scanned_block = block_hash;
             result.last_scanned_height = block_height;
@@ -2261,6 +2444,21 @@ CWallet::ScanResult CWallet::ScanForWalletTransactions(const uint256& start_bloc
     } else {
         WalletLogPrintf("Rescan completed in %15dms\n", GetTimeMillis() - start_time);
     }
+
+    // Unless shutting down, where the checkpoint is left in place so the startup rescan
+    // resumes from it, point the best block locator back at the last processed block.
+    // checkpoint_releaser lets later flushes through either way.
+    bool checkpointed = WITH_LOCK(cs_wallet, return m_rescan_checkpointed);
+    if (checkpointed && !chain().shutdownRequested()) {
+        CBlockLocator locator;
+        if (chain().findBlock(WITH_LOCK(cs_wallet, return GetLastBlockHash()), FoundBlock().locator(locator))) {
+            LOCK(cs_wallet);
+            m_rescan_checkpointed = false;
+            chainStateFlushed(locator);
+        }
+    } else if (checkpointed) {
+        WalletLogPrintf("Rescan progress saved, it will resume from block %s on the next start\n", result.last_scanned_block.ToString());
+    }
     return result;
 }
 
@@ -2834,7 +3032,7 @@ CTxOutput CWallet::FindNonChangeParentOutput(const CTransaction& tx, const Outpu
     return ptx->GetOutput(idx);
 }
 
-bool CWallet::SelectCoinsMinConf(const CAmount& nTargetValue, const CoinEligibilityFilter& eligibility_filter, std::vector<OutputGroup> groups,
+bool CWallet::SelectCoinsMinConf(const CAmount& nTargetValue, const CoinEligibilityFilter& eligibility_filter, const std::vector<OutputGroup>& groups,
                                  std::set<CInputCoin>& setCoinsRet, CAmount& nValueRet, const CoinSelectionParams& coin_selection_params, bool& bnb_used) const
 {
     setCoinsRet.clear();
@@ -2845,24 +3043,30 @@ bool CWallet::SelectCoinsMinConf(const CAmount& nTargetValue, const CoinEligibil
         // Calculate cost of change
         size_t mweb_change_spend_weight = 0; // MWEB inputs are weightless
         CAmount cost_of_change = coin_selection_params.m_discard_feerate.GetTotalFee(coin_selection_params.change_spend_size, mweb_change_spend_weight)
-            + coin_selection_params.m_effective_feerate.GetTotalFee(coin_selection_params.change_output_size, coin_selection_params.mweb_change_output_weight);
+            + coin_selection_params.GetTotalFee(coin_selection_params.change_output_size, coin_selection_params.mweb_change_output_weight);
 
-        // Filter by the min conf specs and add to utxo_pool and calculate effective value
-        for (OutputGroup& group : groups) {
-            if (!group.EligibleForSpending(eligibility_filter, coin_selection_params.input_preference)) continue;
+        // Filter by the min conf specs and add to utxo_pool and calculate effective value.
+        // Only eligible groups are copied, as the groups are shared between selection attempts.
+        for (const OutputGroup& eligible_group : groups) {
+            if (!eligible_group.EligibleForSpending(eligibility_filter, coin_selection_params.input_preference)) continue;
 
-            if (coin_selection_params.m_subtract_fee_outputs) {
-                // Set the effective feerate to 0 as we don't want to use the effective value since the fees will be deducted from the output
-                group.SetFees(CFeeRate(0) /* effective_feerate */, coin_selection_params.m_long_term_feerate);
+            OutputGroup pos_group;
+            if (coin_selection_params.m_effective_values_set) {
+                pos_group = eligible_group.GetPositiveOnlyGroup();
             } else {
-                group.SetFees(coin_selection_params.m_effective_feerate, coin_selection_params.m_long_term_feerate);
+                OutputGroup group = eligible_group;
+                if (coin_selection_params.m_subtract_fee_outputs) {
+                    // Set the effective feerate to 0 as we don't want to use the effective value since the fees will be deducted from the output
+                    group.SetFees(CFeeRate(0) /* effective_feerate */, coin_selection_params.m_long_term_feerate);
+                } else {
+                    group.SetFees(coin_selection_params.m_effective_feerate, coin_selection_params.m_long_term_feerate);
+                }
+                pos_group = group.GetPositiveOnlyGroup();
             }
-
-            OutputGroup pos_group = group.GetPositiveOnlyGroup();
             if (pos_group.effective_value > 0) utxo_pool.push_back(pos_group);
         }
         // Calculate the fees for things that aren't inputs
-        CAmount not_input_fees = coin_selection_params.m_effective_feerate.GetTotalFee(coin_selection_params.tx_noinputs_size, coin_selection_params.mweb_nochange_weight);
+        CAmount not_input_fees = coin_selection_params.GetTotalFee(coin_selection_params.tx_noinputs_size, coin_selection_params.mweb_nochange_weight);
         bnb_used = true;
         return SelectCoinsBnB(utxo_pool, nTargetValue, cost_of_change, setCoinsRet, nValueRet, not_input_fees);
     } else {
@@ -2876,9 +3080,37 @@ bool CWallet::SelectCoinsMinConf(const CAmount& nTargetValue, const CoinEligibil
     }
 }
 
-bool CWallet::SelectCoins(const std::vector<COutputCoin>& vAvailableCoins, const CAmount& nTargetValue, std::set<CInputCoin>& setCoinsRet, CAmount& nValueRet, const CCoinControl& coin_control, CoinSelectionParams& coin_selection_params, bool& bnb_used) const
+std::vector<OutputGroup> CWallet::GroupAvailableCoins(const std::vector<COutputCoin>& vAvailableCoins, const CCoinControl& coin_control) const
+{
+    AssertLockHeld(cs_wallet);
+
+    // remove preset inputs, SelectCoins adds them separately
+    std::vector<COutputCoin> vCoins;
+    vCoins.reserve(vAvailableCoins.size());
+    for (const COutputCoin& out : vAvailableCoins) {
+        if (!coin_control.HasSelected() || !coin_control.IsSelected(out.GetIndex())) {
+            vCoins.push_back(out);
+        }
+    }
+
+    unsigned int limit_ancestor_count = 0;
+    unsigned int limit_descendant_count = 0;
+    chain().getPackageLimits(limit_ancestor_count, limit_descendant_count);
+    size_t max_ancestors = (size_t)std::max<int64_t>(1, limit_ancestor_count);
+
+    // form groups from remaining coins; note that preset coins will not
+    // automatically have their associated (same address) coins included
+    if (coin_control.m_avoid_partial_spends && vCoins.size() > OUTPUT_GROUP_MAX_ENTRIES) {
+        // Cases where we have 11+ outputs all pointing to the same destination may result in
+        // privacy leaks as they will potentially be deterministically sorted. We solve that by
+        // explicitly shuffling the outputs before processing
+        Shuffle(vCoins.begin(), vCoins.end(), FastRandomContext());
+    }
+    return GroupOutputs(vCoins, !coin_control.m_avoid_partial_spends, max_ancestors);
+}
+
+bool CWallet::SelectCoins(const std::vector<COutputCoin>& vAvailableCoins, const CAmount& nTargetValue, std::set<CInputCoin>& setCoinsRet, CAmount& nValueRet, const CCoinControl& coin_control, CoinSelectionParams& coin_selection_params, bool& bnb_used, const std::vector<OutputGroup>* groups) const
 {
-    std::vector<COutputCoin> vCoins(vAvailableCoins);
     CAmount value_to_select = nTargetValue;
 
     // Default to bnb was not used. If we use it, we set it later
@@ -2887,7 +3119,7 @@ bool CWallet::SelectCoins(const std::vector<COutputCoin>& vAvailableCoins, const
     // coin control -> return all selected outputs (we want all selected to go into the transaction for sure)
     if (coin_control.HasSelected() && !coin_control.fAllowOtherInputs)
     {
-        for (const COutputCoin& out : vCoins)
+        for (const COutputCoin& out : vAvailableCoins)
         {
             if (!out.IsSpendable())
                  continue;
@@ -2951,15 +3183,6 @@ bool CWallet::SelectCoins(const std::vector<COutputCoin>& vAvailableCoins, const
         }
     }
 
-    // remove preset inputs from vCoins
-    for (std::vector<COutputCoin>::iterator it = vCoins.begin(); it != vCoins.end() && coin_control.HasSelected();)
-    {
-        if (setPresetCoins.count(it->GetInputCoin()))
-            it = vCoins.erase(it);
-        else
-            ++it;
-    }
-
     unsigned int limit_ancestor_count = 0;
     unsigned int limit_descendant_count = 0;
     chain().getPackageLimits(limit_ancestor_count, limit_descendant_count);
@@ -2967,24 +3190,21 @@ bool CWallet::SelectCoins(const std::vector<COutputCoin>& vAvailableCoins, const
     size_t max_descendants = (size_t)std::max<int64_t>(1, limit_descendant_count);
     bool fRejectLongChains = gArgs.GetBoolArg("-walletrejectlongchains", DEFAULT_WALLET_REJECT_LONG_CHAINS);
 
-    // form groups from remaining coins; note that preset coins will not
-    // automatically have their associated (same address) coins included
-    if (coin_control.m_avoid_partial_spends && vCoins.size() > OUTPUT_GROUP_MAX_ENTRIES) {
-        // Cases where we have 11+ outputs all pointing to the same destination may result in
-        // privacy leaks as they will potentially be deterministically sorted. We solve that by
-        // explicitly shuffling the outputs before processing
-        Shuffle(vCoins.begin(), vCoins.end(), FastRandomContext());
+    std::vector<OutputGroup> local_groups;
+    if (groups == nullptr) {
+        assert(!coin_selection_params.m_effective_values_set);
+        local_groups = GroupAvailableCoins(vAvailableCoins, coin_control);
+        groups = &local_groups;
     }
-    std::vector<OutputGroup> groups = GroupOutputs(vCoins, !coin_control.m_avoid_partial_spends, max_ancestors);
 
     bool res = value_to_select <= 0 ||
-        SelectCoinsMinConf(value_to_select, CoinEligibilityFilter(1, 6, 0), groups, setCoinsRet, nValueRet, coin_selection_params, bnb_used) ||
-        SelectCoinsMinConf(value_to_select, CoinEligibilityFilter(1, 1, 0), groups, setCoinsRet, nValueRet, coin_selection_params, bnb_used) ||
-        (m_spend_zero_conf_change && SelectCoinsMinConf(value_to_select, CoinEligibilityFilter(0, 1, 2), groups, setCoinsRet, nValueRet, coin_selection_params, bnb_used)) ||
-        (m_spend_zero_conf_change && SelectCoinsMinConf(value_to_select, CoinEligibilityFilter(0, 1, std::min((size_t)4, max_ancestors/3), std::min((size_t)4, max_descendants/3)), groups, setCoinsRet, nValueRet, coin_selection_params, bnb_used)) ||
-        (m_spend_zero_conf_change && SelectCoinsMinConf(value_to_select, CoinEligibilityFilter(0, 1, max_ancestors/2, max_descendants/2), groups, setCoinsRet, nValueRet, coin_selection_params, bnb_used)) ||
-        (m_spend_zero_conf_change && SelectCoinsMinConf(value_to_select, CoinEligibilityFilter(0, 1, max_ancestors-1, max_descendants-1), groups, setCoinsRet, nValueRet, coin_selection_params, bnb_used)) ||
-        (m_spend_zero_conf_change && !fRejectLongChains && SelectCoinsMinConf(value_to_select, CoinEligibilityFilter(0, 1, std::numeric_limits<uint64_t>::max()), groups, setCoinsRet, nValueRet, coin_selection_params, bnb_used));
+        SelectCoinsMinConf(value_to_select, CoinEligibilityFilter(1, 6, 0), *groups, setCoinsRet, nValueRet, coin_selection_params, bnb_used) ||
+        SelectCoinsMinConf(value_to_select, CoinEligibilityFilter(1, 1, 0), *groups, setCoinsRet, nValueRet, coin_selection_params, bnb_used) ||
+        (m_spend_zero_conf_change && SelectCoinsMinConf(value_to_select, CoinEligibilityFilter(0, 1, 2), *groups, setCoinsRet, nValueRet, coin_selection_params, bnb_used)) ||
+        (m_spend_zero_conf_change && SelectCoinsMinConf(value_to_select, CoinEligibilityFilter(0, 1, std::min((size_t)4, max_ancestors/3), std::min((size_t)4, max_descendants/3)), *groups, setCoinsRet, nValueRet, coin_selection_params, bnb_used)) ||
+        (m_spend_zero_conf_change && SelectCoinsMinConf(value_to_select, CoinEligibilityFilter(0, 1, max_ancestors/2, max_descendants/2), *groups, setCoinsRet, nValueRet, coin_selection_params, bnb_used)) ||
+        (m_spend_zero_conf_change && SelectCoinsMinConf(value_to_select, CoinEligibilityFilter(0, 1, max_ancestors-1, max_descendants-1), *groups, setCoinsRet, nValueRet, coin_selection_params, bnb_used)) ||
+        (m_spend_zero_conf_change && !fRejectLongChains && SelectCoinsMinConf(value_to_select, CoinEligibilityFilter(0, 1, std::numeric_limits<uint64_t>::max()), *groups, setCoinsRet, nValueRet, coin_selection_params, bnb_used));
 
     // because SelectCoinsMinConf clears the setCoinsRet, we now add the possible inputs to the coinset
     util::insert(setCoinsRet, setPresetCoins);
@@ -3263,6 +3483,7 @@ DBErrors CWallet::ZapSelectTx(std::vector<uint256>& vHashIn, std::vector<uint256
     for (const uint256& hash : vHashOut) {
         const auto& it = mapWallet.find(hash);
         wtxOrdered.erase(it->second.m_it_wtxOrdered);
+        if (it->second.m_in_tx_list) m_tx_list_index.erase(it->second.m_it_tx_list);
         for (const auto& txin : it->second.GetInputs())
             mapTxSpends.erase(txin.GetIndex());
         mapWallet.erase(it);
@@ -4009,6 +4230,7 @@ std::shared_ptr<CWallet> CWallet::Create(interfaces::Chain& chain, const std::st
     walletInstance->m_confirm_target = gArgs.GetArg("-txconfirmtarget", DEFAULT_TX_CONFIRM_TARGET);
     walletInstance->m_spend_zero_conf_change = gArgs.GetBoolArg("-spendzeroconfchange", DEFAULT_SPEND_ZEROCONF_CHANGE);
     walletInstance->m_signal_rbf = gArgs.GetBoolArg("-walletrbf", DEFAULT_WALLET_RBF);
+    walletInstance->m_rescan_threads = std::max(0, std::min<int>(gArgs.GetArg("-rescanthreads", DEFAULT_RESCAN_THREADS), MAX_RESCAN_THREADS));
 
     walletInstance->WalletLogPrintf("Wallet completed loading in %15dms\n", GetTimeMillis() - nStart);
 
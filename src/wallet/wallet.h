@@ -34,6 +34,7 @@
 #include <stdexcept>
 #include <stdint.h>
 #include <string>
+#include <tuple>
 #include <utility>
 #include <vector>
 
@@ -88,6 +89,10 @@ static const bool DEFAULT_WALLET_REJECT_LONG_CHAINS = false;
 static const unsigned int DEFAULT_TX_CONFIRM_TARGET = 6;
 //! -walletrbf default
 static const bool DEFAULT_WALLET_RBF = false;
+//! -rescanthreads default
+static const int DEFAULT_RESCAN_THREADS = 2;
+//! Maximum number of blocks read ahead by a rescan
+static const int MAX_RESCAN_THREADS = 16;
 static const bool DEFAULT_WALLETBROADCAST = true;
 static const bool DEFAULT_DISABLE_WALLET = false;
 //! -maxtxfee default
@@ -260,6 +265,13 @@ public:
 //Get the marginal bytes of spending the specified output
 int CalculateMaximumSignedInputSize(const CTxOut& txout, const CWallet* pwallet, bool use_max_sig = false);
 
+/**
+ * Position of a transaction in the wallet's transaction history: block height
+ * (unconfirmed last), coinbase flag, time received and hash. This is the order
+ * of WalletTxRecord::status.sortKey.
+ */
+typedef std::tuple<int, bool, unsigned int, uint256> TxListKey;
+
 /**
  * A transaction with a bunch of additional info that only the owner cares about.
  * It includes any unrecorded transactions needed to link it back to the block chain.
@@ -322,6 +334,8 @@ public:
     bool fFromMe;
     int64_t nOrderPos; //!< position in ordered transaction list
     std::multimap<int64_t, CWalletTx*>::const_iterator m_it_wtxOrdered;
+    std::map<TxListKey, CWalletTx*>::const_iterator m_it_tx_list; //!< position in CWallet::m_tx_list_index, if m_in_tx_list
+    bool m_in_tx_list{false};
 
     boost::optional<MWEB::WalletTxInfo> mweb_wtx_info;
     std::vector<std::pair<mw::Hash, size_t>> pegout_indices;
@@ -741,10 +755,14 @@ struct CoinSelectionParams
     CFeeRate m_effective_feerate;
     CFeeRate m_long_term_feerate;
     CFeeRate m_discard_feerate;
+    //! Estimated fee per 1000 units of MWEB weight, paid instead of the minimum MWEB fee when higher
+    CFeeRate m_mweb_feerate;
     size_t tx_noinputs_size = 0;
     size_t mweb_nochange_weight = 0;
     //! Indicate that we are subtracting the fee from outputs
     bool m_subtract_fee_outputs = false;
+    //! Indicate that the groups passed to SelectCoinsMinConf already have their effective values set for these feerates
+    bool m_effective_values_set = false;
     InputPreference input_preference = InputPreference::ANY;
 
     CoinSelectionParams(bool use_bnb, size_t change_output_size, size_t mweb_change_output_weight, size_t change_spend_size, CFeeRate effective_feerate,
@@ -760,6 +778,12 @@ struct CoinSelectionParams
         mweb_nochange_weight(mweb_nochange_weight)
     {}
     CoinSelectionParams() {}
+
+    //! The fee for the given size in bytes & MWEB weight at the effective and MWEB feerates
+    CAmount GetTotalFee(size_t nBytes, uint64_t mweb_weight) const
+    {
+        return m_effective_feerate.GetFee(nBytes) + std::max(m_effective_feerate.GetMWEBFee(mweb_weight), m_mweb_feerate.GetFee(mweb_weight));
+    }
 };
 
 class WalletRescanReserver; //forward declarations for ScanForWalletTransactions/RescanFromTime
@@ -778,6 +802,9 @@ private:
     std::atomic<bool> fScanningWallet{false}; // controlled by WalletRescanReserver
     std::atomic<int64_t> m_scanning_start{0};
     std::atomic<double> m_scanning_progress{0};
+    //! Set while a running rescan has pointed the wallet's best block locator at a checkpoint
+    //! rather than the tip, so chain state flushes don't overwrite it. Cleared when the rescan ends.
+    bool m_rescan_checkpointed GUARDED_BY(cs_wallet){false};
     friend class WalletRescanReserver;
 
     //! the current wallet version: clients below this version are not able to load the wallet
@@ -901,7 +928,16 @@ public:
      * if they are not ours
      */
     bool SelectCoins(const std::vector<COutputCoin>& vAvailableCoins, const CAmount& nTargetValue, std::set<CInputCoin>& setCoinsRet, CAmount& nValueRet,
-                    const CCoinControl& coin_control, CoinSelectionParams& coin_selection_params, bool& bnb_used) const EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
+                    const CCoinControl& coin_control, CoinSelectionParams& coin_selection_params, bool& bnb_used,
+                    const std::vector<OutputGroup>* groups = nullptr) const EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
+
+    /**
+     * Groups the coins SelectCoins may choose from: vAvailableCoins without the
+     * preset inputs of coin_control. Grouping looks up every coin's mempool
+     * ancestry, so callers running several selections over the same coins should
+     * group them once and pass the result to SelectCoins.
+     */
+    std::vector<OutputGroup> GroupAvailableCoins(const std::vector<COutputCoin>& vAvailableCoins, const CCoinControl& coin_control) const EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
 
     /** Get a name for this wallet for logging/debugging purposes.
      */
@@ -938,6 +974,14 @@ public:
     typedef std::multimap<int64_t, CWalletTx*> TxItems;
     TxItems wtxOrdered;
 
+    /**
+     * Wallet transactions in transaction history order, oldest first. Lets
+     * TxList produce the most recent records without visiting every transaction.
+     */
+    std::map<TxListKey, CWalletTx*> m_tx_list_index GUARDED_BY(cs_wallet);
+    /** Moves wtx to its current position in m_tx_list_index. Must be called whenever its confirmation changes. */
+    void UpdateTxListIndex(CWalletTx& wtx) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
+
     int64_t nOrderPosNext GUARDED_BY(cs_wallet) = 0;
     uint64_t nAccountingEntryNumber = 0;
 
@@ -980,7 +1024,7 @@ public:
      * completion the coin set and corresponding actual target value is
      * assembled
      */
-    bool SelectCoinsMinConf(const CAmount& nTargetValue, const CoinEligibilityFilter& eligibility_filter, std::vector<OutputGroup> groups,
+    bool SelectCoinsMinConf(const CAmount& nTargetValue, const CoinEligibilityFilter& eligibility_filter, const std::vector<OutputGroup>& groups,
         std::set<CInputCoin>& setCoinsRet, CAmount& nValueRet, const CoinSelectionParams& coin_selection_params, bool& bnb_used) const;
 
     bool IsSpent(const OutputIndex& idx) const EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
@@ -1061,6 +1105,7 @@ public:
     void blockDisconnected(const CBlock& block, int height) override;
     void updatedBlockTip() override;
     int64_t RescanFromTime(int64_t startTime, const WalletRescanReserver& reserver, bool update);
+    void WriteRescanCheckpoint(const uint256& block_hash) EXCLUSIVE_LOCKS_REQUIRED(!cs_wallet);
 
     struct ScanResult {
         enum { SUCCESS, FAILURE, USER_ABORT } status = SUCCESS;
@@ -1158,6 +1203,10 @@ public:
     unsigned int m_confirm_target{DEFAULT_TX_CONFIRM_TARGET};
     bool m_spend_zero_conf_change{DEFAULT_SPEND_ZEROCONF_CHANGE};
     bool m_signal_rbf{DEFAULT_WALLET_RBF};
+    //! Number of blocks a rescan reads and pre-scans ahead on background threads (0 to scan serially)
+    int m_rescan_threads{DEFAULT_RESCAN_THREADS};
+    //! Seconds between the progress log lines and checkpoints of a long rescan
+    int64_t m_rescan_progress_interval{60};
     bool m_allow_fallback_fee{true}; //!< will be false if -fallbackfee=0
     CFeeRate m_min_fee{DEFAULT_TRANSACTION_MINFEE}; //!< Override with -mintxfee
     /**
@@ -1451,6 +1500,9 @@ public:
     const CWalletTx* FindPrevTx(const CTxInput& input) const;
     CWalletTx* FindPrevTx(const CTxInput& input);
 
+    /** Get the IDs of the MWEB outputs created by wallet transactions. */
+    const std::map<mw::Hash, uint256>& GetMWEBOutputs() const EXCLUSIVE_LOCKS_REQUIRED(cs_wallet) { return mapOutputsMWEB; }
+
     const std::shared_ptr<MWEB::Wallet>& GetMWWallet() const noexcept { return mweb_wallet; }
     // MWEB: END
 };
@@ -352,8 +352,19 @@ ReadKeyValue(CWallet* pwallet, CDataStream& ssKey, CDataStream& ssValue,
                 return false;
             }
         } else if (strType == DBKeys::COIN) {
+            mw::Hash output_id;
+            ssKey >> output_id;
             mw::Coin coin;
-            ssValue >> coin;
+            bool corrupt = false;
+            try {
+                ssValue >> coin;
+            } catch (const std::exception&) {
+                corrupt = true;
+            }
+            if (corrupt || coin.output_id != output_id) {
+                strErr = strprintf("Error reading wallet database: MWEB coin %s corrupt", output_id.ToHex());
+                return false;
+            }
             pwallet->GetMWWallet()->LoadToWallet(coin);
             return true;
         } else if (strType == DBKeys::WATCHS) {
@@ -764,9 +775,9 @@ DBErrors WalletBatch::LoadWallet(CWallet* pwallet)
             std::string strType, strErr;
             if (!ReadKeyValue(pwallet, ssKey, ssValue, wss, strType, strErr))
             {
-                // losing keys is considered a catastrophic error, anything else
-                // we assume the user can live with:
-                if (IsKeyType(strType) || strType == DBKeys::DEFAULTKEY) {
+                // losing keys or MWEB coins (which hold the keys to spend them) is
+                // considered a catastrophic error, anything else we assume the user can live with:
+                if (IsKeyType(strType) || strType == DBKeys::DEFAULTKEY || strType == DBKeys::COIN) {
                     result = DBErrors::CORRUPT;
                 } else if (strType == DBKeys::FLAGS) {
                     // reading the wallet flags can only fail if unknown flags are present
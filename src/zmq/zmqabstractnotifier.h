@@ -10,6 +10,7 @@
 #include <memory>
 #include <string>
 
+class CBlock;
 class CBlockIndex;
 class CTransaction;
 class CZMQAbstractNotifier;
@@ -44,8 +45,9 @@ public:
     virtual bool Initialize(void *pcontext) = 0;
     virtual void Shutdown() = 0;
 
-    // Notifies of ConnectTip result, i.e., new active tip only
-    virtual bool NotifyBlock(const CBlockIndex *pindex);
+    // Notifies of ConnectTip result, i.e., new active tip only. The block
+    // data is passed when it is still in memory, and is nullptr otherwise.
+    virtual bool NotifyBlock(const CBlockIndex *pindex, const CBlock *block);
     // Notifies of every block connection
     virtual bool NotifyBlockConnect(const CBlockIndex *pindex);
     // Notifies of every block disconnection
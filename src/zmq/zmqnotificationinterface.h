@@ -37,6 +37,9 @@ private:
 
     void *pcontext;
     std::list<std::unique_ptr<CZMQAbstractNotifier>> notifiers;
+
+    //! The last connected block, passed on to block notifiers if it becomes the tip
+    std::shared_ptr<const CBlock> m_last_connected_block;
 };
 
 extern CZMQNotificationInterface* g_zmq_notification_interface;
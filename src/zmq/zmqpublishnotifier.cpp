@@ -6,18 +6,26 @@
 
 #include <chain.h>
 #include <chainparams.h>
+#include <mweb/mweb_models.h>
 #include <rpc/server.h>
 #include <streams.h>
+#include <sync.h>
 #include <util/system.h>
 #include <validation.h>
 #include <zmq/zmqutil.h>
 
 #include <zmq.h>
 
+#include <algorithm>
+#include <condition_variable>
 #include <cstdarg>
 #include <cstddef>
+#include <deque>
+#include <functional>
 #include <map>
+#include <set>
 #include <string>
+#include <thread>
 #include <utility>
 
 static std::multimap<std::string, CZMQAbstractPublishNotifier*> mapPublishNotifiers;
@@ -26,7 +34,200 @@ static const char *MSG_HASHBLOCK = "hashblock";
 static const char *MSG_HASHTX    = "hashtx";
 static const char *MSG_RAWBLOCK  = "rawblock";
 static const char *MSG_RAWTX     = "rawtx";
+static const char *MSG_RAWTXBATCH = "rawtxbatch";
 static const char *MSG_SEQUENCE  = "sequence";
+static const char *MSG_MWEBBLOCK = "mwebblock";
+
+//! Maximum number of transactions in one rawtxbatch message
+static const size_t MAX_RAWTXBATCH_COUNT = 1000;
+//! Maximum size of the transactions in one rawtxbatch message
+static const size_t MAX_RAWTXBATCH_SIZE = 4 * 1000 * 1000;
+//! Maximum total size of the messages waiting for the publisher thread
+static const size_t MAX_ZMQ_QUEUE_SIZE = 256 * 1000 * 1000;
+
+namespace {
+
+/** A message queued by a notifier, to be sent on the publisher thread. */
+struct QueuedZmqMessage
+{
+    CZMQAbstractPublishNotifier* notifier;
+    const char* command;
+    std::vector<unsigned char> data;
+};
+
+/**
+ * Sends the messages queued by all publish notifiers on a single thread, in the
+ * order they were queued, so that notifications never wait on a socket and each
+ * socket is only used by one thread. Consecutive rawtxbatch messages queued while
+ * the thread was busy are coalesced into a single message per notifier.
+ *
+ * Once a message doesn't fit in the queue, messages are dropped and counted until the
+ * queue is taken. The sequence number of their notifier skips them, so subscribers
+ * can tell that they missed messages.
+ * A notifier whose message couldn't be sent fails its next notification, so that it
+ * is shut down like one whose send failed on the notification thread.
+ */
+class ZmqPublisher
+{
+private:
+    Mutex m_mutex;
+    std::condition_variable m_cond;
+    std::deque<QueuedZmqMessage> m_queue GUARDED_BY(m_mutex);
+    //! Total size of the data in m_queue
+    size_t m_queue_size GUARDED_BY(m_mutex){0};
+    //! Messages dropped since the last ones were taken from m_queue, per notifier
+    std::map<CZMQAbstractPublishNotifier*, uint32_t> m_dropped GUARDED_BY(m_mutex);
+    uint64_t m_dropped_total GUARDED_BY(m_mutex){0};
+    std::set<CZMQAbstractPublishNotifier*> m_failed GUARDED_BY(m_mutex);
+    bool m_sending GUARDED_BY(m_mutex){false};
+    bool m_stop GUARDED_BY(m_mutex){false};
+    std::thread m_thread;
+
+    void Send(std::deque<QueuedZmqMessage>& messages, std::set<CZMQAbstractPublishNotifier*>& failed);
+    void ThreadPublish();
+
+public:
+    void Start();
+    void Stop();
+    //! Queue a message, unless its notifier failed to send an earlier one.
+    bool Queue(QueuedZmqMessage message);
+    //! Wait until all queued messages have been sent.
+    void Flush();
+    //! Forget about a notifier that is shut down. Must be called after Flush.
+    void Remove(CZMQAbstractPublishNotifier* notifier);
+};
+
+void ZmqPublisher::Start()
+{
+    assert(!m_thread.joinable());
+    {
+        LOCK(m_mutex);
+        m_stop = false;
+    }
+    m_thread = std::thread(&TraceThread<std::function<void()>>, "zmqpub", std::bind(&ZmqPublisher::ThreadPublish, this));
+}
+
+void ZmqPublisher::Stop()
+{
+    {
+        LOCK(m_mutex);
+        m_stop = true;
+    }
+    m_cond.notify_all();
+    if (m_thread.joinable()) m_thread.join();
+}
+
+bool ZmqPublisher::Queue(QueuedZmqMessage message)
+{
+    {
+        LOCK(m_mutex);
+        if (m_failed.count(message.notifier)) return false;
+        // Once a message is dropped, later ones are too until the queue is taken, so that
+        // the sequence numbers of the dropped messages can be skipped after the queued ones
+        if (!m_dropped.empty() || m_queue_size + message.data.size() > MAX_ZMQ_QUEUE_SIZE) {
+            ++m_dropped[message.notifier];
+            if (m_dropped_total++ % 1000 == 0) {
+                LogPrintf("zmq: Publisher is falling behind, dropped %u messages so far\n", m_dropped_total);
+            }
+            return true;
+        }
+        m_queue_size += message.data.size();
+        m_queue.push_back(std::move(message));
+    }
+    m_cond.notify_all();
+    return true;
+}
+
+void ZmqPublisher::Flush()
+{
+    WAIT_LOCK(m_mutex, lock);
+    m_cond.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return m_queue.empty() && !m_sending; });
+}
+
+void ZmqPublisher::Remove(CZMQAbstractPublishNotifier* notifier)
+{
+    LOCK(m_mutex);
+    m_dropped.erase(notifier);
+    m_failed.erase(notifier);
+}
+
+void ZmqPublisher::Send(std::deque<QueuedZmqMessage>& messages, std::set<CZMQAbstractPublishNotifier*>& failed)
+{
+    // A rawtxbatch message is the CompactSize count of transactions followed by
+    // the transactions themselves.
+    struct PendingBatch {
+        size_t count{0};
+        std::vector<unsigned char> txs;
+    };
+    std::map<CZMQAbstractPublishNotifier*, PendingBatch> pending;
+    const auto send_batch = [&](CZMQAbstractPublishNotifier* notifier, PendingBatch& pending_batch) {
+        CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
+        WriteCompactSize(ss, pending_batch.count);
+        ss.write((const char*)pending_batch.txs.data(), pending_batch.txs.size());
+        if (!notifier->SendZmqMessage(MSG_RAWTXBATCH, &(*ss.begin()), ss.size())) failed.insert(notifier);
+        pending_batch = PendingBatch{};
+    };
+    const auto send_batches = [&]() {
+        for (auto& entry : pending) {
+            if (entry.second.count > 0) send_batch(entry.first, entry.second);
+        }
+    };
+
+    for (QueuedZmqMessage& message : messages) {
+        if (failed.count(message.notifier)) continue;
+        if (message.command == MSG_RAWTXBATCH) {
+            PendingBatch& pending_batch = pending[message.notifier];
+            if (pending_batch.count == MAX_RAWTXBATCH_COUNT ||
+                (pending_batch.count > 0 && pending_batch.txs.size() + message.data.size() > MAX_RAWTXBATCH_SIZE)) {
+                send_batch(message.notifier, pending_batch);
+            }
+            pending_batch.txs.insert(pending_batch.txs.end(), message.data.begin(), message.data.end());
+            ++pending_batch.count;
+        } else {
+            // Transactions notified before this message are published before it
+            send_batches();
+            if (!message.notifier->SendZmqMessage(message.command, message.data.data(), message.data.size())) {
+                failed.insert(message.notifier);
+            }
+        }
+    }
+    send_batches();
+}
+
+void ZmqPublisher::ThreadPublish()
+{
+    while (true) {
+        std::deque<QueuedZmqMessage> messages;
+        std::map<CZMQAbstractPublishNotifier*, uint32_t> dropped;
+        std::set<CZMQAbstractPublishNotifier*> failed;
+        {
+            WAIT_LOCK(m_mutex, lock);
+            m_cond.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return m_stop || !m_queue.empty(); });
+            if (m_queue.empty()) return;
+            messages.swap(m_queue);
+            m_queue_size = 0;
+            dropped.swap(m_dropped);
+            failed = m_failed;
+            m_sending = true;
+        }
+
+        Send(messages, failed);
+        for (const auto& entry : dropped) {
+            entry.first->SkipZmqMessages(entry.second);
+        }
+
+        {
+            LOCK(m_mutex);
+            m_failed.insert(failed.begin(), failed.end());
+            m_sending = false;
+        }
+        m_cond.notify_all();
+    }
+}
+
+} // namespace
+
+static ZmqPublisher g_zmq_publisher;
 
 // Internal function to send multipart message
 static int zmq_send_multipart(void *sock, const void* data, size_t size, ...)
@@ -114,6 +315,7 @@ bool CZMQAbstractPublishNotifier::Initialize(void *pcontext)
         }
 
         // register this notifier for the address, so it can be reused for other publish notifier
+        if (mapPublishNotifiers.empty()) g_zmq_publisher.Start();
         mapPublishNotifiers.insert(std::make_pair(address, this));
         return true;
     }
@@ -134,6 +336,10 @@ void CZMQAbstractPublishNotifier::Shutdown()
     // Early return if Initialize was not called
     if (!psocket) return;
 
+    // Send out anything this notifier queued before its socket may be closed.
+    g_zmq_publisher.Flush();
+    g_zmq_publisher.Remove(this);
+
     int count = mapPublishNotifiers.count(address);
 
     // remove this notifier from the list of publishers using this address
@@ -157,6 +363,8 @@ void CZMQAbstractPublishNotifier::Shutdown()
         zmq_close(psocket);
     }
 
+    if (mapPublishNotifiers.empty()) g_zmq_publisher.Stop();
+
     psocket = nullptr;
 }
 
@@ -177,54 +385,97 @@ bool CZMQAbstractPublishNotifier::SendZmqMessage(const char *command, const void
     return true;
 }
 
-bool CZMQPublishHashBlockNotifier::NotifyBlock(const CBlockIndex *pindex)
+bool CZMQAbstractPublishNotifier::QueueZmqMessage(const char *command, std::vector<unsigned char> data)
+{
+    assert(psocket);
+
+    return g_zmq_publisher.Queue({this, command, std::move(data)});
+}
+
+static std::vector<unsigned char> ReversedHash(const uint256& hash, size_t extra = 0)
+{
+    std::vector<unsigned char> data(hash.size() + extra);
+    std::reverse_copy(hash.begin(), hash.end(), data.begin());
+    return data;
+}
+
+bool CZMQPublishHashBlockNotifier::NotifyBlock(const CBlockIndex *pindex, const CBlock * /*block*/)
 {
     uint256 hash = pindex->GetBlockHash();
     LogPrint(BCLog::ZMQ, "zmq: Publish hashblock %s to %s\n", hash.GetHex(), this->address);
-    char data[32];
-    for (unsigned int i = 0; i < 32; i++)
-        data[31 - i] = hash.begin()[i];
-    return SendZmqMessage(MSG_HASHBLOCK, data, 32);
+    return QueueZmqMessage(MSG_HASHBLOCK, ReversedHash(hash));
 }
 
 bool CZMQPublishHashTransactionNotifier::NotifyTransaction(const CTransaction &transaction)
 {
     uint256 hash = transaction.GetHash();
     LogPrint(BCLog::ZMQ, "zmq: Publish hashtx %s to %s\n", hash.GetHex(), this->address);
-    char data[32];
-    for (unsigned int i = 0; i < 32; i++)
-        data[31 - i] = hash.begin()[i];
-    return SendZmqMessage(MSG_HASHTX, data, 32);
+    return QueueZmqMessage(MSG_HASHTX, ReversedHash(hash));
 }
 
-bool CZMQPublishRawBlockNotifier::NotifyBlock(const CBlockIndex *pindex)
+bool CZMQPublishRawBlockNotifier::NotifyBlock(const CBlockIndex *pindex, const CBlock *block)
 {
     LogPrint(BCLog::ZMQ, "zmq: Publish rawblock %s to %s\n", pindex->GetBlockHash().GetHex(), this->address);
 
-    const Consensus::Params& consensusParams = Params().GetConsensus();
-    CDataStream ss(SER_NETWORK, PROTOCOL_VERSION | RPCSerializationFlags());
-    {
+    std::vector<unsigned char> data;
+    CVectorWriter ss(SER_NETWORK, PROTOCOL_VERSION | RPCSerializationFlags(), data, 0);
+    if (block) {
+        ss << *block;
+    } else {
+        const Consensus::Params& consensusParams = Params().GetConsensus();
         LOCK(cs_main);
-        CBlock block;
-        if(!ReadBlockFromDisk(block, pindex, consensusParams))
+        CBlock block_read;
+        if(!ReadBlockFromDisk(block_read, pindex, consensusParams))
         {
             zmqError("Can't read block from disk");
             return false;
         }
 
-        ss << block;
+        ss << block_read;
     }
 
-    return SendZmqMessage(MSG_RAWBLOCK, &(*ss.begin()), ss.size());
+    return QueueZmqMessage(MSG_RAWBLOCK, std::move(data));
 }
 
 bool CZMQPublishRawTransactionNotifier::NotifyTransaction(const CTransaction &transaction)
 {
     uint256 hash = transaction.GetHash();
     LogPrint(BCLog::ZMQ, "zmq: Publish rawtx %s to %s\n", hash.GetHex(), this->address);
-    CDataStream ss(SER_NETWORK, PROTOCOL_VERSION | RPCSerializationFlags());
-    ss << transaction;
-    return SendZmqMessage(MSG_RAWTX, &(*ss.begin()), ss.size());
+    std::vector<unsigned char> data;
+    CVectorWriter(SER_NETWORK, PROTOCOL_VERSION | RPCSerializationFlags(), data, 0) << transaction;
+    return QueueZmqMessage(MSG_RAWTX, std::move(data));
+}
+
+bool CZMQPublishRawTransactionBatchNotifier::NotifyTransaction(const CTransaction &transaction)
+{
+    uint256 hash = transaction.GetHash();
+    LogPrint(BCLog::ZMQ, "zmq: Publish rawtxbatch %s to %s\n", hash.GetHex(), this->address);
+    std::vector<unsigned char> data;
+    CVectorWriter(SER_NETWORK, PROTOCOL_VERSION | RPCSerializationFlags(), data, 0) << transaction;
+    return QueueZmqMessage(MSG_RAWTXBATCH, std::move(data));
+}
+
+bool CZMQPublishMWEBBlockNotifier::NotifyBlock(const CBlockIndex *pindex, const CBlock *block)
+{
+    CBlock block_read;
+    if (!block) {
+        const Consensus::Params& consensusParams = Params().GetConsensus();
+        LOCK(cs_main);
+        if(!ReadBlockFromDisk(block_read, pindex, consensusParams))
+        {
+            zmqError("Can't read block from disk");
+            return false;
+        }
+        block = &block_read;
+    }
+
+    // Blocks from before MWEB activation have nothing to publish
+    if (block->mweb_block.IsNull()) return true;
+
+    LogPrint(BCLog::ZMQ, "zmq: Publish mwebblock %s to %s\n", pindex->GetBlockHash().GetHex(), this->address);
+    std::vector<unsigned char> data;
+    CVectorWriter(SER_NETWORK, PROTOCOL_VERSION, data, 0) << MWEB::BlockSummary(pindex->GetBlockHash(), pindex->nHeight, pindex->mweb_amount, block->mweb_block);
+    return QueueZmqMessage(MSG_MWEBBLOCK, std::move(data));
 }
 
 
@@ -233,44 +484,36 @@ bool CZMQPublishSequenceNotifier::NotifyBlockConnect(const CBlockIndex *pindex)
 {
     uint256 hash = pindex->GetBlockHash();
     LogPrint(BCLog::ZMQ, "zmq: Publish sequence block connect %s to %s\n", hash.GetHex(), this->address);
-    char data[sizeof(uint256)+1];
-    for (unsigned int i = 0; i < sizeof(uint256); i++)
-        data[sizeof(uint256) - 1 - i] = hash.begin()[i];
-    data[sizeof(data) - 1] = 'C'; // Block (C)onnect
-    return SendZmqMessage(MSG_SEQUENCE, data, sizeof(data));
+    std::vector<unsigned char> data = ReversedHash(hash, 1);
+    data.back() = 'C'; // Block (C)onnect
+    return QueueZmqMessage(MSG_SEQUENCE, std::move(data));
 }
 
 bool CZMQPublishSequenceNotifier::NotifyBlockDisconnect(const CBlockIndex *pindex)
 {
     uint256 hash = pindex->GetBlockHash();
     LogPrint(BCLog::ZMQ, "zmq: Publish sequence block disconnect %s to %s\n", hash.GetHex(), this->address);
-    char data[sizeof(uint256)+1];
-    for (unsigned int i = 0; i < sizeof(uint256); i++)
-        data[sizeof(uint256) - 1 - i] = hash.begin()[i];
-    data[sizeof(data) - 1] = 'D'; // Block (D)isconnect
-    return SendZmqMessage(MSG_SEQUENCE, data, sizeof(data));
+    std::vector<unsigned char> data = ReversedHash(hash, 1);
+    data.back() = 'D'; // Block (D)isconnect
+    return QueueZmqMessage(MSG_SEQUENCE, std::move(data));
 }
 
 bool CZMQPublishSequenceNotifier::NotifyTransactionAcceptance(const CTransaction &transaction, uint64_t mempool_sequence)
 {
     uint256 hash = transaction.GetHash();
     LogPrint(BCLog::ZMQ, "zmq: Publish hashtx mempool acceptance %s to %s\n", hash.GetHex(), this->address);
-    unsigned char data[sizeof(uint256)+sizeof(mempool_sequence)+1];
-    for (unsigned int i = 0; i < sizeof(uint256); i++)
-        data[sizeof(uint256) - 1 - i] = hash.begin()[i];
+    std::vector<unsigned char> data = ReversedHash(hash, 1 + sizeof(mempool_sequence));
     data[sizeof(uint256)] = 'A'; // Mempool (A)cceptance
-    WriteLE64(data+sizeof(uint256)+1, mempool_sequence);
-    return SendZmqMessage(MSG_SEQUENCE, data, sizeof(data));
+    WriteLE64(data.data() + sizeof(uint256) + 1, mempool_sequence);
+    return QueueZmqMessage(MSG_SEQUENCE, std::move(data));
 }
 
 bool CZMQPublishSequenceNotifier::NotifyTransactionRemoval(const CTransaction &transaction, uint64_t mempool_sequence)
 {
     uint256 hash = transaction.GetHash();
     LogPrint(BCLog::ZMQ, "zmq: Publish hashtx mempool removal %s to %s\n", hash.GetHex(), this->address);
-    unsigned char data[sizeof(uint256)+sizeof(mempool_sequence)+1];
-    for (unsigned int i = 0; i < sizeof(uint256); i++)
-        data[sizeof(uint256) - 1 - i] = hash.begin()[i];
+    std::vector<unsigned char> data = ReversedHash(hash, 1 + sizeof(mempool_sequence));
     data[sizeof(uint256)] = 'R'; // Mempool (R)emoval
-    WriteLE64(data+sizeof(uint256)+1, mempool_sequence);
-    return SendZmqMessage(MSG_SEQUENCE, data, sizeof(data));
+    WriteLE64(data.data() + sizeof(uint256) + 1, mempool_sequence);
+    return QueueZmqMessage(MSG_SEQUENCE, std::move(data));
 }
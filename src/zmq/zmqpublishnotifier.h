@@ -7,6 +7,8 @@
 
 #include <zmq/zmqabstractnotifier.h>
 
+#include <vector>
+
 class CBlockIndex;
 
 class CZMQAbstractPublishNotifier : public CZMQAbstractNotifier
@@ -21,9 +23,22 @@ public:
           * command
           * data
           * message sequence number
+       only called on the publisher thread
     */
     bool SendZmqMessage(const char *command, const void* data, size_t size);
 
+    /* queue a message to be sent by SendZmqMessage on the publisher thread,
+       so notifications never wait on the socket
+       returns false if an earlier message of this notifier failed to send
+    */
+    bool QueueZmqMessage(const char *command, std::vector<unsigned char> data);
+
+    /* count messages that were dropped instead of sent, so that the next
+       message's sequence number shows the gap
+       only called on the publisher thread
+    */
+    void SkipZmqMessages(uint32_t count) { nSequence += count; }
+
     bool Initialize(void *pcontext) override;
     void Shutdown() override;
 };
@@ -31,7 +46,7 @@ public:
 class CZMQPublishHashBlockNotifier : public CZMQAbstractPublishNotifier
 {
 public:
-    bool NotifyBlock(const CBlockIndex *pindex) override;
+    bool NotifyBlock(const CBlockIndex *pindex, const CBlock *block) override;
 };
 
 class CZMQPublishHashTransactionNotifier : public CZMQAbstractPublishNotifier
@@ -43,7 +58,7 @@ public:
 class CZMQPublishRawBlockNotifier : public CZMQAbstractPublishNotifier
 {
 public:
-    bool NotifyBlock(const CBlockIndex *pindex) override;
+    bool NotifyBlock(const CBlockIndex *pindex, const CBlock *block) override;
 };
 
 class CZMQPublishRawTransactionNotifier : public CZMQAbstractPublishNotifier
@@ -52,6 +67,18 @@ public:
     bool NotifyTransaction(const CTransaction &transaction) override;
 };
 
+class CZMQPublishRawTransactionBatchNotifier : public CZMQAbstractPublishNotifier
+{
+public:
+    bool NotifyTransaction(const CTransaction &transaction) override;
+};
+
+class CZMQPublishMWEBBlockNotifier : public CZMQAbstractPublishNotifier
+{
+public:
+    bool NotifyBlock(const CBlockIndex *pindex, const CBlock *block) override;
+};
+
 class CZMQPublishSequenceNotifier : public CZMQAbstractPublishNotifier
 {
 public:
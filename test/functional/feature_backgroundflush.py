@@ -0,0 +1,150 @@
+#!/usr/bin/env python3
+# Copyright (c) 2021 The Bitcoin Core developers
+# Distributed under the MIT software license, see the accompanying
+# file COPYING or http://www.opensource.org/licenses/mit-license.php.
+"""Test -backgroundflush on a chain with MWEB blocks.
+
+- node0 writes its chainstate in the background. node1 is a regular node to compare with.
+- Moving the mock time past the flush interval makes node0 hand its coins cache over to
+  a background write after the next block.
+- An MWEB coin created in that block is spent right away. The mempool and the next block
+  read it through the pending writes of the MWEB database, unless the write has already
+  been committed.
+- Several background writes in a row compact the leafset and PMMR files on the writer
+  thread. node0 must still load them after a restart.
+- A background write interrupted by -dbcrashratio is replayed on restart.
+"""
+
+import http.client
+import time
+
+from test_framework.ltc_util import setup_mweb_chain
+from test_framework.test_framework import BitcoinTestFramework
+from test_framework.util import assert_equal
+
+# DATABASE_FLUSH_INTERVAL in validation.cpp, plus an hour
+FLUSH_INTERVAL = 25 * 60 * 60
+
+# Logged with -debug=bench once the writer has committed a snapshot
+SNAPSHOT_WRITTEN = 'coins) completed'
+
+
+class BackgroundFlushTest(BitcoinTestFramework):
+    def set_test_params(self):
+        self.setup_clean_chain = True
+        self.num_nodes = 2
+        self.background_args = ['-backgroundflush', '-debug=bench', '-whitelist=noban@127.0.0.1']
+        self.extra_args = [self.background_args, ['-whitelist=noban@127.0.0.1']]
+
+    def skip_test_if_missing_module(self):
+        self.skip_if_no_wallet()
+
+    def advance_time(self):
+        """Move the mock time of all nodes past the flush interval."""
+        self.mock_time += FLUSH_INTERVAL
+        for node in self.nodes:
+            node.setmocktime(self.mock_time)
+
+    def restart_node0(self, extra_args=None):
+        self.restart_node(0, extra_args=self.background_args + (extra_args or []))
+        # The blocks are ahead of the clock after the mock time moved
+        self.nodes[0].setmocktime(self.mock_time)
+        self.connect_nodes(0, 1)
+
+    def run_test(self):
+        node0, node1 = self.nodes
+        self.mock_time = int(time.time())
+        for node in self.nodes:
+            node.setmocktime(self.mock_time)
+
+        self.log.info("Activate MWEB")
+        setup_mweb_chain(node0)
+        node0.sendtoaddress(node1.getnewaddress(), 10)
+        node0.generate(1)
+        self.sync_all()
+
+        self.test_pending_mweb_reads()
+        self.test_compaction()
+        self.test_interrupted_write()
+
+    def test_pending_mweb_reads(self):
+        node0, node1 = self.nodes
+
+        self.log.info("Spend an MWEB coin right after it is handed over to a background write")
+        # node1 pegs in its only coin, so that its next transaction spends the MWEB coin
+        node1.sendtoaddress(address=node1.getnewaddress(address_type='mweb'), amount=10, subtractfeefromamount=True)
+        self.sync_mempools()
+        self.advance_time()
+        with node0.assert_debug_log([SNAPSHOT_WRITTEN], timeout=30):
+            node0.generate(1)
+            self.sync_blocks()
+            spend_txid = node1.sendtoaddress(node0.getnewaddress(address_type='mweb'), 5)
+            self.sync_mempools()
+            node0.generate(1)
+        self.sync_all()
+        assert_equal(node0.getrawmempool(), [])
+        assert_equal(node1.gettransaction(spend_txid)['confirmations'], 1)
+
+    def test_compaction(self):
+        node0, node1 = self.nodes
+
+        self.log.info("Compact the leafset and PMMR files in several background writes in a row")
+        for _ in range(3):
+            node0.sendtoaddress(node0.getnewaddress(address_type='mweb'), 1)
+            self.sync_mempools()
+            self.advance_time()
+            with node0.assert_debug_log([SNAPSHOT_WRITTEN], timeout=30):
+                node0.generate(1)
+            self.sync_all()
+
+        self.log.info("Restart node0 and check it loads the compacted files")
+        tip = node0.getbestblockhash()
+        utxo_hash = node0.gettxoutsetinfo()['hash_serialized_2']
+        self.restart_node0()
+        assert_equal(node0.getbestblockhash(), tip)
+        assert_equal(node0.gettxoutsetinfo()['hash_serialized_2'], utxo_hash)
+
+        self.log.info("Check node0 still validates MWEB spends")
+        spend_txid = node1.sendtoaddress(node0.getnewaddress(address_type='mweb'), 1)
+        self.sync_mempools()
+        node0.generate(1)
+        self.sync_all()
+        assert_equal(node1.gettransaction(spend_txid)['confirmations'], 1)
+
+    def test_interrupted_write(self):
+        node0, node1 = self.nodes
+
+        self.log.info("Interrupt a background write with -dbcrashratio")
+        mining_addr = node0.getnewaddress()
+        height = node0.getblockcount()
+        self.restart_node0(['-dbcrashratio=1', '-dbbatchsize=1'])
+        node0 = self.nodes[0]
+        # The block pending in the interrupted write creates and spends MWEB coins
+        node1.sendtoaddress(node1.getnewaddress(address_type='mweb'), 1)
+        self.sync_mempools()
+        self.advance_time()
+        try:
+            node0.generatetoaddress(1, mining_addr)
+        except (http.client.CannotSendRequest, ConnectionError) as e:
+            self.log.debug("node0 crashed while mining: %s", e)
+        node0.wait_until_stopped()
+
+        self.log.info("Restart node0 and check it replays the block")
+        with node0.assert_debug_log(['Replaying blocks', 'Rolling forward']):
+            self.start_node(0, extra_args=self.background_args)
+        node0.setmocktime(self.mock_time)
+        assert_equal(node0.getblockcount(), height + 1)
+        self.connect_nodes(0, 1)
+        self.sync_blocks()
+        assert_equal(node0.gettxoutsetinfo()['hash_serialized_2'], node1.gettxoutsetinfo()['hash_serialized_2'])
+
+        self.log.info("Check node0 validates a spend of an MWEB coin from the replayed block")
+        spend_txid = node1.sendtoaddress(node0.getnewaddress(address_type='mweb'), 0.5)
+        self.sync_mempools()
+        node0.generatetoaddress(1, mining_addr)
+        self.sync_all()
+        assert_equal(node1.gettransaction(spend_txid)['confirmations'], 1)
+
+
+if __name__ == '__main__':
+    BackgroundFlushTest().main()
@@ -0,0 +1,67 @@
+#!/usr/bin/env python3
+# Copyright (c) 2021 The Bitcoin Core developers
+# Distributed under the MIT software license, see the accompanying
+# file COPYING or http://www.opensource.org/licenses/mit-license.php.
+"""Test the -dboption option and the getdbstats RPC."""
+
+import os
+
+from test_framework.test_framework import BitcoinTestFramework
+from test_framework.util import assert_equal, assert_greater_than
+
+
+class DBOptionTest(BitcoinTestFramework):
+    def set_test_params(self):
+        self.num_nodes = 1
+        self.extra_args = [[
+            '-txindex',
+            '-blockfilterindex=basic',
+            '-dboption=chainstate:bloombits=16',
+            '-dboption=txindex:blocksize=16',
+            '-dboption=blockfilterindex/basic:maxfilesize=4',
+        ]]
+
+    def run_test(self):
+        node = self.nodes[0]
+
+        self.log.info("getdbstats reports all open databases")
+        stats = node.getdbstats()
+        assert_equal(sorted(stats.keys()), ['blockfilterindex/basic', 'blockindex', 'chainstate', 'txindex'])
+        chainstate = stats['chainstate']
+        assert_equal(chainstate['engine'], 'leveldb')
+        assert_greater_than(chainstate['reads'], 0)
+        assert_greater_than(chainstate['memory_usage'], 0)
+        assert 0 <= chainstate['block_cache_hit_rate'] <= 1
+        assert chainstate['read_amplification'] >= 0
+        for level in chainstate['levels']:
+            assert level['files'] >= 0
+
+        self.log.info("getdbstats can be filtered by database")
+        assert_equal(list(node.getdbstats('txindex').keys()), ['txindex'])
+        assert_equal(node.getdbstats('unknown'), {})
+
+        self.log.info("-dboption settings only apply to their database")
+        datadir = os.path.join(node.datadir, self.chain)
+        with node.assert_debug_log([
+            "LevelDB options for {}: bloom_bits=16 block_size=4096 max_file_size=2097152 ".format(os.path.join(datadir, 'chainstate')),
+            "LevelDB options for {}: bloom_bits=10 block_size=16384 max_file_size=2097152 ".format(os.path.join(datadir, 'indexes', 'txindex')),
+            "LevelDB options for {}: bloom_bits=10 block_size=4096 max_file_size=4194304 ".format(os.path.join(datadir, 'indexes', 'blockfilter', 'basic', 'db')),
+            "LevelDB options for {}: bloom_bits=10 block_size=4096 max_file_size=2097152 ".format(os.path.join(datadir, 'blocks', 'index')),
+        ]):
+            self.restart_node(0, self.extra_args[0] + ['-debug=leveldb'])
+
+        self.log.info("Invalid -dboption settings are rejected")
+        self.stop_node(0)
+        for setting, error in [
+            ('wallet:bloombits=10', "Error: Unknown database 'wallet' in -dboption 'wallet:bloombits=10'"),
+            ('blockfilterindex:bloombits=10', "Error: Unknown database 'blockfilterindex' in -dboption 'blockfilterindex:bloombits=10'"),
+            ('blockfilterindex/unknown:bloombits=10', "Error: Unknown database 'blockfilterindex/unknown' in -dboption 'blockfilterindex/unknown:bloombits=10'"),
+            ('chainstate:bloombits', "Error: Invalid -dboption 'chainstate:bloombits', expected <db>:<option>=<value>"),
+            ('chainstate:bloom=10', "Error: Unknown database option 'bloom' in -dboption 'chainstate:bloom=10'"),
+            ('chainstate:blockcachepercent=0', "Error: Database option blockcachepercent must be between 1 and 99 in -dboption 'chainstate:blockcachepercent=0'"),
+        ]:
+            node.assert_start_raises_init_error(['-dboption=' + setting], error)
+
+
+if __name__ == '__main__':
+    DBOptionTest().main()
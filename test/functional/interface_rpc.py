@@ -5,9 +5,10 @@
 """Tests some generic aspects of the RPC interface."""
 
 import os
+import threading
 from test_framework.authproxy import JSONRPCException
 from test_framework.test_framework import BitcoinTestFramework
-from test_framework.util import assert_equal, assert_greater_than_or_equal
+from test_framework.util import assert_equal, assert_greater_than_or_equal, get_rpc_proxy
 
 def expect_http_status(expected_http_status, expected_rpc_code,
                        fcn, *args):
@@ -35,6 +36,11 @@ class RPCInterfaceTest(BitcoinTestFramework):
         assert_greater_than_or_equal(command['duration'], 0)
         assert_equal(info['logpath'], os.path.join(self.nodes[0].datadir, self.chain, 'debug.log'))
 
+        assert_equal([queue['name'] for queue in info['work_queues']], ['default', 'heavy'])
+        for queue in info['work_queues']:
+            assert_equal(len(queue['queue_wait']), len(info['latency_buckets']) + 1)
+            assert_equal(len(queue['exec']), len(info['latency_buckets']) + 1)
+
     def test_batch_request(self):
         self.log.info("Testing basic JSON-RPC batch request...")
 
@@ -67,10 +73,57 @@ class RPCInterfaceTest(BitcoinTestFramework):
         expect_http_status(404, -32601, self.nodes[0].invalidmethod)
         expect_http_status(500, -8, self.nodes[0].getblockhash, 42)
 
+    def test_work_classes(self):
+        self.log.info("Testing work class limits...")
+        self.restart_node(0, extra_args=["-rpcworkclass=slow,1,1,-1,waitfornewblock"])
+        node = self.nodes[0]
+        assert_equal([queue['name'] for queue in node.getrpcinfo()['work_queues']], ['default', 'slow'])
+
+        # Occupy the only thread of the class and fill its queue
+        calls = [threading.Thread(target=get_rpc_proxy(node.url, 0, timeout=60).waitfornewblock, args=(3000,)) for _ in range(2)]
+        for call in calls:
+            call.start()
+        self.wait_until(lambda: node.getrpcinfo()['work_queues'][1]['queued'] == 1)
+        slow = node.getrpcinfo()['work_queues'][1]
+        assert_equal(slow['active'], 1)
+
+        # Further calls of the class are rejected, while other calls still run
+        expect_http_status(503, -342, get_rpc_proxy(node.url, 0).waitfornewblock, 3000)
+        expect_http_status(503, -342, get_rpc_proxy(node.url, 0).batch, [
+            {"method": "getblockcount", "id": 1},
+            {"method": "waitfornewblock", "id": 2, "params": [3000]},
+        ])
+        assert_equal(node.getblockcount(), 0)
+
+        for call in calls:
+            call.join()
+        slow = node.getrpcinfo()['work_queues'][1]
+        assert_equal(slow['rejected'], 2)
+        assert_equal(sum(slow['exec']), 2)
+
+        self.log.info("Testing work class priorities...")
+        self.restart_node(0, extra_args=["-rpcworkclass=slow,1,1,-1,waitfornewblock", "-rpcworkclass=fast,1,1,1,getblockcount"])
+        node = self.nodes[0]
+        assert_equal([queue['name'] for queue in node.getrpcinfo()['work_queues']], ['fast', 'default', 'slow'])
+
+        # Calls of a class with a higher priority than the default one run in it
+        node.getblockcount()
+        get_rpc_proxy(node.url, 0).batch([{"method": "getblockcount", "id": 1}, {"method": "getblockcount", "id": 2}])
+        queues = node.getrpcinfo()['work_queues']
+        assert_equal(sum(queues[0]['exec']), 2)
+
+        # A batch mixing classes runs in the lowest priority one
+        get_rpc_proxy(node.url, 0).batch([{"method": "getblockcount", "id": 1}, {"method": "getbestblockhash", "id": 2}])
+        get_rpc_proxy(node.url, 0).batch([{"method": "getblockcount", "id": 1}, {"method": "waitfornewblock", "id": 2, "params": [1]}])
+        queues = node.getrpcinfo()['work_queues']
+        assert_equal(sum(queues[0]['exec']), 2)
+        assert_equal(sum(queues[2]['exec']), 1)
+
     def run_test(self):
         self.test_getrpcinfo()
         self.test_batch_request()
         self.test_http_status_codes()
+        self.test_work_classes()
 
 
 if __name__ == '__main__':
@@ -8,7 +8,7 @@ import struct
 from test_framework.address import ADDRESS_BCRT1_UNSPENDABLE, ADDRESS_BCRT1_P2WSH_OP_TRUE
 from test_framework.blocktools import create_block, create_coinbase, add_witness_commitment
 from test_framework.test_framework import BitcoinTestFramework
-from test_framework.messages import CTransaction, hash256, FromHex
+from test_framework.messages import CTransaction, deser_compact_size, hash256, FromHex
 from test_framework.util import (
     assert_equal,
     assert_raises_rpc_error,
@@ -75,6 +75,7 @@ class ZMQTest (BitcoinTestFramework):
         self.ctx = zmq.Context()
         try:
             self.test_basic()
+            self.test_rawtxbatch()
             self.test_sequence()
             self.test_mempool_sync()
             self.test_reorg()
@@ -171,6 +172,52 @@ class ZMQTest (BitcoinTestFramework):
 
         assert_equal(self.nodes[1].getzmqnotifications(), [])
 
+    def test_rawtxbatch(self):
+        self.log.info("Testing rawtxbatch publisher")
+
+        address = 'tcp://127.0.0.1:28333'
+        socket = self.ctx.socket(zmq.SUB)
+        socket.set(zmq.RCVTIMEO, 60000)
+        rawtxbatch = ZMQSubscriber(socket, b"rawtxbatch")
+        hashblock = ZMQSubscriber(socket, b"hashblock")
+
+        self.restart_node(0, ["-zmqpubrawtxbatch=%s" % address, "-zmqpubhashblock=%s" % address])
+        socket.connect(address)
+        # Relax so that the subscriber is ready before publishing zmq messages
+        sleep(0.2)
+
+        num_blocks = 5
+        genhashes = self.nodes[0].generatetoaddress(num_blocks, ADDRESS_BCRT1_UNSPENDABLE)
+        coinbase_txids = [self.nodes[0].getblock(hash)["tx"][0] for hash in genhashes]
+
+        # Batches are published in order with the other topics, so each block's
+        # coinbase arrives before its hashblock message.
+        txids = []
+        blockhashes = []
+        while len(blockhashes) < num_blocks:
+            topic, body, seq = socket.recv_multipart()
+            subscriber = rawtxbatch if topic == rawtxbatch.topic else hashblock
+            assert_equal(topic, subscriber.topic)
+            assert_equal(struct.unpack('<I', seq)[-1], subscriber.sequence)
+            subscriber.sequence += 1
+            if subscriber is hashblock:
+                blockhashes.append(body.hex())
+                assert_equal(txids, coinbase_txids[:len(blockhashes)])
+                continue
+            f = BytesIO(body)
+            count = deser_compact_size(f)
+            assert count > 0
+            for _ in range(count):
+                tx = CTransaction()
+                tx.deserialize(f)
+                tx.calc_sha256()
+                txids.append(tx.hash)
+            assert_equal(f.read(), b"")
+        assert_equal(blockhashes, genhashes)
+        assert_equal(txids, coinbase_txids)
+
+        socket.close()
+
     def test_reorg(self):
         if not self.is_wallet_compiled():
             self.log.info("Skipping reorg test because wallet is disabled")
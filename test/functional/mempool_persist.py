@@ -37,6 +37,7 @@ Test is as follows:
 """
 from decimal import Decimal
 import os
+import struct
 import time
 
 from test_framework.p2p import P2PTxInvStore
@@ -51,7 +52,7 @@ from test_framework.util import (
 class MempoolPersistTest(BitcoinTestFramework):
     def set_test_params(self):
         self.num_nodes = 3
-        self.extra_args = [[], ["-persistmempool=0"], []]
+        self.extra_args = [["-persistsigcache"], ["-persistmempool=0"], []]
 
     def skip_test_if_missing_module(self):
         self.skip_if_no_wallet()
@@ -115,16 +116,33 @@ class MempoolPersistTest(BitcoinTestFramework):
         # start node0 with wallet disabled so wallet transactions don't get resubmitted
         self.log.debug("Stop-start node0 with -persistmempool=0. Verify that it doesn't load its mempool.dat file.")
         self.stop_nodes()
-        self.start_node(0, extra_args=["-persistmempool=0", "-disablewallet"])
+        self.start_node(0, extra_args=["-persistmempool=0", "-disablewallet", "-persistsigcache"])
         assert self.nodes[0].getmempoolinfo()["loaded"]
         assert_equal(len(self.nodes[0].getrawmempool()), 0)
 
-        self.log.debug("Stop-start node0. Verify that it has the transactions in its mempool.")
+        self.log.debug("Stop-start node0. Verify that it has the transactions in its mempool and reloads its signature caches.")
         self.stop_nodes()
-        self.start_node(0)
-        assert self.nodes[0].getmempoolinfo()["loaded"]
+        for cache_file in ['sigcache.dat', 'scriptcache.dat']:
+            assert os.path.isfile(os.path.join(self.nodes[0].datadir, self.chain, cache_file))
+        with self.nodes[0].assert_debug_log(['signature cache entries', 'script execution cache entries']):
+            self.start_node(0)
+            # The caches are loaded before the mempool
+            assert self.nodes[0].getmempoolinfo()["loaded"]
         assert_equal(len(self.nodes[0].getrawmempool()), 6)
 
+        self.log.debug("Stop-start node0. Verify that it discards signature caches saved by another client version.")
+        self.stop_nodes()
+        sigcachedat0 = os.path.join(self.nodes[0].datadir, self.chain, 'sigcache.dat')
+        with open(sigcachedat0, 'r+b') as f:
+            # The client version follows the 8-byte file format version
+            f.seek(8)
+            client_version = struct.unpack("<i", f.read(4))[0]
+            f.seek(8)
+            f.write(struct.pack("<i", client_version + 1))
+        with self.nodes[0].assert_debug_log(['Discarding {}, which was saved by another client version'.format(sigcachedat0)]):
+            self.start_node(0)
+        assert not os.path.isfile(sigcachedat0)
+
         mempooldat0 = os.path.join(self.nodes[0].datadir, self.chain, 'mempool.dat')
         mempooldat1 = os.path.join(self.nodes[1].datadir, self.chain, 'mempool.dat')
         self.log.debug("Remove the mempool.dat file. Verify that savemempool to disk via RPC re-creates it")
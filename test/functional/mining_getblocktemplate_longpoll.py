@@ -9,7 +9,7 @@ import random
 import threading
 
 from test_framework.test_framework import BitcoinTestFramework
-from test_framework.util import get_rpc_proxy
+from test_framework.util import assert_equal, get_rpc_proxy
 from test_framework.wallet import MiniWallet
 
 
@@ -77,5 +77,32 @@ class GetBlockTemplateLPTest(BitcoinTestFramework):
         thr.join(60 + 20)
         assert not thr.is_alive()
 
+        self.log.info("Test that the template is kept up to date in the background with -blocktemplaterefresh")
+        self.restart_node(0, extra_args=['-blocktemplaterefresh=1'])
+        self.connect_nodes(0, 1)
+        node = self.nodes[0]
+        rules = {'rules': ['mweb', 'segwit']}
+        # Nothing is built before the first request
+        with node.assert_debug_log(['Built block template (request) on {}'.format(node.getbestblockhash())]):
+            template = node.getblocktemplate(rules)
+        # Later requests are served the prebuilt template
+        with node.assert_debug_log([], unexpected_msgs=['Built block template (request)']):
+            assert_equal(node.getblocktemplate(rules)['longpollid'], template['longpollid'])
+
+        # It is rebuilt in the background after a mempool change, and served
+        with node.assert_debug_log(['Built block template (background) on {}'.format(node.getbestblockhash())], unexpected_msgs=['Built block template (request)'], timeout=10):
+            txid = miniwallets[0].send_self_transfer(from_node=node)['txid']
+        with node.assert_debug_log([], unexpected_msgs=['Built block template (request)']):
+            template = node.getblocktemplate(rules)
+        assert txid in [tx['txid'] for tx in template['transactions']]
+
+        # And after a new block
+        with node.assert_debug_log(['Built block template (background) on'], unexpected_msgs=['Built block template (request)'], timeout=10):
+            miniwallets[0].generate(1)
+        with node.assert_debug_log([], unexpected_msgs=['Built block template (request)']):
+            template = node.getblocktemplate(rules)
+        assert_equal(template['previousblockhash'], node.getbestblockhash())
+        assert txid not in [tx['txid'] for tx in template['transactions']]
+
 if __name__ == '__main__':
     GetBlockTemplateLPTest().main()
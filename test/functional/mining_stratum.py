@@ -0,0 +1,224 @@
+#!/usr/bin/env python3
+# Copyright (c) 2021 The Bitcoin Core developers
+# Distributed under the MIT software license, see the accompanying
+# file COPYING or http://www.opensource.org/licenses/mit-license.php.
+"""Test the stratum work server with a stand-in miner.
+
+- Subscribe and authorize, and receive the share difficulty and a job.
+- Mine a block from the job and check it is accepted and pays to -stratumaddress.
+- Check that a new job is pushed for the new tip.
+- Check duplicate, low difficulty, unknown job and unauthorized submissions are rejected.
+- After MWEB activation, mine a block with a peg-in from a job, and check it has the HogEx.
+- Check that shares are only accepted for the last jobs built on a tip.
+"""
+
+from decimal import Decimal
+import json
+import socket
+import struct
+
+import catcoin_scrypt
+
+from test_framework.address import ADDRESS_BCRT1_UNSPENDABLE
+from test_framework.ltc_util import get_hogex_tx, setup_mweb_chain
+from test_framework.messages import hash256, uint256_from_compact, uint256_from_str
+from test_framework.test_framework import BitcoinTestFramework
+from test_framework.util import assert_equal, p2p_port
+from test_framework.wallet import MiniWallet
+
+# Share target at difficulty 1, the regtest proof-of-work limit
+SHARE_TARGET = 2**255 - 1
+
+# MAX_STRATUM_JOBS_PER_TIP in stratum.cpp
+MAX_STRATUM_JOBS_PER_TIP = 8
+
+
+def stratum_prevhash(block_hash):
+    """The previous block hash as sent in jobs: eight 32-bit words, each byte-swapped."""
+    internal = bytes.fromhex(block_hash)[::-1]
+    return b''.join(internal[i:i + 4][::-1] for i in range(0, 32, 4)).hex()
+
+
+class StratumMiner:
+    """A minimal stratum client."""
+
+    def __init__(self, port):
+        self.sock = socket.create_connection(('127.0.0.1', port), timeout=60)
+        self.reader = self.sock.makefile('r')
+        self.next_id = 0
+        self.notifications = []
+
+    def close(self):
+        self.reader.close()
+        self.sock.close()
+
+    def read_message(self):
+        return json.loads(self.reader.readline())
+
+    def request(self, method, params):
+        self.next_id += 1
+        self.sock.sendall((json.dumps({'id': self.next_id, 'method': method, 'params': params}) + '\n').encode())
+        while True:
+            message = self.read_message()
+            if message['id'] == self.next_id:
+                return message
+            self.notifications.append(message)
+
+    def wait_for_notification(self, method):
+        for i, message in enumerate(self.notifications):
+            if message['method'] == method:
+                return self.notifications.pop(i)
+        while True:
+            message = self.read_message()
+            if message['method'] == method:
+                return message
+            self.notifications.append(message)
+
+    def subscribe(self):
+        result = self.request('mining.subscribe', [])['result']
+        self.extranonce1 = bytes.fromhex(result[1])
+        self.extranonce2_size = result[2]
+
+    def header(self, job, extranonce2, ntime, nonce):
+        job_id, prevhash, coinb1, coinb2, branch, version, nbits, _, _ = job
+        coinbase = bytes.fromhex(coinb1) + self.extranonce1 + extranonce2 + bytes.fromhex(coinb2)
+        merkle_root = hash256(coinbase)
+        for h in branch:
+            merkle_root = hash256(merkle_root + bytes.fromhex(h))
+        prev = b''.join(bytes.fromhex(prevhash)[i:i + 4][::-1] for i in range(0, 32, 4))
+        return struct.pack('<I', int(version, 16)) + prev + merkle_root + struct.pack('<III', ntime, int(nbits, 16), nonce)
+
+    def find_nonce(self, job, extranonce2, ntime, accept):
+        """Return the first nonce whose scrypt hash is accepted by accept(hash)."""
+        nonce = 0
+        while not accept(uint256_from_str(catcoin_scrypt.getPoWHash(self.header(job, extranonce2, ntime, nonce)))):
+            nonce += 1
+        return nonce
+
+    def submit(self, job_id, extranonce2, ntime, nonce):
+        return self.request('mining.submit', ['worker', job_id, extranonce2.hex(), '%08x' % ntime, '%08x' % nonce])
+
+
+class StratumTest(BitcoinTestFramework):
+    def set_test_params(self):
+        self.num_nodes = 1
+        self.setup_clean_chain = True
+
+    def setup_network(self):
+        # The stratum port is taken from the range reserved for a second node.
+        self.stratum_port = p2p_port(1)
+        self.extra_args = [['-stratum', '-stratumaddress={}'.format(ADDRESS_BCRT1_UNSPENDABLE), '-stratumport={}'.format(self.stratum_port), '-stratumjobinterval=1']]
+        self.setup_nodes()
+
+    def run_test(self):
+        node = self.nodes[0]
+        # Leave initial block download, so that jobs are created
+        node.generatetoaddress(1, ADDRESS_BCRT1_UNSPENDABLE)
+
+        self.log.info("Subscribe and receive the difficulty and a job")
+        miner = StratumMiner(self.stratum_port)
+        miner.subscribe()
+        assert_equal(miner.extranonce2_size, 4)
+        assert_equal(miner.wait_for_notification('mining.set_difficulty')['params'], [1])
+        job = miner.wait_for_notification('mining.notify')['params']
+        assert_equal(job[8], True)
+        assert_equal(miner.request('mining.authorize', ['worker', 'x'])['result'], True)
+
+        self.log.info("Mine a block from the job")
+        extranonce2 = bytes(miner.extranonce2_size)
+        ntime = int(job[7], 16)
+        block_target = uint256_from_compact(int(job[6], 16))
+        nonce = miner.find_nonce(job, extranonce2, ntime, lambda h: h <= block_target)
+        tip = node.getbestblockhash()
+        reply = miner.submit(job[0], extranonce2, ntime, nonce)
+        assert_equal(reply['result'], True)
+        assert_equal(reply['error'], None)
+        self.wait_until(lambda: node.getbestblockhash() != tip)
+        block = node.getblock(node.getbestblockhash(), 2)
+        assert_equal(block['height'], 2)
+        assert_equal(block['previousblockhash'], tip)
+        assert_equal(block['tx'][0]['vout'][0]['scriptPubKey']['addresses'], [ADDRESS_BCRT1_UNSPENDABLE])
+
+        self.log.info("A new job is pushed for the new tip")
+        new_job = miner.wait_for_notification('mining.notify')['params']
+        assert new_job[0] != job[0]
+        assert_equal(new_job[8], True)
+
+        self.log.info("Reject duplicate, stale and low difficulty shares")
+        assert_equal(miner.submit(job[0], extranonce2, ntime, nonce)['error'][0], 21)
+        ntime = int(new_job[7], 16)
+        nonce = miner.find_nonce(new_job, extranonce2, ntime, lambda h: h > SHARE_TARGET)
+        assert_equal(miner.submit(new_job[0], extranonce2, ntime, nonce)['error'][0], 23)
+        assert_equal(miner.submit(new_job[0], extranonce2, ntime, nonce)['error'][0], 22)
+
+        self.log.info("Reject shares from miners that didn't authorize")
+        other = StratumMiner(self.stratum_port)
+        other.subscribe()
+        assert_equal(other.submit(new_job[0], extranonce2, ntime, nonce)['error'][0], 24)
+        other.close()
+
+        if self.is_wallet_compiled():
+            self.test_mweb_block(miner)
+
+        self.test_job_cap(miner)
+
+        miner.close()
+
+    def test_mweb_block(self, miner):
+        self.log.info("Mine a block with a peg-in from a job after MWEB activation")
+        node = self.nodes[0]
+        setup_mweb_chain(node)
+        pegin_txid = node.sendtoaddress(node.getnewaddress(address_type='mweb'), 1)
+        tip = node.getbestblockhash()
+
+        # Wait for the job with the peg-in: its merkle branch covers the peg-in and the HogEx.
+        while True:
+            job = miner.wait_for_notification('mining.notify')['params']
+            if job[1] == stratum_prevhash(tip) and len(job[4]) == 2:
+                break
+
+        extranonce2 = bytes(miner.extranonce2_size)
+        ntime = int(job[7], 16)
+        block_target = uint256_from_compact(int(job[6], 16))
+        nonce = miner.find_nonce(job, extranonce2, ntime, lambda h: h <= block_target)
+        assert_equal(miner.submit(job[0], extranonce2, ntime, nonce)['result'], True)
+        self.wait_until(lambda: node.getbestblockhash() != tip)
+
+        block_hash = node.getbestblockhash()
+        block = node.getblock(block_hash)
+        assert_equal(block['previousblockhash'], tip)
+        assert_equal(len(block['tx']), 3)
+        assert_equal(block['tx'][1], pegin_txid)
+        assert 'mweb' in block
+        assert_equal(get_hogex_tx(node, block_hash).hash, block['tx'][2])
+
+    def test_job_cap(self, miner):
+        self.log.info("Only accept shares for the last {} jobs built on a tip".format(MAX_STRATUM_JOBS_PER_TIP))
+        node = self.nodes[0]
+        mini_wallet = MiniWallet(node)
+        mini_wallet.generate(1)
+        node.generatetoaddress(100, ADDRESS_BCRT1_UNSPENDABLE)
+        tip = node.getbestblockhash()
+
+        jobs = []
+        while not jobs:
+            job = miner.wait_for_notification('mining.notify')['params']
+            if job[1] == stratum_prevhash(tip) and job[8]:
+                jobs.append(job)
+        # Each transaction changes the mempool, so the next refresh builds another job on the same tip
+        while len(jobs) <= MAX_STRATUM_JOBS_PER_TIP:
+            mini_wallet.send_self_transfer(fee_rate=Decimal("0.01"), from_node=node)
+            job = miner.wait_for_notification('mining.notify')['params']
+            assert_equal(job[1], stratum_prevhash(tip))
+            assert_equal(job[8], False)
+            jobs.append(job)
+
+        extranonce2 = bytes(miner.extranonce2_size)
+        for job, error in [(jobs[0], 21), (jobs[1], 23)]:
+            ntime = int(job[7], 16)
+            nonce = miner.find_nonce(job, extranonce2, ntime, lambda h: h > SHARE_TARGET)
+            assert_equal(miner.submit(job[0], extranonce2, ntime, nonce)['error'][0], error)
+
+
+if __name__ == '__main__':
+    StratumTest().main()
@@ -0,0 +1,80 @@
+#!/usr/bin/env python3
+# Copyright (c) 2021 The Catcoin Core developers
+# Distributed under the MIT software license, see the accompanying
+# file COPYING or http://www.opensource.org/licenses/mit-license.php.
+"""Test the MWEB block summary REST endpoint"""
+
+import http.client
+from io import BytesIO
+import struct
+import urllib.parse
+
+from test_framework.ltc_util import get_hog_addr_txout, get_mweb_header, setup_mweb_chain
+from test_framework.messages import COIN, MWEBHeader, MWEBKernel, deser_compact_size, deser_varint, deser_vector
+from test_framework.test_framework import BitcoinTestFramework
+from test_framework.util import assert_equal
+
+class MWEBRestTest(BitcoinTestFramework):
+    def set_test_params(self):
+        self.setup_clean_chain = True
+        self.num_nodes = 1
+        self.extra_args = [["-rest"]]
+
+    def skip_test_if_missing_module(self):
+        self.skip_if_no_wallet()
+
+    def get_summary(self, block_hash, ext='bin', status=200):
+        url = urllib.parse.urlparse(self.nodes[0].url)
+        conn = http.client.HTTPConnection(url.hostname, url.port)
+        conn.request('GET', '/rest/mwebblock/{}.{}'.format(block_hash, ext))
+        resp = conn.getresponse()
+        assert_equal(resp.status, status)
+        return resp.read()
+
+    def run_test(self):
+        node = self.nodes[0]
+
+        self.log.info("Setup MWEB chain")
+        setup_mweb_chain(node)
+
+        self.log.info("Check the summary of a block without MWEB data")
+        pre_mweb_hash = node.getblockhash(1)
+        f = BytesIO(self.get_summary(pre_mweb_hash))
+        assert_equal(f.read(32)[::-1].hex(), pre_mweb_hash)
+        assert_equal(struct.unpack("<i", f.read(4))[0], 1)
+        assert_equal(deser_varint(f), 0)
+        assert_equal(f.read(1), b"\x00")
+        assert_equal(f.read(), b"\x00\x00\x00")
+
+        self.log.info("Check the summary of the first MWEB block")
+        block_hash = node.getbestblockhash()
+        summary = self.get_summary(block_hash)
+        assert_equal(self.get_summary(block_hash, 'hex').decode().strip(), summary.hex())
+
+        f = BytesIO(summary)
+        assert_equal(f.read(32)[::-1].hex(), block_hash)
+        assert_equal(struct.unpack("<i", f.read(4))[0], node.getblockcount())
+        assert_equal(deser_varint(f), get_hog_addr_txout(node).nValue)
+
+        assert_equal(f.read(1), b"\x01")
+        header = MWEBHeader()
+        header.deserialize(f)
+        assert_equal(header.hash, get_mweb_header(node).hash)
+
+        kernels = deser_vector(f, MWEBKernel)
+        assert_equal(len(kernels), 1)
+        assert_equal(kernels[0].pegin, 1 * COIN)
+
+        assert_equal(deser_compact_size(f), 1)
+        assert_equal(deser_varint(f), 1 * COIN)
+        assert_equal(f.read(32), kernels[0].hash.serialize())
+
+        assert_equal(deser_compact_size(f), 0)
+        assert_equal(f.read(), b"")
+
+        self.log.info("Check error handling")
+        self.get_summary(block_hash, 'json', status=404)
+        self.get_summary("0" * 64, status=404)
+
+if __name__ == '__main__':
+    MWEBRestTest().main()
@@ -231,6 +231,14 @@ class BlockchainTest(BitcoinTestFramework):
         assert size < 64000
         assert_equal(len(res['bestblock']), 64)
         assert_equal(len(res['hash_serialized_2']), 64)
+        assert_equal(res['mweb_utxos'], 0)
+        assert_equal(res['mweb_amount'], Decimal('0'))
+        assert 'mweb_sums_valid' not in res
+
+        self.log.info("Test that gettxoutsetinfo() audits the MWEB commitment sums")
+        res_mweb = node.gettxoutsetinfo("none", True)
+        assert_equal(res_mweb['mweb_sums_valid'], True)
+        assert_equal(res_mweb['txouts'], res['txouts'])
 
         self.log.info("Test that gettxoutsetinfo() works for blockchain with just the genesis block")
         b1hash = node.getblockhash(1)
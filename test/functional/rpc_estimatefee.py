@@ -10,7 +10,7 @@ Test the following RPCs:
 """
 
 from test_framework.test_framework import BitcoinTestFramework
-from test_framework.util import assert_raises_rpc_error
+from test_framework.util import assert_equal, assert_raises_rpc_error
 
 class EstimateFeeTest(BitcoinTestFramework):
     def set_test_params(self):
@@ -30,17 +30,24 @@ class EstimateFeeTest(BitcoinTestFramework):
         assert_raises_rpc_error(-3, "Expected type string, got number", self.nodes[0].estimatesmartfee, 1, 1)
         assert_raises_rpc_error(-8, 'Invalid estimate_mode parameter, must be one of: "unset", "economical", "conservative"', self.nodes[0].estimatesmartfee, 1, 'foo')
 
+        # wrong type for estimatesmartfee(mweb)
+        assert_raises_rpc_error(-3, "Expected type bool, got number", self.nodes[0].estimatesmartfee, 1, 'ECONOMICAL', 1)
+
         # wrong type for estimaterawfee(threshold)
         assert_raises_rpc_error(-3, "Expected type number, got string", self.nodes[0].estimaterawfee, 1, 'foo')
 
         # extra params
-        assert_raises_rpc_error(-1, "estimatesmartfee", self.nodes[0].estimatesmartfee, 1, 'ECONOMICAL', 1)
+        assert_raises_rpc_error(-1, "estimatesmartfee", self.nodes[0].estimatesmartfee, 1, 'ECONOMICAL', True, 1)
         assert_raises_rpc_error(-1, "estimaterawfee", self.nodes[0].estimaterawfee, 1, 1, 1)
 
         # valid calls
         self.nodes[0].estimatesmartfee(1)
         # self.nodes[0].estimatesmartfee(1, None)
         self.nodes[0].estimatesmartfee(1, 'ECONOMICAL')
+        assert_equal(self.nodes[0].estimatesmartfee(1, 'ECONOMICAL', True)['errors'], [
+            "Insufficient data or no feerate found",
+            "Insufficient data or no MWEB feerate found",
+        ])
 
         self.nodes[0].estimaterawfee(1)
         self.nodes[0].estimaterawfee(1, None)
@@ -9,7 +9,7 @@ from test_framework.util import (
     assert_equal, assert_is_hex_string, assert_raises_rpc_error,
     )
 
-FILTER_TYPES = ["basic"]
+FILTER_TYPES = ["basic", "mweb"]
 
 class GetBlockFilterTest(BitcoinTestFramework):
     def set_test_params(self):
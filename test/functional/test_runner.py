@@ -232,6 +232,7 @@ BASE_SCRIPTS = [
     'rpc_bind.py --ipv6',
     'rpc_bind.py --nonloopback',
     'mining_basic.py',
+    'mining_stratum.py',
     'feature_signet.py',
     'wallet_bumpfee.py',
     'wallet_bumpfee.py --descriptors',
@@ -248,6 +249,7 @@ BASE_SCRIPTS = [
     'mweb_basic.py',
     'mweb_mining.py',
     'mweb_reorg.py',
+    'mweb_rest.py',
     'mweb_p2p.py',
     'mweb_pegout_all.py',
     'mweb_node_compatibility.py',
@@ -290,6 +292,8 @@ BASE_SCRIPTS = [
     'feature_blocksdir.py',
     'wallet_startup.py',
     'feature_config_args.py',
+    'feature_dboption.py',
+    'feature_backgroundflush.py',
     'feature_settings.py',
     'rpc_getdescriptorinfo.py',
     'rpc_getpeerinfo_deprecation.py',
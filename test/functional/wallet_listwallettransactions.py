@@ -146,5 +146,29 @@ class ListWalletTransactionsTest(BitcoinTestFramework):
 
         # TODO: Reorg and ensure hogex is marked as not accepted
 
+        # pages are slices of the full, newest-first list
+        all_records = node0.listwallettransactions()
+        assert_equal(node0.listwallettransactions("", len(all_records)), all_records)
+        assert_equal(node0.listwallettransactions("", 3), all_records[:3])
+        assert_equal(node0.listwallettransactions("", 3, 2), all_records[2:5])
+        assert_equal(node0.listwallettransactions(count=2, skip=len(all_records) - 1), all_records[-1:])
+        assert_equal(node0.listwallettransactions("", 0), [])
+
+        # records of txs with the same height and time received are kept together, so no page
+        # repeats or misses one
+        node0.setmocktime(node0.getblockheader(node0.getbestblockhash())['time'] + 1)
+        tie_txids = [node0.sendmany("", {node1.getnewaddress(): 1, node1.getnewaddress(): 2}) for _ in range(3)]
+        node0.generate(1)
+        node0.setmocktime(0)
+        all_records = node0.listwallettransactions()
+        tie_records = [r["txid"] for r in all_records if r["txid"] in tie_txids]
+        assert_equal(len(tie_records), 6)
+        assert all(tie_records[i] == tie_records[i + 1] for i in range(0, 6, 2))
+        for count in range(1, 4):
+            paged = []
+            while len(paged) < 10:
+                paged += node0.listwallettransactions("", count, len(paged))
+            assert_equal(paged, all_records[:len(paged)])
+
 if __name__ == '__main__':
     ListWalletTransactionsTest().main()